@@ -19,6 +19,7 @@
 #include "gpio.h"
 #include "errno-base.h"
 #include "cmsis_compiler.h"
+#include <assert.h>
 
 /* Debug support - optional */
 #define  LOG_TAG             "spi"
@@ -29,16 +30,39 @@
 static LIST_HEAD(spi_controller_list);  /* Controller list head */
 
 /* Private define ------------------------------------------------------------*/
+#define SPI_DUMMY_BUF_SIZE      (16U)   /* Fill bytes per emulated dummy chunk */
+#define SPI_XFER_IN_FLIGHT      (1)     /* Async transfer started, resumed from ISR */
 
 /* Private macro -------------------------------------------------------------*/
+/* A waiter spins until the bus owner (pump caller or completion ISR) is done,
+ * so it must not be an ISR itself nor have interrupts masked */
+#define SPI_ASSERT_CAN_WAIT()   assert((__get_IPSR() == 0U) && (__get_PRIMASK() == 0U))
 
 /* Private variables ---------------------------------------------------------*/
+static const uint8_t spi_dummy_fill[SPI_DUMMY_BUF_SIZE] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
 
 /* Exported variables -------------------------------------------------------*/
 
 /* Private function prototypes -----------------------------------------------*/
 static int spi_controller_setup_internal(struct spi_controller *ctrl, 
                                          struct spi_device *dev);
+static int spi_validate_transfer(const struct spi_controller *ctrl,
+                                 const struct spi_transfer *xfer);
+static uint8_t spi_dummy_nbits(const struct spi_controller *ctrl,
+                               const struct spi_transfer *xfer);
+static int spi_transfer_dummy(struct spi_controller *ctrl,
+                              struct spi_device *dev,
+                              const struct spi_transfer *xfer);
+static void spi_pump_messages(struct spi_controller *ctrl);
+static int spi_prepare_device(struct spi_controller *ctrl, struct spi_device *dev);
+static int spi_run_transfers(struct spi_controller *ctrl);
+static void spi_transfer_done(struct spi_controller *ctrl, struct spi_transfer *xfer);
+static void spi_finalize_message(struct spi_controller *ctrl, int status);
+static void spi_mmap_sync(struct spi_controller *ctrl);
+static void spi_wait_bus(struct spi_controller *ctrl);
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -134,6 +158,18 @@ int spi_controller_register(struct spi_controller *ctrl,
     ctrl->actual_speed_hz = 0U;
     ctrl->current_device = NULL;
     
+    /* Initialize message queue */
+    list_node_init(&ctrl->queue);
+    ctrl->cur_msg = NULL;
+    ctrl->cur_transfer = NULL;
+    ctrl->busy = 0U;
+    ctrl->cs_active = 0U;
+    
+    /* No mapping until spi_mmap_enable() */
+    ctrl->mmap_dev = NULL;
+    ctrl->mmap_refs = 0U;
+    ctrl->mmap_on = 0U;
+    
     /* Add to list */
     list_add_tail(&ctrl->node, &spi_controller_list);
     
@@ -220,8 +256,11 @@ void spi_message_init(struct spi_message *m)
     }
     
     list_node_init(&m->transfers);
+    list_node_init(&m->queue);
     m->spi = NULL;
     m->status = 0;
+    m->actual_length = 0U;
+    m->complete = NULL;
     m->context = NULL;
 }
 
@@ -241,18 +280,66 @@ void spi_message_add_tail(struct spi_transfer *t, struct spi_message *m)
 
 /**
  * @brief Synchronous SPI message transfer
+ * @details Queues the message like spi_async() and waits for it. With a
+ *          controller lacking transfer_one_async the transfers run in the
+ *          caller's context exactly as before.
+ * @note Only call from thread context with interrupts enabled, never from
+ *       an ISR or completion callback. If the bus is busy the call spins
+ *       until the current owner finishes. Without ops->wait all users of
+ *       one controller must run in the same task (or round-robin tasks of
+ *       equal priority); a caller that preempted the pump owner would wait
+ *       forever. Asserted when the call has to wait.
  * @param dev Device pointer
  * @param message Message pointer
  * @return 0 on success, error code on failure
  */
 int spi_sync(struct spi_device *dev, struct spi_message *message)
+{
+    int ret;
+    
+    if (message == NULL) {
+        return -EINVAL;
+    }
+    
+    message->complete = NULL;
+    message->context = NULL;
+    
+    ret = spi_async(dev, message);
+    if (ret != 0) {
+        return ret;
+    }
+    
+    /* Completed by the pump, either here or from the controller ISR */
+    if (message->status == SPI_MSG_PENDING) {
+        SPI_ASSERT_CAN_WAIT();
+    }
+    while (message->status == SPI_MSG_PENDING) {
+        spi_wait_bus(dev->controller);
+    }
+    
+    return message->status;
+}
+
+/**
+ * @brief Asynchronous SPI message transfer
+ * @details The message is appended to the controller FIFO. If the
+ *          controller is idle the pump starts immediately in the caller's
+ *          context; with transfer_one_async the call returns as soon as the
+ *          first transfer is started and the rest is chained from
+ *          spi_transfer_complete(). message->complete(message->context) is
+ *          called once message->status is final.
+ * @note The message and its transfers must stay valid until completion
+ * @param dev Device pointer
+ * @param message Message pointer
+ * @return 0 if queued, error code on failure (complete is not called)
+ */
+int spi_async(struct spi_device *dev, struct spi_message *message)
 {
     struct spi_controller *ctrl;
     struct spi_transfer *transfer;
-    struct spi_transfer *transfer_next;
+    uint32_t primask;
+    uint8_t start;
     int ret;
-    uint8_t cs_active;
-    uint8_t need_setup;
     
     /* Parameter validation */
     if ((dev == NULL) || (message == NULL)) {
@@ -269,78 +356,590 @@ int spi_sync(struct spi_device *dev, struct spi_message *message)
         return -EINVAL;
     }
     
-    /* Initialize message status */
+    /* Reject bus widths/features the controller cannot drive before queuing */
+    list_for_each_entry(transfer, &message->transfers, transfer_list) {
+        ret = spi_validate_transfer(ctrl, transfer);
+        if (ret != 0) {
+            message->status = ret;
+            return ret;
+        }
+    }
+    
     message->spi = dev;
-    message->status = 0;
+    message->actual_length = 0U;
+    message->status = SPI_MSG_PENDING;
+    
+    primask = __get_PRIMASK();
+    __disable_irq();
+    list_add_tail(&message->queue, &ctrl->queue);
+    start = (ctrl->busy == 0U) ? 1U : 0U;
+    ctrl->busy = 1U;
+    __set_PRIMASK(primask);
+    
+    if (start != 0U) {
+        spi_pump_messages(ctrl);
+    }
     
-    need_setup = 0U;
-    if ((ctrl->current_device != dev) ||
-        (ctrl->mode != dev->mode) ||
-        (ctrl->bits_per_word != dev->bits_per_word) ||
-        (ctrl->max_speed_hz != dev->max_speed_hz)) {
-        need_setup = 1U;
+    return 0;
+}
+
+/**
+ * @brief Report completion of a transfer started by transfer_one_async
+ * @details Called by the BSP from its DMA/SPI completion interrupt. Starts
+ *          the next transfer of the current message, or completes the
+ *          message and starts the next queued one.
+ * @param ctrl Controller pointer
+ * @param status Bytes transferred (>=0) or error code (<0)
+ */
+void spi_transfer_complete(struct spi_controller *ctrl, int status)
+{
+    struct spi_transfer *transfer;
+    int ret;
+    
+    if ((ctrl == NULL) || (ctrl->cur_msg == NULL) || (ctrl->cur_transfer == NULL)) {
+        return;
     }
     
-    /* Setup controller if needed */
-    if (need_setup != 0U) {
-        ret = spi_controller_setup_internal(ctrl, dev);
-        if (ret != 0) {
-            message->status = ret;
-            return ret;
+    transfer = ctrl->cur_transfer;
+    
+    if (status < 0) {
+        spi_finalize_message(ctrl, status);
+    } else {
+        spi_transfer_done(ctrl, transfer);
+        
+        ret = spi_run_transfers(ctrl);
+        if (ret == SPI_XFER_IN_FLIGHT) {
+            return;
+        }
+        spi_finalize_message(ctrl, ret);
+    }
+    
+    spi_pump_messages(ctrl);
+}
+
+/**
+ * @brief Map the device into the controller's memory window
+ * @details The first call programs the controller; later calls from the
+ *          same device with the same template only take a reference.
+ *          Messages queued while mapped temporarily leave mapped mode,
+ *          the window is restored when the queue drains.
+ * @note The window must not be dereferenced while messages are in flight
+ *       on the same controller
+ * @param dev Device pointer
+ * @param info Read command template
+ * @param base Output: CPU address of device offset 0
+ * @param size Output: window size in bytes (may be NULL)
+ * @return 0 on success, -ENOTSUPP without mmap ops, -EBUSY if the
+ *         controller is busy or mapped for another device/template
+ */
+int spi_mmap_enable(struct spi_device *dev, const struct spi_mmap_info *info,
+                    const void **base, size_t *size)
+{
+    struct spi_controller *ctrl;
+    uint32_t primask;
+    int ret;
+    
+    if ((dev == NULL) || (info == NULL) || (base == NULL)) {
+        return -EINVAL;
+    }
+    
+    if (spi_mmap_supported(dev) == 0) {
+        return -ENOTSUPP;
+    }
+    
+    ctrl = dev->controller;
+    
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if (ctrl->busy != 0U) {
+        __set_PRIMASK(primask);
+        return -EBUSY;
+    }
+    
+    if (ctrl->mmap_refs != 0U) {
+        if ((ctrl->mmap_dev != dev) ||
+            (memcmp(&ctrl->mmap_info, info, sizeof(*info)) != 0)) {
+            __set_PRIMASK(primask);
+            return -EBUSY;
+        }
+        ctrl->mmap_refs++;
+        __set_PRIMASK(primask);
+        
+        *base = ctrl->mmap_base;
+        if (size != NULL) {
+            *size = ctrl->mmap_size;
         }
+        return 0;
     }
     
-    /* Process transfers */
-    cs_active = 0U;
-    ret = 0;
+    /* Own the controller like the pump does */
+    ctrl->busy = 1U;
+    __set_PRIMASK(primask);
     
-    {
-        struct spi_transfer *transfer_next;
-        uint8_t has_next;
+    ret = spi_controller_setup_internal(ctrl, dev);
+    if (ret == 0) {
+        ret = ctrl->ops->mmap_enable(ctrl, dev, info, &ctrl->mmap_base, &ctrl->mmap_size);
+    }
+    
+    if (ret == 0) {
+        ctrl->mmap_info = *info;
+        ctrl->mmap_dev = dev;
+        ctrl->mmap_on = 1U;
+        ctrl->mmap_refs = 1U;
         
-        list_for_each_entry_safe(transfer, transfer_next, &message->transfers, transfer_list) {
-            
-            /* Check if there's a next transfer before processing current one */
-            has_next = (uint8_t)((&transfer_next->transfer_list != &message->transfers) ? 1U : 0U);
-            
-            /* Skip zero-length transfers */
-            if (transfer->len == 0U) {
+        *base = ctrl->mmap_base;
+        if (size != NULL) {
+            *size = ctrl->mmap_size;
+        }
+    }
+    
+    /* Run messages queued meanwhile and drop ownership */
+    spi_pump_messages(ctrl);
+    
+    return ret;
+}
+
+/**
+ * @brief Drop a reference taken by spi_mmap_enable()
+ * @details The controller leaves mapped mode when the last reference is
+ *          released and the bus is idle
+ * @param dev Device pointer
+ */
+void spi_mmap_disable(struct spi_device *dev)
+{
+    struct spi_controller *ctrl;
+    uint32_t primask;
+    uint8_t start;
+    
+    if ((dev == NULL) || (dev->controller == NULL)) {
+        return;
+    }
+    
+    ctrl = dev->controller;
+    
+    primask = __get_PRIMASK();
+    __disable_irq();
+    if ((ctrl->mmap_refs == 0U) || (ctrl->mmap_dev != dev)) {
+        __set_PRIMASK(primask);
+        return;
+    }
+    
+    ctrl->mmap_refs--;
+    start = (ctrl->busy == 0U) ? 1U : 0U;
+    ctrl->busy = 1U;
+    __set_PRIMASK(primask);
+    
+    /* A running pump syncs the mapping itself before going idle */
+    if (start != 0U) {
+        spi_pump_messages(ctrl);
+    }
+}
+
+/**
+ * @brief Poll a status register until the masked bits match
+ * @details Waits for the bus like a queued message, then lets the
+ *          controller repeat the status read in hardware. Messages queued
+ *          meanwhile run afterwards, and a memory mapping is restored.
+ * @note Same calling context as spi_sync(): thread context, interrupts
+ *       enabled, not preempting the task that owns the bus
+ * @param dev Device pointer
+ * @param info Status read and match condition
+ * @param status Output: last status byte read (may be NULL)
+ * @return 0 on match, -ETIMEDOUT, -ENOTSUPP without poll_status op or
+ *         for a template the controller cannot poll, error code on failure
+ */
+int spi_poll_status(struct spi_device *dev, const struct spi_poll_info *info, uint8_t *status)
+{
+    struct spi_controller *ctrl;
+    uint32_t primask;
+    uint8_t sr = 0U;
+    int ret;
+    
+    if ((dev == NULL) || (info == NULL)) {
+        return -EINVAL;
+    }
+    
+    if (spi_poll_supported(dev) == 0) {
+        return -ENOTSUPP;
+    }
+    
+    ctrl = dev->controller;
+    
+    /* Own the controller once in-flight messages have drained */
+    for (;;) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if (ctrl->busy == 0U) {
+            ctrl->busy = 1U;
+            __set_PRIMASK(primask);
+            break;
+        }
+        __set_PRIMASK(primask);
+        SPI_ASSERT_CAN_WAIT();
+        spi_wait_bus(ctrl);
+    }
+    
+    ret = spi_prepare_device(ctrl, dev);
+    if (ret == 0) {
+        ret = ctrl->ops->poll_status(ctrl, dev, info, &sr);
+    }
+    
+    if (status != NULL) {
+        *status = sr;
+    }
+    
+    spi_pump_messages(ctrl);
+    
+    return ret;
+}
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief Check a transfer against the controller capabilities
+ * @param ctrl Controller pointer
+ * @param xfer Transfer pointer
+ * @return 0 if the controller can execute it, -EINVAL for a malformed
+ *         transfer, -ENOTSUPP if it needs an unsupported lane/feature
+ */
+static int spi_validate_transfer(const struct spi_controller *ctrl,
+                                 const struct spi_transfer *xfer)
+{
+    uint32_t caps = ctrl->ops->caps;
+    uint8_t nbits;
+    
+    switch (xfer->tx_nbits) {
+    case 0U:
+    case SPI_NBITS_SINGLE:
+        break;
+    case SPI_NBITS_DUAL:
+        if ((caps & (SPI_CAP_TX_DUAL | SPI_CAP_TX_QUAD)) == 0U) {
+            return -ENOTSUPP;
+        }
+        break;
+    case SPI_NBITS_QUAD:
+        if ((caps & SPI_CAP_TX_QUAD) == 0U) {
+            return -ENOTSUPP;
+        }
+        break;
+    default:
+        return -EINVAL;
+    }
+    
+    switch (xfer->rx_nbits) {
+    case 0U:
+    case SPI_NBITS_SINGLE:
+        break;
+    case SPI_NBITS_DUAL:
+        if ((caps & (SPI_CAP_RX_DUAL | SPI_CAP_RX_QUAD)) == 0U) {
+            return -ENOTSUPP;
+        }
+        break;
+    case SPI_NBITS_QUAD:
+        if ((caps & SPI_CAP_RX_QUAD) == 0U) {
+            return -ENOTSUPP;
+        }
+        break;
+    default:
+        return -EINVAL;
+    }
+    
+    /* Multi-lane lines are half-duplex */
+    if ((xfer->tx_buf != NULL) && (xfer->rx_buf != NULL) &&
+        ((xfer->tx_nbits > SPI_NBITS_SINGLE) || (xfer->rx_nbits > SPI_NBITS_SINGLE))) {
+        return -EINVAL;
+    }
+    
+    if ((xfer->dtr != 0U) && ((caps & SPI_CAP_DTR) == 0U)) {
+        return -ENOTSUPP;
+    }
+    
+    if ((xfer->dummy_cycles != 0U) && ((caps & SPI_CAP_DUMMY) == 0U)) {
+        /* Emulated dummy must be a whole number of SDR bytes */
+        if (xfer->dtr != 0U) {
+            return -ENOTSUPP;
+        }
+        nbits = spi_dummy_nbits(ctrl, xfer);
+        if (((uint32_t)xfer->dummy_cycles * nbits) % 8U != 0U) {
+            return -EINVAL;
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Bus width used to emulate the dummy phase of a transfer
+ * @details Dummy clocks are sent at the data phase width so that each byte
+ *          covers 8/nbits cycles; falls back to single lane when the
+ *          controller cannot transmit at that width (e.g. 1-1-4 reads on
+ *          an RX-only quad controller).
+ * @param ctrl Controller pointer
+ * @param xfer Transfer pointer
+ * @return Lane count used for the fill bytes
+ */
+static uint8_t spi_dummy_nbits(const struct spi_controller *ctrl,
+                               const struct spi_transfer *xfer)
+{
+    uint32_t caps = ctrl->ops->caps;
+    uint8_t nbits;
+    
+    nbits = (xfer->rx_buf != NULL) ? xfer->rx_nbits : xfer->tx_nbits;
+    
+    if ((nbits == SPI_NBITS_QUAD) && ((caps & SPI_CAP_TX_QUAD) != 0U)) {
+        return SPI_NBITS_QUAD;
+    }
+    if ((nbits >= SPI_NBITS_DUAL) && ((caps & (SPI_CAP_TX_DUAL | SPI_CAP_TX_QUAD)) != 0U)) {
+        return SPI_NBITS_DUAL;
+    }
+    
+    return SPI_NBITS_SINGLE;
+}
+
+/**
+ * @brief Emulate dummy cycles by clocking out 0xFF bytes
+ * @param ctrl Controller pointer
+ * @param dev Device pointer
+ * @param xfer Transfer whose dummy phase is emulated
+ * @return 0 on success, error code on failure
+ */
+static int spi_transfer_dummy(struct spi_controller *ctrl,
+                              struct spi_device *dev,
+                              const struct spi_transfer *xfer)
+{
+    struct spi_transfer dummy;
+    size_t remaining;
+    ssize_t ret;
+    uint8_t nbits;
+    
+    nbits = spi_dummy_nbits(ctrl, xfer);
+    
+    (void)memset(&dummy, 0, sizeof(dummy));
+    dummy.tx_nbits = nbits;
+    
+    remaining = ((size_t)xfer->dummy_cycles * nbits) / 8U;
+    while (remaining > 0U) {
+        dummy.tx_buf = spi_dummy_fill;
+        dummy.len = (remaining > SPI_DUMMY_BUF_SIZE) ? SPI_DUMMY_BUF_SIZE : remaining;
+        
+        ret = ctrl->ops->transfer_one(ctrl, dev, &dummy);
+        if (ret < 0) {
+            return (int)ret;
+        }
+        remaining -= dummy.len;
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Run queued messages until the queue is empty or a transfer is in flight
+ * @note Caller must own ctrl->busy; ownership is dropped when the queue drains
+ * @param ctrl Controller pointer
+ */
+static void spi_pump_messages(struct spi_controller *ctrl)
+{
+    struct spi_message *msg;
+    uint32_t primask;
+    int ret;
+    
+    for (;;) {
+        primask = __get_PRIMASK();
+        __disable_irq();
+        if (list_empty(&ctrl->queue)) {
+            /* Restore/leave mapped mode before handing the bus back */
+            if ((ctrl->mmap_refs != 0U) != (ctrl->mmap_on != 0U)) {
+                __set_PRIMASK(primask);
+                spi_mmap_sync(ctrl);
                 continue;
             }
-            
-            /* Activate CS if not already active */
-            if (cs_active == 0U) {
-                ctrl->ops->set_cs(ctrl, dev, 1U);
-                cs_active = 1U;
+            ctrl->busy = 0U;
+            __set_PRIMASK(primask);
+            return;
+        }
+        msg = list_first_entry(&ctrl->queue, struct spi_message, queue);
+        list_del(&msg->queue);
+        __set_PRIMASK(primask);
+        
+        ctrl->cur_msg = msg;
+        ctrl->cur_transfer = NULL;
+        
+        ret = spi_prepare_device(ctrl, msg->spi);
+        if (ret == 0) {
+            ret = spi_run_transfers(ctrl);
+            if (ret == SPI_XFER_IN_FLIGHT) {
+                return;
             }
-            
-            /* Execute transfer */
-            ret = (int)ctrl->ops->transfer_one(ctrl, dev, transfer);
+        }
+        
+        spi_finalize_message(ctrl, ret);
+    }
+}
+
+/**
+ * @brief Reconfigure the controller if the next user is another device/mode
+ * @param ctrl Controller pointer
+ * @param dev Device about to use the bus
+ * @return 0 on success, error code on failure
+ */
+static int spi_prepare_device(struct spi_controller *ctrl, struct spi_device *dev)
+{
+    /* Indirect transfers are not possible while memory-mapped */
+    if (ctrl->mmap_on != 0U) {
+        ctrl->ops->mmap_disable(ctrl, ctrl->mmap_dev);
+        ctrl->mmap_on = 0U;
+    }
+    
+    if ((ctrl->current_device != dev) ||
+        (ctrl->mode != dev->mode) ||
+        (ctrl->bits_per_word != dev->bits_per_word) ||
+        (ctrl->max_speed_hz != dev->max_speed_hz)) {
+        return spi_controller_setup_internal(ctrl, dev);
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief Execute the remaining transfers of the current message
+ * @details Resumes after ctrl->cur_transfer (or from the head when NULL).
+ *          Synchronous transfers are run back to back; an async transfer
+ *          is started and the function returns SPI_XFER_IN_FLIGHT.
+ * @param ctrl Controller pointer
+ * @return 0 when all transfers are done, SPI_XFER_IN_FLIGHT, or error code
+ */
+static int spi_run_transfers(struct spi_controller *ctrl)
+{
+    struct spi_message *msg = ctrl->cur_msg;
+    struct spi_device *dev = msg->spi;
+    struct spi_transfer *transfer;
+    struct list_node *node;
+    ssize_t sret;
+    int ret;
+    
+    node = (ctrl->cur_transfer == NULL) ? msg->transfers.next :
+                                          ctrl->cur_transfer->transfer_list.next;
+    
+    for (; node != &msg->transfers; node = node->next) {
+        transfer = list_entry(node, struct spi_transfer, transfer_list);
+        ctrl->cur_transfer = transfer;
+        
+        /* Skip zero-length transfers */
+        if (transfer->len == 0U) {
+            continue;
+        }
+        
+        /* Activate CS if not already active */
+        if (ctrl->cs_active == 0U) {
+            ctrl->ops->set_cs(ctrl, dev, 1U);
+            ctrl->cs_active = 1U;
+        }
+        
+        /* Emulate dummy cycles if the controller cannot generate them */
+        if ((transfer->dummy_cycles != 0U) &&
+            ((ctrl->ops->caps & SPI_CAP_DUMMY) == 0U)) {
+            ret = spi_transfer_dummy(ctrl, dev, transfer);
             if (ret < 0) {
-                message->status = ret;
-                break;
-            }
-            
-            /* Handle CS change */
-            if (transfer->cs_change != 0U) {
-                /* Deactivate CS */
-                ctrl->ops->set_cs(ctrl, dev, 0U);
-                cs_active = 0U;
-                
-                /* Reactivate CS for next transfer if exists */
-                if (has_next != 0U) {
-                    ctrl->ops->set_cs(ctrl, dev, 1U);
-                    cs_active = 1U;
-                }
+                return ret;
             }
         }
+        
+        if (ctrl->ops->transfer_one_async != NULL) {
+            ret = ctrl->ops->transfer_one_async(ctrl, dev, transfer);
+            return (ret < 0) ? ret : SPI_XFER_IN_FLIGHT;
+        }
+        
+        sret = ctrl->ops->transfer_one(ctrl, dev, transfer);
+        if (sret < 0) {
+            return (int)sret;
+        }
+        
+        spi_transfer_done(ctrl, transfer);
     }
     
-    /* Ensure CS is deactivated */
-    if (cs_active != 0U) {
-        ctrl->ops->set_cs(ctrl, dev, 0U);
+    return 0;
+}
+
+/**
+ * @brief Account a finished transfer and apply its cs_change
+ * @param ctrl Controller pointer
+ * @param xfer Finished transfer
+ */
+static void spi_transfer_done(struct spi_controller *ctrl, struct spi_transfer *xfer)
+{
+    ctrl->cur_msg->actual_length += xfer->len;
+    
+    /* CS is re-asserted by the next non-empty transfer */
+    if ((xfer->cs_change != 0U) && (ctrl->cs_active != 0U)) {
+        ctrl->ops->set_cs(ctrl, ctrl->cur_msg->spi, 0U);
+        ctrl->cs_active = 0U;
     }
+}
+
+/**
+ * @brief Release CS, publish the status and notify the submitter
+ * @param ctrl Controller pointer
+ * @param status Final message status
+ */
+static void spi_finalize_message(struct spi_controller *ctrl, int status)
+{
+    struct spi_message *msg = ctrl->cur_msg;
+    void (*complete)(void *context);
+    void *context;
     
-    message->status = ret;
-    return ret;
+    if (ctrl->cs_active != 0U) {
+        ctrl->ops->set_cs(ctrl, msg->spi, 0U);
+        ctrl->cs_active = 0U;
+    }
+    
+    ctrl->cur_msg = NULL;
+    ctrl->cur_transfer = NULL;
+    
+    /* A spi_sync() waiter may release the message as soon as status is set */
+    complete = msg->complete;
+    context = msg->context;
+    msg->status = status;
+    
+    if (complete != NULL) {
+        complete(context);
+    }
+}
+
+/**
+ * @brief Let the bus owner run while a synchronous caller waits
+ * @param ctrl Controller pointer
+ */
+static void spi_wait_bus(struct spi_controller *ctrl)
+{
+    if (ctrl->ops->wait != NULL) {
+        ctrl->ops->wait(ctrl);
+    }
+}
+
+/**
+ * @brief Bring the hardware mapping state in line with mmap_refs
+ * @note Caller must own ctrl->busy. If re-entering fails the mapping is
+ *       dropped so the pump cannot loop on it.
+ * @param ctrl Controller pointer
+ */
+static void spi_mmap_sync(struct spi_controller *ctrl)
+{
+    int ret;
+    
+    if ((ctrl->mmap_refs != 0U) && (ctrl->mmap_on == 0U)) {
+        ret = spi_controller_setup_internal(ctrl, ctrl->mmap_dev);
+        if (ret == 0) {
+            ret = ctrl->ops->mmap_enable(ctrl, ctrl->mmap_dev, &ctrl->mmap_info,
+                                         &ctrl->mmap_base, &ctrl->mmap_size);
+        }
+        if (ret == 0) {
+            ctrl->mmap_on = 1U;
+        } else {
+            LOG_E("%s: failed to restore memory mapping (%d)", ctrl->name, ret);
+            ctrl->mmap_refs = 0U;
+        }
+    } else if ((ctrl->mmap_refs == 0U) && (ctrl->mmap_on != 0U)) {
+        ctrl->ops->mmap_disable(ctrl, ctrl->mmap_dev);
+        ctrl->mmap_on = 0U;
+    }
 }
@@ -0,0 +1,131 @@
+/**
+  ******************************************************************************
+  * @file        : crc32.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : CRC-32 (IEEE 802.3) slice-by-8 / 半字节查表实现
+  * @attention   : 与 zlib crc32() 结果一致, 初值传0, 可分段累加
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "crc32.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+/* 16项表, 兼顾ROM占用与速度 */
+static const uint32_t crc32_nibble_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+#if CRC32_SLICE_BY_8
+/* crc32_table[k][b]: 字节b后跟k个0字节的CRC余式 */
+static uint32_t crc32_table[8][256];
+static volatile uint8_t crc32_table_ready;
+#endif
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+#if CRC32_SLICE_BY_8
+static void crc32_table_init(void);
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  计算CRC-32
+  * @param  crc 上一段的结果, 首段传0
+  * @param  buf 数据
+  * @param  len 长度
+  * @retval CRC-32
+  */
+uint32_t crc32(uint32_t crc, const void *buf, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+
+    crc = ~crc;
+
+#if CRC32_SLICE_BY_8
+    uint32_t lo;
+    uint32_t hi;
+
+    if (!crc32_table_ready)
+        crc32_table_init();
+
+    /* 对齐到4字节后每次取两个字 */
+    while (len && ((uintptr_t)p & 3U)) {
+        crc = (crc >> 8) ^ crc32_table[0][(crc ^ *p++) & 0xFFU];
+        len--;
+    }
+
+    while (len >= 8U) {
+        (void)memcpy(&lo, p, 4);
+        (void)memcpy(&hi, p + 4, 4);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+        lo = __builtin_bswap32(lo);
+        hi = __builtin_bswap32(hi);
+#endif
+        lo ^= crc;
+        crc = crc32_table[7][lo & 0xFFU] ^ crc32_table[6][(lo >> 8) & 0xFFU] ^
+              crc32_table[5][(lo >> 16) & 0xFFU] ^ crc32_table[4][lo >> 24] ^
+              crc32_table[3][hi & 0xFFU] ^ crc32_table[2][(hi >> 8) & 0xFFU] ^
+              crc32_table[1][(hi >> 16) & 0xFFU] ^ crc32_table[0][hi >> 24];
+        p += 8;
+        len -= 8U;
+    }
+
+    while (len--)
+        crc = (crc >> 8) ^ crc32_table[0][(crc ^ *p++) & 0xFFU];
+#else
+    while (len--) {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0FU];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0FU];
+    }
+#endif
+
+    return ~crc;
+}
+
+/* Private functions ---------------------------------------------------------*/
+#if CRC32_SLICE_BY_8
+/**
+  * @brief  由半字节表生成slice-by-8表
+  * @note   重入时各调用者写入相同的值, 无需加锁
+  */
+static void crc32_table_init(void)
+{
+    uint32_t crc;
+    uint32_t i;
+    uint32_t k;
+
+    for (i = 0; i < 256U; i++) {
+        crc = i;
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0FU];
+        crc = (crc >> 4) ^ crc32_nibble_table[crc & 0x0FU];
+        crc32_table[0][i] = crc;
+    }
+
+    for (i = 0; i < 256U; i++) {
+        crc = crc32_table[0][i];
+        for (k = 1; k < 8U; k++) {
+            crc = (crc >> 8) ^ crc32_table[0][crc & 0xFFU];
+            crc32_table[k][i] = crc;
+        }
+    }
+
+    crc32_table_ready = 1;
+}
+#endif
@@ -0,0 +1,776 @@
+/**
+  ******************************************************************************
+  * @file        : ftl.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 基于MTD的日志结构闪存转换层
+  * @attention   : 块内布局: [块头][标签区][数据槽0..n-1]
+  *                - 块头在擦除后写入擦除次数与魔数, 打开时写入顺序号
+  *                - 每次更新追加到打开块的下一个槽: 先写数据, 再写标签
+  *                  (逻辑扇区号 + CRC), 标签即提交点
+  *                - 同一逻辑扇区的多个副本以 (块顺序号, 槽号) 最大者为准,
+  *                  旧副本无需改写, 由垃圾回收整块回收
+  *                - 适用于可位写入的NOR类设备
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "ftl.h"
+#include "crc32.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "ftl"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+/* Private typedef -----------------------------------------------------------*/
+enum {
+    FTL_BLOCK_DIRTY = 0,        /* 内容无效, 待擦除 */
+    FTL_BLOCK_FREE,             /* 已擦除, 块头有效, 未打开 */
+    FTL_BLOCK_USED,             /* 已打开/写满 */
+};
+
+struct ftl_block_hdr {
+    uint32_t magic;
+    uint32_t erase_count;
+    uint32_t seq;
+    uint32_t seq_inv;           /* ~seq, 校验顺序号写入完整 */
+};
+
+struct ftl_tag {
+    uint16_t sector;
+    uint16_t sector_inv;        /* ~sector, 全0表示作废槽 */
+    uint32_t crc;               /* CRC32(sector + 数据) */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define FTL_MAGIC               0x4C54464EUL    /* "NFTL" */
+#define FTL_NO_BLOCK            0xFFFFU
+#define FTL_UNMAPPED            0xFFFFU
+#define FTL_ERASED32            0xFFFFFFFFUL
+
+#define FTL_HDR_SIZE            ((uint32_t)sizeof(struct ftl_block_hdr))
+#define FTL_TAG_SIZE            ((uint32_t)sizeof(struct ftl_tag))
+#define FTL_TAG_BATCH           (FTL_SECTOR_SIZE / sizeof(struct ftl_tag))
+#define FTL_BLANK_CHUNK         32U
+
+/* Private macro -------------------------------------------------------------*/
+#define FTL_BLOCK_OF(ftl, phys) ((uint16_t)((phys) / (ftl)->slots))
+#define FTL_SLOT_OF(ftl, phys)  ((uint16_t)((phys) % (ftl)->slots))
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static mtd_addr_t ftl_block_addr(struct ftl *ftl, uint16_t block);
+static mtd_addr_t ftl_tag_addr(struct ftl *ftl, uint16_t block, uint16_t slot);
+static mtd_addr_t ftl_data_addr(struct ftl *ftl, uint16_t block, uint16_t slot);
+static int ftl_raw_read(struct ftl *ftl, mtd_addr_t addr, void *buf, size_t len);
+static int ftl_raw_write(struct ftl *ftl, mtd_addr_t addr, const void *buf, size_t len);
+static uint32_t ftl_tag_crc(uint16_t sector, const uint8_t *data);
+static int ftl_tag_valid(const struct ftl *ftl, const struct ftl_tag *tag);
+static int ftl_tag_erased(const struct ftl_tag *tag);
+static int ftl_kill_slot(struct ftl *ftl, uint16_t block, uint16_t slot);
+static int ftl_slot_blank(struct ftl *ftl, uint16_t block, uint16_t slot);
+static int ftl_erase_block(struct ftl *ftl, uint16_t block);
+static int ftl_open_block(struct ftl *ftl);
+static int ftl_append(struct ftl *ftl, uint16_t sector, const uint8_t *data);
+static int ftl_gc(struct ftl *ftl, int allow_wl);
+static int ftl_layout(struct ftl *ftl);
+static int ftl_scan_headers(struct ftl *ftl, uint16_t *newest);
+static int ftl_scan_tags(struct ftl *ftl, uint16_t block, uint16_t *used);
+static int ftl_check_last(struct ftl *ftl, uint16_t block, uint16_t used);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  挂载FTL, 从Flash重建逻辑映射
+  * @param  ftl FTL实例 (调用者分配)
+  * @param  mtd 底层设备, 整个设备用于FTL, 可传分区
+  * @retval 0=成功, 负数=错误码
+  * @note   空白或损坏的块在挂载时擦除初始化, 全新设备可直接挂载;
+  *         挂载只读块头与标签区, 仅校验最后写入的一个槽的数据CRC
+  */
+int ftl_mount(struct ftl *ftl, struct mtd_info *mtd)
+{
+    uint16_t newest = FTL_NO_BLOCK;
+    uint16_t used = 0;
+    uint16_t b;
+    uint32_t ec_sum = 0;
+    uint32_t ec_cnt = 0;
+    uint32_t i;
+    int ret;
+
+    if (!ftl || !mtd) {
+        log_e("ftl_mount: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    if (mtd->type == MTD_NANDFLASH || !(mtd->flags & MTD_WRITEABLE))
+        return -ERR_NOTSUPP;
+
+    memset(ftl, 0, sizeof(*ftl));
+    ftl->mtd = mtd;
+
+    ret = ftl_layout(ftl);
+    if (ret)
+        return ret;
+
+    memset(ftl->map, 0xFF, sizeof(ftl->map));
+    ftl->open_block = FTL_NO_BLOCK;
+
+    ret = ftl_scan_headers(ftl, &newest);
+    if (ret)
+        return ret;
+
+    /* 最新块的最后一个槽可能在掉电时写了一半, 先校验再参与映射 */
+    if (newest != FTL_NO_BLOCK) {
+        ret = ftl_scan_tags(ftl, newest, &used);
+        if (ret)
+            return ret;
+        ret = ftl_check_last(ftl, newest, used);
+        if (ret)
+            return ret;
+        memset(ftl->map, 0xFF, sizeof(ftl->map));
+    }
+
+    for (b = 0; b < ftl->nblocks; b++) {
+        if (ftl->blocks[b].state != FTL_BLOCK_USED)
+            continue;
+        ret = ftl_scan_tags(ftl, b, (b == newest) ? &used : NULL);
+        if (ret)
+            return ret;
+    }
+
+    for (i = 0; i < ftl->sector_count; i++) {
+        if (ftl->map[i] != FTL_UNMAPPED)
+            ftl->blocks[FTL_BLOCK_OF(ftl, ftl->map[i])].valid++;
+    }
+
+    /* 无有效块头的块继承平均擦除次数 */
+    for (b = 0; b < ftl->nblocks; b++) {
+        if (ftl->blocks[b].erase_count != FTL_ERASED32) {
+            ec_sum += ftl->blocks[b].erase_count;
+            ec_cnt++;
+        }
+    }
+    for (b = 0; b < ftl->nblocks; b++) {
+        if (ftl->blocks[b].erase_count == FTL_ERASED32)
+            ftl->blocks[b].erase_count = ec_cnt ? (ec_sum / ec_cnt) : 0;
+        if (ftl->blocks[b].state == FTL_BLOCK_DIRTY) {
+            ret = ftl_erase_block(ftl, b);
+            if (ret)
+                return ret;
+        }
+    }
+
+    if (newest != FTL_NO_BLOCK && used < ftl->slots) {
+        ftl->open_block = newest;
+        ftl->wp = used;
+        ftl->wp_verify = 1;
+    }
+
+    ftl->mounted = 1;
+
+    log_i("ftl: %u blocks x %u slots, %lu sectors, %u free.",
+          ftl->nblocks, ftl->slots, (unsigned long)ftl->sector_count, ftl->free_count);
+
+    return 0;
+}
+
+/**
+  * @brief  清空全部逻辑扇区
+  * @param  ftl 已挂载的FTL实例
+  * @retval 0=成功, 负数=错误码
+  * @note   擦除次数保留
+  */
+int ftl_format(struct ftl *ftl)
+{
+    uint16_t b;
+    int ret;
+
+    if (!ftl || !ftl->mounted)
+        return -ERR_INVAL;
+
+    for (b = 0; b < ftl->nblocks; b++) {
+        if (ftl->blocks[b].state == FTL_BLOCK_FREE)
+            continue;
+        ret = ftl_erase_block(ftl, b);
+        if (ret)
+            return ret;
+    }
+
+    memset(ftl->map, 0xFF, sizeof(ftl->map));
+    ftl->open_block = FTL_NO_BLOCK;
+    ftl->wp = 0;
+    ftl->wp_verify = 0;
+
+    return 0;
+}
+
+/**
+  * @brief  读逻辑扇区
+  * @param  ftl FTL实例
+  * @param  sector 起始扇区号
+  * @param  buf 数据缓冲区, count * FTL_SECTOR_SIZE 字节
+  * @param  count 扇区数
+  * @retval 0=成功, 负数=错误码
+  * @note   从未写过的扇区读出全0xFF
+  */
+int ftl_read(struct ftl *ftl, uint32_t sector, uint8_t *buf, uint32_t count)
+{
+    uint16_t phys;
+    int ret;
+
+    if (!ftl || !buf || !ftl->mounted)
+        return -ERR_INVAL;
+
+    if (sector >= ftl->sector_count || count > ftl->sector_count - sector)
+        return -ERR_INVAL;
+
+    while (count--) {
+        phys = ftl->map[sector];
+        if (phys == FTL_UNMAPPED) {
+            memset(buf, 0xFF, FTL_SECTOR_SIZE);
+        } else {
+            ret = ftl_raw_read(ftl, ftl_data_addr(ftl, FTL_BLOCK_OF(ftl, phys),
+                               FTL_SLOT_OF(ftl, phys)), buf, FTL_SECTOR_SIZE);
+            if (ret)
+                return ret;
+        }
+        sector++;
+        buf += FTL_SECTOR_SIZE;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  写逻辑扇区
+  * @param  ftl FTL实例
+  * @param  sector 起始扇区号
+  * @param  buf 数据, count * FTL_SECTOR_SIZE 字节
+  * @param  count 扇区数
+  * @retval 0=成功, 负数=错误码
+  * @note   每个扇区返回前已提交; 掉电时最多丢失正在写的一个扇区,
+  *         该扇区保持旧内容
+  */
+int ftl_write(struct ftl *ftl, uint32_t sector, const uint8_t *buf, uint32_t count)
+{
+    int allow_wl = 1;
+    int ret;
+
+    if (!ftl || !buf || !ftl->mounted)
+        return -ERR_INVAL;
+
+    if (sector >= ftl->sector_count || count > ftl->sector_count - sector)
+        return -ERR_INVAL;
+
+    while (count--) {
+        /* 打开新块前至少保留一个空闲块给垃圾回收周转 */
+        while ((ftl->open_block == FTL_NO_BLOCK || ftl->wp >= ftl->slots) &&
+               ftl->free_count <= 1U) {
+            ret = ftl_gc(ftl, allow_wl);
+            if (ret)
+                return ret;
+            allow_wl = 0;
+        }
+
+        ret = ftl_append(ftl, (uint16_t)sector, buf);
+        if (ret)
+            return ret;
+
+        sector++;
+        buf += FTL_SECTOR_SIZE;
+    }
+
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static mtd_addr_t ftl_block_addr(struct ftl *ftl, uint16_t block)
+{
+    return (mtd_addr_t)block * ftl->mtd->erasesize;
+}
+
+static mtd_addr_t ftl_tag_addr(struct ftl *ftl, uint16_t block, uint16_t slot)
+{
+    return ftl_block_addr(ftl, block) + FTL_HDR_SIZE + (mtd_addr_t)slot * FTL_TAG_SIZE;
+}
+
+static mtd_addr_t ftl_data_addr(struct ftl *ftl, uint16_t block, uint16_t slot)
+{
+    return ftl_block_addr(ftl, block) + ftl->data_offset + (mtd_addr_t)slot * FTL_SECTOR_SIZE;
+}
+
+static int ftl_raw_read(struct ftl *ftl, mtd_addr_t addr, void *buf, size_t len)
+{
+    size_t retlen = 0;
+    int ret;
+
+    ret = mtd_read(ftl->mtd, addr, len, &retlen, (uint8_t *)buf);
+    if (ret < 0)
+        return ret;
+
+    return (retlen == len) ? 0 : -ERR_IO;
+}
+
+/**
+  * @brief  写入并确保已落到Flash (绕过写合并缓冲的延迟)
+  */
+static int ftl_raw_write(struct ftl *ftl, mtd_addr_t addr, const void *buf, size_t len)
+{
+    size_t retlen = 0;
+    int ret;
+
+    ret = mtd_write(ftl->mtd, addr, len, &retlen, (const uint8_t *)buf);
+    if (ret < 0)
+        return ret;
+    if (retlen != len)
+        return -ERR_IO;
+
+#if MTD_SUPPORT_WRITE_BUFFER
+    /* 数据->标签 的提交顺序依赖每一步都已写入 */
+    ret = mtd_sync(ftl->mtd);
+    if (ret < 0)
+        return ret;
+#endif
+
+    return 0;
+}
+
+static uint32_t ftl_tag_crc(uint16_t sector, const uint8_t *data)
+{
+    return crc32(crc32(0, &sector, sizeof(sector)), data, FTL_SECTOR_SIZE);
+}
+
+static int ftl_tag_valid(const struct ftl *ftl, const struct ftl_tag *tag)
+{
+    uint16_t inv = (uint16_t)~tag->sector;
+
+    return inv == tag->sector_inv && tag->sector < ftl->sector_count;
+}
+
+static int ftl_tag_erased(const struct ftl_tag *tag)
+{
+    return tag->sector == 0xFFFFU && tag->sector_inv == 0xFFFFU && tag->crc == FTL_ERASED32;
+}
+
+/**
+  * @brief  标签写全0, 使该槽永久作废 (NOR可把1写为0)
+  */
+static int ftl_kill_slot(struct ftl *ftl, uint16_t block, uint16_t slot)
+{
+    struct ftl_tag tag;
+
+    memset(&tag, 0, sizeof(tag));
+    return ftl_raw_write(ftl, ftl_tag_addr(ftl, block, slot), &tag, sizeof(tag));
+}
+
+/**
+  * @brief  检查数据槽是否全0xFF
+  * @retval 1=空, 0=非空, 负数=错误码
+  */
+static int ftl_slot_blank(struct ftl *ftl, uint16_t block, uint16_t slot)
+{
+    uint8_t chunk[FTL_BLANK_CHUNK];
+    mtd_addr_t addr = ftl_data_addr(ftl, block, slot);
+    uint32_t done;
+    uint32_t i;
+    int ret;
+
+    for (done = 0; done < FTL_SECTOR_SIZE; done += FTL_BLANK_CHUNK) {
+        ret = ftl_raw_read(ftl, addr + done, chunk, FTL_BLANK_CHUNK);
+        if (ret)
+            return ret;
+        for (i = 0; i < FTL_BLANK_CHUNK; i++) {
+            if (chunk[i] != 0xFFU)
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+  * @brief  擦除块并写入新块头 (擦除次数+1)
+  * @note   擦除前先清除魔数, 擦除中途掉电不会留下看似有效的块
+  */
+static int ftl_erase_block(struct ftl *ftl, uint16_t block)
+{
+    struct ftl_block *blk = &ftl->blocks[block];
+    struct erase_info instr;
+    uint32_t word;
+    int ret;
+
+    if (blk->state != FTL_BLOCK_DIRTY) {
+        word = 0;
+        ret = ftl_raw_write(ftl, ftl_block_addr(ftl, block), &word, sizeof(word));
+        if (ret)
+            return ret;
+    }
+
+    if (blk->state == FTL_BLOCK_FREE)
+        ftl->free_count--;
+    blk->state = FTL_BLOCK_DIRTY;
+    blk->valid = 0;
+    blk->seq = 0;
+
+    instr.addr = ftl_block_addr(ftl, block);
+    instr.len = ftl->mtd->erasesize;
+    ret = mtd_erase(ftl->mtd, &instr);
+    if (ret)
+        return ret;
+
+    blk->erase_count++;
+
+    /* 先写擦除次数, 魔数最后写, 魔数有效即块头完整 */
+    word = blk->erase_count;
+    ret = ftl_raw_write(ftl, ftl_block_addr(ftl, block) + offsetof(struct ftl_block_hdr, erase_count),
+                        &word, sizeof(word));
+    if (ret)
+        return ret;
+
+    word = FTL_MAGIC;
+    ret = ftl_raw_write(ftl, ftl_block_addr(ftl, block), &word, sizeof(word));
+    if (ret)
+        return ret;
+
+    blk->state = FTL_BLOCK_FREE;
+    ftl->free_count++;
+
+    return 0;
+}
+
+/**
+  * @brief  取擦除次数最少的空闲块作为新的写入块 (动态磨损均衡)
+  */
+static int ftl_open_block(struct ftl *ftl)
+{
+    struct ftl_block *blk;
+    uint16_t best = FTL_NO_BLOCK;
+    uint16_t b;
+    uint32_t seq[2];
+    int ret;
+
+    for (b = 0; b < ftl->nblocks; b++) {
+        if (ftl->blocks[b].state != FTL_BLOCK_FREE)
+            continue;
+        if (best == FTL_NO_BLOCK ||
+            ftl->blocks[b].erase_count < ftl->blocks[best].erase_count)
+            best = b;
+    }
+
+    if (best == FTL_NO_BLOCK)
+        return -ERR_NOSPC;
+
+    blk = &ftl->blocks[best];
+    seq[0] = ftl->next_seq;
+    seq[1] = ~ftl->next_seq;
+    ret = ftl_raw_write(ftl, ftl_block_addr(ftl, best) + offsetof(struct ftl_block_hdr, seq),
+                        seq, sizeof(seq));
+    if (ret)
+        return ret;
+
+    blk->state = FTL_BLOCK_USED;
+    blk->seq = ftl->next_seq++;
+    blk->valid = 0;
+    ftl->free_count--;
+    ftl->open_block = best;
+    ftl->wp = 0;
+    ftl->wp_verify = 0;
+
+    return 0;
+}
+
+/**
+  * @brief  把一个扇区追加到写入块并更新映射
+  * @note   调用者保证需要打开新块时有空闲块
+  */
+static int ftl_append(struct ftl *ftl, uint16_t sector, const uint8_t *data)
+{
+    struct ftl_tag tag;
+    uint16_t old;
+    int ret;
+
+    for (;;) {
+        if (ftl->open_block == FTL_NO_BLOCK || ftl->wp >= ftl->slots) {
+            ret = ftl_open_block(ftl);
+            if (ret)
+                return ret;
+        }
+
+        if (!ftl->wp_verify)
+            break;
+
+        /* 挂载后首个空槽可能残留掉电前写了一半的数据 */
+        ftl->wp_verify = 0;
+        ret = ftl_slot_blank(ftl, ftl->open_block, ftl->wp);
+        if (ret < 0)
+            return ret;
+        if (ret)
+            break;
+
+        ret = ftl_kill_slot(ftl, ftl->open_block, ftl->wp);
+        if (ret)
+            return ret;
+        ftl->wp++;
+    }
+
+    ret = ftl_raw_write(ftl, ftl_data_addr(ftl, ftl->open_block, ftl->wp), data, FTL_SECTOR_SIZE);
+    if (ret)
+        return ret;
+
+    tag.sector = sector;
+    tag.sector_inv = (uint16_t)~sector;
+    tag.crc = ftl_tag_crc(sector, data);
+    ret = ftl_raw_write(ftl, ftl_tag_addr(ftl, ftl->open_block, ftl->wp), &tag, sizeof(tag));
+    if (ret)
+        return ret;
+
+    old = ftl->map[sector];
+    if (old != FTL_UNMAPPED)
+        ftl->blocks[FTL_BLOCK_OF(ftl, old)].valid--;
+
+    ftl->map[sector] = (uint16_t)(ftl->open_block * ftl->slots + ftl->wp);
+    ftl->blocks[ftl->open_block].valid++;
+    ftl->wp++;
+
+    return 0;
+}
+
+/**
+  * @brief  回收一个块
+  * @param  allow_wl 允许本次做静态磨损均衡
+  * @note   通常选有效扇区最少的块; 擦除次数差超过 FTL_WL_THRESHOLD 时
+  *         改选擦除次数最少的块, 把其中的冷数据迁出 (静态磨损均衡);
+  *         每次 ftl_write() 至多迁移一块, 避免单次写入停顿过久
+  */
+static int ftl_gc(struct ftl *ftl, int allow_wl)
+{
+    struct ftl_block *blk;
+    struct ftl_tag tag;
+    uint16_t victim = FTL_NO_BLOCK;
+    uint16_t coldest = FTL_NO_BLOCK;
+    uint16_t b;
+    uint16_t slot;
+    uint16_t phys;
+    uint32_t ec_min = FTL_ERASED32;
+    uint32_t ec_max = 0;
+    int ret;
+
+    for (b = 0; b < ftl->nblocks; b++) {
+        blk = &ftl->blocks[b];
+        if (blk->erase_count < ec_min)
+            ec_min = blk->erase_count;
+        if (blk->erase_count > ec_max)
+            ec_max = blk->erase_count;
+
+        if (blk->state != FTL_BLOCK_USED || b == ftl->open_block)
+            continue;
+
+        if (victim == FTL_NO_BLOCK || blk->valid < ftl->blocks[victim].valid ||
+            (blk->valid == ftl->blocks[victim].valid &&
+             blk->erase_count < ftl->blocks[victim].erase_count))
+            victim = b;
+
+        if (coldest == FTL_NO_BLOCK || blk->erase_count < ftl->blocks[coldest].erase_count)
+            coldest = b;
+    }
+
+    if (victim == FTL_NO_BLOCK)
+        return -ERR_NOSPC;
+
+    if (allow_wl && ec_max - ec_min > FTL_WL_THRESHOLD &&
+        ftl->blocks[coldest].erase_count == ec_min)
+        victim = coldest;
+
+    /* 搬移需要可用槽, 否则只能等下一次 */
+    if (ftl->blocks[victim].valid >= ftl->slots && victim != coldest)
+        return -ERR_NOSPC;
+
+    for (slot = 0; slot < ftl->slots && ftl->blocks[victim].valid; slot++) {
+        ret = ftl_raw_read(ftl, ftl_tag_addr(ftl, victim, slot), &tag, sizeof(tag));
+        if (ret)
+            return ret;
+        if (!ftl_tag_valid(ftl, &tag))
+            continue;
+
+        phys = (uint16_t)(victim * ftl->slots + slot);
+        if (ftl->map[tag.sector] != phys)
+            continue;
+
+        ret = ftl_raw_read(ftl, ftl_data_addr(ftl, victim, slot), ftl->buf, FTL_SECTOR_SIZE);
+        if (ret)
+            return ret;
+
+        ret = ftl_append(ftl, tag.sector, ftl->buf);
+        if (ret)
+            return ret;
+    }
+
+    return ftl_erase_block(ftl, victim);
+}
+
+/**
+  * @brief  根据擦除块大小计算块内布局与逻辑容量
+  */
+static int ftl_layout(struct ftl *ftl)
+{
+    struct mtd_info *mtd = ftl->mtd;
+    uint32_t slots;
+    uint32_t offset;
+    uint32_t sectors;
+
+    if (!mtd->erasesize || mtd->erasesize % FTL_SECTOR_SIZE)
+        return -ERR_INVAL;
+
+    ftl->nblocks = (uint16_t)(mtd->size / mtd->erasesize);
+    if (mtd->size / mtd->erasesize > FTL_MAX_BLOCKS ||
+        ftl->nblocks <= FTL_RESERVED_BLOCKS) {
+        log_e("ftl_layout: %lu blocks not supported.", (unsigned long)(mtd->size / mtd->erasesize));
+        return -ERR_INVAL;
+    }
+
+    slots = (mtd->erasesize - FTL_HDR_SIZE) / (FTL_SECTOR_SIZE + FTL_TAG_SIZE);
+    for (;;) {
+        offset = FTL_HDR_SIZE + slots * FTL_TAG_SIZE;
+        offset = (offset + FTL_SECTOR_SIZE - 1U) / FTL_SECTOR_SIZE * FTL_SECTOR_SIZE;
+        if (!slots || offset + slots * FTL_SECTOR_SIZE <= mtd->erasesize)
+            break;
+        slots--;
+    }
+
+    if (!slots || (uint32_t)ftl->nblocks * slots >= FTL_UNMAPPED)
+        return -ERR_INVAL;
+
+    ftl->slots = (uint16_t)slots;
+    ftl->data_offset = offset;
+
+    sectors = (uint32_t)(ftl->nblocks - FTL_RESERVED_BLOCKS) * slots;
+    ftl->sector_count = (sectors > FTL_MAX_SECTORS) ? FTL_MAX_SECTORS : sectors;
+
+    return 0;
+}
+
+/**
+  * @brief  读全部块头, 确定块状态与最新块
+  */
+static int ftl_scan_headers(struct ftl *ftl, uint16_t *newest)
+{
+    struct ftl_block_hdr hdr;
+    struct ftl_block *blk;
+    uint16_t b;
+    int ret;
+
+    for (b = 0; b < ftl->nblocks; b++) {
+        blk = &ftl->blocks[b];
+        ret = ftl_raw_read(ftl, ftl_block_addr(ftl, b), &hdr, sizeof(hdr));
+        if (ret)
+            return ret;
+
+        if (hdr.magic != FTL_MAGIC) {
+            blk->erase_count = FTL_ERASED32;
+            blk->state = FTL_BLOCK_DIRTY;
+            continue;
+        }
+
+        blk->erase_count = hdr.erase_count;
+
+        if (hdr.seq == FTL_ERASED32 && hdr.seq_inv == FTL_ERASED32) {
+            blk->state = FTL_BLOCK_FREE;
+            ftl->free_count++;
+        } else if (hdr.seq == ~hdr.seq_inv) {
+            blk->state = FTL_BLOCK_USED;
+            blk->seq = hdr.seq;
+            if (hdr.seq >= ftl->next_seq)
+                ftl->next_seq = hdr.seq + 1U;
+            if (*newest == FTL_NO_BLOCK || hdr.seq > ftl->blocks[*newest].seq)
+                *newest = b;
+        } else {
+            /* 顺序号写到一半, 尚无数据 */
+            blk->state = FTL_BLOCK_DIRTY;
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  扫描块的标签区, 较新的副本覆盖映射
+  * @param  used 输出已使用的槽数, 可为NULL
+  */
+static int ftl_scan_tags(struct ftl *ftl, uint16_t block, uint16_t *used)
+{
+    struct ftl_tag *tags = (struct ftl_tag *)(void *)ftl->buf;
+    uint16_t slot = 0;
+    uint16_t n;
+    uint16_t i;
+    uint16_t phys;
+    uint16_t old;
+    int ret;
+
+    while (slot < ftl->slots) {
+        n = ftl->slots - slot;
+        if (n > FTL_TAG_BATCH)
+            n = FTL_TAG_BATCH;
+
+        ret = ftl_raw_read(ftl, ftl_tag_addr(ftl, block, slot), tags, (size_t)n * FTL_TAG_SIZE);
+        if (ret)
+            return ret;
+
+        for (i = 0; i < n; i++, slot++) {
+            if (ftl_tag_erased(&tags[i]))
+                goto out;
+            if (!ftl_tag_valid(ftl, &tags[i]))
+                continue;
+
+            phys = (uint16_t)(block * ftl->slots + slot);
+            old = ftl->map[tags[i].sector];
+            if (old == FTL_UNMAPPED ||
+                ftl->blocks[block].seq > ftl->blocks[FTL_BLOCK_OF(ftl, old)].seq ||
+                (FTL_BLOCK_OF(ftl, old) == block && slot > FTL_SLOT_OF(ftl, old)))
+                ftl->map[tags[i].sector] = phys;
+        }
+    }
+
+out:
+    if (used)
+        *used = slot;
+    return 0;
+}
+
+/**
+  * @brief  校验最新块最后一个已用槽, CRC不符说明掉电时标签未写完, 作废
+  */
+static int ftl_check_last(struct ftl *ftl, uint16_t block, uint16_t used)
+{
+    struct ftl_tag tag;
+    uint16_t slot;
+    int ret;
+
+    if (!used)
+        return 0;
+
+    slot = used - 1U;
+    ret = ftl_raw_read(ftl, ftl_tag_addr(ftl, block, slot), &tag, sizeof(tag));
+    if (ret)
+        return ret;
+
+    if (!ftl_tag_valid(ftl, &tag))
+        return 0;
+
+    ret = ftl_raw_read(ftl, ftl_data_addr(ftl, block, slot), ftl->buf, FTL_SECTOR_SIZE);
+    if (ret)
+        return ret;
+
+    if (ftl_tag_crc(tag.sector, ftl->buf) == tag.crc)
+        return 0;
+
+    log_w("ftl: torn sector %u in block %u slot %u dropped.", tag.sector, block, slot);
+    return ftl_kill_slot(ftl, block, slot);
+}
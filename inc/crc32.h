@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  * @file        : crc32.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : CRC-32 (IEEE 802.3, 反射多项式 0xEDB88320)
+  * @attention   : None
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __CRC32_H__
+#define __CRC32_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported define -----------------------------------------------------------*/
+/**
+ * @brief 是否使用 slice-by-8 查表 (每次处理8字节)
+ * @note  8张256项表共占RAM 8KB, 首次调用时生成; 为0时使用16项半字节表, 适合小块数据
+ */
+#define CRC32_SLICE_BY_8                1
+
+/* Exported typedef ----------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+uint32_t crc32(uint32_t crc, const void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __CRC32_H__ */
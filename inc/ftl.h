@@ -0,0 +1,94 @@
+/**
+  ******************************************************************************
+  * @file        : ftl.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 基于MTD的日志结构闪存转换层 (块设备接口 + 磨损均衡)
+  * @attention   : 所有状态保存在调用者提供的 struct ftl 中, 无动态内存
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __FTL_H__
+#define __FTL_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "mtd.h"
+
+/* Exported define -----------------------------------------------------------*/
+/**
+ * @brief 逻辑扇区大小 (字节), 通常等于Flash页大小, 一次更新=一次页编程
+ */
+#define FTL_SECTOR_SIZE                 256
+
+/**
+ * @brief 最大擦除块数与最大逻辑扇区数, 决定 struct ftl 的RAM占用
+ */
+#define FTL_MAX_BLOCKS                  64
+#define FTL_MAX_SECTORS                 1024
+
+/**
+ * @brief 预留块数 (不计入逻辑容量), 至少2: 1块供垃圾回收周转
+ * @note  预留越多, 垃圾回收时受害块中有效扇区越少, 写放大越低;
+ *        随机写满负载下 1/4 预留约为每次更新 3 次扇区写入
+ */
+#define FTL_RESERVED_BLOCKS             16
+
+/**
+ * @brief 静态磨损均衡阈值: 最大与最小擦除次数差超过此值时迁移冷数据
+ */
+#define FTL_WL_THRESHOLD                64
+
+/* Exported typedef ----------------------------------------------------------*/
+struct ftl_block {
+    uint32_t erase_count;       /* 擦除次数 */
+    uint32_t seq;               /* 打开顺序号, 越大越新 */
+    uint16_t valid;             /* 有效扇区数 */
+    uint8_t state;              /* FTL_BLOCK_xxx */
+};
+
+struct ftl {
+    struct mtd_info *mtd;
+    uint32_t sector_count;      /* 逻辑扇区数 */
+    uint32_t next_seq;          /* 下一个打开块的顺序号 */
+    uint16_t nblocks;           /* 擦除块数 */
+    uint16_t slots;             /* 每块数据槽数 */
+    uint32_t data_offset;       /* 块内数据区起始偏移 (块头+标签区之后) */
+    uint16_t open_block;        /* 当前写入块, FTL_NO_BLOCK=无 */
+    uint16_t wp;                /* 打开块的下一个空槽 */
+    uint16_t free_count;        /* 已擦除待用块数 */
+    uint8_t wp_verify;          /* 挂载后首个空槽需查空 (可能有掉电残留) */
+    uint8_t mounted;
+    uint16_t map[FTL_MAX_SECTORS];          /* 逻辑扇区 -> 物理槽 */
+    struct ftl_block blocks[FTL_MAX_BLOCKS];
+    uint8_t buf[FTL_SECTOR_SIZE];           /* 垃圾回收搬移缓冲 */
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int ftl_mount(struct ftl *ftl, struct mtd_info *mtd);
+int ftl_format(struct ftl *ftl);
+int ftl_read(struct ftl *ftl, uint32_t sector, uint8_t *buf, uint32_t count);
+int ftl_write(struct ftl *ftl, uint32_t sector, const uint8_t *buf, uint32_t count);
+
+static inline uint32_t ftl_sector_count(const struct ftl *ftl)
+{
+    return ftl->sector_count;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __FTL_H__ */
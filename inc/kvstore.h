@@ -0,0 +1,85 @@
+/**
+  ******************************************************************************
+  * @file        : kvstore.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 基于MTD的键值存储 (追加写记录 + RAM哈希索引)
+  * @attention   : 所有状态保存在调用者提供的 struct kv_store 中, 无动态内存;
+  *                区域不超过256KB (索引以4字节为单位记录位置)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __KVSTORE_H__
+#define __KVSTORE_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "mtd.h"
+
+/* Exported define -----------------------------------------------------------*/
+/**
+ * @brief 键最大长度 (不含结束符) 与值最大长度 (字节)
+ */
+#define KV_KEY_MAX                      32
+#define KV_VAL_MAX                      256
+
+/**
+ * @brief 索引槽数, 必须为2的幂, 建议不小于键数的1.5倍
+ */
+#define KV_INDEX_SIZE                   512
+
+/**
+ * @brief 最大扇区数 (扇区=擦除块), 至少2: 1块作为整理时的预留
+ */
+#define KV_MAX_SECTORS                  32
+
+/* Exported typedef ----------------------------------------------------------*/
+struct kv_index_ent {
+    uint16_t tag;               /* 键哈希高16位, 比对前过滤 */
+    uint16_t loc;               /* 记录位置 (4字节为单位), 0xFFFF=空 */
+};
+
+struct kv_store {
+    struct mtd_info *mtd;
+    uint32_t sector_size;       /* 扇区大小 (擦除块大小) */
+    uint16_t nsectors;          /* 扇区数 */
+    uint16_t active;            /* 当前追加扇区 */
+    uint32_t wp;                /* 当前扇区内下一条记录偏移 */
+    uint32_t next_seq;          /* 下一个扇区顺序号 */
+    uint32_t live_bytes;        /* 有效记录总字节数 (含记录头) */
+    uint16_t count;             /* 有效键数 */
+    uint8_t mounted;
+    uint8_t used[KV_MAX_SECTORS];               /* 扇区是否已启用 */
+    struct kv_index_ent index[KV_INDEX_SIZE];
+    uint8_t buf[KV_KEY_MAX + KV_VAL_MAX];       /* 记录搬移/比对缓冲 */
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int kv_mount(struct kv_store *kv, struct mtd_info *mtd);
+int kv_format(struct kv_store *kv);
+int kv_set(struct kv_store *kv, const char *key, const void *val, size_t len);
+int kv_get(struct kv_store *kv, const char *key, void *buf, size_t size, size_t *len);
+int kv_delete(struct kv_store *kv, const char *key);
+
+static inline uint16_t kv_count(const struct kv_store *kv)
+{
+    return kv->count;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __KVSTORE_H__ */
@@ -34,6 +34,30 @@
 #define MTD_BIT_WRITEABLE	                0x800	/* Single bits can be flipped */
 #define MTD_NO_ERASE		                0x1000	/* No erase necessary */
 
+/* mtd_info::type */
+#define MTD_ABSENT                          0
+#define MTD_RAM                             1
+#define MTD_ROM                             2
+#define MTD_NORFLASH                        3
+#define MTD_NANDFLASH                       4
+
+#define MTD_CAP_NORFLASH                    (MTD_WRITEABLE | MTD_BIT_WRITEABLE)
+#define MTD_CAP_NANDFLASH                   (MTD_WRITEABLE)
+
+#if MTD_SUPPORT_PARTITION
+/* mtd_partition::offset / size 特殊值 */
+#define MTDPART_OFS_APPEND                  (MTD_ADDR_MAX)      /* 紧接上一个分区 */
+#define MTDPART_SIZ_FULL                    (0)                 /* 延伸到父设备末尾 */
+
+/* Flash分区表 */
+#define MTD_PART_NAME_MAX                   16
+#define MTD_PART_TABLE_MAGIC                0x3154504DUL        /* "MPT1" */
+#endif
+
+#if MTD_SUPPORT_BBT
+#define MTD_BBT_MAGIC                       0x3154424DUL        /* "MBT1" */
+#endif
+
 /* Exported typedef ----------------------------------------------------------*/
 struct mtd_info;
 
@@ -76,6 +100,64 @@ struct mtd_oob_ops {
 };
 #endif
 
+#if MTD_SUPPORT_READ_CACHE
+struct mtd_cache_stats {
+    uint32_t hits;              /* 命中的缓存行访问 */
+    uint32_t misses;            /* 需要回填的缓存行 */
+    uint32_t readahead;         /* 顺序预读回填的缓存行 */
+    uint32_t bypass;            /* 大块读旁路次数 */
+    uint32_t invalidates;       /* 因写/擦除失效的缓存行 */
+};
+#endif
+
+#if MTD_SUPPORT_WRITE_BUFFER
+/**
+ * @brief 写合并缓冲, 由调用者提供存储
+ * @note  缓冲内容只覆盖一个对齐的 MTD_WBUF_SIZE 窗口内的连续区域
+ */
+struct mtd_wbuf {
+    mtd_addr_t addr;            /* 缓冲数据起始地址 (主设备地址空间) */
+    size_t len;                 /* 已缓冲字节数, 0=空 */
+    uint32_t stamp;             /* 首字节进入缓冲的时刻 (ms) */
+    uint8_t data[MTD_WBUF_SIZE];
+};
+#endif
+
+#if MTD_SUPPORT_IOVEC
+/**
+ * @brief 分散读写的一段
+ */
+struct mtd_iovec {
+    mtd_addr_t offset;          /* 设备内偏移 */
+    size_t len;
+    void *buf;
+};
+#endif
+
+#if MTD_SUPPORT_BBT
+/**
+ * @brief 坏块表, 由调用者提供存储, 每擦除块1位 (1=坏块)
+ */
+struct mtd_bbt {
+    uint32_t version;           /* 最新表版本, 每写一次+1 */
+    uint32_t nblocks;           /* 主设备擦除块数 */
+    uint32_t rsv_start;         /* 保留区首块号, 其后 MTD_BBT_RESERVED_BLOCKS 块存放表 */
+    uint8_t cur;                /* 最新表所在的保留块序号, 0xFF=尚未写出 */
+    uint8_t map[(MTD_BBT_MAX_BLOCKS + 7) / 8];
+};
+#endif
+
+#if MTD_SUPPORT_ERASE_REGIONS
+/**
+ * @brief 擦除区域, 按地址升序排列且首尾相接, 覆盖整个设备
+ */
+struct mtd_erase_region_info {
+    mtd_addr_t offset;          /* 区域起始 */
+    uint32_t erasesize;         /* 区域内可单独擦除的最小块 */
+    uint32_t numblocks;
+};
+#endif
+
 struct erase_info {
     mtd_addr_t addr;
     mtd_addr_t len;
@@ -88,6 +170,38 @@ struct mtd_part {
     mtd_addr_t offset;
     mtd_addr_t size;
     uint32_t flags;
+    struct mtd_info *master;    /* 注册时预先计算; NULL=手工构造, 逐级查找 */
+    mtd_addr_t master_ofs;      /* 分区起始在主设备中的绝对偏移 */
+};
+
+/**
+ * @brief 分区描述, 用于 mtd_add_partitions()
+ */
+struct mtd_partition {
+    const char *name;
+    mtd_addr_t offset;          /* 相对父设备, 可为 MTDPART_OFS_APPEND */
+    mtd_addr_t size;            /* 可为 MTDPART_SIZ_FULL */
+    uint32_t mask_flags;        /* 从父设备继承时要去掉的标志, 如 MTD_WRITEABLE */
+};
+
+/**
+ * @brief Flash分区表表项 (小端存储), 也作为解析时的名字存储
+ */
+struct mtd_part_tbl_entry {
+    char name[MTD_PART_NAME_MAX];   /* 以'\0'结尾, 最多 MTD_PART_NAME_MAX-1 个字符 */
+    uint32_t offset;
+    uint32_t size;
+    uint32_t mask_flags;
+};
+
+/**
+ * @brief Flash分区表头, 其后紧跟 count 个表项
+ */
+struct mtd_part_tbl_hdr {
+    uint32_t magic;             /* MTD_PART_TABLE_MAGIC */
+    uint32_t count;
+    uint32_t crc;               /* CRC32(全部表项) */
+    uint32_t reserved;
 };
 #endif
 
@@ -101,6 +215,11 @@ typedef struct mtd_info {
     uint32_t writesize;
     uint8_t writesize_shift;
     
+#if MTD_SUPPORT_ERASE_REGIONS
+    uint32_t numeraseregions;   /* 0=全片统一为 erasesize */
+    const struct mtd_erase_region_info *eraseregions;
+#endif
+
 #if MTD_SUPPORT_OOB
     uint32_t oobsize;
     uint32_t oobavail;
@@ -116,6 +235,25 @@ typedef struct mtd_info {
     int (*_write)(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, const uint8_t *buf);
     int (*_erase)(struct mtd_info *mtd, struct erase_info *instr);
 
+#if MTD_SUPPORT_ERASE_ASYNC
+    int (*_erase_start)(struct mtd_info *mtd, mtd_addr_t addr);     /* 发起一个擦除块的擦除, 不等待 */
+    int (*_erase_wait)(struct mtd_info *mtd);                       /* 等待已发起的擦除完成并返回其结果 */
+#endif
+
+#if MTD_SUPPORT_READ_ASYNC
+    int (*_read_start)(struct mtd_info *mtd, mtd_addr_t from, size_t len, uint8_t *buf); /* 发起读, 不等待数据 */
+    int (*_read_wait)(struct mtd_info *mtd, size_t *retlen);                           /* 等待已发起的读完成并返回其结果 */
+#endif
+
+#if MTD_SUPPORT_IOVEC
+    int (*_readv)(struct mtd_info *mtd, const struct mtd_iovec *vec, uint32_t cnt);  /* 一次事务读多段, cnt<=MTD_IOV_BATCH */
+#endif
+
+#if MTD_SUPPORT_POINT
+    int (*_point)(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, const void **virt);
+    int (*_unpoint)(struct mtd_info *mtd, mtd_addr_t from, size_t len);
+#endif
+
 #if MTD_SUPPORT_OOB
     int (*_read_oob)(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops);
     int (*_write_oob)(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops);
@@ -131,6 +269,19 @@ typedef struct mtd_info {
     struct mtd_part part;
 #endif
 
+#if MTD_SUPPORT_WRITE_BUFFER
+    struct mtd_wbuf *wbuf;      /* 写合并缓冲, NULL=直写 */
+#endif
+
+#if MTD_SUPPORT_BBT
+    struct mtd_bbt *bbt;        /* 坏块表, NULL=每次查询驱动 */
+#endif
+
+#if MTD_SUPPORT_READ_CACHE
+    mtd_addr_t cache_next;      /* 上次读结束地址, 用于顺序预读判断 */
+    struct mtd_cache_stats cache_stats;
+#endif
+
     void *priv;
 } mtd_info_t;
 
@@ -145,6 +296,9 @@ typedef struct mtd_info {
 #if MTD_SUPPORT_PARTITION
 static inline struct mtd_info *mtd_get_master(struct mtd_info *mtd)
 {
+    if (mtd->parent && mtd->part.master)
+        return mtd->part.master;
+
     while (mtd->parent) {
         mtd = mtd->parent;
     }
@@ -153,6 +307,9 @@ static inline struct mtd_info *mtd_get_master(struct mtd_info *mtd)
 
 static inline mtd_addr_t mtd_get_master_ofs(struct mtd_info *mtd, mtd_addr_t ofs)
 {
+    if (mtd->parent && mtd->part.master)
+        return ofs + mtd->part.master_ofs;
+
     while (mtd->parent) {
         ofs += mtd->part.offset;
         mtd = mtd->parent;
@@ -179,6 +336,58 @@ int mtd_erase(struct mtd_info *mtd, struct erase_info *instr);
 int mtd_read(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, uint8_t *buf);
 int mtd_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, const uint8_t *buf);
 
+#if MTD_SUPPORT_READ_ASYNC
+int mtd_read_start(struct mtd_info *mtd, mtd_addr_t from, size_t len, uint8_t *buf);
+int mtd_read_wait(struct mtd_info *mtd, size_t *retlen);
+#endif
+
+#if MTD_SUPPORT_IOVEC
+int mtd_readv(struct mtd_info *mtd, struct mtd_iovec *vec, uint32_t cnt, size_t *retlen);
+int mtd_writev(struct mtd_info *mtd, struct mtd_iovec *vec, uint32_t cnt, size_t *retlen);
+#endif
+
+#if MTD_SUPPORT_ERASE_REGIONS
+uint32_t mtd_get_erasesize(struct mtd_info *mtd, mtd_addr_t ofs, mtd_addr_t len);
+#endif
+
+#if MTD_SUPPORT_PARTITION
+int mtd_add_partitions(struct mtd_info *parent, const struct mtd_partition *parts,
+                       struct mtd_info *slots, uint32_t nr);
+int mtd_del_partition(struct mtd_info *mtd);
+int mtd_parse_partitions(struct mtd_info *mtd, mtd_addr_t from, struct mtd_part_tbl_entry *ents,
+                         struct mtd_partition *parts, uint32_t max);
+struct mtd_info *mtd_get_partition(const char *name);
+struct mtd_info *mtd_next_partition(struct mtd_info *prev);
+#endif
+
+#if MTD_SUPPORT_NAND
+int mtd_block_isbad(struct mtd_info *mtd, mtd_addr_t ofs);
+int mtd_block_markbad(struct mtd_info *mtd, mtd_addr_t ofs);
+int mtd_read_skip_bad(struct mtd_info *mtd, mtd_addr_t *ofs, size_t len, size_t *retlen, uint8_t *buf);
+int mtd_write_skip_bad(struct mtd_info *mtd, mtd_addr_t *ofs, size_t len, size_t *retlen,
+                       const uint8_t *buf);
+#endif
+
+#if MTD_SUPPORT_BBT
+int mtd_bbt_attach(struct mtd_info *mtd, struct mtd_bbt *bbt);
+#endif
+
+#if MTD_SUPPORT_WRITE_BUFFER
+int mtd_wbuf_attach(struct mtd_info *mtd, struct mtd_wbuf *wbuf);
+int mtd_sync(struct mtd_info *mtd);
+int mtd_wbuf_poll(struct mtd_info *mtd);
+#endif
+
+#if MTD_SUPPORT_READ_CACHE
+void mtd_cache_invalidate(struct mtd_info *mtd);
+int mtd_cache_get_stats(struct mtd_info *mtd, struct mtd_cache_stats *stats);
+#endif
+
+#if MTD_SUPPORT_POINT
+int mtd_point(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, const void **virt);
+int mtd_unpoint(struct mtd_info *mtd, mtd_addr_t from, size_t len);
+#endif
+
 #if MTD_SUPPORT_OOB
 int mtd_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops);
 int mtd_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops);
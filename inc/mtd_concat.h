@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_concat.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 多片Flash拼接为一个MTD设备 (线性拼接 / 擦除块交错)
+  * @attention   : 子设备须为主设备 (非分区), 擦除块大小一致
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __MTD_CONCAT_H__
+#define __MTD_CONCAT_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "mtd.h"
+
+/* Exported define -----------------------------------------------------------*/
+/**
+ * @brief 最大子设备数
+ */
+#define MTD_CONCAT_MAX_SUBDEV           4
+
+/* mtd_concat_create() mode */
+#define MTD_CONCAT_LINEAR               0x00    /* 子设备首尾相接 */
+#define MTD_CONCAT_STRIPED              0x01    /* 擦除块依次轮流分配到各子设备 */
+#define MTD_CONCAT_DEFER_ERASE          0x02    /* 擦除发起后即返回, 该片下次访问前再等待 */
+
+/* Exported typedef ----------------------------------------------------------*/
+struct mtd_concat {
+    struct mtd_info mtd;
+    struct mtd_info *subdev[MTD_CONCAT_MAX_SUBDEV];
+    uint32_t num_subdev;
+    uint32_t mode;
+    uint32_t pending;                           /* 擦除进行中的子设备位图 */
+    mtd_addr_t pending_addr[MTD_CONCAT_MAX_SUBDEV];     /* 对应的拼接设备地址, 用于报告失败位置 */
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int mtd_concat_create(struct mtd_concat *cat, struct mtd_info *const *subdev, uint32_t num,
+                      const char *name, uint32_t mode);
+int mtd_concat_wait(struct mtd_concat *cat);
+
+static inline struct mtd_info *mtd_concat_to_mtd(struct mtd_concat *cat)
+{
+    return &cat->mtd;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MTD_CONCAT_H__ */
@@ -40,6 +40,82 @@
  */
 #define MTD_SUPPORT_NAND                1
 
+/**
+ * @brief 是否启用坏块表（mtd_bbt_attach），依赖 MTD_SUPPORT_NAND
+ * @note  RAM中每块1位, mtd_block_isbad() 直接查表; 表带版本号轮流写入
+ *        主设备末尾的 MTD_BBT_RESERVED_BLOCKS 个保留块
+ */
+#define MTD_SUPPORT_BBT                 1
+#if MTD_SUPPORT_BBT && !MTD_SUPPORT_NAND
+#error "MTD_SUPPORT_BBT requires MTD_SUPPORT_NAND"
+#endif
+
+/**
+ * @brief 坏块表支持的最大块数、保留块数、写表缓冲大小（字节，不小于页大小）
+ */
+#define MTD_BBT_MAX_BLOCKS              2048
+#define MTD_BBT_RESERVED_BLOCKS         4
+#define MTD_BBT_PAGE_SIZE               2048
+
+/**
+ * @brief 是否支持直接映射访问（mtd_point/mtd_unpoint）
+ * @note  需底层驱动提供 _point，用于常量资源的零拷贝读取
+ */
+#define MTD_SUPPORT_POINT               1
+
+/**
+ * @brief 是否启用读缓存（LRU + 顺序预读）
+ * @note  缓存全部设备共享，写入/擦除时自动失效；NAND不经过缓存
+ */
+#define MTD_SUPPORT_READ_CACHE          1
+
+/**
+ * @brief 读缓存行数与行大小（字节，须为2的幂）
+ * @note  占用RAM约 行数 x 行大小；不小于行大小的读请求直接旁路
+ */
+#define MTD_READ_CACHE_LINES            8
+#define MTD_READ_CACHE_LINE_SIZE        256
+
+/**
+ * @brief 是否支持写合并缓冲（mtd_wbuf_attach/mtd_sync）
+ * @note  连续的小块写先进缓冲，满页、mtd_sync()或超时后一次写入
+ */
+#define MTD_SUPPORT_WRITE_BUFFER        1
+
+/**
+ * @brief 写缓冲大小（字节，须为2的幂，通常等于Flash页大小）与超时时间
+ */
+#define MTD_WBUF_SIZE                   256
+#define MTD_WBUF_TIMEOUT_MS             100
+
+/**
+ * @brief 是否支持分段擦除（驱动提供 _erase_start/_erase_wait）
+ * @note  发起擦除后立即返回, mtd_concat 借此让多片Flash的擦除并行进行
+ */
+#define MTD_SUPPORT_ERASE_ASYNC         1
+
+/**
+ * @brief 是否支持分段读（mtd_read_start/mtd_read_wait）
+ * @note  驱动提供 _read_start/_read_wait 时数据阶段由控制器在后台完成,
+ *        调用者可在等待期间处理上一块数据（如镜像校验的双缓冲）
+ */
+#define MTD_SUPPORT_READ_ASYNC          1
+
+/**
+ * @brief 是否支持分散读写（mtd_readv/mtd_writev）
+ * @note  多段按地址排序合并后下发; 驱动提供 _readv 时一次总线事务读取至多
+ *        MTD_IOV_BATCH 段, 每段约占 3 个 spi_transfer 的栈空间
+ */
+#define MTD_SUPPORT_IOVEC               1
+#define MTD_IOV_BATCH                   4
+
+/**
+ * @brief 是否支持擦除区域（mtd_info::eraseregions, mtd_get_erasesize）
+ * @note  用于参数扇区与大扇区混合的NOR: erasesize 为全片都能单独擦除的块,
+ *        区域内可按更小的粒度擦除, 分区据此取各自的擦除块大小
+ */
+#define MTD_SUPPORT_ERASE_REGIONS       1
+
 /**
  * @brief 是否启用参数校验
  * @note  发布版本可关闭以提高性能
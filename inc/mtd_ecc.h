@@ -0,0 +1,99 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_ecc.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 软件ECC引擎 (Hamming / BCH) 与带ECC的NAND设备
+  * @attention   : 用于无片上ECC的NAND: 数据按步计算ECC, 存放在OOB中,
+  *                读取时纠错并计入 ecc_stats 与 mtd_oob_ops::stats
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __MTD_ECC_H__
+#define __MTD_ECC_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "mtd.h"
+
+/* Exported define -----------------------------------------------------------*/
+/**
+ * @brief 是否编译BCH引擎
+ * @note  GF(2^13) 对数/反对数表共占RAM约32KB, 首次使用时生成
+ */
+#define MTD_ECC_SUPPORT_BCH             1
+
+/**
+ * @brief 支持的最大页/OOB大小与每步最大ECC字节数, 决定 struct mtd_ecc_nand 的缓冲大小
+ */
+#define MTD_ECC_MAX_PAGE                2048
+#define MTD_ECC_MAX_OOB                 128
+#define MTD_ECC_MAX_BYTES               16
+
+/**
+ * @brief OOB布局: [0, 2) 坏块标记, 其后依次为各步ECC, 剩余字节供 MTD_OPS_AUTO_OOB 使用
+ */
+#define MTD_ECC_OOB_OFFSET              2
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief ECC引擎, 可由硬件ECC控制器按同一接口实现
+ */
+struct mtd_ecc_engine {
+    const char *name;
+    uint16_t step;              /* 每步数据字节数 */
+    uint8_t bytes;              /* 每步ECC字节数 */
+    uint8_t strength;           /* 每步可纠正的位数 */
+    int (*init)(const struct mtd_ecc_engine *eng);     /* 生成查找表, 可为NULL */
+    void (*calculate)(const struct mtd_ecc_engine *eng, const uint8_t *data, uint8_t *ecc);
+    /* 返回纠正的位数, -ERR_IO=无法纠正 (此时不修改data) */
+    int (*correct)(const struct mtd_ecc_engine *eng, uint8_t *data, const uint8_t *read_ecc,
+                   const uint8_t *calc_ecc);
+    void *priv;
+};
+
+/**
+ * @brief 带ECC的NAND设备, 叠加在无片上ECC的NAND之上
+ */
+struct mtd_ecc_nand {
+    struct mtd_info mtd;
+    struct mtd_info *raw;       /* 原始NAND, 页读写不做校验 */
+    const struct mtd_ecc_engine *eng;
+    uint16_t steps;             /* 每页步数 */
+    uint16_t free_offs;         /* OOB空闲区起始偏移 */
+    uint8_t page[MTD_ECC_MAX_PAGE];
+    uint8_t oob[MTD_ECC_MAX_OOB];
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+extern const struct mtd_ecc_engine mtd_ecc_hamming_256;    /* 1位/256字节, 3字节ECC */
+extern const struct mtd_ecc_engine mtd_ecc_hamming_512;    /* 1位/512字节, 3字节ECC */
+#if MTD_ECC_SUPPORT_BCH
+extern const struct mtd_ecc_engine mtd_ecc_bch4;           /* 4位/512字节, 7字节ECC */
+extern const struct mtd_ecc_engine mtd_ecc_bch8;           /* 8位/512字节, 13字节ECC */
+#endif
+
+/* Exported function prototypes ----------------------------------------------*/
+int mtd_ecc_nand_create(struct mtd_ecc_nand *en, struct mtd_info *raw,
+                        const struct mtd_ecc_engine *eng, const char *name);
+
+static inline struct mtd_info *mtd_ecc_nand_to_mtd(struct mtd_ecc_nand *en)
+{
+    return &en->mtd;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MTD_ECC_H__ */
@@ -0,0 +1,51 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_file.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 以主机文件为存储的仿真MTD设备
+  * @attention   : 仅用于主机端, 依赖标准C文件接口; 内容跨进程保持,
+  *                可在进程重启后验证掉电恢复
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __MTD_FILE_H__
+#define __MTD_FILE_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdio.h>
+#include "mtd_sim.h"
+
+/* Exported define -----------------------------------------------------------*/
+
+/* Exported typedef ----------------------------------------------------------*/
+struct mtd_file {
+    struct mtd_sim sim;
+    FILE *fp;
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int mtd_file_open(struct mtd_file *file, const struct mtd_sim_config *cfg, const char *path);
+int mtd_file_close(struct mtd_file *file);
+
+static inline struct mtd_info *mtd_file_to_mtd(struct mtd_file *file)
+{
+    return &file->sim.mtd;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MTD_FILE_H__ */
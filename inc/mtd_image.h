@@ -0,0 +1,75 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_image.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : Flash镜像流式校验 / 加载 (CRC-32, SHA-256)
+  * @attention   : 按块读取, 一块在总线上传输时计算上一块的摘要;
+  *                驱动不支持 mtd_read_start() 时退化为逐块同步读
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __MTD_IMAGE_H__
+#define __MTD_IMAGE_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "mtd.h"
+
+/* Exported define -----------------------------------------------------------*/
+/**
+ * @brief 是否编译SHA-256校验
+ */
+#define MTD_IMAGE_SUPPORT_SHA256        1
+
+/**
+ * @brief 校验值不符时 mtd_image_verify()/mtd_image_load() 的返回值
+ */
+#define MTD_IMAGE_MISMATCH              1
+
+/* Exported typedef ----------------------------------------------------------*/
+enum mtd_image_algo {
+    MTD_IMAGE_CRC32 = 0,                /* 期望值为 uint32_t (主机字节序) */
+#if MTD_IMAGE_SUPPORT_SHA256
+    MTD_IMAGE_SHA256,                   /* 期望值为32字节摘要 */
+#endif
+};
+
+/**
+ * @brief 校验结果, 校验失败时同样填写
+ */
+struct mtd_image_result {
+    uint32_t crc;                       /* MTD_IMAGE_CRC32 */
+#if MTD_IMAGE_SUPPORT_SHA256
+    uint8_t sha256[32];                 /* MTD_IMAGE_SHA256 */
+#endif
+    size_t bytes;                       /* 已读取并计算的字节数 */
+    uint32_t elapsed_ms;
+    uint32_t kbps;                      /* 吞吐量 (KB/s, 按 字节/ms 计) */
+    uint8_t overlapped;                 /* 1=读与计算重叠进行 */
+    uint8_t uclean;                     /* NAND: 有页翻转位数达到阈值, 建议搬移 */
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int mtd_image_verify(struct mtd_info *mtd, mtd_addr_t from, size_t len, enum mtd_image_algo algo,
+                     const void *expect, uint8_t *buf, size_t bufsize, struct mtd_image_result *res);
+int mtd_image_load(struct mtd_info *mtd, mtd_addr_t from, size_t len, enum mtd_image_algo algo,
+                   const void *expect, uint8_t *dst, size_t chunk, struct mtd_image_result *res);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MTD_IMAGE_H__ */
@@ -0,0 +1,60 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_ram.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 以RAM为存储的仿真MTD设备
+  * @attention   : 存储由调用者提供, 大小见 mtd_ram_mem_size()
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __MTD_RAM_H__
+#define __MTD_RAM_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "mtd_sim.h"
+
+/* Exported define -----------------------------------------------------------*/
+
+/* Exported typedef ----------------------------------------------------------*/
+struct mtd_ram {
+    struct mtd_sim sim;
+    uint8_t *mem;
+    size_t mem_size;
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int mtd_ram_init(struct mtd_ram *ram, const struct mtd_sim_config *cfg, uint8_t *mem, size_t mem_size);
+
+/**
+  * @brief  存储所需字节数 (数据区 + 全部页的OOB)
+  */
+static inline size_t mtd_ram_mem_size(const struct mtd_sim_config *cfg)
+{
+    size_t oob = (cfg->type == MTD_NANDFLASH && cfg->writesize) ?
+                 (size_t)(cfg->size / cfg->writesize) * cfg->oobsize : 0;
+
+    return (size_t)cfg->size + oob;
+}
+
+static inline struct mtd_info *mtd_ram_to_mtd(struct mtd_ram *ram)
+{
+    return &ram->sim.mtd;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MTD_RAM_H__ */
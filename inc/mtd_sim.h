@@ -0,0 +1,129 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_sim.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 仿真MTD设备 (延时模型 + Flash位语义 + 故障注入)
+  * @attention   : 供主机端测试与性能评估, 存储后端由 mtd_ram / mtd_file 提供
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __MTD_SIM_H__
+#define __MTD_SIM_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "mtd.h"
+
+/* Exported define -----------------------------------------------------------*/
+/**
+ * @brief 最大擦除块数, 决定擦除计数与坏块表的RAM占用
+ */
+#define MTD_SIM_MAX_BLOCKS              1024
+
+/**
+ * @brief 故障计数器关闭值
+ */
+#define MTD_SIM_FAULT_OFF               (-1L)
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 存储后端, 地址空间: [0, size) 为数据区, 其后为各页OOB
+ */
+struct mtd_sim_store {
+    int (*load)(void *ctx, uint32_t off, void *buf, size_t len);
+    int (*save)(void *ctx, uint32_t off, const void *buf, size_t len);
+};
+
+/**
+ * @brief 延时模型 (0表示不计)
+ */
+struct mtd_sim_timing {
+    uint32_t bus_kbps;          /* 总线带宽 (KB/s), 按传输字节计时 */
+    uint32_t cmd_ns;            /* 每次操作的命令/地址开销 */
+    uint32_t read_us;           /* NAND tR: 每页载入缓存时间 */
+    uint32_t prog_us;           /* tPP: 每页编程时间 */
+    uint32_t erase_us;          /* tSE/tBERS: 每块擦除时间 */
+    void (*delay_us)(uint32_t us);  /* 非NULL时按模型真实阻塞 */
+};
+
+struct mtd_sim_config {
+    const char *name;
+    uint8_t type;               /* MTD_NORFLASH / MTD_NANDFLASH */
+    mtd_addr_t size;
+    uint32_t erasesize;
+    uint32_t writesize;         /* 页大小, NOR编程按页计时 */
+    uint32_t oobsize;           /* 每页OOB字节数, 仅NAND */
+    uint32_t erase_limit;       /* 擦除寿命, 超过后擦除失败, 0=不限 */
+    struct mtd_sim_timing timing;
+};
+
+/**
+ * @brief 故障注入, 计数器按操作次数递减, 到0时触发
+ * @note  写/擦除故障模拟掉电: 只完成一半后返回错误, 并进入掉电状态,
+ *        之后所有操作失败, 直到 mtd_sim_power_cycle()
+ */
+struct mtd_sim_fault {
+    long write_fail_after;      /* 第N+1次编程被撕裂, MTD_SIM_FAULT_OFF=关闭 */
+    long erase_fail_after;      /* 第N+1次擦除被撕裂 */
+    uint32_t read_flip_every;   /* 每N次读在返回数据中翻转1位, 0=关闭 */
+    uint32_t seed;              /* 翻转位置的伪随机种子 */
+    uint8_t powered_off;
+};
+
+struct mtd_sim_stats {
+    uint32_t reads;
+    uint32_t writes;
+    uint32_t erases;
+    uint64_t read_bytes;
+    uint64_t write_bytes;
+    uint64_t elapsed_ns;        /* 按延时模型累计的设备时间 */
+    uint32_t overprogram;       /* 试图把0写成1的编程次数 (NOR) */
+    uint32_t flips;             /* 已注入的读翻转 */
+    uint32_t faults;            /* 已触发的写/擦除故障 */
+};
+
+struct mtd_sim {
+    struct mtd_info mtd;
+    struct mtd_sim_config cfg;
+    struct mtd_sim_fault fault;
+    struct mtd_sim_stats stats;
+    const struct mtd_sim_store *store;
+    void *ctx;
+    uint32_t nblocks;
+    int erase_result;           /* 分段擦除的结果, 由 _erase_wait 取走 */
+    uint8_t erase_pending;
+    uint32_t erase_count[MTD_SIM_MAX_BLOCKS];
+    uint8_t bad[(MTD_SIM_MAX_BLOCKS + 7) / 8];
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int mtd_sim_init(struct mtd_sim *sim, const struct mtd_sim_config *cfg,
+                 const struct mtd_sim_store *store, void *ctx);
+int mtd_sim_format(struct mtd_sim *sim);
+void mtd_sim_power_cycle(struct mtd_sim *sim);
+int mtd_sim_set_bad(struct mtd_sim *sim, uint32_t block, int bad);
+void mtd_sim_reset_stats(struct mtd_sim *sim);
+
+static inline struct mtd_info *mtd_sim_to_mtd(struct mtd_sim *sim)
+{
+    return &sim->mtd;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MTD_SIM_H__ */
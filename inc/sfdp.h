@@ -20,6 +20,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include <stdint.h>
+#include "bitops.h"
 
 /* Exported define -----------------------------------------------------------*/
 /**
@@ -54,14 +55,57 @@
 #define BFPT_DWORD1_FAST_READ_1_4_4		    BIT(21)
 #define BFPT_DWORD1_FAST_READ_1_1_4		    BIT(22)
 
+/* 2nd DWORD. */
+#define BFPT_DWORD2_DENSITY_4G_MORE         BIT(31) /* bits[30:0] = N, density = 2^N bits */
+
+/* 3rd/4th DWORD: fast read settings, one 16-bit half per protocol. */
+#define BFPT_SETTINGS_WAIT_STATES_MASK      GENMASK(4, 0)
+#define BFPT_SETTINGS_MODE_CLOCKS_SHIFT     5
+#define BFPT_SETTINGS_MODE_CLOCKS_MASK      GENMASK(7, 5)
+#define BFPT_SETTINGS_OPCODE_SHIFT          8
+
 /* 5th DWORD. */
 #define BFPT_DWORD5_FAST_READ_2_2_2		    BIT(0)
 #define BFPT_DWORD5_FAST_READ_4_4_4		    BIT(4)
 
+/* 8th and 9th DWORDs: erase types, one 16-bit half per type. */
+#define BFPT_ERASE_SIZE_SHIFT_MASK          GENMASK(7, 0)
+#define BFPT_ERASE_OPCODE_SHIFT             8
+
+/* 10th DWORD: typical erase times, max = typical * 2 * (multiplier + 1). */
+#define BFPT_DWORD10_ERASE_MULT_MASK        GENMASK(3, 0)
+#define BFPT_DWORD10_ERASE_TYP_SHIFT(i)     (4 + 7 * (i))
+#define BFPT_ERASE_TYP_COUNT_MASK           GENMASK(4, 0)   /* (count + 1) units */
+#define BFPT_ERASE_TYP_UNIT_SHIFT           5               /* 1ms/16ms/128ms/1s */
+
 /* 11th DWORD. */
+#define BFPT_DWORD11_PROGRAM_MULT_MASK      GENMASK(3, 0)
+#define BFPT_DWORD11_PP_TYP_SHIFT           8
+#define BFPT_DWORD11_PP_TYP_COUNT_MASK      GENMASK(4, 0)   /* (count + 1) units */
+#define BFPT_DWORD11_PP_TYP_UNIT_64US       BIT(5)          /* else 8us */
 #define BFPT_DWORD11_PAGE_SIZE_SHIFT		4
 #define BFPT_DWORD11_PAGE_SIZE_MASK		    GENMASK(7, 4)
 
+/* 12th DWORD: suspend/resume timing. */
+#define BFPT_DWORD12_SUSPEND_UNSUPPORTED    BIT(31)
+#define BFPT_DWORD12_SUSPEND_LAT_SHIFT      24
+#define BFPT_DWORD12_SUSPEND_LAT_COUNT_MASK GENMASK(4, 0)   /* (count + 1) units */
+#define BFPT_DWORD12_SUSPEND_LAT_UNIT_SHIFT 5               /* 128ns/1us/8us/64us */
+#define BFPT_DWORD12_RESUME_TO_SUSPEND_SHIFT 20
+#define BFPT_DWORD12_RESUME_TO_SUSPEND_MASK GENMASK(3, 0)   /* (count + 1) * 64us */
+
+/* 13th DWORD: suspend/resume instructions. */
+#define BFPT_DWORD13_ERASE_SUSPEND_SHIFT    24
+#define BFPT_DWORD13_ERASE_RESUME_SHIFT     16
+#define BFPT_DWORD13_PROGRAM_SUSPEND_SHIFT  8
+#define BFPT_DWORD13_PROGRAM_RESUME_SHIFT   0
+
+/* 14th DWORD: deep power-down. */
+#define BFPT_DWORD14_DPD_UNSUPPORTED        BIT(31)
+#define BFPT_DWORD14_DPD_EXIT_SHIFT         8
+#define BFPT_DWORD14_DPD_EXIT_COUNT_MASK    GENMASK(4, 0)   /* (count + 1) units */
+#define BFPT_DWORD14_DPD_EXIT_UNIT_SHIFT    5               /* 128ns/1us/8us/64us */
+
 /* 15th DWORD. */
 /*
  * (from JESD216 rev B)
@@ -144,7 +188,53 @@
 #define BFPT_DWORD18_CMD_EXT_16B		(0x3UL << 29) /* 16-bit opcode */
 #define BFPT_DWORD18_BYTE_ORDER_SWAPPED		BIT(31)	/* Byte order swapped in 8D-8D-8D mode */
 
+/* 4-byte Address Instruction Table, 1st DWORD. */
+#define BAIT_DWORD1_READ                    BIT(0)
+#define BAIT_DWORD1_READ_FAST               BIT(1)
+#define BAIT_DWORD1_READ_1_1_2              BIT(2)
+#define BAIT_DWORD1_READ_1_2_2              BIT(3)
+#define BAIT_DWORD1_READ_1_1_4              BIT(4)
+#define BAIT_DWORD1_READ_1_4_4              BIT(5)
+#define BAIT_DWORD1_PP                      BIT(6)
+#define BAIT_DWORD1_PP_1_1_4                BIT(7)
+#define BAIT_DWORD1_PP_1_4_4                BIT(8)
+#define BAIT_DWORD1_ERASE_TYPE(i)           BIT(9 + (i))
+#define BAIT_DWORD1_READ_1_1_1_DTR          BIT(13)
+#define BAIT_DWORD1_READ_1_2_2_DTR          BIT(14)
+#define BAIT_DWORD1_READ_1_4_4_DTR          BIT(15)
+#define BAIT_DWORD_MAX                      2
+
+/* Sector Map Parameter Table: 配置检测命令描述符 (各2个DWORD) + 配置映射 */
+#define SMPT_DESC_END                       BIT(0)          /* 最后一个描述符 */
+#define SMPT_DESC_TYPE_MAP                  BIT(1)          /* 0=检测命令, 1=配置映射 */
+
+/* 检测命令描述符第1个DWORD, 第2个DWORD为读地址 */
+#define SMPT_CMD_OPCODE_SHIFT               8
+#define SMPT_CMD_READ_DUMMY_SHIFT           16
+#define SMPT_CMD_READ_DUMMY_MASK            GENMASK(19, 16)
+#define SMPT_CMD_READ_DUMMY_IS_VARIABLE     0xfU            /* 与当前读命令相同 */
+#define SMPT_CMD_ADDRESS_LEN_MASK           GENMASK(23, 22)
+#define SMPT_CMD_ADDRESS_LEN_0              (0x0UL << 22)
+#define SMPT_CMD_ADDRESS_LEN_3              (0x1UL << 22)
+#define SMPT_CMD_ADDRESS_LEN_4              (0x2UL << 22)
+#define SMPT_CMD_ADDRESS_LEN_USE_CURRENT    (0x3UL << 22)
+#define SMPT_CMD_READ_DATA_SHIFT            24              /* 读出字节的检测位掩码 */
+
+/* 配置映射头, 其后每个区域一个DWORD */
+#define SMPT_MAP_ID_SHIFT                   8
+#define SMPT_MAP_ID_MASK                    GENMASK(15, 8)
+#define SMPT_MAP_REGION_COUNT_SHIFT         16
+#define SMPT_MAP_REGION_COUNT_MASK          GENMASK(23, 16) /* 区域数 - 1 */
+#define SMPT_MAP_REGION_ERASE_TYPE_MASK     GENMASK(3, 0)   /* bit n: 支持擦除类型 n+1 */
+#define SMPT_MAP_REGION_SIZE_SHIFT          8
+#define SMPT_MAP_REGION_SIZE_MASK           GENMASK(31, 8)  /* (值 + 1) * 256 字节 */
+
+/* 解析时最多读取的SMPT长度 (DWORD) */
+#define SMPT_DWORD_MAX                      64
+
 /* Exported typedef ----------------------------------------------------------*/
+struct spi_nor;
+
 struct sfdp_bfpt {
 	uint32_t	dwords[BFPT_DWORD_MAX];
 };
@@ -158,11 +248,23 @@ struct sfdp_parameter_header {
 	uint8_t		id_msb;
 };
 
+struct sfdp_header {
+	uint32_t	signature; /* 0x50444653U <=> "SFDP" */
+	uint8_t		minor;
+	uint8_t		major;
+	uint8_t		nph; /* 0-base number of parameter headers */
+	uint8_t		unused;
+
+	/* Basic Flash Parameter Table. */
+	struct sfdp_parameter_header	bfpt_header;
+};
+
 /* Exported macro ------------------------------------------------------------*/
 
 /* Exported variable prototypes ----------------------------------------------*/
 
 /* Exported function prototypes ----------------------------------------------*/
+int spi_nor_parse_sfdp(struct spi_nor *nor);
 
 #ifdef __cplusplus
 }
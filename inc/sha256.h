@@ -0,0 +1,50 @@
+/**
+  ******************************************************************************
+  * @file        : sha256.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SHA-256 (FIPS 180-4) 流式摘要
+  * @attention   : 可分段调用 sha256_update(), 分段方式不影响结果
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __SHA256_H__
+#define __SHA256_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported define -----------------------------------------------------------*/
+#define SHA256_BLOCK_SIZE               64
+#define SHA256_DIGEST_SIZE              32
+
+/* Exported typedef ----------------------------------------------------------*/
+struct sha256_ctx {
+    uint32_t state[8];
+    uint64_t count;                     /* 已输入的字节数 */
+    uint8_t buf[SHA256_BLOCK_SIZE];     /* 不足一块的剩余数据 */
+    uint32_t buflen;
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+void sha256_init(struct sha256_ctx *ctx);
+void sha256_update(struct sha256_ctx *ctx, const void *data, size_t len);
+void sha256_final(struct sha256_ctx *ctx, uint8_t digest[SHA256_DIGEST_SIZE]);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __SHA256_H__ */
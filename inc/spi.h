@@ -51,6 +51,27 @@
 #define SPI_NAME_MAX        (16U)                    /**< Maximum length of SPI device name */
 /** @} */
 
+/**
+ * @defgroup SPI Bus Width Definitions
+ * @{
+ */
+#define SPI_NBITS_SINGLE    (1U)                     /**< 1-bit transfer (MOSI/MISO) */
+#define SPI_NBITS_DUAL      (2U)                     /**< 2-bit transfer (IO0-IO1) */
+#define SPI_NBITS_QUAD      (4U)                     /**< 4-bit transfer (IO0-IO3) */
+/** @} */
+
+/**
+ * @defgroup SPI Controller Capability Flags (spi_controller_ops::caps)
+ * @{
+ */
+#define SPI_CAP_TX_DUAL     (1U<<0)                  /**< Can transmit on 2 lanes */
+#define SPI_CAP_TX_QUAD     (1U<<1)                  /**< Can transmit on 4 lanes */
+#define SPI_CAP_RX_DUAL     (1U<<2)                  /**< Can receive on 2 lanes */
+#define SPI_CAP_RX_QUAD     (1U<<3)                  /**< Can receive on 4 lanes */
+#define SPI_CAP_DUMMY       (1U<<4)                  /**< Generates dummy cycles in hardware */
+#define SPI_CAP_DTR         (1U<<5)                  /**< Supports double transfer rate */
+/** @} */
+
 /* Forward declarations */
 struct spi_device;
 struct spi_controller;
@@ -69,6 +90,35 @@ struct spi_delay {
 	uint8_t	unit;
 };
 
+/**
+ * @brief Memory-mapped read template
+ * @details Describes the read command a memory-mapped controller (e.g.
+ *          QSPI) issues on every CPU access to its window
+ */
+struct spi_mmap_info {
+    uint8_t opcode;                    /**< Read command */
+    uint8_t addr_nbytes;               /**< Address bytes (3 or 4) */
+    uint8_t dummy_cycles;              /**< Idle clocks before data */
+    uint8_t cmd_nbits;                 /**< Command bus width */
+    uint8_t addr_nbits;                /**< Address bus width */
+    uint8_t data_nbits;                /**< Data bus width */
+    unsigned dtr : 1;                  /**< Address/data on both edges */
+};
+
+/**
+ * @brief Status polling template
+ * @details Describes a single-byte status read a controller repeats in
+ *          hardware until (status & mask) == match
+ */
+struct spi_poll_info {
+    uint8_t opcode;                    /**< Status read command */
+    uint8_t mask;                      /**< Bits compared */
+    uint8_t match;                     /**< Expected value of the masked bits */
+    uint8_t nbits;                     /**< Bus width of command and status (0 = single) */
+    uint16_t interval_us;              /**< Delay between two reads */
+    uint32_t timeout_ms;               /**< Give up after this long */
+};
+
 /**
  * @brief SPI Transfer Structure
  * @details Single transfer descriptor, can be linked into a message
@@ -77,7 +127,11 @@ struct spi_transfer {
     const void *tx_buf;                /**< Pointer to transmit buffer */
     void *rx_buf;                      /**< Pointer to receive buffer */
     size_t len;                        /**< Length of data to transfer (bytes) */
+    uint8_t tx_nbits;                  /**< TX bus width (SPI_NBITS_xxx), 0 = single */
+    uint8_t rx_nbits;                  /**< RX bus width (SPI_NBITS_xxx), 0 = single */
+    uint8_t dummy_cycles;              /**< Idle clocks issued before the data phase */
     unsigned cs_change : 1;            /**< Change chip select state after transfer */
+    unsigned dtr : 1;                  /**< Clock data on both edges */
     struct list_node transfer_list;    /**< Message list node */
 };
 
@@ -85,11 +139,16 @@ struct spi_transfer {
  * @brief SPI Message Structure
  * @details Message queue containing multiple transfers
  */
+#define SPI_MSG_PENDING     (1)                      /**< spi_message::status while queued/in flight */
+
 struct spi_message {
     struct list_node transfers;        /**< Transfer list head */
     struct spi_device *spi;            /**< Associated SPI device */
-    int status;                        /**< Transfer status: 0=success, <0=error */
-    void *context;                     /**< Context pointer (optional) */
+    volatile int status;               /**< Transfer status: 0=success, <0=error, SPI_MSG_PENDING=in progress */
+    size_t actual_length;              /**< Bytes transferred in all completed transfers */
+    void (*complete)(void *context);   /**< Completion callback (optional, may run in ISR context) */
+    void *context;                     /**< Context pointer (optional, passed to complete) */
+    struct list_node queue;            /**< Controller queue node (internal) */
 };
 
 /**
@@ -118,6 +177,13 @@ struct spi_device {
  * @details Hardware-specific operations that must be implemented by BSP layer
  */
 struct spi_controller_ops {
+    /**
+     * @brief Capability mask (SPI_CAP_xxx), 0 for a plain single-lane controller
+     * @note Without SPI_CAP_DUMMY, spi_sync() emulates dummy cycles by
+     *       clocking out 0xFF bytes at the transfer's bus width
+     */
+    uint32_t caps;
+    
     /**
      * @brief Configure SPI controller parameters
      * @param ctrl Controller pointer
@@ -136,14 +202,81 @@ struct spi_controller_ops {
     
     /**
      * @brief Execute transfer
+     * @note tx_nbits/rx_nbits/dtr/dummy_cycles are only set to values
+     *       advertised in caps (dummy_cycles only with SPI_CAP_DUMMY)
      * @param ctrl Controller pointer
      * @param dev Device pointer
      * @param transfer Transfer descriptor pointer
-     * @return Number of bytes transferred on success, error code on failure
+     * @return Number of bytes transferred (>=0) on success, error code on
+     *         failure; only the sign is used, spi_sync() reports 0
      */
     ssize_t (*transfer_one)(struct spi_controller *ctrl, 
                            struct spi_device *dev,
                            struct spi_transfer *transfer);
+    
+    /**
+     * @brief Start a transfer without waiting for it (optional, e.g. DMA)
+     * @note The BSP must call spi_transfer_complete() from its completion
+     *       interrupt; the framework then chains the next transfer/message
+     * @param ctrl Controller pointer
+     * @param dev Device pointer
+     * @param transfer Transfer descriptor pointer
+     * @return 0 if the transfer was started, error code on failure
+     */
+    int (*transfer_one_async)(struct spi_controller *ctrl,
+                              struct spi_device *dev,
+                              struct spi_transfer *transfer);
+    
+    /**
+     * @brief Enter memory-mapped read mode (optional)
+     * @note The framework leaves mapped mode via mmap_disable before
+     *       running any message and re-enters it once the queue drains
+     * @param ctrl Controller pointer
+     * @param dev Device pointer
+     * @param info Read command issued for each CPU access
+     * @param base Output: CPU address of device offset 0
+     * @param size Output: window size in bytes
+     * @return 0 on success, error code on failure
+     */
+    int (*mmap_enable)(struct spi_controller *ctrl,
+                       struct spi_device *dev,
+                       const struct spi_mmap_info *info,
+                       const void **base, size_t *size);
+    
+    /**
+     * @brief Leave memory-mapped mode so indirect transfers can run
+     * @param ctrl Controller pointer
+     * @param dev Device pointer
+     */
+    void (*mmap_disable)(struct spi_controller *ctrl, struct spi_device *dev);
+    
+    /**
+     * @brief Poll a status register in hardware (optional)
+     * @details Repeats info->opcode every info->interval_us and compares the
+     *          returned byte without CPU involvement (e.g. QUADSPI automatic
+     *          polling mode), returning as soon as the masked bits match
+     * @param ctrl Controller pointer
+     * @param dev Device pointer
+     * @param info Status read and match condition
+     * @param status Output: last status byte read
+     * @return 0 on match, -ETIMEDOUT, -ENOTSUPP if this template cannot be
+     *         polled in hardware, or another error code
+     */
+    int (*poll_status)(struct spi_controller *ctrl,
+                       struct spi_device *dev,
+                       const struct spi_poll_info *info,
+                       uint8_t *status);
+    
+    /**
+     * @brief Give up the CPU while spi_sync()/spi_poll_status() wait (optional)
+     * @details Called repeatedly while the bus is owned by another context.
+     *          An RTOS port should block here (e.g. osDelay(1) or a
+     *          semaphore given from spi_transfer_complete()) so that a
+     *          preempted lower-priority bus owner can finish. When NULL the
+     *          wait is a pure busy-spin.
+     * @param ctrl Controller pointer
+     */
+    void (*wait)(struct spi_controller *ctrl);
 };
 
 /**
@@ -160,6 +293,19 @@ struct spi_controller {
     uint32_t max_speed_hz;                      /**< Maximum speed */
     uint32_t actual_speed_hz;                   /**< Actual configured speed */
     struct spi_device *current_device;          /**< Currently configured device */
+    
+    struct list_node queue;                     /**< Pending spi_message FIFO */
+    struct spi_message *cur_msg;                /**< Message being transferred */
+    struct spi_transfer *cur_transfer;          /**< Transfer in flight (async only) */
+    volatile uint8_t busy;                      /**< Pump running */
+    uint8_t cs_active;                          /**< Chip select currently asserted */
+    
+    struct spi_mmap_info mmap_info;             /**< Active mapping template */
+    struct spi_device *mmap_dev;                /**< Device owning the mapping */
+    const void *mmap_base;                      /**< Window base address */
+    size_t mmap_size;                           /**< Window size */
+    volatile uint8_t mmap_refs;                 /**< spi_mmap_enable() references */
+    uint8_t mmap_on;                            /**< Hardware currently in mapped mode */
 };
 
 /* Exported types ------------------------------------------------------------*/
@@ -179,14 +325,72 @@ struct spi_controller *spi_controller_find(const char *name);
 int spi_device_attach(struct spi_device *dev, const char *controller_name);
 void spi_message_init(struct spi_message *m);
 void spi_message_add_tail(struct spi_transfer *t, struct spi_message *m);
+/*
+ * spi_sync() queues behind in-flight spi_async() messages and waits for the
+ * pump, unlike the original direct call into transfer_one. Callers must be
+ * in thread context with interrupts enabled; on an RTOS where a higher
+ * priority task may preempt the bus owner, provide ops->wait.
+ */
 int spi_sync(struct spi_device *dev, struct spi_message *message);
+int spi_async(struct spi_device *dev, struct spi_message *message);
+void spi_transfer_complete(struct spi_controller *ctrl, int status);
+int spi_mmap_enable(struct spi_device *dev, const struct spi_mmap_info *info,
+                    const void **base, size_t *size);
+void spi_mmap_disable(struct spi_device *dev);
+int spi_poll_status(struct spi_device *dev, const struct spi_poll_info *info, uint8_t *status);
+
+/**
+ * @brief Get capability mask of the controller a device is attached to
+ * @param spi SPI device pointer
+ * @return SPI_CAP_xxx mask, 0 if not attached
+ */
+static inline uint32_t
+spi_get_caps(const struct spi_device *spi)
+{
+    if ((spi == NULL) || (spi->controller == NULL) || (spi->controller->ops == NULL)) {
+        return 0U;
+    }
+    
+    return spi->controller->ops->caps;
+}
+
+/**
+ * @brief Check whether the device's controller has a memory-mapped window
+ * @param spi SPI device pointer
+ * @return 1 if spi_mmap_enable() can be used, 0 otherwise
+ */
+static inline int
+spi_mmap_supported(const struct spi_device *spi)
+{
+    if ((spi == NULL) || (spi->controller == NULL) || (spi->controller->ops == NULL)) {
+        return 0;
+    }
+    
+    return (spi->controller->ops->mmap_enable != NULL) &&
+           (spi->controller->ops->mmap_disable != NULL);
+}
+
+/**
+ * @brief Check whether the device's controller can poll status in hardware
+ * @param spi SPI device pointer
+ * @return 1 if spi_poll_status() can be used, 0 otherwise
+ */
+static inline int
+spi_poll_supported(const struct spi_device *spi)
+{
+    if ((spi == NULL) || (spi->controller == NULL) || (spi->controller->ops == NULL)) {
+        return 0;
+    }
+    
+    return spi->controller->ops->poll_status != NULL;
+}
 
 /**
  * @brief Write data to SPI device
  * @param spi SPI device pointer
  * @param buf Data buffer to write
  * @param len Length of data
- * @return Number of bytes written on success, error code on failure
+ * @return 0 on success, error code on failure
  */
 static inline int
 spi_write(struct spi_device *spi, const void *buf, size_t len)
@@ -200,10 +404,9 @@ spi_write(struct spi_device *spi, const void *buf, size_t len)
     
     spi_message_init(&m);
     
+    (void)memset(&t, 0, sizeof(t));
     t.tx_buf = buf;
-    t.rx_buf = NULL;
     t.len = len;
-    t.cs_change = 0U;
     list_node_init(&t.transfer_list);
     
     spi_message_add_tail(&t, &m);
@@ -216,7 +419,7 @@ spi_write(struct spi_device *spi, const void *buf, size_t len)
  * @param spi SPI device pointer
  * @param buf Buffer to store read data
  * @param len Length of data to read
- * @return Number of bytes read on success, error code on failure
+ * @return 0 on success, error code on failure
  */
 static inline int
 spi_read(struct spi_device *spi, void *buf, size_t len)
@@ -230,10 +433,9 @@ spi_read(struct spi_device *spi, void *buf, size_t len)
     
     spi_message_init(&m);
     
-    t.tx_buf = NULL;
+    (void)memset(&t, 0, sizeof(t));
     t.rx_buf = buf;
     t.len = len;
-    t.cs_change = 0U;
     list_node_init(&t.transfer_list);
     
     spi_message_add_tail(&t, &m);
@@ -248,7 +450,7 @@ spi_read(struct spi_device *spi, void *buf, size_t len)
  * @param txlen Length of data to write
  * @param rxbuf Buffer to store read data
  * @param rxlen Length of data to read
- * @return Number of bytes transferred on success, error code on failure
+ * @return 0 on success, error code on failure
  */
 static inline int
 spi_write_then_read(struct spi_device *spi, 
@@ -268,15 +470,14 @@ spi_write_then_read(struct spi_device *spi,
     spi_message_init(&m);
     
     /* TX transfer */
+    (void)memset(&t_tx, 0, sizeof(t_tx));
     t_tx.tx_buf = txbuf;
-    t_tx.rx_buf = NULL;
     t_tx.len = txlen;
-    t_tx.cs_change = 0U;
     list_node_init(&t_tx.transfer_list);
     spi_message_add_tail(&t_tx, &m);
     
     /* RX transfer */
-    t_rx.tx_buf = NULL;
+    (void)memset(&t_rx, 0, sizeof(t_rx));
     t_rx.rx_buf = rxbuf;
     t_rx.len = rxlen;
     t_rx.cs_change = 1U;
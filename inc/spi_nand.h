@@ -0,0 +1,154 @@
+/**
+  ******************************************************************************
+  * @file        : spi_nand.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SPI NAND Flash驱动 (带片上ECC), 通过 mtd_info 访问
+  * @attention   : 顺序多页读使用 cache read (30h/3Fh) 或 Winbond连续读,
+  *                下一页从阵列载入缓存与本页经总线读出重叠进行
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __SPI_NAND_H__
+#define __SPI_NAND_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sys_def.h"
+#include "spi.h"
+#include "bitops.h"
+#include "mtd.h"
+
+/* Exported define -----------------------------------------------------------*/
+/* SPI NAND Flash CMD codes. */
+#define SPINAND_CMD_RESET               0xff    /* Reset */
+#define SPINAND_CMD_GET_FEATURE         0x0f    /* Read feature register */
+#define SPINAND_CMD_SET_FEATURE         0x1f    /* Write feature register */
+#define SPINAND_CMD_RDID                0x9f    /* Read JEDEC ID (with one dummy byte) */
+#define SPINAND_CMD_WREN                0x06    /* Write enable */
+#define SPINAND_CMD_WRDI                0x04    /* Write disable */
+#define SPINAND_CMD_PAGE_READ           0x13    /* Array -> cache */
+#define SPINAND_CMD_READ_CACHE_RANDOM   0x30    /* Cache read: previous page to cache, load next */
+#define SPINAND_CMD_READ_CACHE_LAST     0x3f    /* Cache read: last page to cache, end */
+#define SPINAND_CMD_READ_FROM_CACHE     0x03    /* Read cache (low frequency) */
+#define SPINAND_CMD_READ_FROM_CACHE_FAST 0x0b   /* Read cache (high frequency) */
+#define SPINAND_CMD_READ_FROM_CACHE_X2  0x3b    /* Read cache (Dual Output SPI) */
+#define SPINAND_CMD_READ_FROM_CACHE_X4  0x6b    /* Read cache (Quad Output SPI) */
+#define SPINAND_CMD_PROG_LOAD           0x02    /* Reset cache to 0xFF, load data */
+#define SPINAND_CMD_PROG_LOAD_X4        0x32    /* Quad program load */
+#define SPINAND_CMD_PROG_EXEC           0x10    /* Cache -> array */
+#define SPINAND_CMD_BLOCK_ERASE         0xd8    /* Erase one block */
+
+/* Feature register addresses. */
+#define SPINAND_REG_PROT                0xa0    /* Block protection */
+#define SPINAND_REG_CFG                 0xb0    /* Configuration */
+#define SPINAND_REG_STATUS              0xc0    /* Status */
+
+/* Status register bits. */
+#define SPINAND_SR_OIP                  BIT(0)  /* Operation in progress */
+#define SPINAND_SR_WEL                  BIT(1)  /* Write enable latch */
+#define SPINAND_SR_E_FAIL               BIT(2)  /* Erase failed */
+#define SPINAND_SR_P_FAIL               BIT(3)  /* Program failed */
+#define SPINAND_SR_ECC_SHIFT            4
+#define SPINAND_SR_ECC_MASK             GENMASK(6, 4)
+#define SPINAND_SR_CRBSY                BIT(7)  /* Cache read busy (Micron) */
+
+/* Configuration register bits. */
+#define SPINAND_CFG_BUF                 BIT(3)  /* 1=缓存读模式, 0=连续读模式 (Winbond) */
+#define SPINAND_CFG_ECC_EN              BIT(4)  /* On-die ECC enable */
+#define SPINAND_CFG_OTP_EN              BIT(6)
+
+/* struct spi_nand_info::flags */
+#define SPINAND_F_CACHE_RANDOM          BIT(0)  /* 支持 30h/3Fh 流水读 */
+#define SPINAND_F_CONT_READ             BIT(1)  /* 支持BUF=0连续读 (Winbond) */
+#define SPINAND_F_TWO_PLANES            BIT(2)  /* 列地址bit12为plane选择 (块号bit0) */
+
+/* spi_nand_scan() hwcaps */
+#define SPINAND_HWCAPS_READ_X2          BIT(0)
+#define SPINAND_HWCAPS_READ_X4          BIT(1)
+#define SPINAND_HWCAPS_PROG_X4          BIT(2)
+
+/**
+ * @brief OOB暂存缓冲大小, 不小于支持器件的最大OOB
+ */
+#define SPI_NAND_MAX_OOB                128
+
+/* Exported typedef ----------------------------------------------------------*/
+struct spi_nand;
+
+/**
+ * @brief 器件参数表项
+ */
+struct spi_nand_info {
+    const char *name;
+    uint8_t mfr_id;
+    uint16_t dev_id;                    // ID第2,3字节; 1字节ID的器件放在高8位
+    uint8_t dev_id_len;                 // 1或2
+    uint32_t flags;                     // SPINAND_F_xxx
+    uint16_t page_size;
+    uint16_t oob_size;
+    uint16_t pages_per_block;
+    uint16_t nblocks;
+    uint8_t ecc_strength;               // 每步可纠正位数
+    uint8_t oob_free_offs;              // MTD_OPS_AUTO_OOB 可用区
+    uint8_t oob_free_len;
+    /* SR的ECC状态位 -> 翻转位数, -ERR_IO=无法纠正 */
+    int (*ecc_status)(const struct spi_nand *nand, uint8_t sr);
+};
+
+/**
+ * @brief 顺序读统计, 用于评估流水读的收益
+ */
+struct spi_nand_stats {
+    uint32_t page_reads;                // 13h 单页读
+    uint32_t cache_reads;               // 30h/3Fh 流水读出的页
+    uint32_t cont_reads;                // 连续读模式读出的页
+    uint32_t cont_fallback;             // 连续读有ECC事件后改为逐页重读的次数
+};
+
+struct spi_nand
+{
+    struct spi_device *spi;             // SPI设备指针
+    const struct spi_nand_info *info;
+    uint8_t manufacturer_id;
+    uint16_t device_id;
+
+    uint8_t read_opcode;                // 选定的读缓存命令
+    uint8_t read_nbits;
+    uint8_t program_opcode;             // 选定的载入命令
+    uint8_t program_nbits;
+    uint8_t cfg;                        // 配置寄存器的当前值
+    uint8_t page_shift;
+    uint8_t block_shift;                // 每块页数的位数
+    struct spi_nand_stats stats;
+    uint8_t oob[SPI_NAND_MAX_OOB];      // OOB暂存
+    struct mtd_info mtd;                // MTD接口, 由 spi_nand_mtd_init() 填充
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int spi_nand_scan(struct spi_nand *nand, uint32_t hwcaps);
+int spi_nand_reset(struct spi_nand *nand);
+int spi_nand_get_feature(struct spi_nand *nand, uint8_t reg, uint8_t *val);
+int spi_nand_set_feature(struct spi_nand *nand, uint8_t reg, uint8_t val);
+int spi_nand_mtd_init(struct spi_nand *nand, const char *name);
+
+static inline struct mtd_info *spi_nand_to_mtd(struct spi_nand *nand)
+{
+    return &nand->mtd;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __SPI_NAND_H__ */
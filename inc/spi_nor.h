@@ -22,6 +22,8 @@
 #include "sys_def.h"
 #include "spi.h"
 #include "bitops.h"
+#include "stimer.h"
+#include "mtd.h"
 /* Exported define -----------------------------------------------------------*/
 /* SPI Nor Flash CMD codes. */
 #define SPINOR_CMD_WREN		            0x06	/* Write enable */
@@ -30,6 +32,8 @@
 #define SPINOR_CMD_WRSR                 0x01	/* Write status register 1 */
 #define SPINOR_CMD_RDSR2                0x35	/* Read status register 2 */
 #define SPINOR_CMD_WRSR2                0x31	/* Write status register 2 */
+#define SPINOR_CMD_RDSR2_BIT7           0x3f    /* Read status register 2 (QE is bit 7) */
+#define SPINOR_CMD_WRSR2_BIT7           0x3e    /* Write status register 2 (QE is bit 7) */
 #define SPINOR_CMD_RDSR3		        0x15	/* Read status register 3 */
 #define SPINOR_CMD_WRSR3		        0x11	/* Write status register 3 */
 #define SPINOR_CMD_READ		            0x03	/* Read data bytes (low frequency) */
@@ -56,12 +60,16 @@
 #define SPINOR_CMD_SRSTEN	            0x66	/* Software Reset Enable */
 #define SPINOR_CMD_SRST		            0x99	/* Software Reset */
 #define SPINOR_CMD_GBULK		        0x98    /* Global Block Unlock */
+#define SPINOR_CMD_SUSPEND              0x75    /* Erase/Program suspend */
+#define SPINOR_CMD_RESUME               0x7a    /* Erase/Program resume */
 #define SPINOR_CMD_POWER_DOWN           0xb9    /* Power down */
 #define SPINOR_CMD_RELEASE_POWER_DOWN   0xab    /* Release power down */
+#define SPINOR_CMD_EWSR                 0x50    /* Write enable for volatile status register */
+#define SPINOR_CMD_RDUID                0x4b    /* Read unique ID */
 
 /* 4-byte address opcodes */
 #define SPINOR_CMD_ENTER_4B             0xb7    /* Enter 4-Byte Address Mode */
-#define SPINOR_CMD_EXIT_4B              0xb7    /* Exit 4-Byte Address Mode */
+#define SPINOR_CMD_EXIT_4B              0xe9    /* Exit 4-Byte Address Mode */
 #define SPINOR_CMD_READ_4B	            0x13	/* Read data bytes (low frequency) */
 #define SPINOR_CMD_READ_FAST_4B	        0x0c	/* Read data bytes (high frequency) */
 #define SPINOR_CMD_READ_1_1_2_4B	    0x3c	/* Read data bytes (Dual Output SPI) */
@@ -92,10 +100,6 @@
 #define SPINOR_CMD_BP		            0x02	/* Byte program */
 #define SPINOR_CMD_AAI_WP	            0xad	/* Auto address increment word program */
 
-/* Used for Macronix and Winbond flashes. */
-#define SPINOR_CMD_EN4B		            0xb7	/* Enter 4-byte mode */
-#define SPINOR_CMD_EX4B		            0xe9	/* Exit 4-byte mode */
-
 /* Used for Spansion flashes only. */
 #define SPINOR_CMD_BRWR		            0x17	/* Bank register write */
 
@@ -137,6 +141,7 @@
 #define SPINOR_SR2_LB2			    BIT(4)	/* Security Register Lock Bit 2 */
 #define SPINOR_SR2_LB3			    BIT(5)	/* Security Register Lock Bit 3 */
 #define SPINOR_SR2_QUAD_EN_BIT7	    BIT(7)
+#define SPINOR_SR2_SUS			    BIT(7)	/* Erase/Program suspended (Winbond/GigaDevice) */
 
 /* Supported SPI protocols */
 #define SNOR_PROTO_INST_MASK	    0x00FF0000
@@ -193,29 +198,359 @@ enum spi_nor_protocol {
 #define SPI_NOR_ERR_INVALID_ADDR    -5
 #define SPI_NOR_ERR_NOT_SUPPORTED   -6
 #define SPI_NOR_ERR_BUSY            -7
+
+/* 控制器/板级支持的读写协议 (hwcaps), 位序即速度优先级 */
+#define SNOR_HWCAPS_READ            BIT(0)
+#define SNOR_HWCAPS_READ_FAST       BIT(1)
+#define SNOR_HWCAPS_READ_1_1_1_DTR  BIT(2)
+#define SNOR_HWCAPS_READ_1_1_2      BIT(3)
+#define SNOR_HWCAPS_READ_1_2_2      BIT(4)
+#define SNOR_HWCAPS_READ_1_2_2_DTR  BIT(5)
+#define SNOR_HWCAPS_READ_1_1_4      BIT(6)
+#define SNOR_HWCAPS_READ_1_4_4      BIT(7)
+#define SNOR_HWCAPS_READ_1_4_4_DTR  BIT(8)
+#define SNOR_HWCAPS_READ_MASK       GENMASK(8, 0)
+
+#define SNOR_HWCAPS_PP_SHIFT        16
+#define SNOR_HWCAPS_PP              BIT(16)
+#define SNOR_HWCAPS_PP_1_1_4        BIT(17)
+#define SNOR_HWCAPS_PP_1_4_4        BIT(18)
+#define SNOR_HWCAPS_PP_MASK         GENMASK(18, 16)
+
+#define SNOR_HWCAPS_DEFAULT         (SNOR_HWCAPS_READ | SNOR_HWCAPS_READ_FAST | SNOR_HWCAPS_PP)
+
+/* struct spi_nor::flags */
+#define SNOR_F_HAS_SFDP             BIT(0)  /* 已成功解析SFDP */
+#define SNOR_F_HAS_4BAIT            BIT(1)  /* SFDP提供4字节地址指令表 */
+#define SNOR_F_HAS_SMPT             BIT(2)  /* SFDP提供扇区映射表 */
+#define SNOR_F_SUSPEND              BIT(3)  /* 支持擦写暂停/恢复 */
+#define SNOR_F_4B_OPCODES           BIT(4)  /* 使用专用4字节地址指令 */
+#define SNOR_F_4B_MODE              BIT(5)  /* 已通过EN4B进入4字节地址模式 */
+#define SNOR_F_SR_VOLATILE          BIT(6)  /* 支持 50h 易失写状态寄存器 */
+#define SNOR_F_NO_DPD               BIT(7)  /* 不支持深度掉电 (SFDP声明) */
+
+/* struct flash_info::flags, 用于无SFDP或SFDP不完整的器件 */
+#define SNOR_INFO_DUAL_READ         BIT(0)  /* 支持 3Bh (1-1-2) */
+#define SNOR_INFO_QUAD_READ         BIT(1)  /* 支持 6Bh (1-1-4) */
+#define SNOR_INFO_QUAD_PP           BIT(2)  /* 支持 32h (1-1-4) */
+#define SNOR_INFO_SR_VOLATILE       BIT(3)  /* 支持 50h 易失写状态寄存器 */
+#define SNOR_INFO_SUSPEND           BIT(4)  /* 支持擦写暂停/恢复 */
+
+/**
+ * @brief 探测时用易失写解除块保护 (BP/TB/SEC/CMP 与单块锁), 断电后恢复非易失的保护设置
+ */
+#define SPI_NOR_UNLOCK_AT_SCAN      1
+
+#define SPI_NOR_UID_MAX             16      /* 唯一ID最大字节数 */
+
+#define SNOR_ERASE_TYPE_MAX         4
+#define SNOR_ERASE_REGION_MAX       8       /* SFDP扇区映射表中最多处理的区域数 */
+#define SNOR_DUMMY_BYTES_MAX        8       /* 单线下最多64个dummy周期 */
+
 /* Exported typedef ----------------------------------------------------------*/
+struct spi_nor;
+
+/* 读命令索引, 与 SNOR_HWCAPS_READ_xxx 位号一一对应 */
+enum spi_nor_read_command_index {
+    SNOR_CMD_READ,
+    SNOR_CMD_READ_FAST,
+    SNOR_CMD_READ_1_1_1_DTR,
+    SNOR_CMD_READ_1_1_2,
+    SNOR_CMD_READ_1_2_2,
+    SNOR_CMD_READ_1_2_2_DTR,
+    SNOR_CMD_READ_1_1_4,
+    SNOR_CMD_READ_1_4_4,
+    SNOR_CMD_READ_1_4_4_DTR,
+    SNOR_CMD_READ_MAX
+};
+
+/* 页编程命令索引, 与 SNOR_HWCAPS_PP_xxx 位号 - SNOR_HWCAPS_PP_SHIFT 对应 */
+enum spi_nor_pp_command_index {
+    SNOR_CMD_PP,
+    SNOR_CMD_PP_1_1_4,
+    SNOR_CMD_PP_1_4_4,
+    SNOR_CMD_PP_MAX
+};
+
+struct spi_nor_read_command {
+    uint8_t num_mode_clocks;            // 模式位周期数
+    uint8_t num_wait_states;            // 等待周期数
+    uint8_t opcode;
+    enum spi_nor_protocol proto;
+};
+
+struct spi_nor_pp_command {
+    uint8_t opcode;
+    enum spi_nor_protocol proto;
+};
+
+struct spi_nor_erase_type {
+    uint32_t size;                      // 擦除尺寸 (字节), 0表示不支持
+    uint8_t size_shift;
+    uint8_t opcode;
+    uint32_t typ_ms;                    // 典型擦除时间
+    uint32_t max_ms;                    // 最大擦除时间
+};
+
+/**
+ * @brief 擦除区域, 来自SFDP扇区映射表 (SMPT)
+ */
+struct spi_nor_erase_region {
+    uint32_t offset;
+    uint32_t size;
+    uint8_t erase_mask;                 // 可用的擦除类型, bit n 对应 erase_types[n]
+};
+
+/**
+ * @brief 安全寄存器 (OTP) 操作, addr为区域内的Flash地址
+ */
+struct spi_nor_otp_ops {
+    int (*read)(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *buf);
+    int (*write)(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *buf);
+    int (*erase)(struct spi_nor *nor, uint32_t addr);
+    int (*is_locked)(struct spi_nor *nor, uint32_t region);     // 1=已永久锁定
+};
+
+/**
+ * @brief 安全寄存器布局: 第n个区域位于 base + n * offset, 长 len 字节
+ */
+struct spi_nor_otp {
+    uint32_t base;
+    uint32_t offset;
+    uint16_t len;
+    uint8_t n_regions;
+    const struct spi_nor_otp_ops *ops;
+};
+
+/**
+ * @brief Flash参数, 由默认值、SFDP以及厂商修正依次填充
+ */
+struct spi_nor_flash_parameter {
+    uint32_t size;                      // 容量 (字节)
+    uint32_t page_size;                 // 页大小 (字节)
+    uint8_t addr_nbytes;                // 地址字节数
+    uint32_t hwcaps;                    // Flash支持的读写协议 (SNOR_HWCAPS_xxx)
+    struct spi_nor_read_command reads[SNOR_CMD_READ_MAX];
+    struct spi_nor_pp_command page_programs[SNOR_CMD_PP_MAX];
+    struct spi_nor_erase_type erase_types[SNOR_ERASE_TYPE_MAX];
+    uint32_t bait_hwcaps;               // 4BAIT中存在4字节地址指令的协议
+    uint8_t bait_erase_opcodes[SNOR_ERASE_TYPE_MAX];
+    uint32_t page_program_typ_us;       // 典型页编程时间
+    uint32_t page_program_max_us;       // 最大页编程时间
+    uint8_t erase_suspend_opcode;
+    uint8_t erase_resume_opcode;
+    uint8_t program_suspend_opcode;
+    uint8_t program_resume_opcode;
+    uint32_t suspend_latency_us;        // 暂停命令到可读的最大延迟 (tSUS)
+    uint32_t resume_to_suspend_us;      // 恢复后再次暂停前的最小间隔 (tRS)
+    uint32_t power_down_us;             // B9h 到进入深度掉电的时间 (tDP)
+    uint32_t release_power_down_us;     // ABh 到可以访问的时间 (tRES1)
+    uint32_t smpt_addr;                 // 扇区映射表SFDP地址
+    uint16_t smpt_len;                  // 扇区映射表长度 (字节)
+    uint8_t n_regions;                  // 0=全片支持所有擦除类型
+    struct spi_nor_erase_region regions[SNOR_ERASE_REGION_MAX];
+    struct spi_nor_otp otp;             // 安全寄存器布局, n_regions=0表示不支持
+    uint8_t unique_id_len;              // 4Bh返回的唯一ID字节数, 0表示不支持
+    uint8_t unique_id_dummy;            // 4Bh地址/dummy阶段的周期数
+    int (*quad_enable)(struct spi_nor *nor);
+    int (*suspend_status)(struct spi_nor *nor); // 1=已暂停, 0=未暂停, 负数=错误码; NULL则不启用暂停
+};
+
+/**
+ * @brief 厂商/型号修正, 在探测的各阶段调用, 各项可为NULL
+ */
+struct spi_nor_fixups {
+    void (*default_init)(struct spi_nor *nor);  // SFDP解析前, 补充默认参数
+    void (*post_sfdp)(struct spi_nor *nor);     // SFDP解析后, 修正缺失或错误的参数
+    int (*late_init)(struct spi_nor *nor);      // 协议与地址模式选定后, 如解除写保护
+};
+
+/**
+ * @brief 型号表项, 按JEDEC ID第2,3字节匹配
+ */
+struct flash_info {
+    const char *name;
+    uint16_t id;
+    uint32_t size;                      // 容量 (字节), 0表示由ID/SFDP决定
+    uint32_t flags;                     // SNOR_INFO_xxx
+    const struct spi_nor_fixups *fixups;
+};
+
+/**
+ * @brief 厂商表项, 按JEDEC厂商ID匹配
+ */
+struct spi_nor_manufacturer {
+    const char *name;
+    uint8_t id;
+    const struct flash_info *parts;
+    uint32_t nparts;
+    const struct spi_nor_fixups *fixups;    // 对该厂商所有器件生效, 先于型号修正
+};
+
+typedef void (*spi_nor_done_t)(struct spi_nor *nor, int status, void *arg);
+
+/**
+ * @brief 异步擦除/编程状态, 由软件定时器驱动SR1轮询
+ */
+struct spi_nor_async {
+    volatile uint8_t busy;              // 擦写进行中
+    volatile uint8_t suspended;         // 已被读操作暂停
+    uint8_t is_erase;                   // 1=擦除, 0=页编程
+    uint8_t rdsr_opcode;
+    uint8_t sr;                         // 最近一次读取的SR1
+    volatile int status;                // 最近一次完成的结果
+    uint32_t start_ms;                  // 命令发出时刻
+    uint32_t timeout_ms;                // 最大允许时间
+    uint32_t interval_ms;               // 后续轮询间隔
+    uint32_t addr;                      // 擦写区域, 与之重叠的读不可抢占
+    uint32_t len;
+    uint32_t suspend_ms;                // 最近一次暂停时刻, 暂停期间不计入超时
+    uint32_t resume_ms;                 // 最近一次恢复时刻
+    spi_nor_done_t done;                // 完成回调 (定时器/SPI完成上下文)
+    void *arg;
+    stimer_t timer;
+    struct spi_message msg;
+    struct spi_transfer xfer[2];
+};
+
+/**
+ * @brief 空闲掉电管理的状态
+ */
+enum spi_nor_pm_state {
+    SNOR_PM_STANDBY,                    // 待机 (含访问进行中)
+    SNOR_PM_POWER_DOWN,                 // 深度掉电
+    SNOR_PM_STATE_MAX,
+};
+
+/**
+ * @brief 空闲掉电统计, 由 spi_nor_pm_get_stats() 取得
+ */
+struct spi_nor_pm_stats {
+    uint32_t power_downs;               // 进入深度掉电的次数
+    uint32_t wakeups;                   // 因访问而唤醒的次数
+    uint32_t time_ms[SNOR_PM_STATE_MAX];    // 各状态累计时间 (ms)
+};
+
+/**
+ * @brief 空闲掉电状态, 由软件定时器在空闲超时后发出 B9h
+ */
+struct spi_nor_pm {
+    volatile uint8_t state;             // enum spi_nor_pm_state
+    volatile uint8_t active;            // 进行中的总线访问数, 非0时不掉电
+    uint8_t pointed;                    // 未释放的 spi_nor_point() 次数, 非0时占用一次访问计数
+    uint8_t opcode;
+    uint32_t idle_ms;                   // 空闲超时, 0=关闭
+    volatile uint32_t last_ms;          // 最近一次访问结束时刻
+    uint32_t state_ms;                  // 进入当前状态的时刻
+    struct spi_nor_pm_stats stats;
+    stimer_t timer;
+    struct spi_message msg;
+    struct spi_transfer xfer;
+};
+
+/**
+ * @brief 单次Flash操作: 命令 + 地址 + dummy + 数据
+ */
+struct spi_nor_op {
+    uint8_t opcode;
+    uint8_t addr_nbytes;                // 0表示无地址阶段
+    uint8_t dummy_cycles;               // dummy时钟周期数 (含模式位)
+    uint32_t addr;
+    enum spi_nor_protocol proto;
+    const void *tx_buf;                 // 写数据, 与rx_buf二选一
+    void *rx_buf;                       // 读数据
+    size_t len;                         // 数据长度
+};
+
+#if MTD_SUPPORT_READ_ASYNC
+/**
+ * @brief 分段读状态 (mtd_read_start/mtd_read_wait), 消息在途期间op与地址缓冲须保持有效
+ */
+struct spi_nor_read_async {
+    volatile uint8_t busy;              // 已发起, 尚未被 _read_wait 取走
+    uint8_t sync;                       // 擦写进行中, 已在发起时同步读完
+    int status;                         // 同步读的结果
+    uint32_t len;
+    struct spi_nor_op op;
+    uint8_t addr[4];
+    struct spi_message msg;
+    struct spi_transfer xfer[3];
+};
+#endif
+
 struct spi_nor
 {
     struct spi_device *spi;      // SPI设备指针
     uint32_t capacity;           // 存储器容量 (字节)
-    uint16_t sector_size;        // 扇区大小 (字节)
+    uint32_t sector_size;        // 全片都能单独擦除的最小块 (字节)
     uint16_t page_size;          // 页大小 (字节)
     uint32_t unique_id;          // 唯一ID
     uint8_t manufacturer_id;     // 制造商ID
     uint16_t device_id;          // 设备ID
     char name[8];                // 设备名称
+    const struct spi_nor_manufacturer *manufacturer;    // 未收录的厂商为NULL
+    const struct flash_info *info;                      // 未收录的型号为NULL
+
+    uint32_t flags;              // SNOR_F_xxx
+    uint8_t addr_nbytes;         // 当前使用的地址字节数
+    uint8_t read_opcode;         // 选定的读命令
+    uint8_t read_dummy;          // 读命令dummy周期
+    uint8_t program_opcode;      // 选定的页编程命令
+    uint8_t erase_opcode;        // 扇区擦除命令, 非均匀扇区时为0
+    uint32_t hwcaps;             // 选定的读/写协议 (SNOR_HWCAPS_xxx)
+    enum spi_nor_protocol read_proto;
+    enum spi_nor_protocol write_proto;
+    struct spi_nor_flash_parameter params;
+    struct spi_nor_async async;  // 异步擦写状态
+    struct spi_nor_pm pm;        // 空闲掉电状态
+#if MTD_SUPPORT_READ_ASYNC
+    struct spi_nor_read_async rd; // 分段读状态
+#endif
+#if MTD_SUPPORT_ERASE_REGIONS
+    struct mtd_erase_region_info eraseregions[SNOR_ERASE_REGION_MAX];
+#endif
+    struct mtd_info mtd;         // MTD接口, 由 spi_nor_mtd_init() 填充
 };
 /* Exported macro ------------------------------------------------------------*/
+static inline uint8_t spi_nor_get_protocol_inst_nbits(enum spi_nor_protocol proto)
+{
+    return (uint8_t)(((uint32_t)proto & SNOR_PROTO_INST_MASK) >> SNOR_PROTO_INST_SHIFT);
+}
+
+static inline uint8_t spi_nor_get_protocol_addr_nbits(enum spi_nor_protocol proto)
+{
+    return (uint8_t)(((uint32_t)proto & SNOR_PROTO_ADDR_MASK) >> SNOR_PROTO_ADDR_SHIFT);
+}
+
+static inline uint8_t spi_nor_get_protocol_data_nbits(enum spi_nor_protocol proto)
+{
+    return (uint8_t)(((uint32_t)proto & SNOR_PROTO_DATA_MASK) >> SNOR_PROTO_DATA_SHIFT);
+}
+
+static inline int spi_nor_protocol_is_dtr(enum spi_nor_protocol proto)
+{
+    return ((uint32_t)proto & SNOR_PROTO_IS_DTR) != 0U;
+}
 
 /* Exported variable prototypes ----------------------------------------------*/
+extern const struct spi_nor_manufacturer spi_nor_winbond;
 
 /* Exported function prototypes ----------------------------------------------*/
+/* 探测与底层操作 */
+int spi_nor_scan(struct spi_nor *nor, uint32_t hwcaps);
+int spi_nor_exec_op(struct spi_nor *nor, const struct spi_nor_op *op);
+int spi_nor_sr2_bit1_quad_enable(struct spi_nor *nor);
+int spi_nor_sr1_bit6_quad_enable(struct spi_nor *nor);
+int spi_nor_sr2_bit7_quad_enable(struct spi_nor *nor);
+
 /* 基本电源管理与控制命令 */
 int spi_nor_power_down(struct spi_nor *nor);
 int spi_nor_release_power_down(struct spi_nor *nor);
 int spi_nor_software_reset(struct spi_nor *nor);
 int spi_nor_suspend(struct spi_nor *nor);
 int spi_nor_resume(struct spi_nor *nor);
+int spi_nor_pm_enable(struct spi_nor *nor, uint32_t idle_ms);
+void spi_nor_pm_get_stats(struct spi_nor *nor, struct spi_nor_pm_stats *stats);
 
 /* 状态寄存器操作 */
 int spi_nor_read_sr1(struct spi_nor *nor);
@@ -228,11 +563,16 @@ int spi_nor_write_volatile_sr1(struct spi_nor *nor, uint8_t status);
 int spi_nor_write_volatile_sr2(struct spi_nor *nor, uint8_t status);
 int spi_nor_write_volatile_sr3(struct spi_nor *nor, uint8_t status);
 int spi_nor_write_enable_for_volatile_sr(struct spi_nor *nor);
+int spi_nor_write_sr1_sr2(struct spi_nor *nor, uint8_t sr1, uint8_t sr2, bool vol);
 
 /* 安全寄存器操作 */
-int spi_nor_read_security_register(struct spi_nor *nor, uint32_t param1, uint8_t *param2);
-int spi_nor_program_security_register(struct spi_nor *nor, uint32_t param1, uint8_t *param2);
-int spi_nor_erase_security_register(struct spi_nor *nor, uint32_t param);
+int spi_nor_read_security_register(struct spi_nor *nor, uint32_t offs, uint32_t len, uint8_t *buf);
+int spi_nor_program_security_register(struct spi_nor *nor, uint32_t offs, uint32_t len,
+                                      const uint8_t *buf);
+int spi_nor_erase_security_register(struct spi_nor *nor, uint32_t region);
+int spi_nor_otp_read_secr(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *buf);
+int spi_nor_otp_write_secr(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *buf);
+int spi_nor_otp_erase_secr(struct spi_nor *nor, uint32_t addr);
 
 /* 设备ID与参数读取 */
 int spi_nor_read_unique_id(struct spi_nor *nor, uint8_t *unique_id);
@@ -251,8 +591,16 @@ int spi_nor_sector_erase(struct spi_nor *nor, uint32_t addr);
 int spi_nor_sector_erase_4byte_address(struct spi_nor *nor, uint32_t addr);
 int spi_nor_block_erase_no_rb_check(struct spi_nor *nor, uint32_t addr);
 
+/* 异步擦写: 立即返回, 完成后调用 done(nor, status, arg) */
+int spi_nor_erase_async(struct spi_nor *nor, uint32_t addr, spi_nor_done_t done, void *arg);
+int spi_nor_program_async(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *data,
+                          spi_nor_done_t done, void *arg);
+bool spi_nor_is_busy(struct spi_nor *nor);
+
 /* 编程操作 */
 int spi_nor_page_program(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data);
+int spi_nor_write(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *buf);
+int spi_nor_erase(struct spi_nor *nor, uint32_t addr, uint32_t len, uint32_t *fail_addr);
 int spi_nor_page_program_4byte_address(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data);
 int spi_nor_quad_input_page_program(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data);
 int spi_nor_quad_page_program_4byte_address(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data);
@@ -307,6 +655,14 @@ int spi_nor_exit_4byte_address_mode(struct spi_nor *nor);
 int spi_nor_set_burst_with_wrap(struct spi_nor *nor, uint32_t wrap_setting);
 int spi_nor_set_read_parameters(struct spi_nor *nor, uint8_t read_setting);
 
+/* 直接映射读 */
+int spi_nor_point(struct spi_nor *nor, uint32_t addr, uint32_t len,
+                  uint32_t *retlen, const void **virt);
+int spi_nor_unpoint(struct spi_nor *nor);
+
+/* MTD接口 */
+int spi_nor_mtd_init(struct spi_nor *nor, const char *name);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
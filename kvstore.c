@@ -0,0 +1,887 @@
+/**
+  ******************************************************************************
+  * @file        : kvstore.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 基于MTD的键值存储
+  * @attention   : 扇区布局: [扇区头][记录0][记录1]...
+  *                - 记录 = 记录头(类型, 键长, 值长, CRC) + 键 + 值, 4字节对齐
+  *                - 更新与删除均追加新记录 (删除为墓碑), 旧记录原地作废
+  *                - 扇区按环形顺序使用, 始终保留一个空扇区; 写满时
+  *                  启用预留扇区, 并把最旧扇区的有效记录搬入后擦除
+  *                - 挂载时顺序扫描一次全部记录, 建立开放寻址哈希索引,
+  *                  之后查找只需读取目标记录本身
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "kvstore.h"
+#include "crc32.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "kv"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct kv_sector_hdr {
+    uint32_t magic;
+    uint32_t seq;
+    uint32_t seq_inv;           /* ~seq, 校验扇区头写入完整 */
+    uint32_t reserved;
+};
+
+struct kv_rec_hdr {
+    uint8_t type;               /* KV_REC_xxx */
+    uint8_t key_len;
+    uint16_t val_len;
+    uint32_t crc;               /* CRC32(前4字节 + 键 + 值) */
+};
+
+/* Private define ------------------------------------------------------------*/
+#define KV_MAGIC                0x5653564BUL    /* "KVSV" */
+#define KV_REC_VALUE            0x56U           /* 'V' */
+#define KV_REC_DELETE           0x44U           /* 'D' 墓碑 */
+#define KV_LOC_EMPTY            0xFFFFU
+#define KV_NO_SECTOR            0xFFFFU
+#define KV_ALIGN                4U
+
+#define KV_SECTOR_HDR_SIZE      ((uint32_t)sizeof(struct kv_sector_hdr))
+#define KV_REC_HDR_SIZE         ((uint32_t)sizeof(struct kv_rec_hdr))
+#define KV_REC_MAX_SIZE         KV_REC_SIZE(KV_KEY_MAX, KV_VAL_MAX)
+#define KV_BLANK_CHUNK          32U
+#define KV_INDEX_LIMIT          (KV_INDEX_SIZE * 3U / 4U)   /* 装载因子上限, 探测长度有界 */
+
+#if (KV_INDEX_SIZE & (KV_INDEX_SIZE - 1)) != 0 || KV_INDEX_SIZE > 65536
+#error "KV_INDEX_SIZE must be a power of 2 not larger than 65536"
+#endif
+
+/* Private macro -------------------------------------------------------------*/
+#define KV_REC_SIZE(klen, vlen) \
+    ((KV_REC_HDR_SIZE + (uint32_t)(klen) + (uint32_t)(vlen) + KV_ALIGN - 1U) & ~(KV_ALIGN - 1U))
+
+/* 索引项只存哈希高16位, 起始槽也由它导出, 删除时无需重读键 */
+#define KV_TAG(hash)            ((uint16_t)((hash) >> 16))
+#define KV_HOME(tag)            ((uint16_t)((tag) & (KV_INDEX_SIZE - 1U)))
+#define KV_NEXT(i)              ((uint16_t)(((i) + 1U) & (KV_INDEX_SIZE - 1U)))
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int kv_raw_read(struct kv_store *kv, mtd_addr_t addr, void *buf, size_t len);
+static int kv_raw_write(struct kv_store *kv, mtd_addr_t addr, const void *buf, size_t len);
+static int kv_range_blank(struct kv_store *kv, mtd_addr_t addr, uint32_t len);
+static uint32_t kv_hash(const char *key, uint8_t len);
+static uint32_t kv_rec_crc(const struct kv_rec_hdr *hdr, const void *key, const void *val);
+static int kv_rec_sane(const struct kv_store *kv, const struct kv_rec_hdr *hdr, uint32_t off);
+static uint16_t kv_find_loc(const struct kv_store *kv, uint16_t tag, uint16_t loc);
+static int kv_lookup(struct kv_store *kv, const char *key, uint8_t len, uint32_t hash, uint16_t *slot);
+static void kv_index_remove(struct kv_store *kv, uint16_t slot);
+static int kv_index_apply(struct kv_store *kv, const struct kv_rec_hdr *hdr,
+                          const char *key, uint16_t loc);
+static int kv_erase_sector(struct kv_store *kv, uint16_t sector);
+static int kv_open_sector(struct kv_store *kv, uint16_t sector);
+static int kv_write_rec(struct kv_store *kv, struct kv_rec_hdr *hdr,
+                        const void *key, const void *val, uint16_t *loc);
+static int kv_compact(struct kv_store *kv, uint16_t sector);
+static int kv_reserve(struct kv_store *kv, uint32_t size);
+static uint32_t kv_capacity(const struct kv_store *kv);
+static int kv_layout(struct kv_store *kv);
+static int kv_scan_sector(struct kv_store *kv, uint16_t sector, uint32_t *end);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  挂载键值存储, 扫描全部记录重建索引
+  * @param  kv 实例 (调用者分配)
+  * @param  mtd 底层设备, 整个设备用于存储, 可传分区
+  * @retval 0=成功, 负数=错误码
+  * @note   挂载时间与区域大小成正比: 每条记录只读一次;
+  *         全新或无有效扇区的设备自动初始化
+  */
+int kv_mount(struct kv_store *kv, struct mtd_info *mtd)
+{
+    struct kv_sector_hdr hdr;
+    uint32_t best_seq = 0;
+    uint32_t end = 0;
+    uint16_t active = KV_NO_SECTOR;
+    uint16_t resume;
+    uint16_t s;
+    uint16_t i;
+    int ret;
+
+    if (!kv || !mtd) {
+        log_e("kv_mount: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    if (mtd->type == MTD_NANDFLASH || !(mtd->flags & MTD_WRITEABLE))
+        return -ERR_NOTSUPP;
+
+    memset(kv, 0, sizeof(*kv));
+    kv->mtd = mtd;
+
+    ret = kv_layout(kv);
+    if (ret)
+        return ret;
+
+    memset(kv->index, 0xFF, sizeof(kv->index));
+
+    for (s = 0; s < kv->nsectors; s++) {
+        ret = kv_raw_read(kv, (mtd_addr_t)s * kv->sector_size, &hdr, sizeof(hdr));
+        if (ret)
+            return ret;
+
+        if (hdr.magic == KV_MAGIC && hdr.seq == ~hdr.seq_inv) {
+            kv->used[s] = 1;
+            if (active == KV_NO_SECTOR || hdr.seq > best_seq) {
+                active = s;
+                best_seq = hdr.seq;
+            }
+            continue;
+        }
+
+        /* 无有效扇区头: 空白则直接可用, 否则是擦除中断的残留 */
+        ret = kv_range_blank(kv, (mtd_addr_t)s * kv->sector_size, kv->sector_size);
+        if (ret < 0)
+            return ret;
+        if (!ret) {
+            ret = kv_erase_sector(kv, s);
+            if (ret)
+                return ret;
+        }
+    }
+
+    if (active == KV_NO_SECTOR) {
+        log_i("kv_mount: no valid sector, initializing.");
+        ret = kv_open_sector(kv, 0);
+        if (ret)
+            return ret;
+        kv->mounted = 1;
+        return 0;
+    }
+
+    kv->next_seq = best_seq + 1U;
+    kv->active = active;
+
+    /*
+     * 预留扇区仍在使用说明整理过程中掉电. 整理紧跟在启用新扇区之后,
+     * 此时当前扇区只有搬移的副本 (可能还有写了一半的记录), 原记录仍完整
+     * 保留在最旧扇区, 故直接清空当前扇区, 扫描后重新整理
+     */
+    resume = (uint16_t)((active + 1U) % kv->nsectors);
+    if (kv->used[resume]) {
+        log_w("kv_mount: interrupted compaction of sector %u, redo.", resume);
+        ret = kv_erase_sector(kv, active);
+        if (ret)
+            return ret;
+        ret = kv_open_sector(kv, active);
+        if (ret)
+            return ret;
+    } else {
+        resume = KV_NO_SECTOR;
+    }
+
+    /* 从最旧扇区扫到当前扇区, 后写入的记录覆盖先写入的 */
+    for (i = 1; i <= kv->nsectors; i++) {
+        s = (uint16_t)((active + i) % kv->nsectors);
+        if (!kv->used[s])
+            continue;
+        ret = kv_scan_sector(kv, s, &end);
+        if (ret)
+            return ret;
+    }
+
+    /* 当前扇区尾部须为空白, 否则 (掉电残留) 封存该扇区 */
+    kv->wp = end;
+    ret = kv_range_blank(kv, (mtd_addr_t)active * kv->sector_size + end, kv->sector_size - end);
+    if (ret < 0)
+        return ret;
+    if (!ret) {
+        log_w("kv_mount: sector %u tail not blank, sealed.", active);
+        kv->wp = kv->sector_size;
+    }
+
+    if (resume != KV_NO_SECTOR) {
+        ret = kv_compact(kv, resume);
+        if (ret)
+            return ret;
+    }
+
+    kv->mounted = 1;
+
+    return 0;
+}
+
+/**
+  * @brief  清空全部数据
+  * @retval 0=成功, 负数=错误码
+  */
+int kv_format(struct kv_store *kv)
+{
+    uint16_t s;
+    int ret;
+
+    if (!kv || !kv->mtd)
+        return -ERR_INVAL;
+
+    for (s = 0; s < kv->nsectors; s++) {
+        ret = kv_erase_sector(kv, s);
+        if (ret)
+            return ret;
+    }
+
+    memset(kv->index, 0xFF, sizeof(kv->index));
+    kv->live_bytes = 0;
+    kv->count = 0;
+
+    ret = kv_open_sector(kv, 0);
+    if (ret)
+        return ret;
+
+    kv->mounted = 1;
+
+    return 0;
+}
+
+/**
+  * @brief  写入键值
+  * @param  key 以'\0'结尾的键, 长度 1~KV_KEY_MAX
+  * @param  val 值, len为0时可为NULL
+  * @param  len 值长度, 不超过 KV_VAL_MAX
+  * @retval 0=成功, 负数=错误码
+  * @note   与现有值相同时不写Flash
+  */
+int kv_set(struct kv_store *kv, const char *key, const void *val, size_t len)
+{
+    struct kv_rec_hdr hdr;
+    struct kv_rec_hdr old;
+    uint32_t old_size = 0;
+    uint32_t size;
+    uint32_t hash;
+    uint16_t slot;
+    uint16_t loc;
+    size_t klen;
+    int found;
+    int ret;
+
+    if (!kv || !kv->mounted || !key || (len && !val) || len > KV_VAL_MAX)
+        return -ERR_INVAL;
+
+    klen = strlen(key);
+    if (!klen || klen > KV_KEY_MAX)
+        return -ERR_INVAL;
+
+    hash = kv_hash(key, (uint8_t)klen);
+    found = kv_lookup(kv, key, (uint8_t)klen, hash, &slot);
+    if (found < 0)
+        return found;
+
+    if (found) {
+        ret = kv_raw_read(kv, (mtd_addr_t)kv->index[slot].loc * KV_ALIGN, &old, sizeof(old));
+        if (ret)
+            return ret;
+        old_size = KV_REC_SIZE(old.key_len, old.val_len);
+
+        if (old.val_len == len) {
+            ret = kv_raw_read(kv, (mtd_addr_t)kv->index[slot].loc * KV_ALIGN + KV_REC_HDR_SIZE + klen,
+                              kv->buf, len);
+            if (ret)
+                return ret;
+            if (!len || !memcmp(kv->buf, val, len))
+                return 0;
+        }
+    } else if (kv->count >= KV_INDEX_LIMIT) {
+        return -ERR_NOSPC;
+    }
+
+    size = KV_REC_SIZE(klen, len);
+    if (kv->live_bytes - old_size + size > kv_capacity(kv))
+        return -ERR_NOSPC;
+
+    ret = kv_reserve(kv, size);
+    if (ret)
+        return ret;
+
+    hdr.type = KV_REC_VALUE;
+    hdr.key_len = (uint8_t)klen;
+    hdr.val_len = (uint16_t)len;
+    ret = kv_write_rec(kv, &hdr, key, val, &loc);
+    if (ret)
+        return ret;
+
+    /* 整理只会改写已有索引项的位置, 空槽位置不变 */
+    if (!found) {
+        kv->index[slot].tag = KV_TAG(hash);
+        kv->count++;
+    }
+    kv->index[slot].loc = loc;
+    kv->live_bytes = kv->live_bytes - old_size + size;
+
+    return 0;
+}
+
+/**
+  * @brief  读取键值
+  * @param  buf 输出缓冲, 值长于size时截断
+  * @param  len 输出值的实际长度, 可为NULL
+  * @retval 0=成功, -ERR_NOENT=键不存在, 其他负数=错误码
+  */
+int kv_get(struct kv_store *kv, const char *key, void *buf, size_t size, size_t *len)
+{
+    struct kv_rec_hdr hdr;
+    mtd_addr_t addr;
+    uint32_t hash;
+    uint16_t slot;
+    size_t klen;
+    int ret;
+
+    if (!kv || !kv->mounted || !key || (size && !buf))
+        return -ERR_INVAL;
+
+    klen = strlen(key);
+    if (!klen || klen > KV_KEY_MAX)
+        return -ERR_INVAL;
+
+    hash = kv_hash(key, (uint8_t)klen);
+    ret = kv_lookup(kv, key, (uint8_t)klen, hash, &slot);
+    if (ret < 0)
+        return ret;
+    if (!ret)
+        return -ERR_NOENT;
+
+    addr = (mtd_addr_t)kv->index[slot].loc * KV_ALIGN;
+    ret = kv_raw_read(kv, addr, &hdr, sizeof(hdr));
+    if (ret)
+        return ret;
+
+    if (len)
+        *len = hdr.val_len;
+    if (size > hdr.val_len)
+        size = hdr.val_len;
+
+    return kv_raw_read(kv, addr + KV_REC_HDR_SIZE + klen, buf, size);
+}
+
+/**
+  * @brief  删除键
+  * @retval 0=成功, -ERR_NOENT=键不存在, 其他负数=错误码
+  */
+int kv_delete(struct kv_store *kv, const char *key)
+{
+    struct kv_rec_hdr hdr;
+    struct kv_rec_hdr old;
+    uint32_t hash;
+    uint16_t slot;
+    uint16_t loc;
+    size_t klen;
+    int ret;
+
+    if (!kv || !kv->mounted || !key)
+        return -ERR_INVAL;
+
+    klen = strlen(key);
+    if (!klen || klen > KV_KEY_MAX)
+        return -ERR_INVAL;
+
+    hash = kv_hash(key, (uint8_t)klen);
+    ret = kv_lookup(kv, key, (uint8_t)klen, hash, &slot);
+    if (ret < 0)
+        return ret;
+    if (!ret)
+        return -ERR_NOENT;
+
+    ret = kv_raw_read(kv, (mtd_addr_t)kv->index[slot].loc * KV_ALIGN, &old, sizeof(old));
+    if (ret)
+        return ret;
+
+    ret = kv_reserve(kv, KV_REC_SIZE(klen, 0));
+    if (ret)
+        return ret;
+
+    hdr.type = KV_REC_DELETE;
+    hdr.key_len = (uint8_t)klen;
+    hdr.val_len = 0;
+    ret = kv_write_rec(kv, &hdr, key, NULL, &loc);
+    if (ret)
+        return ret;
+
+    kv->live_bytes -= KV_REC_SIZE(old.key_len, old.val_len);
+    kv->count--;
+    kv_index_remove(kv, slot);
+
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static int kv_raw_read(struct kv_store *kv, mtd_addr_t addr, void *buf, size_t len)
+{
+    size_t retlen = 0;
+    int ret;
+
+    if (!len)
+        return 0;
+
+    ret = mtd_read(kv->mtd, addr, len, &retlen, (uint8_t *)buf);
+    if (ret < 0)
+        return ret;
+
+    return (retlen == len) ? 0 : -ERR_IO;
+}
+
+/**
+  * @brief  写入并确保已落到Flash (绕过写合并缓冲的延迟)
+  */
+static int kv_raw_write(struct kv_store *kv, mtd_addr_t addr, const void *buf, size_t len)
+{
+    size_t retlen = 0;
+    int ret;
+
+    if (!len)
+        return 0;
+
+    ret = mtd_write(kv->mtd, addr, len, &retlen, (const uint8_t *)buf);
+    if (ret < 0)
+        return ret;
+    if (retlen != len)
+        return -ERR_IO;
+
+#if MTD_SUPPORT_WRITE_BUFFER
+    /* 记录体->记录头 的提交顺序依赖每一步都已写入 */
+    ret = mtd_sync(kv->mtd);
+    if (ret < 0)
+        return ret;
+#endif
+
+    return 0;
+}
+
+/**
+  * @brief  检查区域是否全0xFF
+  * @retval 1=空, 0=非空, 负数=错误码
+  */
+static int kv_range_blank(struct kv_store *kv, mtd_addr_t addr, uint32_t len)
+{
+    uint8_t chunk[KV_BLANK_CHUNK];
+    uint32_t n;
+    uint32_t i;
+    int ret;
+
+    while (len) {
+        n = (len > KV_BLANK_CHUNK) ? KV_BLANK_CHUNK : len;
+        ret = kv_raw_read(kv, addr, chunk, n);
+        if (ret)
+            return ret;
+        for (i = 0; i < n; i++) {
+            if (chunk[i] != 0xFFU)
+                return 0;
+        }
+        addr += n;
+        len -= n;
+    }
+
+    return 1;
+}
+
+/**
+  * @brief  FNV-1a 32位哈希
+  */
+static uint32_t kv_hash(const char *key, uint8_t len)
+{
+    uint32_t h = 2166136261UL;
+
+    while (len--) {
+        h ^= (uint8_t)*key++;
+        h *= 16777619UL;
+    }
+
+    return h;
+}
+
+static uint32_t kv_rec_crc(const struct kv_rec_hdr *hdr, const void *key, const void *val)
+{
+    uint32_t crc;
+
+    crc = crc32(0, hdr, offsetof(struct kv_rec_hdr, crc));
+    crc = crc32(crc, key, hdr->key_len);
+    if (hdr->val_len)
+        crc = crc32(crc, val, hdr->val_len);
+
+    return crc;
+}
+
+/**
+  * @brief  记录头合法性检查 (不校验CRC)
+  * @param  off 记录在扇区内的偏移
+  */
+static int kv_rec_sane(const struct kv_store *kv, const struct kv_rec_hdr *hdr, uint32_t off)
+{
+    if (hdr->type != KV_REC_VALUE && hdr->type != KV_REC_DELETE)
+        return 0;
+    if (!hdr->key_len || hdr->key_len > KV_KEY_MAX || hdr->val_len > KV_VAL_MAX)
+        return 0;
+    if (hdr->type == KV_REC_DELETE && hdr->val_len)
+        return 0;
+
+    return off + KV_REC_SIZE(hdr->key_len, hdr->val_len) <= kv->sector_size;
+}
+
+
+/**
+  * @brief  按位置查找索引项 (不读Flash)
+  * @retval 索引槽号, KV_LOC_EMPTY=无
+  */
+static uint16_t kv_find_loc(const struct kv_store *kv, uint16_t tag, uint16_t loc)
+{
+    uint16_t i = KV_HOME(tag);
+
+    while (kv->index[i].loc != KV_LOC_EMPTY) {
+        if (kv->index[i].loc == loc)
+            return i;
+        i = KV_NEXT(i);
+    }
+
+    return KV_LOC_EMPTY;
+}
+
+/**
+  * @brief  按键查找索引 (线性探测, 哈希标签相同时读Flash比对键)
+  * @param  slot 输出: 命中时为所在槽, 否则为可插入的空槽
+  * @retval 1=命中, 0=不存在, 负数=错误码
+  */
+static int kv_lookup(struct kv_store *kv, const char *key, uint8_t len, uint32_t hash, uint16_t *slot)
+{
+    struct kv_rec_hdr hdr;
+    char name[KV_KEY_MAX];
+    uint16_t tag = KV_TAG(hash);
+    uint16_t i = KV_HOME(tag);
+    mtd_addr_t addr;
+    int ret;
+
+    while (kv->index[i].loc != KV_LOC_EMPTY) {
+        if (kv->index[i].tag == tag) {
+            addr = (mtd_addr_t)kv->index[i].loc * KV_ALIGN;
+            ret = kv_raw_read(kv, addr, &hdr, sizeof(hdr));
+            if (ret)
+                return ret;
+            if (hdr.key_len == len) {
+                ret = kv_raw_read(kv, addr + KV_REC_HDR_SIZE, name, len);
+                if (ret)
+                    return ret;
+                if (!memcmp(name, key, len)) {
+                    *slot = i;
+                    return 1;
+                }
+            }
+        }
+        i = KV_NEXT(i);
+    }
+
+    *slot = i;
+
+    return 0;
+}
+
+/**
+  * @brief  删除索引项, 后移删除保持探测链连续, 无需墓碑
+  */
+static void kv_index_remove(struct kv_store *kv, uint16_t slot)
+{
+    uint16_t i = slot;
+    uint16_t j = slot;
+    uint16_t home;
+
+    for (;;) {
+        j = KV_NEXT(j);
+        if (kv->index[j].loc == KV_LOC_EMPTY)
+            break;
+
+        /* 起始槽循环落在 (i, j] 内的项不能前移 */
+        home = KV_HOME(kv->index[j].tag);
+        if ((i <= j) ? (i < home && home <= j) : (i < home || home <= j))
+            continue;
+
+        kv->index[i] = kv->index[j];
+        i = j;
+    }
+
+    kv->index[i].loc = KV_LOC_EMPTY;
+}
+
+/**
+  * @brief  挂载扫描时把一条记录应用到索引
+  * @param  key 键, 值紧随其后
+  * @param  loc 记录位置 (4字节为单位)
+  */
+static int kv_index_apply(struct kv_store *kv, const struct kv_rec_hdr *hdr,
+                          const char *key, uint16_t loc)
+{
+    struct kv_rec_hdr old;
+    uint32_t hash = kv_hash(key, hdr->key_len);
+    uint16_t slot;
+    int found;
+    int ret;
+
+    found = kv_lookup(kv, key, hdr->key_len, hash, &slot);
+    if (found < 0)
+        return found;
+
+    if (found) {
+        ret = kv_raw_read(kv, (mtd_addr_t)kv->index[slot].loc * KV_ALIGN, &old, sizeof(old));
+        if (ret)
+            return ret;
+        kv->live_bytes -= KV_REC_SIZE(old.key_len, old.val_len);
+    }
+
+    if (hdr->type == KV_REC_DELETE) {
+        if (found) {
+            kv_index_remove(kv, slot);
+            kv->count--;
+        }
+        return 0;
+    }
+
+    if (!found) {
+        if (kv->count >= KV_INDEX_LIMIT) {
+            log_e("kv_index_apply: index full.");
+            return -ERR_NOSPC;
+        }
+        kv->index[slot].tag = KV_TAG(hash);
+        kv->count++;
+    }
+    kv->index[slot].loc = loc;
+    kv->live_bytes += KV_REC_SIZE(hdr->key_len, hdr->val_len);
+
+    return 0;
+}
+
+/**
+  * @brief  擦除扇区
+  * @note   擦除前先清除魔数, 擦除中途掉电不会留下看似有效的扇区
+  */
+static int kv_erase_sector(struct kv_store *kv, uint16_t sector)
+{
+    struct erase_info instr;
+    uint32_t word = 0;
+    int ret;
+
+    if (kv->used[sector]) {
+        ret = kv_raw_write(kv, (mtd_addr_t)sector * kv->sector_size, &word, sizeof(word));
+        if (ret)
+            return ret;
+        kv->used[sector] = 0;
+    }
+
+    instr.addr = (mtd_addr_t)sector * kv->sector_size;
+    instr.len = kv->sector_size;
+
+    return mtd_erase(kv->mtd, &instr);
+}
+
+/**
+  * @brief  写入扇区头, 使其成为当前追加扇区
+  */
+static int kv_open_sector(struct kv_store *kv, uint16_t sector)
+{
+    struct kv_sector_hdr hdr;
+    int ret;
+
+    hdr.magic = KV_MAGIC;
+    hdr.seq = kv->next_seq;
+    hdr.seq_inv = ~kv->next_seq;
+    hdr.reserved = 0xFFFFFFFFUL;
+
+    ret = kv_raw_write(kv, (mtd_addr_t)sector * kv->sector_size, &hdr, sizeof(hdr));
+    if (ret)
+        return ret;
+
+    kv->used[sector] = 1;
+    kv->active = sector;
+    kv->wp = KV_SECTOR_HDR_SIZE;
+    kv->next_seq++;
+
+    return 0;
+}
+
+/**
+  * @brief  在当前扇区追加一条记录, 调用者保证空间足够
+  * @note   先写键和值, 最后写记录头, 记录头即提交点
+  * @param  loc 输出记录位置 (4字节为单位)
+  */
+static int kv_write_rec(struct kv_store *kv, struct kv_rec_hdr *hdr,
+                        const void *key, const void *val, uint16_t *loc)
+{
+    mtd_addr_t addr = (mtd_addr_t)kv->active * kv->sector_size + kv->wp;
+    int ret;
+
+    hdr->crc = kv_rec_crc(hdr, key, val);
+
+    ret = kv_raw_write(kv, addr + KV_REC_HDR_SIZE, key, hdr->key_len);
+    if (ret)
+        return ret;
+
+    ret = kv_raw_write(kv, addr + KV_REC_HDR_SIZE + hdr->key_len, val, hdr->val_len);
+    if (ret)
+        return ret;
+
+    ret = kv_raw_write(kv, addr, hdr, sizeof(*hdr));
+    if (ret)
+        return ret;
+
+    *loc = (uint16_t)(addr / KV_ALIGN);
+    kv->wp += KV_REC_SIZE(hdr->key_len, hdr->val_len);
+
+    return 0;
+}
+
+/**
+  * @brief  把扇区中仍有效的记录搬到当前扇区, 然后擦除
+  * @note   墓碑不搬移: 被整理的总是最旧扇区, 更早的值已不存在
+  */
+static int kv_compact(struct kv_store *kv, uint16_t sector)
+{
+    struct kv_rec_hdr hdr;
+    mtd_addr_t base = (mtd_addr_t)sector * kv->sector_size;
+    uint32_t off = KV_SECTOR_HDR_SIZE;
+    uint32_t size;
+    uint16_t slot;
+    uint16_t loc;
+    int ret;
+
+    while (off + KV_REC_HDR_SIZE <= kv->sector_size) {
+        ret = kv_raw_read(kv, base + off, &hdr, sizeof(hdr));
+        if (ret)
+            return ret;
+        if (!kv_rec_sane(kv, &hdr, off))
+            break;
+
+        size = KV_REC_SIZE(hdr.key_len, hdr.val_len);
+        if (hdr.type == KV_REC_VALUE) {
+            ret = kv_raw_read(kv, base + off + KV_REC_HDR_SIZE, kv->buf,
+                              (size_t)hdr.key_len + hdr.val_len);
+            if (ret)
+                return ret;
+
+            slot = kv_find_loc(kv, KV_TAG(kv_hash((const char *)kv->buf, hdr.key_len)),
+                               (uint16_t)((base + off) / KV_ALIGN));
+            if (slot != KV_LOC_EMPTY) {
+                if (kv->wp + size > kv->sector_size) {
+                    log_e("kv_compact: sector %u does not fit.", sector);
+                    return -ERR_NOSPC;
+                }
+                ret = kv_write_rec(kv, &hdr, kv->buf, kv->buf + hdr.key_len, &loc);
+                if (ret)
+                    return ret;
+                kv->index[slot].loc = loc;
+            }
+        }
+        off += size;
+    }
+
+    return kv_erase_sector(kv, sector);
+}
+
+/**
+  * @brief  确保当前扇区能放下size字节, 必要时切换扇区并整理最旧扇区
+  */
+static int kv_reserve(struct kv_store *kv, uint32_t size)
+{
+    uint16_t next;
+    uint16_t i;
+    int ret;
+
+    for (i = 0; kv->wp + size > kv->sector_size; i++) {
+        next = (uint16_t)((kv->active + 1U) % kv->nsectors);
+        if (i >= kv->nsectors || kv->used[next])
+            return -ERR_NOSPC;
+
+        ret = kv_open_sector(kv, next);
+        if (ret)
+            return ret;
+
+        /* 恢复预留: 新的下一个扇区就是最旧扇区 */
+        next = (uint16_t)((next + 1U) % kv->nsectors);
+        if (kv->used[next]) {
+            ret = kv_compact(kv, next);
+            if (ret)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  有效数据上限: 除预留扇区外, 每个扇区尾部最多浪费一条最大记录
+  */
+static uint32_t kv_capacity(const struct kv_store *kv)
+{
+    return (uint32_t)(kv->nsectors - 1U) * (kv->sector_size - KV_SECTOR_HDR_SIZE - KV_REC_MAX_SIZE);
+}
+
+static int kv_layout(struct kv_store *kv)
+{
+    struct mtd_info *mtd = kv->mtd;
+    mtd_addr_t n;
+
+    if (!mtd->erasesize || mtd->erasesize % KV_ALIGN ||
+        mtd->erasesize < KV_SECTOR_HDR_SIZE + 2U * KV_REC_MAX_SIZE)
+        return -ERR_INVAL;
+
+    n = mtd->size / mtd->erasesize;
+    if (n < 2 || n > KV_MAX_SECTORS || mtd->size / KV_ALIGN >= KV_LOC_EMPTY) {
+        log_e("kv_layout: region of %lu bytes not supported.", (unsigned long)mtd->size);
+        return -ERR_INVAL;
+    }
+
+    kv->sector_size = mtd->erasesize;
+    kv->nsectors = (uint16_t)n;
+
+    return 0;
+}
+
+/**
+  * @brief  顺序扫描扇区内的记录并应用到索引
+  * @param  end 输出最后一条可解析记录之后的偏移
+  */
+static int kv_scan_sector(struct kv_store *kv, uint16_t sector, uint32_t *end)
+{
+    struct kv_rec_hdr hdr;
+    mtd_addr_t base = (mtd_addr_t)sector * kv->sector_size;
+    uint32_t off = KV_SECTOR_HDR_SIZE;
+    int ret;
+
+    while (off + KV_REC_HDR_SIZE <= kv->sector_size) {
+        ret = kv_raw_read(kv, base + off, &hdr, sizeof(hdr));
+        if (ret)
+            return ret;
+        /* 空白或写了一半的记录头: 扇区内有效记录到此为止 */
+        if (!kv_rec_sane(kv, &hdr, off))
+            break;
+
+        ret = kv_raw_read(kv, base + off + KV_REC_HDR_SIZE, kv->buf,
+                          (size_t)hdr.key_len + hdr.val_len);
+        if (ret)
+            return ret;
+
+        if (kv_rec_crc(&hdr, kv->buf, kv->buf + hdr.key_len) == hdr.crc) {
+            ret = kv_index_apply(kv, &hdr, (const char *)kv->buf,
+                                 (uint16_t)((base + off) / KV_ALIGN));
+            if (ret)
+                return ret;
+        } else {
+            log_w("kv_scan_sector: bad record at 0x%lx skipped.", (unsigned long)(base + off));
+        }
+
+        off += KV_REC_SIZE(hdr.key_len, hdr.val_len);
+    }
+
+    *end = off;
+
+    return 0;
+}
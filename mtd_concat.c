@@ -0,0 +1,416 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_concat.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 多片Flash拼接为一个MTD设备
+  * @attention   : - 线性模式: 地址依次落在各子设备上
+  *                - 交错模式: 第n个擦除块位于子设备 n % num, 顺序写入的日志
+  *                  依次轮换芯片, 一片擦除时另一片可继续读写
+  *                - 子设备提供 _erase_start/_erase_wait 时, 一次擦除请求中
+  *                  落在不同芯片上的块并行擦除; 否则逐块同步擦除
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "mtd_concat.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "mtd_concat"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+#define MTD_CONCAT_STRIPE(cat)  ((cat)->mode & MTD_CONCAT_STRIPED)
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t mtd_concat_map(struct mtd_concat *cat, mtd_addr_t addr, mtd_addr_t *sub_addr,
+                               mtd_addr_t *avail);
+static int mtd_concat_wait_one(struct mtd_concat *cat, uint32_t i, mtd_addr_t *fail_addr);
+static int mtd_concat_read(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, uint8_t *buf);
+static int mtd_concat_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, const uint8_t *buf);
+static int mtd_concat_erase(struct mtd_info *mtd, struct erase_info *instr);
+#if MTD_SUPPORT_NAND
+static int mtd_concat_block_isbad(struct mtd_info *mtd, mtd_addr_t offs);
+static int mtd_concat_block_markbad(struct mtd_info *mtd, mtd_addr_t offs);
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  创建拼接设备
+  * @param  cat 拼接设备 (调用者分配)
+  * @param  subdev 子设备列表
+  * @param  num 子设备数, 2 ~ MTD_CONCAT_MAX_SUBDEV
+  * @param  name 设备名
+  * @param  mode MTD_CONCAT_xxx 组合
+  * @retval 0=成功, 负数=错误码
+  * @note   交错模式下每个子设备只使用最小子设备容量 (按擦除块取整)
+  */
+int mtd_concat_create(struct mtd_concat *cat, struct mtd_info *const *subdev, uint32_t num,
+                      const char *name, uint32_t mode)
+{
+    struct mtd_info *mtd;
+    struct mtd_info *sub;
+    mtd_addr_t min_size;
+    uint64_t total = 0;
+    uint32_t i;
+
+    if (!cat || !subdev || num < 2 || num > MTD_CONCAT_MAX_SUBDEV) {
+        log_e("mtd_concat_create: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    min_size = subdev[0] ? subdev[0]->size : 0;
+    for (i = 0; i < num; i++) {
+        sub = subdev[i];
+        if (!sub || !sub->erasesize || !sub->_read) {
+            log_e("mtd_concat_create: subdev %lu invalid.", (unsigned long)i);
+            return -ERR_INVAL;
+        }
+#if MTD_SUPPORT_PARTITION
+        if (sub->parent) {
+            log_e("mtd_concat_create: %s is a partition.", sub->name);
+            return -ERR_INVAL;
+        }
+#endif
+        if (sub->type != subdev[0]->type || sub->erasesize != subdev[0]->erasesize) {
+            log_e("mtd_concat_create: %s geometry differs.", sub->name);
+            return -ERR_INVAL;
+        }
+        if (sub->size < min_size)
+            min_size = sub->size;
+        total += sub->size;
+    }
+
+    memset(cat, 0, sizeof(*cat));
+    for (i = 0; i < num; i++)
+        cat->subdev[i] = subdev[i];
+    cat->num_subdev = num;
+    cat->mode = mode;
+
+    if (mode & MTD_CONCAT_STRIPED)
+        total = (uint64_t)(min_size - min_size % subdev[0]->erasesize) * num;
+
+    if (total > MTD_ADDR_MAX) {
+        log_e("mtd_concat_create: total size exceeds address range.");
+        return -ERR_INVAL;
+    }
+
+    mtd = &cat->mtd;
+    mtd->name = name ? name : "concat";
+    mtd->type = subdev[0]->type;
+    mtd->flags = subdev[0]->flags;
+    mtd->size = (mtd_addr_t)total;
+    mtd->erasesize = subdev[0]->erasesize;
+    mtd->writesize = subdev[0]->writesize;
+    mtd->writesize_shift = subdev[0]->writesize_shift;
+    for (i = 1; i < num; i++) {
+        mtd->flags &= subdev[i]->flags;
+        if (subdev[i]->writesize > mtd->writesize) {
+            mtd->writesize = subdev[i]->writesize;
+            mtd->writesize_shift = subdev[i]->writesize_shift;
+        }
+    }
+#if MTD_SUPPORT_ECC_STATS
+    mtd->ecc_strength = subdev[0]->ecc_strength;
+    mtd->bitflip_threshold = subdev[0]->bitflip_threshold;
+#endif
+
+    mtd->_read = mtd_concat_read;
+    mtd->_write = mtd_concat_write;
+    mtd->_erase = mtd_concat_erase;
+#if MTD_SUPPORT_NAND
+    mtd->block_isbad = mtd_concat_block_isbad;
+    mtd->block_markbad = mtd_concat_block_markbad;
+#endif
+    mtd->priv = cat;
+
+    return 0;
+}
+
+/**
+  * @brief  等待所有已发起的擦除完成 (MTD_CONCAT_DEFER_ERASE 模式下使用)
+  * @retval 0=成功, 负数=第一个失败擦除的错误码
+  */
+int mtd_concat_wait(struct mtd_concat *cat)
+{
+    uint32_t i;
+    int first = 0;
+    int ret;
+
+    if (!cat)
+        return -ERR_INVAL;
+
+    for (i = 0; i < cat->num_subdev; i++) {
+        ret = mtd_concat_wait_one(cat, i, NULL);
+        if (ret && !first)
+            first = ret;
+    }
+
+    return first;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  拼接地址 -> 子设备与子设备地址
+  * @param  avail 输出从该地址起在同一子设备上连续的字节数
+  * @retval 子设备序号
+  */
+static uint32_t mtd_concat_map(struct mtd_concat *cat, mtd_addr_t addr, mtd_addr_t *sub_addr,
+                               mtd_addr_t *avail)
+{
+    mtd_addr_t es = cat->mtd.erasesize;
+    mtd_addr_t block;
+    uint32_t i;
+
+    if (MTD_CONCAT_STRIPE(cat)) {
+        block = addr / es;
+        *sub_addr = (block / cat->num_subdev) * es + addr % es;
+        *avail = es - addr % es;
+        return (uint32_t)(block % cat->num_subdev);
+    }
+
+    for (i = 0; i < cat->num_subdev - 1U; i++) {
+        if (addr < cat->subdev[i]->size)
+            break;
+        addr -= cat->subdev[i]->size;
+    }
+
+    *sub_addr = addr;
+    *avail = cat->subdev[i]->size - addr;
+
+    return i;
+}
+
+/**
+  * @brief  等待子设备上进行中的擦除
+  * @param  fail_addr 失败时输出拼接设备地址, 可为NULL
+  */
+static int mtd_concat_wait_one(struct mtd_concat *cat, uint32_t i, mtd_addr_t *fail_addr)
+{
+#if MTD_SUPPORT_ERASE_ASYNC
+    struct mtd_info *sub = cat->subdev[i];
+    int ret;
+
+    if (!(cat->pending & (1UL << i)))
+        return 0;
+
+    cat->pending &= ~(1UL << i);
+    ret = sub->_erase_wait(sub);
+    if (ret) {
+        log_e("mtd_concat: erase at 0x%lx on %s failed (%d).",
+              (unsigned long)cat->pending_addr[i], sub->name, ret);
+        if (fail_addr)
+            *fail_addr = cat->pending_addr[i];
+    }
+
+    return ret;
+#else
+    (void)cat;
+    (void)i;
+    (void)fail_addr;
+    return 0;
+#endif
+}
+
+static int mtd_concat_read(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, uint8_t *buf)
+{
+    struct mtd_concat *cat = (struct mtd_concat *)mtd->priv;
+    struct mtd_info *sub;
+    mtd_addr_t sub_addr;
+    mtd_addr_t avail;
+    size_t n;
+    size_t got;
+    uint32_t i;
+    int max_bitflips = 0;
+    int ret;
+
+    *retlen = 0;
+
+    while (len) {
+        i = mtd_concat_map(cat, from, &sub_addr, &avail);
+        sub = cat->subdev[i];
+        n = (len < avail) ? len : (size_t)avail;
+
+        ret = mtd_concat_wait_one(cat, i, NULL);
+        if (ret)
+            return ret;
+
+        got = 0;
+        ret = sub->_read(sub, sub_addr, n, &got, buf);
+        if (ret < 0)
+            return ret;
+        if (ret > max_bitflips)
+            max_bitflips = ret;
+
+        *retlen += got;
+        if (got != n)
+            return -ERR_IO;
+
+        from += n;
+        buf += n;
+        len -= n;
+    }
+
+    return max_bitflips;
+}
+
+static int mtd_concat_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, const uint8_t *buf)
+{
+    struct mtd_concat *cat = (struct mtd_concat *)mtd->priv;
+    struct mtd_info *sub;
+    mtd_addr_t sub_addr;
+    mtd_addr_t avail;
+    size_t n;
+    size_t done;
+    uint32_t i;
+    int ret;
+
+    *retlen = 0;
+
+    while (len) {
+        i = mtd_concat_map(cat, to, &sub_addr, &avail);
+        sub = cat->subdev[i];
+        n = (len < avail) ? len : (size_t)avail;
+
+        if (!sub->_write)
+            return -ERR_NOTSUPP;
+
+        ret = mtd_concat_wait_one(cat, i, NULL);
+        if (ret)
+            return ret;
+
+        done = 0;
+        ret = sub->_write(sub, sub_addr, n, &done, buf);
+        *retlen += done;
+        if (ret < 0)
+            return ret;
+        if (done != n)
+            return -ERR_IO;
+
+        to += n;
+        buf += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  逐块擦除; 支持分段擦除的子设备先各自发起再统一等待
+  */
+static int mtd_concat_erase(struct mtd_info *mtd, struct erase_info *instr)
+{
+    struct mtd_concat *cat = (struct mtd_concat *)mtd->priv;
+    struct erase_info sub_instr;
+    struct mtd_info *sub;
+    mtd_addr_t es = mtd->erasesize;
+    mtd_addr_t addr;
+    mtd_addr_t sub_addr;
+    mtd_addr_t avail;
+    uint32_t i;
+    int ret = 0;
+
+    if ((instr->addr | instr->len) % es)
+        return -ERR_INVAL;
+
+    for (addr = instr->addr; addr < instr->addr + instr->len; addr += es) {
+        i = mtd_concat_map(cat, addr, &sub_addr, &avail);
+        sub = cat->subdev[i];
+
+        /* 同一片上的上一块必须先擦完 */
+        ret = mtd_concat_wait_one(cat, i, &instr->fail_addr);
+        if (ret)
+            break;
+
+#if MTD_SUPPORT_ERASE_ASYNC
+        if (sub->_erase_start && sub->_erase_wait) {
+            ret = sub->_erase_start(sub, sub_addr);
+            if (ret) {
+                instr->fail_addr = addr;
+                break;
+            }
+            cat->pending |= 1UL << i;
+            cat->pending_addr[i] = addr;
+            continue;
+        }
+#endif
+
+        if (!sub->_erase) {
+            ret = -ERR_NOTSUPP;
+            break;
+        }
+
+        sub_instr.addr = sub_addr;
+        sub_instr.len = es;
+        sub_instr.fail_addr = MTD_FAIL_ADDR_UNKNOWN;
+        ret = sub->_erase(sub, &sub_instr);
+        if (ret) {
+            instr->fail_addr = addr;
+            break;
+        }
+    }
+
+    /* 出错时也要等其他片结束, 避免后续操作撞上进行中的擦除 */
+    if (ret || !(cat->mode & MTD_CONCAT_DEFER_ERASE)) {
+        for (i = 0; i < cat->num_subdev; i++) {
+            int err = mtd_concat_wait_one(cat, i, ret ? NULL : &instr->fail_addr);
+            if (err && !ret)
+                ret = err;
+        }
+    }
+
+    return ret;
+}
+
+#if MTD_SUPPORT_NAND
+static int mtd_concat_block_isbad(struct mtd_info *mtd, mtd_addr_t offs)
+{
+    struct mtd_concat *cat = (struct mtd_concat *)mtd->priv;
+    struct mtd_info *sub;
+    mtd_addr_t sub_addr;
+    mtd_addr_t avail;
+    uint32_t i;
+    int ret;
+
+    i = mtd_concat_map(cat, offs, &sub_addr, &avail);
+    sub = cat->subdev[i];
+
+    ret = mtd_concat_wait_one(cat, i, NULL);
+    if (ret)
+        return ret;
+
+    return mtd_block_isbad(sub, sub_addr);
+}
+
+static int mtd_concat_block_markbad(struct mtd_info *mtd, mtd_addr_t offs)
+{
+    struct mtd_concat *cat = (struct mtd_concat *)mtd->priv;
+    struct mtd_info *sub;
+    mtd_addr_t sub_addr;
+    mtd_addr_t avail;
+    uint32_t i;
+    int ret;
+
+    i = mtd_concat_map(cat, offs, &sub_addr, &avail);
+    sub = cat->subdev[i];
+
+    ret = mtd_concat_wait_one(cat, i, NULL);
+    if (ret)
+        return ret;
+
+    return mtd_block_markbad(sub, sub_addr);
+}
+#endif /* MTD_SUPPORT_NAND */
@@ -16,22 +16,104 @@
 #include "mtd.h"
 #include "errno-base.h"
 #include <string.h>
+#if MTD_SUPPORT_PARTITION || MTD_SUPPORT_BBT
+#include "crc32.h"
+#endif
 
 #define  LOG_TAG             "mtd_core"
 #define  LOG_LVL             ELOG_LVL_DEBUG
 #include "elog.h"
 
 /* Private typedef -----------------------------------------------------------*/
+#if MTD_SUPPORT_READ_CACHE
+struct mtd_cache_line {
+    struct mtd_info *master;                    /* NULL=空闲 */
+    mtd_addr_t addr;                            /* 行起始地址 (主设备地址空间) */
+    uint32_t lru;                               /* 最近访问序号 */
+    uint8_t data[MTD_READ_CACHE_LINE_SIZE];
+};
+#endif
+
+#if MTD_SUPPORT_BBT
+/**
+ * @brief 保留块中表的格式 (小端), 表头后紧跟 (nblocks+7)/8 字节位图
+ */
+struct mtd_bbt_hdr {
+    uint32_t magic;                             /* MTD_BBT_MAGIC */
+    uint32_t version;
+    uint32_t nblocks;
+    uint32_t crc;                               /* CRC32(version, nblocks, 位图) */
+};
+#endif
 
 /* Private define ------------------------------------------------------------*/
+#if MTD_SUPPORT_WRITE_BUFFER
+#define MTD_WBUF_MASK           ((mtd_addr_t)MTD_WBUF_SIZE - 1U)
+#endif
+#if MTD_SUPPORT_READ_CACHE
+#define MTD_CACHE_LINE_MASK     ((mtd_addr_t)MTD_READ_CACHE_LINE_SIZE - 1U)
+#endif
 
 /* Private macro -------------------------------------------------------------*/
+#if MTD_SUPPORT_WRITE_BUFFER
+uint32_t HAL_GetTick(void);
+#endif
 
 /* Private variables ---------------------------------------------------------*/
+#if MTD_SUPPORT_PARTITION
+static LIST_HEAD(mtd_part_list);                /* 已注册的分区 */
+#endif
+#if MTD_SUPPORT_READ_CACHE
+static struct mtd_cache_line mtd_cache[MTD_READ_CACHE_LINES];
+static uint32_t mtd_cache_clock;
+#endif
+
+#if MTD_SUPPORT_BBT
+static uint8_t mtd_bbt_page[MTD_BBT_PAGE_SIZE];  /* 读写表的页缓冲, 各设备共用 */
+#endif
 
 /* Exported variables  -------------------------------------------------------*/
 
 /* Private function prototypes -----------------------------------------------*/
+static int mtd_read_master(struct mtd_info *master, mtd_addr_t from, size_t len,
+                           size_t *retlen, uint8_t *buf);
+#if MTD_SUPPORT_WRITE_BUFFER
+static struct mtd_info *mtd_wbuf_master(struct mtd_info *mtd);
+static int mtd_wbuf_flush(struct mtd_info *master);
+static int mtd_wbuf_flush_range(struct mtd_info *master, mtd_addr_t addr, mtd_addr_t len);
+static int mtd_wbuf_write(struct mtd_info *master, mtd_addr_t to, size_t len,
+                          size_t *retlen, const uint8_t *buf);
+#endif
+#if MTD_SUPPORT_IOVEC
+static int mtd_iov_prepare(struct mtd_info *mtd, struct mtd_iovec *vec, uint32_t cnt, int no_overlap);
+static uint32_t mtd_iov_run(const struct mtd_iovec *vec, uint32_t cnt, size_t *len);
+static int mtd_iov_submit(struct mtd_info *master, struct mtd_iovec *batch, uint32_t *nbatch,
+                          size_t *retlen);
+#endif
+#if MTD_SUPPORT_READ_CACHE
+static struct mtd_cache_line *mtd_cache_lookup(struct mtd_info *master, mtd_addr_t addr);
+static struct mtd_cache_line *mtd_cache_fill(struct mtd_info *master, mtd_addr_t addr, int *err);
+static int mtd_cache_read(struct mtd_info *master, mtd_addr_t from, size_t len,
+                          size_t *retlen, uint8_t *buf);
+static void mtd_cache_drop(struct mtd_info *master, mtd_addr_t addr, mtd_addr_t len);
+#if MTD_SUPPORT_IOVEC
+static int mtd_cache_peek(struct mtd_info *master, mtd_addr_t from, size_t len, uint8_t *buf);
+#endif
+#endif
+
+#if MTD_SUPPORT_NAND
+static int mtd_rw_skip_bad(struct mtd_info *mtd, mtd_addr_t *ofs, size_t len, size_t *retlen,
+                           uint8_t *buf, int write);
+#endif
+#if MTD_SUPPORT_BBT
+static int mtd_bbt_isbad(const struct mtd_bbt *bbt, uint32_t blk);
+static int mtd_bbt_check_erase(struct mtd_info *master, struct erase_info *instr);
+static size_t mtd_bbt_len(struct mtd_info *master, uint32_t nblocks);
+static uint32_t mtd_bbt_crc(const struct mtd_bbt_hdr *hdr, const uint8_t *map, size_t maplen);
+static int mtd_bbt_load(struct mtd_info *master, struct mtd_bbt *bbt);
+static int mtd_bbt_scan(struct mtd_info *master, struct mtd_bbt *bbt);
+static int mtd_bbt_write(struct mtd_info *master, struct mtd_bbt *bbt);
+#endif
 
 /* Exported functions --------------------------------------------------------*/
 
@@ -90,12 +172,12 @@ static int mtd_read_oob_std(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oo
     if (master->_read_oob)
         ret = master->_read_oob(master, from, ops);
     else
-        ret = master->_read(master, from, ops->len, &ops->retlen, ops->datbuf);
+        ret = mtd_read_master(master, from, ops->len, &ops->retlen, ops->datbuf);
 #else
     if (mtd->_read_oob)
         ret = mtd->_read_oob(mtd, from, ops);
     else
-        ret = mtd->_read(mtd, from, ops->len, &ops->retlen, ops->datbuf);
+        ret = mtd_read_master(mtd, from, ops->len, &ops->retlen, ops->datbuf);
 #endif
 
     return ret;
@@ -116,11 +198,29 @@ static int mtd_write_oob_std(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob
     struct mtd_info *master = mtd_get_master(mtd);
     to = mtd_get_master_ofs(mtd, to);
     
+#if MTD_SUPPORT_WRITE_BUFFER
+    ret = mtd_wbuf_flush_range(master, to, ops->len);
+    if (ret)
+        return ret;
+#endif
+#if MTD_SUPPORT_READ_CACHE
+    mtd_cache_drop(master, to, ops->len);
+#endif
+
     if (master->_write_oob)
         ret = master->_write_oob(master, to, ops);
     else
         ret = master->_write(master, to, ops->len, &ops->retlen, ops->datbuf);
 #else
+#if MTD_SUPPORT_WRITE_BUFFER
+    ret = mtd_wbuf_flush_range(mtd, to, ops->len);
+    if (ret)
+        return ret;
+#endif
+#if MTD_SUPPORT_READ_CACHE
+    mtd_cache_drop(mtd, to, ops->len);
+#endif
+
     if (mtd->_write_oob)
         ret = mtd->_write_oob(mtd, to, ops);
     else
@@ -200,12 +300,42 @@ int mtd_erase(struct mtd_info *mtd, struct erase_info *instr)
 
 #if MTD_SUPPORT_PARTITION
     adjinstr.addr += mst_ofs;
+#if MTD_SUPPORT_BBT
+    ret = mtd_bbt_check_erase(master, &adjinstr);
+    if (ret) {
+        instr->fail_addr = adjinstr.fail_addr - mst_ofs;
+        return ret;
+    }
+#endif
+#if MTD_SUPPORT_WRITE_BUFFER
+    ret = mtd_wbuf_flush_range(master, adjinstr.addr, adjinstr.len);
+    if (ret)
+        return ret;
+#endif
+#if MTD_SUPPORT_READ_CACHE
+    mtd_cache_drop(master, adjinstr.addr, adjinstr.len);
+#endif
     ret = master->_erase(master, &adjinstr);
     
     if (adjinstr.fail_addr != MTD_FAIL_ADDR_UNKNOWN) {
         instr->fail_addr = adjinstr.fail_addr - mst_ofs;
     }
 #else
+#if MTD_SUPPORT_BBT
+    ret = mtd_bbt_check_erase(mtd, &adjinstr);
+    if (ret) {
+        instr->fail_addr = adjinstr.fail_addr;
+        return ret;
+    }
+#endif
+#if MTD_SUPPORT_WRITE_BUFFER
+    ret = mtd_wbuf_flush_range(mtd, adjinstr.addr, adjinstr.len);
+    if (ret)
+        return ret;
+#endif
+#if MTD_SUPPORT_READ_CACHE
+    mtd_cache_drop(mtd, adjinstr.addr, adjinstr.len);
+#endif
     ret = mtd->_erase(mtd, &adjinstr);
 #endif
 
@@ -247,9 +377,9 @@ int mtd_read(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen,
 #if MTD_SUPPORT_PARTITION
     struct mtd_info *master = mtd_get_master(mtd);
     from = mtd_get_master_ofs(mtd, from);
-    ret = master->_read(master, from, len, retlen, buf);
+    ret = mtd_read_master(master, from, len, retlen, buf);
 #else
-    ret = mtd->_read(mtd, from, len, retlen, buf);
+    ret = mtd_read_master(mtd, from, len, retlen, buf);
 #endif
 #endif
 
@@ -278,6 +408,18 @@ int mtd_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, c
     if (!(mtd->flags & MTD_WRITEABLE))
         return -ERR_ROFS;
 
+#if MTD_SUPPORT_WRITE_BUFFER
+    if (mtd_wbuf_master(mtd)->wbuf) {
+        if (to >= mtd->size || len > mtd->size - to)
+            return -ERR_INVAL;
+#if MTD_SUPPORT_PARTITION
+        return mtd_wbuf_write(mtd_get_master(mtd), mtd_get_master_ofs(mtd, to), len, retlen, buf);
+#else
+        return mtd_wbuf_write(mtd, to, len, retlen, buf);
+#endif
+    }
+#endif
+
 #if MTD_SUPPORT_OOB
     struct mtd_oob_ops ops = {
         .len = len,
@@ -291,8 +433,14 @@ int mtd_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, c
 #if MTD_SUPPORT_PARTITION
     struct mtd_info *master = mtd_get_master(mtd);
     to = mtd_get_master_ofs(mtd, to);
+#if MTD_SUPPORT_READ_CACHE
+    mtd_cache_drop(master, to, len);
+#endif
     ret = master->_write(master, to, len, retlen, buf);
 #else
+#if MTD_SUPPORT_READ_CACHE
+    mtd_cache_drop(mtd, to, len);
+#endif
     ret = mtd->_write(mtd, to, len, retlen, buf);
 #endif
 #endif
@@ -300,106 +448,1744 @@ int mtd_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, c
     return ret;
 }
 
-#if MTD_SUPPORT_OOB
+#if MTD_SUPPORT_WRITE_BUFFER
 /**
-  * @brief  从MTD设备读取数据和OOB
+  * @brief  为设备挂接写合并缓冲
+  * @param  mtd MTD设备信息（分区时挂接到主设备）
+  * @param  wbuf 缓冲存储, NULL表示刷出并解除
+  * @retval 0=成功, 负数=错误码
+  * @note   挂接后 mtd_write() 返回成功只表示数据已进入缓冲,
+  *         mtd_sync() 返回成功后才保证已写入Flash; 掉电丢失未刷出的数据
+  */
+int mtd_wbuf_attach(struct mtd_info *mtd, struct mtd_wbuf *wbuf)
+{
+    int ret;
+
+    if (!mtd) {
+        log_e("mtd_wbuf_attach: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    mtd = mtd_wbuf_master(mtd);
+
+    /* NAND须整页带ECC写入, 不做合并 */
+    if (wbuf && (mtd->type == MTD_NANDFLASH || !mtd->_write))
+        return -ERR_NOTSUPP;
+
+    ret = mtd_wbuf_flush(mtd);
+    if (ret)
+        return ret;
+
+    if (wbuf)
+        wbuf->len = 0;
+    mtd->wbuf = wbuf;
+
+    return 0;
+}
+
+/**
+  * @brief  把写缓冲中的数据写入Flash
   * @param  mtd MTD设备信息
-  * @param  from 起始地址
-  * @param  ops OOB操作参数
-  * @retval 0=成功, 负数=错误码, 正数=最大bit翻转数
+  * @retval 0=成功, 负数=错误码
   */
-int mtd_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops)
+int mtd_sync(struct mtd_info *mtd)
 {
-    if (!mtd || !ops) {
-        log_e("mtd_read_oob: invalid argument.");
+    if (!mtd) {
+        log_e("mtd_sync: invalid argument.");
         return -ERR_INVAL;
     }
 
-#if MTD_SUPPORT_ECC_STATS && MTD_SUPPORT_PARTITION
-    struct mtd_info *master = mtd_get_master(mtd);
-    struct mtd_ecc_stats old_stats = master->ecc_stats;
+    return mtd_wbuf_flush(mtd_wbuf_master(mtd));
+}
+
+/**
+  * @brief  周期调用, 缓冲数据超过 MTD_WBUF_TIMEOUT_MS 未刷出则写入
+  * @param  mtd MTD设备信息
+  * @retval 0=成功, 负数=错误码
+  */
+int mtd_wbuf_poll(struct mtd_info *mtd)
+{
+    struct mtd_wbuf *wbuf;
+
+    if (!mtd)
+        return -ERR_INVAL;
+
+    mtd = mtd_wbuf_master(mtd);
+    wbuf = mtd->wbuf;
+
+    if (!wbuf || !wbuf->len)
+        return 0;
+
+    if ((HAL_GetTick() - wbuf->stamp) < MTD_WBUF_TIMEOUT_MS)
+        return 0;
+
+    return mtd_wbuf_flush(mtd);
+}
+#endif /* MTD_SUPPORT_WRITE_BUFFER */
+
+#if MTD_SUPPORT_READ_CACHE
+/**
+  * @brief  丢弃设备在读缓存中的全部数据
+  * @param  mtd MTD设备信息（分区时作用于整个主设备）
+  * @retval None
+  * @note   绕过MTD层直接修改Flash内容后须调用
+  */
+void mtd_cache_invalidate(struct mtd_info *mtd)
+{
+    if (!mtd)
+        return;
+
+#if MTD_SUPPORT_PARTITION
+    mtd = mtd_get_master(mtd);
 #endif
 
-    int ret_code;
+    mtd_cache_drop(mtd, 0, mtd->size);
+    mtd->cache_next = MTD_ADDR_MAX;
+}
 
-    ops->retlen = ops->oobretlen = 0;
+/**
+  * @brief  读取读缓存统计
+  * @param  mtd MTD设备信息（分区时返回主设备统计）
+  * @param  stats 输出
+  * @retval 0=成功, 负数=错误码
+  */
+int mtd_cache_get_stats(struct mtd_info *mtd, struct mtd_cache_stats *stats)
+{
+    if (!mtd || !stats)
+        return -ERR_INVAL;
 
-    ret_code = mtd_check_oob_ops(mtd, from, ops);
-    if (ret_code)
-        return ret_code;
+#if MTD_SUPPORT_PARTITION
+    mtd = mtd_get_master(mtd);
+#endif
+
+    *stats = mtd->cache_stats;
+    return 0;
+}
+#endif /* MTD_SUPPORT_READ_CACHE */
+
+#if MTD_SUPPORT_POINT
+/**
+  * @brief  获取MTD区域的直接访问指针（零拷贝读）
+  * @param  mtd MTD设备信息
+  * @param  from 起始地址
+  * @param  len 期望长度
+  * @param  retlen 指针后实际连续可访问的长度
+  * @param  virt 返回的只读指针
+  * @retval 0=成功, 负数=错误码
+  * @note   使用完毕须调用 mtd_unpoint() 释放; 释放前不得擦写该设备
+  */
+int mtd_point(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, const void **virt)
+{
+    if (!mtd || !retlen || !virt) {
+        log_e("mtd_point: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    *retlen = 0;
+    *virt = NULL;
+
+    struct mtd_info *master;
+#if MTD_SUPPORT_WRITE_BUFFER
+    int ret;
+#endif
 
 #if MTD_SUPPORT_PARTITION
-    struct mtd_info *master_dev = mtd_get_master(mtd);
-    if (!master_dev->_read_oob && (!master_dev->_read || ops->oobbuf))
-        return -ERR_NOTSUPP;
+    master = mtd_get_master(mtd);
 #else
-    if (!mtd->_read_oob && (!mtd->_read || ops->oobbuf))
+    master = mtd;
+#endif
+
+    if (!master->_point)
         return -ERR_NOTSUPP;
+
+    if (from >= mtd->size || len > mtd->size - from)
+        return -ERR_INVAL;
+
+    if (!len)
+        return 0;
+
+#if MTD_SUPPORT_PARTITION
+    from = mtd_get_master_ofs(mtd, from);
 #endif
 
-#if MTD_SUPPORT_ECC_STATS
-    if (ops->stats)
-        memset(ops->stats, 0, sizeof(*ops->stats));
+    /* 映射直接读介质, 缓冲中未写入的数据须先落盘 */
+#if MTD_SUPPORT_WRITE_BUFFER
+    ret = mtd_wbuf_flush_range(master, from, len);
+    if (ret)
+        return ret;
+#endif
+#if MTD_SUPPORT_READ_CACHE
+    mtd_cache_drop(master, from, len);
 #endif
 
-    ret_code = mtd_read_oob_std(mtd, from, ops);
+    return master->_point(master, from, len, retlen, virt);
+}
 
-#if MTD_SUPPORT_ECC_STATS && MTD_SUPPORT_PARTITION
-    mtd_update_ecc_stats(mtd, master, &old_stats);
+/**
+  * @brief  释放 mtd_point() 获得的指针
+  * @param  mtd MTD设备信息
+  * @param  from 起始地址, 与 mtd_point() 一致
+  * @param  len 长度, 与 mtd_point() 一致
+  * @retval 0=成功, 负数=错误码
+  */
+int mtd_unpoint(struct mtd_info *mtd, mtd_addr_t from, size_t len)
+{
+    if (!mtd) {
+        log_e("mtd_unpoint: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+#if MTD_SUPPORT_PARTITION
+    struct mtd_info *master = mtd_get_master(mtd);
+
+    if (!master->_unpoint)
+        return -ERR_NOTSUPP;
+#else
+    if (!mtd->_unpoint)
+        return -ERR_NOTSUPP;
 #endif
 
-    if (ret_code < 0)
-        return ret_code;
+    if (from >= mtd->size || len > mtd->size - from)
+        return -ERR_INVAL;
 
-#if MTD_SUPPORT_ECC_STATS
-    if (mtd->ecc_strength == 0)
+    if (!len)
         return 0;
 
-    if (ops->stats)
-        ops->stats->max_bitflips = ret_code;
-
-    return ((uint32_t)ret_code >= mtd->bitflip_threshold) ? -ERR_UCLEAN : 0;
+#if MTD_SUPPORT_PARTITION
+    return master->_unpoint(master, mtd_get_master_ofs(mtd, from), len);
 #else
-    return 0;
+    return mtd->_unpoint(mtd, from, len);
 #endif
 }
+#endif /* MTD_SUPPORT_POINT */
 
+#if MTD_SUPPORT_READ_ASYNC
 /**
-  * @brief  向MTD设备写入数据和OOB
+  * @brief  发起一次读, 不等待数据到达
   * @param  mtd MTD设备信息
-  * @param  to 目标地址
-  * @param  ops OOB操作参数
-  * @retval 0=成功, 负数=错误码
+  * @param  from 起始地址
+  * @param  len 长度
+  * @param  buf 数据缓冲, mtd_read_wait() 返回前不得访问
+  * @retval 0=已发起, -ERR_NOTSUPP=驱动不支持（调用者改用 mtd_read()）, 其他负数=错误码
+  * @note   每个主设备同时只能有一次读在途; 在 mtd_read_wait() 之前不得以其他方式访问该设备.
+  *         不经过读缓存, 适合大块顺序读
   */
-int mtd_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops)
+int mtd_read_start(struct mtd_info *mtd, mtd_addr_t from, size_t len, uint8_t *buf)
 {
-    if (!mtd || !ops) {
-        log_e("mtd_write_oob: invalid argument.");
+    if (!mtd || !buf) {
+        log_e("mtd_read_start: invalid argument.");
         return -ERR_INVAL;
     }
 
+    struct mtd_info *master;
     int ret;
 
-    ops->retlen = ops->oobretlen = 0;
+#if MTD_SUPPORT_PARTITION
+    master = mtd_get_master(mtd);
+#else
+    master = mtd;
+#endif
 
-    if (!(mtd->flags & MTD_WRITEABLE))
-        return -ERR_ROFS;
+    if (!master->_read_start || !master->_read_wait)
+        return -ERR_NOTSUPP;
 
-    ret = mtd_check_oob_ops(mtd, to, ops);
+    if (!len || from >= mtd->size || len > mtd->size - from)
+        return -ERR_INVAL;
+
+#if MTD_SUPPORT_PARTITION
+    from = mtd_get_master_ofs(mtd, from);
+#endif
+
+#if MTD_SUPPORT_WRITE_BUFFER
+    ret = mtd_wbuf_flush_range(master, from, len);
     if (ret)
         return ret;
+#endif
+
+    ret = master->_read_start(master, from, len, buf);
+    if (ret)
+        log_e("mtd_read_start: start 0x%08lx+%lu failed (%d).", (unsigned long)from, (unsigned long)len, ret);
+
+    return ret;
+}
+
+/**
+  * @brief  等待 mtd_read_start() 发起的读完成
+  * @param  mtd MTD设备信息, 与 mtd_read_start() 一致
+  * @param  retlen 实际读取的字节数
+  * @retval 0=成功, 负数=错误码
+  */
+int mtd_read_wait(struct mtd_info *mtd, size_t *retlen)
+{
+    if (!mtd || !retlen) {
+        log_e("mtd_read_wait: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    struct mtd_info *master;
 
 #if MTD_SUPPORT_PARTITION
-    struct mtd_info *master = mtd_get_master(mtd);
-    if (!master->_write_oob && (!master->_write || ops->oobbuf))
-        return -ERR_NOTSUPP;
+    master = mtd_get_master(mtd);
 #else
-    if (!mtd->_write_oob && (!mtd->_write || ops->oobbuf))
-        return -ERR_NOTSUPP;
+    master = mtd;
 #endif
 
-    return mtd_write_oob_std(mtd, to, ops);
+    *retlen = 0;
+    if (!master->_read_wait)
+        return -ERR_NOTSUPP;
+
+    return master->_read_wait(master, retlen);
 }
-#endif /* MTD_SUPPORT_OOB */
+#endif /* MTD_SUPPORT_READ_ASYNC */
 
-/* Private functions ---------------------------------------------------------*/
+#if MTD_SUPPORT_IOVEC
+/**
+  * @brief  分散读: 一次调用读取多段
+  * @param  mtd MTD设备信息
+  * @param  vec 段数组, 调用后按 offset 升序重排
+  * @param  cnt 段数
+  * @param  retlen 已读入的总字节数
+  * @retval 0=成功, 负数=错误码; NAND上 -ERR_UCLEAN 表示全部读完但有段翻转过多
+  * @note   参数校验与主设备查找只做一次; 地址和缓冲都相接的段合并为一次读;
+  *         NOR驱动提供 _readv 时, 未命中读缓存的段每 MTD_IOV_BATCH 个一次总线事务
+  */
+int mtd_readv(struct mtd_info *mtd, struct mtd_iovec *vec, uint32_t cnt, size_t *retlen)
+{
+    if (!mtd || !vec || !retlen) {
+        log_e("mtd_readv: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    struct mtd_iovec batch[MTD_IOV_BATCH];
+    struct mtd_info *master;
+    mtd_addr_t mst_ofs;
+    mtd_addr_t addr;
+    uint32_t nbatch = 0;
+    uint32_t i;
+    uint32_t n;
+    size_t len;
+    size_t done;
+    int uclean = 0;
+    int ret;
+
+    *retlen = 0;
+
+    ret = mtd_iov_prepare(mtd, vec, cnt, 0);
+    if (ret)
+        return ret;
+
+#if MTD_SUPPORT_PARTITION
+    master = mtd_get_master(mtd);
+    mst_ofs = mtd_get_master_ofs(mtd, 0);
+#else
+    master = mtd;
+    mst_ofs = 0;
+#endif
+
+    for (i = 0; i < cnt; i += n) {
+        n = mtd_iov_run(&vec[i], cnt - i, &len);
+        if (!len)
+            continue;
+
+        addr = mst_ofs + vec[i].offset;
+
+        /* NAND逐段经 mtd_read(), 保留ECC统计与翻转阈值语义 */
+        if (master->type == MTD_NANDFLASH) {
+            done = 0;
+            ret = mtd_read(mtd, vec[i].offset, len, &done, (uint8_t *)vec[i].buf);
+            *retlen += done;
+            if (ret == -ERR_UCLEAN)
+                uclean = 1;
+            else if (ret)
+                return ret;
+            continue;
+        }
+
+        if (!master->_readv) {
+            done = 0;
+            ret = mtd_read_master(master, addr, len, &done, (uint8_t *)vec[i].buf);
+            *retlen += done;
+            if (ret)
+                return ret;
+            continue;
+        }
+
+#if MTD_SUPPORT_WRITE_BUFFER
+        ret = mtd_wbuf_flush_range(master, addr, len);
+        if (ret)
+            return ret;
+#endif
+#if MTD_SUPPORT_READ_CACHE
+        if (len < MTD_READ_CACHE_LINE_SIZE && mtd_cache_peek(master, addr, len, (uint8_t *)vec[i].buf)) {
+            *retlen += len;
+            continue;
+        }
+        master->cache_stats.bypass++;
+#endif
+
+        batch[nbatch].offset = addr;
+        batch[nbatch].len = len;
+        batch[nbatch].buf = vec[i].buf;
+        if (++nbatch == MTD_IOV_BATCH) {
+            ret = mtd_iov_submit(master, batch, &nbatch, retlen);
+            if (ret)
+                return ret;
+        }
+    }
+
+    if (nbatch) {
+        ret = mtd_iov_submit(master, batch, &nbatch, retlen);
+        if (ret)
+            return ret;
+    }
+
+    return uclean ? -ERR_UCLEAN : 0;
+}
+
+/**
+  * @brief  分散写: 一次调用写入多段
+  * @param  mtd MTD设备信息
+  * @param  vec 段数组, 调用后按 offset 升序重排; 各段不得重叠
+  * @param  cnt 段数
+  * @param  retlen 已写入的总字节数
+  * @retval 0=成功, 负数=错误码
+  * @note   按地址顺序下发, 地址和缓冲都相接的段合并为一次写;
+  *         挂接写缓冲时相邻小段在缓冲内拼成整页
+  */
+int mtd_writev(struct mtd_info *mtd, struct mtd_iovec *vec, uint32_t cnt, size_t *retlen)
+{
+    if (!mtd || !vec || !retlen) {
+        log_e("mtd_writev: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    struct mtd_info *master;
+    mtd_addr_t mst_ofs;
+    mtd_addr_t addr;
+    uint32_t i;
+    uint32_t n;
+    size_t len;
+    size_t done;
+    int ret;
+
+    *retlen = 0;
+
+    if (!(mtd->flags & MTD_WRITEABLE))
+        return -ERR_ROFS;
+
+    ret = mtd_iov_prepare(mtd, vec, cnt, 1);
+    if (ret)
+        return ret;
+
+#if MTD_SUPPORT_PARTITION
+    master = mtd_get_master(mtd);
+    mst_ofs = mtd_get_master_ofs(mtd, 0);
+#else
+    master = mtd;
+    mst_ofs = 0;
+#endif
+
+    if (!master->_write)
+        return -ERR_NOTSUPP;
+
+    for (i = 0; i < cnt; i += n) {
+        n = mtd_iov_run(&vec[i], cnt - i, &len);
+        if (!len)
+            continue;
+
+        addr = mst_ofs + vec[i].offset;
+        done = 0;
+
+#if MTD_SUPPORT_WRITE_BUFFER
+        if (master->wbuf) {
+            ret = mtd_wbuf_write(master, addr, len, &done, (const uint8_t *)vec[i].buf);
+        } else
+#endif
+        if (master->type == MTD_NANDFLASH) {
+            ret = mtd_write(mtd, vec[i].offset, len, &done, (const uint8_t *)vec[i].buf);
+        } else {
+#if MTD_SUPPORT_READ_CACHE
+            mtd_cache_drop(master, addr, len);
+#endif
+            ret = master->_write(master, addr, len, &done, (const uint8_t *)vec[i].buf);
+        }
+
+        *retlen += done;
+        if (ret)
+            return ret;
+    }
+
+    return 0;
+}
+#endif /* MTD_SUPPORT_IOVEC */
+
+#if MTD_SUPPORT_NAND
+/**
+  * @brief  查询擦除块是否为坏块
+  * @param  mtd MTD设备信息
+  * @param  ofs 块内任意地址
+  * @retval 0=好块, 1=坏块, 负数=错误码
+  * @note   挂接坏块表时直接查位图, 坏块表保留区也报告为坏块
+  */
+int mtd_block_isbad(struct mtd_info *mtd, mtd_addr_t ofs)
+{
+    if (!mtd) {
+        log_e("mtd_block_isbad: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    struct mtd_info *master;
+
+    if (!mtd->erasesize || ofs >= mtd->size)
+        return -ERR_INVAL;
+
+#if MTD_SUPPORT_PARTITION
+    master = mtd_get_master(mtd);
+    ofs = mtd_get_master_ofs(mtd, ofs);
+#else
+    master = mtd;
+#endif
+
+#if MTD_SUPPORT_BBT
+    if (master->bbt)
+        return mtd_bbt_isbad(master->bbt, (uint32_t)(ofs / master->erasesize));
+#endif
+
+    if (!master->block_isbad)
+        return 0;
+
+    return master->block_isbad(master, ofs);
+}
+
+/**
+  * @brief  把擦除块标记为坏块
+  * @param  mtd MTD设备信息
+  * @param  ofs 块内任意地址
+  * @retval 0=成功, 负数=错误码
+  * @note   挂接坏块表时先更新位图并写出新版本表, 驱动的坏块标记尽力写入
+  */
+int mtd_block_markbad(struct mtd_info *mtd, mtd_addr_t ofs)
+{
+    if (!mtd) {
+        log_e("mtd_block_markbad: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    struct mtd_info *master;
+    int ret;
+
+    if (!mtd->erasesize || ofs >= mtd->size)
+        return -ERR_INVAL;
+
+    if (!(mtd->flags & MTD_WRITEABLE))
+        return -ERR_ROFS;
+
+#if MTD_SUPPORT_PARTITION
+    master = mtd_get_master(mtd);
+    ofs = mtd_get_master_ofs(mtd, ofs);
+#else
+    master = mtd;
+#endif
+    ofs -= ofs % master->erasesize;
+
+#if MTD_SUPPORT_BBT
+    struct mtd_bbt *bbt = master->bbt;
+    uint32_t blk = (uint32_t)(ofs / master->erasesize);
+
+    if (bbt) {
+        if (mtd_bbt_isbad(bbt, blk))
+            return 0;
+
+        bbt->map[blk / 8] |= (uint8_t)(1U << (blk % 8));
+#if MTD_SUPPORT_ECC_STATS
+        master->ecc_stats.badblocks++;
+#endif
+        if (master->block_markbad)
+            (void)master->block_markbad(master, ofs);
+
+        return mtd_bbt_write(master, bbt);
+    }
+#endif
+
+    if (!master->block_markbad)
+        return -ERR_NOTSUPP;
+
+    ret = master->block_markbad(master, ofs);
+#if MTD_SUPPORT_ECC_STATS
+    if (ret == 0)
+        master->ecc_stats.badblocks++;
+#endif
+
+    return ret;
+}
+
+/**
+  * @brief  跳过坏块顺序读, 用于流式读出原始镜像
+  * @param  mtd MTD设备信息
+  * @param  ofs 起始地址, 返回时推进到下一次读的位置 (已越过途经的坏块)
+  * @param  len 读取长度
+  * @param  retlen 实际读取长度
+  * @param  buf 数据缓冲区
+  * @retval 0=成功, -ERR_NOSPC=到达设备末尾, -ERR_UCLEAN=读完但有块翻转过多, 其他负数=错误码
+  */
+int mtd_read_skip_bad(struct mtd_info *mtd, mtd_addr_t *ofs, size_t len, size_t *retlen, uint8_t *buf)
+{
+    return mtd_rw_skip_bad(mtd, ofs, len, retlen, buf, 0);
+}
+
+/**
+  * @brief  跳过坏块顺序写, 用于流式烧写原始镜像
+  * @param  mtd MTD设备信息
+  * @param  ofs 起始地址, 返回时推进到下一次写的位置 (已越过途经的坏块)
+  * @param  len 写入长度, NAND须为页大小的整数倍
+  * @param  retlen 实际写入长度
+  * @param  buf 数据缓冲区
+  * @retval 0=成功, -ERR_NOSPC=到达设备末尾, 其他负数=错误码
+  * @note   不擦除, 调用者须事先擦除目标区域的好块
+  */
+int mtd_write_skip_bad(struct mtd_info *mtd, mtd_addr_t *ofs, size_t len, size_t *retlen,
+                       const uint8_t *buf)
+{
+    return mtd_rw_skip_bad(mtd, ofs, len, retlen, (uint8_t *)buf, 1);
+}
+#endif /* MTD_SUPPORT_NAND */
+
+#if MTD_SUPPORT_BBT
+/**
+  * @brief  为设备挂接坏块表
+  * @param  mtd MTD设备信息（分区时挂接到主设备）
+  * @param  bbt 坏块表存储, NULL表示解除
+  * @retval 0=成功, 负数=错误码
+  * @note   从保留区加载版本最新且校验正确的表; 一份都没有时逐块调用驱动
+  *         block_isbad() 扫描一次并写出. 保留区不应划入分区使用
+  */
+int mtd_bbt_attach(struct mtd_info *mtd, struct mtd_bbt *bbt)
+{
+    if (!mtd) {
+        log_e("mtd_bbt_attach: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    struct mtd_info *master;
+    uint32_t nblocks;
+    uint32_t i;
+    int ret;
+
+#if MTD_SUPPORT_PARTITION
+    master = mtd_get_master(mtd);
+#else
+    master = mtd;
+#endif
+
+    master->bbt = NULL;
+    if (!bbt)
+        return 0;
+
+    if (!master->erasesize || !master->_erase || !master->_write)
+        return -ERR_NOTSUPP;
+
+    nblocks = (uint32_t)(master->size / master->erasesize);
+    if (nblocks > MTD_BBT_MAX_BLOCKS || nblocks <= MTD_BBT_RESERVED_BLOCKS ||
+        mtd_bbt_len(master, nblocks) > MTD_BBT_PAGE_SIZE) {
+        log_e("mtd_bbt_attach: %s geometry not supported.", master->name);
+        return -ERR_NOTSUPP;
+    }
+
+    memset(bbt, 0, sizeof(*bbt));
+    bbt->nblocks = nblocks;
+    bbt->rsv_start = nblocks - MTD_BBT_RESERVED_BLOCKS;
+    bbt->cur = 0xFF;
+
+    ret = mtd_bbt_load(master, bbt);
+    if (ret == -ERR_NOENT) {
+        log_i("%s: no bad block table, scanning.", master->name);
+        ret = mtd_bbt_scan(master, bbt);
+        if (ret == 0)
+            ret = mtd_bbt_write(master, bbt);
+    }
+    if (ret)
+        return ret;
+
+    master->bbt = bbt;
+
+#if MTD_SUPPORT_ECC_STATS
+    master->ecc_stats.badblocks = 0;
+    for (i = 0; i < bbt->rsv_start; i++)
+        master->ecc_stats.badblocks += (uint32_t)mtd_bbt_isbad(bbt, i);
+    master->ecc_stats.bbtblocks = MTD_BBT_RESERVED_BLOCKS;
+#else
+    (void)i;
+#endif
+
+    return 0;
+}
+#endif /* MTD_SUPPORT_BBT */
+
+#if MTD_SUPPORT_OOB
+/**
+  * @brief  从MTD设备读取数据和OOB
+  * @param  mtd MTD设备信息
+  * @param  from 起始地址
+  * @param  ops OOB操作参数
+  * @retval 0=成功, 负数=错误码, 正数=最大bit翻转数
+  */
+int mtd_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops)
+{
+    if (!mtd || !ops) {
+        log_e("mtd_read_oob: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+#if MTD_SUPPORT_ECC_STATS && MTD_SUPPORT_PARTITION
+    struct mtd_info *master = mtd_get_master(mtd);
+    struct mtd_ecc_stats old_stats = master->ecc_stats;
+#endif
+
+    int ret_code;
+
+    ops->retlen = ops->oobretlen = 0;
+
+    ret_code = mtd_check_oob_ops(mtd, from, ops);
+    if (ret_code)
+        return ret_code;
+
+#if MTD_SUPPORT_PARTITION
+    struct mtd_info *master_dev = mtd_get_master(mtd);
+    if (!master_dev->_read_oob && (!master_dev->_read || ops->oobbuf))
+        return -ERR_NOTSUPP;
+#else
+    if (!mtd->_read_oob && (!mtd->_read || ops->oobbuf))
+        return -ERR_NOTSUPP;
+#endif
+
+#if MTD_SUPPORT_ECC_STATS
+    if (ops->stats)
+        memset(ops->stats, 0, sizeof(*ops->stats));
+#endif
+
+    ret_code = mtd_read_oob_std(mtd, from, ops);
+
+#if MTD_SUPPORT_ECC_STATS && MTD_SUPPORT_PARTITION
+    mtd_update_ecc_stats(mtd, master, &old_stats);
+#endif
+
+    if (ret_code < 0)
+        return ret_code;
+
+#if MTD_SUPPORT_ECC_STATS
+    if (mtd->ecc_strength == 0)
+        return 0;
+
+    if (ops->stats)
+        ops->stats->max_bitflips = ret_code;
+
+    return ((uint32_t)ret_code >= mtd->bitflip_threshold) ? -ERR_UCLEAN : 0;
+#else
+    return 0;
+#endif
+}
+
+/**
+  * @brief  向MTD设备写入数据和OOB
+  * @param  mtd MTD设备信息
+  * @param  to 目标地址
+  * @param  ops OOB操作参数
+  * @retval 0=成功, 负数=错误码
+  */
+int mtd_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops)
+{
+    if (!mtd || !ops) {
+        log_e("mtd_write_oob: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    int ret;
+
+    ops->retlen = ops->oobretlen = 0;
+
+    if (!(mtd->flags & MTD_WRITEABLE))
+        return -ERR_ROFS;
+
+    ret = mtd_check_oob_ops(mtd, to, ops);
+    if (ret)
+        return ret;
+
+#if MTD_SUPPORT_PARTITION
+    struct mtd_info *master = mtd_get_master(mtd);
+    if (!master->_write_oob && (!master->_write || ops->oobbuf))
+        return -ERR_NOTSUPP;
+#else
+    if (!mtd->_write_oob && (!mtd->_write || ops->oobbuf))
+        return -ERR_NOTSUPP;
+#endif
+
+    return mtd_write_oob_std(mtd, to, ops);
+}
+#endif /* MTD_SUPPORT_OOB */
+
+#if MTD_SUPPORT_ERASE_REGIONS
+/**
+  * @brief  [ofs, ofs+len) 内每处都能单独擦除的最小块
+  * @param  mtd MTD设备, 可以是分区
+  * @param  ofs 设备内偏移
+  * @param  len 长度, 0按1字节处理
+  * @retval 范围所及各擦除区域中最大的区域擦除块; 主设备无区域描述时为 mtd->erasesize
+  */
+uint32_t mtd_get_erasesize(struct mtd_info *mtd, mtd_addr_t ofs, mtd_addr_t len)
+{
+    const struct mtd_erase_region_info *r;
+    struct mtd_info *master;
+    mtd_addr_t end;
+    uint32_t es = 0;
+    uint32_t i;
+
+    if (!mtd)
+        return 0;
+
+#if MTD_SUPPORT_PARTITION
+    master = mtd_get_master(mtd);
+    ofs = mtd_get_master_ofs(mtd, ofs);
+#else
+    master = mtd;
+#endif
+
+    if (!master->numeraseregions || !master->eraseregions || ofs >= master->size)
+        return mtd->erasesize;
+
+    if (!len)
+        len = 1;
+    end = (len > master->size - ofs) ? master->size : ofs + len;
+
+    for (i = 0; i < master->numeraseregions; i++) {
+        r = &master->eraseregions[i];
+        if (r->offset >= end || r->offset + (mtd_addr_t)r->erasesize * r->numblocks <= ofs)
+            continue;
+        if (r->erasesize > es)
+            es = r->erasesize;
+    }
+
+    return es ? es : mtd->erasesize;
+}
+#endif
+
+#if MTD_SUPPORT_PARTITION
+/**
+  * @brief  注册一组分区
+  * @param  parent 父设备, 可以是主设备或分区
+  * @param  parts 分区描述, 按地址递增排列
+  * @param  slots 分区设备存储 (调用者分配, nr个), 注销前须保持有效
+  * @param  nr 分区数
+  * @retval 0=成功, 负数=错误码
+  * @note   注册时计算每个分区在主设备中的绝对偏移, 读写擦除不再逐级查找父设备;
+  *         未按擦除块对齐的分区按只读注册; 主设备有擦除区域时, 分区的擦除块取其
+  *         覆盖范围内最大的区域擦除块, 只落在小扇区区域的分区可按小块擦除
+  */
+int mtd_add_partitions(struct mtd_info *parent, const struct mtd_partition *parts,
+                       struct mtd_info *slots, uint32_t nr)
+{
+    const struct mtd_partition *p;
+    struct mtd_info *part;
+    mtd_addr_t offset;
+    mtd_addr_t size;
+    mtd_addr_t cur = 0;
+    uint32_t i;
+
+    if (!parent || !parts || !slots || !nr) {
+        log_e("mtd_add_partitions: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    /* 先全部检查并填好, 再统一挂入链表, 失败时不留下半组分区 */
+    for (i = 0; i < nr; i++) {
+        p = &parts[i];
+        part = &slots[i];
+
+        offset = (p->offset == MTDPART_OFS_APPEND) ? cur : p->offset;
+        if (offset >= parent->size) {
+            log_e("mtd_add_partitions: %s offset 0x%lx out of range.", p->name, (unsigned long)offset);
+            return -ERR_INVAL;
+        }
+
+        size = (p->size == MTDPART_SIZ_FULL) ? parent->size - offset : p->size;
+        if (size > parent->size - offset) {
+            log_e("mtd_add_partitions: %s size 0x%lx out of range.", p->name, (unsigned long)size);
+            return -ERR_INVAL;
+        }
+
+        memset(part, 0, sizeof(*part));
+        part->name = p->name;
+        part->type = parent->type;
+        part->flags = parent->flags & ~p->mask_flags;
+        part->size = size;
+#if MTD_SUPPORT_ERASE_REGIONS
+        part->erasesize = mtd_get_erasesize(parent, offset, size);
+#else
+        part->erasesize = parent->erasesize;
+#endif
+        part->writesize = parent->writesize;
+        part->writesize_shift = parent->writesize_shift;
+#if MTD_SUPPORT_OOB
+        part->oobsize = parent->oobsize;
+        part->oobavail = parent->oobavail;
+#endif
+#if MTD_SUPPORT_ECC_STATS
+        part->ecc_strength = parent->ecc_strength;
+        part->bitflip_threshold = parent->bitflip_threshold;
+#endif
+        part->parent = parent;
+        part->part.offset = offset;
+        part->part.size = size;
+        part->part.flags = part->flags;
+        part->part.master = mtd_get_master(parent);
+        part->part.master_ofs = mtd_get_master_ofs(parent, offset);
+        list_node_init(&part->part.node);
+
+        if (part->erasesize && ((part->part.master_ofs | size) % part->erasesize)) {
+            log_w("mtd_add_partitions: %s not erase-block aligned, read-only.", p->name);
+            part->flags &= ~MTD_WRITEABLE;
+        }
+
+        cur = offset + size;
+    }
+
+    for (i = 0; i < nr; i++)
+        list_add_tail(&slots[i].part.node, &mtd_part_list);
+
+    return 0;
+}
+
+/**
+  * @brief  注销分区
+  * @param  mtd mtd_add_partitions() 注册的分区
+  * @retval 0=成功, -ERR_BUSY=仍有子分区, 其他负数=错误码
+  */
+int mtd_del_partition(struct mtd_info *mtd)
+{
+    list_t *pos;
+
+    if (!mtd || !mtd->parent || !mtd->part.master)
+        return -ERR_INVAL;
+
+    list_for_each(pos, &mtd_part_list) {
+        if (list_entry(pos, struct mtd_info, part.node)->parent == mtd)
+            return -ERR_BUSY;
+    }
+
+    list_del(&mtd->part.node);
+    mtd->part.master = NULL;
+    mtd->parent = NULL;
+
+    return 0;
+}
+
+/**
+  * @brief  从Flash读取并校验分区表
+  * @param  mtd 存放分区表的设备
+  * @param  from 分区表地址
+  * @param  ents 表项缓冲 (max个), 同时是解析结果中名字的存储
+  * @param  parts 输出分区描述 (max个), 可直接传给 mtd_add_partitions()
+  * @param  max 缓冲可容纳的表项数
+  * @retval 正数=分区数, 负数=错误码
+  */
+int mtd_parse_partitions(struct mtd_info *mtd, mtd_addr_t from, struct mtd_part_tbl_entry *ents,
+                         struct mtd_partition *parts, uint32_t max)
+{
+    struct mtd_part_tbl_hdr hdr;
+    size_t retlen = 0;
+    size_t len;
+    uint32_t i;
+    int ret;
+
+    if (!mtd || !ents || !parts || !max) {
+        log_e("mtd_parse_partitions: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    ret = mtd_read(mtd, from, sizeof(hdr), &retlen, (uint8_t *)&hdr);
+    if (ret < 0)
+        return ret;
+    if (retlen != sizeof(hdr))
+        return -ERR_IO;
+
+    if (hdr.magic != MTD_PART_TABLE_MAGIC)
+        return -ERR_INVAL;
+
+    if (!hdr.count || hdr.count > max) {
+        log_e("mtd_parse_partitions: %lu entries, room for %lu.",
+              (unsigned long)hdr.count, (unsigned long)max);
+        return -ERR_INVAL;
+    }
+
+    len = (size_t)hdr.count * sizeof(*ents);
+    ret = mtd_read(mtd, from + sizeof(hdr), len, &retlen, (uint8_t *)ents);
+    if (ret < 0)
+        return ret;
+    if (retlen != len)
+        return -ERR_IO;
+
+    if (crc32(0, ents, len) != hdr.crc) {
+        log_e("mtd_parse_partitions: table crc mismatch.");
+        return -ERR_INVAL;
+    }
+
+    for (i = 0; i < hdr.count; i++) {
+        ents[i].name[MTD_PART_NAME_MAX - 1] = '\0';
+        parts[i].name = ents[i].name;
+        parts[i].offset = ents[i].offset;
+        parts[i].size = ents[i].size;
+        parts[i].mask_flags = ents[i].mask_flags;
+    }
+
+    return (int)hdr.count;
+}
+
+/**
+  * @brief  按名字查找已注册的分区
+  * @retval 分区设备, 未找到返回NULL
+  */
+struct mtd_info *mtd_get_partition(const char *name)
+{
+    struct mtd_info *mtd;
+    list_t *pos;
+
+    if (!name)
+        return NULL;
+
+    list_for_each(pos, &mtd_part_list) {
+        mtd = list_entry(pos, struct mtd_info, part.node);
+        if (mtd->name && !strcmp(mtd->name, name))
+            return mtd;
+    }
+
+    return NULL;
+}
+
+/**
+  * @brief  遍历已注册的分区 (按注册顺序)
+  * @param  prev 上一个分区, NULL=从头开始
+  * @retval 下一个分区, 结束返回NULL
+  */
+struct mtd_info *mtd_next_partition(struct mtd_info *prev)
+{
+    list_t *next = prev ? prev->part.node.next : mtd_part_list.next;
+
+    if (next == &mtd_part_list)
+        return NULL;
+
+    return list_entry(next, struct mtd_info, part.node);
+}
+#endif /* MTD_SUPPORT_PARTITION */
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+  * @brief  主设备读, 小块读经由读缓存
+  * @param  master 主设备
+  * @param  from 主设备地址
+  * @param  len 读取长度
+  * @param  retlen 实际读取长度
+  * @param  buf 数据缓冲区
+  * @retval 0=成功, 负数=错误码
+  */
+static int mtd_read_master(struct mtd_info *master, mtd_addr_t from, size_t len,
+                           size_t *retlen, uint8_t *buf)
+{
+#if MTD_SUPPORT_WRITE_BUFFER
+    int ret;
+
+    /* 读到尚未刷出的数据前先写入Flash */
+    ret = mtd_wbuf_flush_range(master, from, len);
+    if (ret)
+        return ret;
+#endif
+
+#if MTD_SUPPORT_READ_CACHE
+    /* NAND读带ECC/坏块语义, 不做缓存 */
+    if (master->type != MTD_NANDFLASH) {
+        if (len < MTD_READ_CACHE_LINE_SIZE)
+            return mtd_cache_read(master, from, len, retlen, buf);
+
+        master->cache_stats.bypass++;
+        master->cache_next = from + len;
+    }
+#endif
+
+    return master->_read(master, from, len, retlen, buf);
+}
+
+#if MTD_SUPPORT_NAND
+/**
+  * @brief  跳过坏块的顺序读写, 每进入一个新块查询一次坏块
+  * @param  write 0=读, 1=写
+  * @retval 同 mtd_read_skip_bad() / mtd_write_skip_bad()
+  */
+static int mtd_rw_skip_bad(struct mtd_info *mtd, mtd_addr_t *ofs, size_t len, size_t *retlen,
+                           uint8_t *buf, int write)
+{
+    mtd_addr_t pos;
+    size_t done = 0;
+    size_t rl;
+    size_t n;
+    int uclean = 0;
+    int ret = 0;
+
+    if (!mtd || !ofs || !retlen || !buf) {
+        log_e("mtd_rw_skip_bad: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    *retlen = 0;
+    if (!mtd->erasesize)
+        return -ERR_NOTSUPP;
+
+    pos = *ofs;
+    while (done < len) {
+        if (pos >= mtd->size) {
+            ret = -ERR_NOSPC;
+            break;
+        }
+
+        if (done == 0 || pos % mtd->erasesize == 0) {
+            ret = mtd_block_isbad(mtd, pos);
+            if (ret < 0)
+                break;
+            if (ret) {
+                pos += mtd->erasesize - pos % mtd->erasesize;
+                ret = 0;
+                continue;
+            }
+        }
+
+        n = mtd->erasesize - pos % mtd->erasesize;
+        if (n > len - done)
+            n = len - done;
+
+        rl = 0;
+        if (write) {
+            ret = mtd_write(mtd, pos, n, &rl, buf + done);
+        } else {
+            ret = mtd_read(mtd, pos, n, &rl, buf + done);
+            if (ret == -ERR_UCLEAN) {
+                uclean = 1;
+                ret = 0;
+            }
+        }
+        if (ret)
+            break;
+
+        pos += n;
+        done += n;
+    }
+
+    *ofs = pos;
+    *retlen = done;
+
+    if (ret)
+        return ret;
+    return uclean ? -ERR_UCLEAN : 0;
+}
+#endif /* MTD_SUPPORT_NAND */
+
+#if MTD_SUPPORT_BBT
+/**
+  * @brief  查表, 保留区视为坏块
+  */
+static int mtd_bbt_isbad(const struct mtd_bbt *bbt, uint32_t blk)
+{
+    if (blk >= bbt->rsv_start)
+        return 1;
+
+    return (bbt->map[blk / 8] >> (blk % 8)) & 1U;
+}
+
+/**
+  * @brief  挂接坏块表时拒绝擦除坏块
+  * @param  master 主设备
+  * @param  instr 擦除信息 (主设备地址空间)
+  * @retval 0=范围内无坏块, -ERR_IO=有坏块 (fail_addr为其起始地址)
+  */
+static int mtd_bbt_check_erase(struct mtd_info *master, struct erase_info *instr)
+{
+    struct mtd_bbt *bbt = master->bbt;
+    uint32_t blk;
+    uint32_t last;
+
+    if (!bbt || !instr->len)
+        return 0;
+
+    last = (uint32_t)((instr->addr + instr->len - 1U) / master->erasesize);
+    for (blk = (uint32_t)(instr->addr / master->erasesize); blk <= last; blk++) {
+        if (blk < bbt->rsv_start && mtd_bbt_isbad(bbt, blk)) {
+            log_w("%s: refusing to erase bad block %lu.", master->name, (unsigned long)blk);
+            instr->fail_addr = (mtd_addr_t)blk * master->erasesize;
+            return -ERR_IO;
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  表在Flash中的写入长度: 表头+位图, 向上对齐到页
+  */
+static size_t mtd_bbt_len(struct mtd_info *master, uint32_t nblocks)
+{
+    size_t len = sizeof(struct mtd_bbt_hdr) + (nblocks + 7U) / 8U;
+    size_t ws = master->writesize ? master->writesize : 1U;
+
+    return (len + ws - 1U) / ws * ws;
+}
+
+static uint32_t mtd_bbt_crc(const struct mtd_bbt_hdr *hdr, const uint8_t *map, size_t maplen)
+{
+    uint32_t crc;
+
+    crc = crc32(0, &hdr->version, sizeof(hdr->version));
+    crc = crc32(crc, &hdr->nblocks, sizeof(hdr->nblocks));
+
+    return crc32(crc, map, maplen);
+}
+
+/**
+  * @brief  在保留区中找版本最新且校验正确的表
+  * @retval 0=成功, -ERR_NOENT=没有可用的表
+  */
+static int mtd_bbt_load(struct mtd_info *master, struct mtd_bbt *bbt)
+{
+    struct mtd_bbt_hdr hdr;
+    size_t maplen = (bbt->nblocks + 7U) / 8U;
+    size_t retlen;
+    mtd_addr_t addr;
+    uint32_t i;
+    int ret;
+
+    for (i = 0; i < MTD_BBT_RESERVED_BLOCKS; i++) {
+        addr = (mtd_addr_t)(bbt->rsv_start + i) * master->erasesize;
+        ret = mtd_read(master, addr, sizeof(hdr) + maplen, &retlen, mtd_bbt_page);
+        if (ret && ret != -ERR_UCLEAN)
+            continue;
+
+        memcpy(&hdr, mtd_bbt_page, sizeof(hdr));
+        if (hdr.magic != MTD_BBT_MAGIC || hdr.nblocks != bbt->nblocks)
+            continue;
+        if (bbt->cur != 0xFF && hdr.version <= bbt->version)
+            continue;
+        if (mtd_bbt_crc(&hdr, mtd_bbt_page + sizeof(hdr), maplen) != hdr.crc)
+            continue;
+
+        memcpy(bbt->map, mtd_bbt_page + sizeof(hdr), maplen);
+        bbt->version = hdr.version;
+        bbt->cur = (uint8_t)i;
+    }
+
+    return (bbt->cur == 0xFF) ? -ERR_NOENT : 0;
+}
+
+/**
+  * @brief  逐块查询驱动的坏块标记, 只在首次挂接时执行
+  */
+static int mtd_bbt_scan(struct mtd_info *master, struct mtd_bbt *bbt)
+{
+    uint32_t blk;
+    int ret;
+
+    if (!master->block_isbad)
+        return 0;
+
+    for (blk = 0; blk < bbt->nblocks; blk++) {
+        ret = master->block_isbad(master, (mtd_addr_t)blk * master->erasesize);
+        if (ret < 0)
+            return ret;
+        if (ret)
+            bbt->map[blk / 8] |= (uint8_t)(1U << (blk % 8));
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  写出新版本表: 轮换到下一个保留块, 旧版本保留作掉电回退
+  * @retval 0=成功, -ERR_IO=保留块全部失效
+  * @note   写失败的保留块在位图中记为坏块并换下一块
+  */
+static int mtd_bbt_write(struct mtd_info *master, struct mtd_bbt *bbt)
+{
+    struct mtd_bbt_hdr hdr;
+    struct erase_info ei;
+    size_t maplen = (bbt->nblocks + 7U) / 8U;
+    size_t len = mtd_bbt_len(master, bbt->nblocks);
+    size_t retlen;
+    uint32_t start;
+    uint32_t blk;
+    uint32_t i;
+    uint32_t n;
+    int ret;
+
+    start = (bbt->cur == 0xFF) ? 0U : bbt->cur + 1U;
+
+    for (n = 0; n < MTD_BBT_RESERVED_BLOCKS; n++) {
+        i = (start + n) % MTD_BBT_RESERVED_BLOCKS;
+        blk = bbt->rsv_start + i;
+        if ((bbt->map[blk / 8] >> (blk % 8)) & 1U)
+            continue;
+
+        hdr.magic = MTD_BBT_MAGIC;
+        hdr.version = bbt->version + 1U;
+        hdr.nblocks = bbt->nblocks;
+        hdr.crc = mtd_bbt_crc(&hdr, bbt->map, maplen);
+        memset(mtd_bbt_page, 0xFF, len);
+        memcpy(mtd_bbt_page, &hdr, sizeof(hdr));
+        memcpy(mtd_bbt_page + sizeof(hdr), bbt->map, maplen);
+
+        ei.addr = (mtd_addr_t)blk * master->erasesize;
+        ei.len = master->erasesize;
+        ret = mtd_erase(master, &ei);
+        if (ret == 0)
+            ret = mtd_write(master, ei.addr, len, &retlen, mtd_bbt_page);
+#if MTD_SUPPORT_WRITE_BUFFER
+        if (ret == 0)
+            ret = mtd_sync(master);
+#endif
+        if (ret == 0) {
+            bbt->version = hdr.version;
+            bbt->cur = (uint8_t)i;
+            return 0;
+        }
+
+        log_w("%s: bbt block %lu failed (%d), retiring it.", master->name, (unsigned long)blk, ret);
+        bbt->map[blk / 8] |= (uint8_t)(1U << (blk % 8));
+        if (master->block_markbad)
+            (void)master->block_markbad(master, ei.addr);
+    }
+
+    log_e("%s: no usable bbt block left.", master->name);
+    return -ERR_IO;
+}
+#endif /* MTD_SUPPORT_BBT */
+
+#if MTD_SUPPORT_IOVEC
+/**
+  * @brief  校验各段并按 offset 升序原地排序 (插入排序, 段数通常很少)
+  * @param  mtd MTD设备信息
+  * @param  vec 段数组
+  * @param  cnt 段数
+  * @param  no_overlap 非0时拒绝相互重叠的段
+  * @retval 0=成功, 负数=错误码
+  */
+static int mtd_iov_prepare(struct mtd_info *mtd, struct mtd_iovec *vec, uint32_t cnt, int no_overlap)
+{
+    struct mtd_iovec tmp;
+    mtd_addr_t end;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0; i < cnt; i++) {
+        if (vec[i].offset >= mtd->size || vec[i].len > mtd->size - vec[i].offset)
+            return -ERR_INVAL;
+        if (vec[i].len && !vec[i].buf)
+            return -ERR_INVAL;
+
+        tmp = vec[i];
+        for (j = i; j > 0 && vec[j - 1].offset > tmp.offset; j--)
+            vec[j] = vec[j - 1];
+        vec[j] = tmp;
+    }
+
+    if (no_overlap) {
+        for (i = 0, end = 0; i < cnt; i++) {
+            if (!vec[i].len)
+                continue;
+            if (vec[i].offset < end)
+                return -ERR_INVAL;
+            end = vec[i].offset + vec[i].len;
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  从 vec[0] 起取一段可合并的连续区: 地址与缓冲都首尾相接
+  * @param  vec 已排序的段
+  * @param  cnt 剩余段数
+  * @param  len 合并后的长度
+  * @retval 合并的段数 (至少1)
+  */
+static uint32_t mtd_iov_run(const struct mtd_iovec *vec, uint32_t cnt, size_t *len)
+{
+    uint32_t n = 1;
+
+    *len = vec[0].len;
+    while (n < cnt && vec[n].offset == vec[0].offset + *len &&
+           (uint8_t *)vec[n].buf == (uint8_t *)vec[0].buf + *len) {
+        *len += vec[n].len;
+        n++;
+    }
+
+    return n;
+}
+
+/**
+  * @brief  把攒下的段交给驱动一次读出
+  * @param  master 主设备
+  * @param  batch 主设备地址空间的段
+  * @param  nbatch 段数, 成功后清0
+  * @param  retlen 累加读入字节数
+  * @retval 0=成功, 负数=错误码
+  */
+static int mtd_iov_submit(struct mtd_info *master, struct mtd_iovec *batch, uint32_t *nbatch,
+                          size_t *retlen)
+{
+    uint32_t i;
+    int ret;
+
+    ret = master->_readv(master, batch, *nbatch);
+    if (ret)
+        return ret;
+
+    for (i = 0; i < *nbatch; i++)
+        *retlen += batch[i].len;
+    *nbatch = 0;
+
+    return 0;
+}
+#endif /* MTD_SUPPORT_IOVEC */
+
+#if MTD_SUPPORT_READ_CACHE
+/**
+  * @brief  查找缓存行
+  * @param  master 主设备
+  * @param  addr 行起始地址
+  * @retval 缓存行, 未命中返回NULL
+  */
+static struct mtd_cache_line *mtd_cache_lookup(struct mtd_info *master, mtd_addr_t addr)
+{
+    uint32_t i;
+
+    for (i = 0; i < MTD_READ_CACHE_LINES; i++) {
+        if (mtd_cache[i].master == master && mtd_cache[i].addr == addr)
+            return &mtd_cache[i];
+    }
+
+    return NULL;
+}
+
+/**
+  * @brief  淘汰最久未用的行并从Flash回填
+  * @param  master 主设备
+  * @param  addr 行起始地址
+  * @param  err 失败时的错误码
+  * @retval 缓存行, 失败返回NULL
+  */
+static struct mtd_cache_line *mtd_cache_fill(struct mtd_info *master, mtd_addr_t addr, int *err)
+{
+    struct mtd_cache_line *line = &mtd_cache[0];
+    size_t len = MTD_READ_CACHE_LINE_SIZE;
+    size_t retlen = 0;
+    uint32_t i;
+    int ret;
+
+    for (i = 0; i < MTD_READ_CACHE_LINES; i++) {
+        if (!mtd_cache[i].master) {
+            line = &mtd_cache[i];
+            break;
+        }
+        if ((int32_t)(mtd_cache[i].lru - line->lru) < 0)
+            line = &mtd_cache[i];
+    }
+
+    /* 设备末尾不足一行 */
+    if (len > master->size - addr)
+        len = master->size - addr;
+
+#if MTD_SUPPORT_WRITE_BUFFER
+    /* 整行回填可能覆盖未刷出的数据 */
+    ret = mtd_wbuf_flush_range(master, addr, len);
+    if (ret) {
+        *err = ret;
+        return NULL;
+    }
+#endif
+
+    line->master = NULL;
+    ret = master->_read(master, addr, len, &retlen, line->data);
+    if (ret < 0 || retlen != len) {
+        *err = (ret < 0) ? ret : -ERR_IO;
+        return NULL;
+    }
+
+    line->master = master;
+    line->addr = addr;
+    line->lru = ++mtd_cache_clock;
+
+    return line;
+}
+
+/**
+  * @brief  经由读缓存读取, 顺序访问时预读下一行
+  * @param  master 主设备
+  * @param  from 主设备地址
+  * @param  len 读取长度
+  * @param  retlen 实际读取长度
+  * @param  buf 数据缓冲区
+  * @retval 0=成功, 负数=错误码
+  */
+static int mtd_cache_read(struct mtd_info *master, mtd_addr_t from, size_t len,
+                          size_t *retlen, uint8_t *buf)
+{
+    struct mtd_cache_line *line;
+    mtd_addr_t line_addr;
+    size_t done = 0;
+    size_t ofs;
+    size_t n;
+    int sequential;
+    int ret = 0;
+
+    sequential = (from == master->cache_next);
+
+    while (done < len) {
+        line_addr = (from + done) & ~MTD_CACHE_LINE_MASK;
+        ofs = (from + done) - line_addr;
+        n = MTD_READ_CACHE_LINE_SIZE - ofs;
+        if (n > len - done)
+            n = len - done;
+
+        line = mtd_cache_lookup(master, line_addr);
+        if (line) {
+            master->cache_stats.hits++;
+            line->lru = ++mtd_cache_clock;
+        } else {
+            master->cache_stats.misses++;
+            line = mtd_cache_fill(master, line_addr, &ret);
+            if (!line) {
+                *retlen = done;
+                master->cache_next = MTD_ADDR_MAX;
+                return ret;
+            }
+        }
+
+        memcpy(buf + done, line->data + ofs, n);
+        done += n;
+    }
+
+    *retlen = len;
+    master->cache_next = from + len;
+
+    /* 顺序读: 提前取回下一行, 预读失败不影响本次结果 */
+    if (sequential) {
+        line_addr = ((from + len - 1U) & ~MTD_CACHE_LINE_MASK) + MTD_READ_CACHE_LINE_SIZE;
+        if (line_addr < master->size && !mtd_cache_lookup(master, line_addr)) {
+            if (mtd_cache_fill(master, line_addr, &ret))
+                master->cache_stats.readahead++;
+        }
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  使与区域重叠的缓存行失效
+  * @param  master 主设备
+  * @param  addr 主设备地址
+  * @param  len 长度
+  * @retval None
+  */
+static void mtd_cache_drop(struct mtd_info *master, mtd_addr_t addr, mtd_addr_t len)
+{
+    uint32_t i;
+
+    if (!len)
+        return;
+
+    for (i = 0; i < MTD_READ_CACHE_LINES; i++) {
+        if (mtd_cache[i].master != master)
+            continue;
+        if (mtd_cache[i].addr >= addr + len ||
+            mtd_cache[i].addr + MTD_READ_CACHE_LINE_SIZE <= addr)
+            continue;
+
+        mtd_cache[i].master = NULL;
+        master->cache_stats.invalidates++;
+    }
+
+    master->cache_next = MTD_ADDR_MAX;
+}
+
+#if MTD_SUPPORT_IOVEC
+/**
+  * @brief  只从已缓存的行取数据, 不回填也不预读
+  * @param  master 主设备
+  * @param  from 主设备地址
+  * @param  len 长度
+  * @param  buf 数据缓冲区
+  * @retval 1=全部命中, 0=有行未缓存 (buf内容不确定)
+  */
+static int mtd_cache_peek(struct mtd_info *master, mtd_addr_t from, size_t len, uint8_t *buf)
+{
+    struct mtd_cache_line *line;
+    mtd_addr_t line_addr;
+    size_t done = 0;
+    size_t ofs;
+    size_t n;
+
+    while (done < len) {
+        line_addr = (from + done) & ~MTD_CACHE_LINE_MASK;
+        ofs = (from + done) - line_addr;
+        n = MTD_READ_CACHE_LINE_SIZE - ofs;
+        if (n > len - done)
+            n = len - done;
+
+        line = mtd_cache_lookup(master, line_addr);
+        if (!line)
+            return 0;
+
+        master->cache_stats.hits++;
+        line->lru = ++mtd_cache_clock;
+        memcpy(buf + done, line->data + ofs, n);
+        done += n;
+    }
+
+    return 1;
+}
+#endif
+#endif /* MTD_SUPPORT_READ_CACHE */
+
+#if MTD_SUPPORT_WRITE_BUFFER
+/**
+  * @brief  写缓冲挂在主设备上
+  */
+static struct mtd_info *mtd_wbuf_master(struct mtd_info *mtd)
+{
+#if MTD_SUPPORT_PARTITION
+    return mtd_get_master(mtd);
+#else
+    return mtd;
+#endif
+}
+
+/**
+  * @brief  刷出写缓冲
+  * @param  master 主设备
+  * @retval 0=成功, 负数=错误码
+  * @note   写失败时缓冲同样清空, 数据状态未知, 错误返回给触发刷出的调用者
+  */
+static int mtd_wbuf_flush(struct mtd_info *master)
+{
+    struct mtd_wbuf *wbuf = master->wbuf;
+    size_t retlen = 0;
+    int ret;
+
+    if (!wbuf || !wbuf->len)
+        return 0;
+
+#if MTD_SUPPORT_READ_CACHE
+    mtd_cache_drop(master, wbuf->addr, wbuf->len);
+#endif
+
+    ret = master->_write(master, wbuf->addr, wbuf->len, &retlen, wbuf->data);
+    if (ret == 0 && retlen != wbuf->len)
+        ret = -ERR_IO;
+
+    if (ret)
+        log_e("mtd_wbuf_flush: write 0x%08lx+%u failed (%d).",
+              (unsigned long)wbuf->addr, (unsigned)wbuf->len, ret);
+
+    wbuf->len = 0;
+
+    return ret;
+}
+
+/**
+  * @brief  区域与缓冲数据重叠时先刷出
+  * @param  master 主设备
+  * @param  addr 主设备地址
+  * @param  len 长度
+  * @retval 0=成功, 负数=错误码
+  */
+static int mtd_wbuf_flush_range(struct mtd_info *master, mtd_addr_t addr, mtd_addr_t len)
+{
+    struct mtd_wbuf *wbuf = master->wbuf;
+
+    if (!wbuf || !wbuf->len || !len)
+        return 0;
+
+    if (addr >= wbuf->addr + wbuf->len || addr + len <= wbuf->addr)
+        return 0;
+
+    return mtd_wbuf_flush(master);
+}
+
+/**
+  * @brief  经由写缓冲写入
+  * @param  master 主设备
+  * @param  to 主设备地址
+  * @param  len 写入长度
+  * @param  retlen 已接受的长度 (进入缓冲或已写入)
+  * @param  buf 数据缓冲区
+  * @retval 0=成功, 负数=错误码
+  * @note   与缓冲末尾连续且在同一窗口内的写追加到缓冲, 否则先刷出;
+  *         窗口写满立即刷出; 对齐的整窗口数据不经缓冲直接写入
+  */
+static int mtd_wbuf_write(struct mtd_info *master, mtd_addr_t to, size_t len,
+                          size_t *retlen, const uint8_t *buf)
+{
+    struct mtd_wbuf *wbuf = master->wbuf;
+    mtd_addr_t addr;
+    mtd_addr_t win_end;
+    size_t done = 0;
+    size_t wlen;
+    size_t n;
+    int ret;
+
+    *retlen = 0;
+
+    while (done < len) {
+        addr = to + done;
+
+        if (wbuf->len && addr != wbuf->addr + wbuf->len) {
+            ret = mtd_wbuf_flush(master);
+            if (ret)
+                return ret;
+        }
+
+        if (!wbuf->len) {
+            if (!(addr & MTD_WBUF_MASK) && len - done >= MTD_WBUF_SIZE) {
+                n = (len - done) & ~(size_t)MTD_WBUF_MASK;
+#if MTD_SUPPORT_READ_CACHE
+                mtd_cache_drop(master, addr, n);
+#endif
+                wlen = 0;
+                ret = master->_write(master, addr, n, &wlen, buf + done);
+                done += wlen;
+                *retlen = done;
+                if (ret)
+                    return ret;
+                if (wlen != n)
+                    return -ERR_IO;
+                continue;
+            }
+
+            wbuf->addr = addr;
+            wbuf->stamp = HAL_GetTick();
+        }
+
+        win_end = (wbuf->addr & ~MTD_WBUF_MASK) + MTD_WBUF_SIZE;
+        n = win_end - (wbuf->addr + wbuf->len);
+        if (n > len - done)
+            n = len - done;
+
+        memcpy(wbuf->data + wbuf->len, buf + done, n);
+        wbuf->len += n;
+        done += n;
+        *retlen = done;
+
+        if (wbuf->addr + wbuf->len == win_end) {
+            ret = mtd_wbuf_flush(master);
+            if (ret)
+                return ret;
+        }
+    }
+
+    return 0;
+}
+#endif /* MTD_SUPPORT_WRITE_BUFFER */
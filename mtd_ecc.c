@@ -0,0 +1,841 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_ecc.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 软件ECC引擎 (Hamming / BCH) 与带ECC的NAND设备
+  * @attention   : - Hamming: 按32位字累加, 每字只做一次奇偶判断, 行校验位由
+  *                  奇校验字的下标异或得到
+  *                - BCH: GF(2^13), 512字节一步; 编码用按字节查表的LFSR,
+  *                  余式以32位字保存; 纠错为 BM迭代 + Chien搜索
+  *                - 存储的ECC与全0xFF数据的ECC取差, 擦除页读出时校验直接通过
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "mtd_ecc.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "mtd_ecc"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+#if MTD_SUPPORT_OOB
+
+/* Private typedef -----------------------------------------------------------*/
+#if MTD_ECC_SUPPORT_BCH
+#define BCH_M                   13
+#define BCH_N                   ((1U << BCH_M) - 1U)    /* 码长上限 8191 */
+#define BCH_POLY                0x201BU                 /* x^13 + x^4 + x^3 + x + 1 */
+#define BCH_STEP                512
+#define BCH_T_MAX               8
+#define BCH_WORDS               ((BCH_M * BCH_T_MAX + 31) / 32)
+
+struct mtd_ecc_bch {
+    uint8_t t;
+    uint8_t ready;
+    uint16_t deg;                               /* 生成多项式次数 = 校验位数 */
+    uint32_t gen[BCH_WORDS];                    /* g(x) 去掉最高项, 左对齐 */
+    uint32_t tab[256][BCH_WORDS];               /* 按字节推进LFSR的查找表 */
+    uint8_t mask[MTD_ECC_MAX_BYTES];            /* 全0xFF数据的ECC取反, 使擦除页校验通过 */
+};
+#endif
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+#define MTD_ECC_PARITY8(x)      ((0x6996U >> (((x) ^ ((x) >> 4)) & 0x0FU)) & 1U)
+
+/* Private variables ---------------------------------------------------------*/
+#if MTD_ECC_SUPPORT_BCH
+static uint16_t bch_exp[BCH_N + 1U];            /* alpha^i */
+static uint16_t bch_log[BCH_N + 1U];            /* log_alpha(x), x != 0 */
+static struct mtd_ecc_bch bch4_state = { .t = 4 };
+static struct mtd_ecc_bch bch8_state = { .t = 8 };
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static void mtd_ecc_hamming_calc(const struct mtd_ecc_engine *eng, const uint8_t *data, uint8_t *ecc);
+static int mtd_ecc_hamming_correct(const struct mtd_ecc_engine *eng, uint8_t *data,
+                                   const uint8_t *read_ecc, const uint8_t *calc_ecc);
+#if MTD_ECC_SUPPORT_BCH
+static int mtd_ecc_bch_init(const struct mtd_ecc_engine *eng);
+static void mtd_ecc_bch_calc(const struct mtd_ecc_engine *eng, const uint8_t *data, uint8_t *ecc);
+static int mtd_ecc_bch_correct(const struct mtd_ecc_engine *eng, uint8_t *data,
+                               const uint8_t *read_ecc, const uint8_t *calc_ecc);
+#endif
+static int mtd_ecc_check_erased(uint8_t *data, size_t len, const uint8_t *ecc, size_t ecclen,
+                                uint32_t strength);
+static int mtd_ecc_nand_fix(struct mtd_ecc_nand *en, struct mtd_oob_ops *ops);
+static int mtd_ecc_nand_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops);
+static int mtd_ecc_nand_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops);
+static int mtd_ecc_nand_read(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, uint8_t *buf);
+static int mtd_ecc_nand_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, const uint8_t *buf);
+static int mtd_ecc_nand_erase(struct mtd_info *mtd, struct erase_info *instr);
+#if MTD_SUPPORT_NAND
+static int mtd_ecc_nand_block_isbad(struct mtd_info *mtd, mtd_addr_t offs);
+static int mtd_ecc_nand_block_markbad(struct mtd_info *mtd, mtd_addr_t offs);
+#endif
+
+/* Exported variables  -------------------------------------------------------*/
+const struct mtd_ecc_engine mtd_ecc_hamming_256 = {
+    .name = "hamming-256",
+    .step = 256,
+    .bytes = 3,
+    .strength = 1,
+    .calculate = mtd_ecc_hamming_calc,
+    .correct = mtd_ecc_hamming_correct,
+};
+
+const struct mtd_ecc_engine mtd_ecc_hamming_512 = {
+    .name = "hamming-512",
+    .step = 512,
+    .bytes = 3,
+    .strength = 1,
+    .calculate = mtd_ecc_hamming_calc,
+    .correct = mtd_ecc_hamming_correct,
+};
+
+#if MTD_ECC_SUPPORT_BCH
+const struct mtd_ecc_engine mtd_ecc_bch4 = {
+    .name = "bch-4",
+    .step = BCH_STEP,
+    .bytes = (BCH_M * 4 + 7) / 8,
+    .strength = 4,
+    .init = mtd_ecc_bch_init,
+    .calculate = mtd_ecc_bch_calc,
+    .correct = mtd_ecc_bch_correct,
+    .priv = &bch4_state,
+};
+
+const struct mtd_ecc_engine mtd_ecc_bch8 = {
+    .name = "bch-8",
+    .step = BCH_STEP,
+    .bytes = (BCH_M * 8 + 7) / 8,
+    .strength = 8,
+    .init = mtd_ecc_bch_init,
+    .calculate = mtd_ecc_bch_calc,
+    .correct = mtd_ecc_bch_correct,
+    .priv = &bch8_state,
+};
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  在原始NAND上创建带ECC的设备
+  * @param  en 设备 (调用者分配)
+  * @param  raw 无片上ECC的NAND, 页大小不超过 MTD_ECC_MAX_PAGE
+  * @param  eng ECC引擎
+  * @param  name 设备名, NULL时使用 raw 的名字
+  * @retval 0=成功, 负数=错误码
+  * @note   数据写入须整页对齐; 读取按页纠错, 超过引擎能力的页返回 -ERR_IO
+  */
+int mtd_ecc_nand_create(struct mtd_ecc_nand *en, struct mtd_info *raw,
+                        const struct mtd_ecc_engine *eng, const char *name)
+{
+    struct mtd_info *mtd;
+    uint32_t steps;
+    uint32_t eccbytes;
+    int ret;
+
+    if (!en || !raw || !eng || !eng->calculate || !eng->correct) {
+        log_e("mtd_ecc_nand_create: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    if (raw->type != MTD_NANDFLASH || !raw->_read_oob || !raw->_write_oob ||
+        raw->writesize > MTD_ECC_MAX_PAGE || raw->oobsize > MTD_ECC_MAX_OOB ||
+        eng->bytes > MTD_ECC_MAX_BYTES || raw->writesize % eng->step) {
+        log_e("mtd_ecc_nand_create: %s not supported by %s.", raw->name, eng->name);
+        return -ERR_NOTSUPP;
+    }
+
+    steps = raw->writesize / eng->step;
+    eccbytes = steps * eng->bytes;
+    if (MTD_ECC_OOB_OFFSET + eccbytes > raw->oobsize) {
+        log_e("mtd_ecc_nand_create: oob too small for %s.", eng->name);
+        return -ERR_NOTSUPP;
+    }
+
+    if (eng->init) {
+        ret = eng->init(eng);
+        if (ret)
+            return ret;
+    }
+
+    memset(&en->mtd, 0, sizeof(en->mtd));
+    en->raw = raw;
+    en->eng = eng;
+    en->steps = (uint16_t)steps;
+    en->free_offs = (uint16_t)(MTD_ECC_OOB_OFFSET + eccbytes);
+
+    mtd = &en->mtd;
+    mtd->name = name ? name : raw->name;
+    mtd->type = MTD_NANDFLASH;
+    mtd->flags = raw->flags;
+    mtd->size = raw->size;
+    mtd->erasesize = raw->erasesize;
+    mtd->writesize = raw->writesize;
+    mtd->writesize_shift = raw->writesize_shift;
+    mtd->oobsize = raw->oobsize;
+    mtd->oobavail = raw->oobsize - en->free_offs;
+#if MTD_SUPPORT_ECC_STATS
+    mtd->ecc_strength = eng->strength;
+    mtd->bitflip_threshold = (eng->strength * 3U + 3U) / 4U;
+#endif
+
+    mtd->_read = mtd_ecc_nand_read;
+    mtd->_write = mtd_ecc_nand_write;
+    mtd->_erase = mtd_ecc_nand_erase;
+    mtd->_read_oob = mtd_ecc_nand_read_oob;
+    mtd->_write_oob = mtd_ecc_nand_write_oob;
+#if MTD_SUPPORT_NAND
+    mtd->block_isbad = mtd_ecc_nand_block_isbad;
+    mtd->block_markbad = mtd_ecc_nand_block_markbad;
+#endif
+    mtd->priv = en;
+
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  Hamming ECC: 6位列校验 + 2x(8|9)位行校验, 取反后存3字节
+  * @note   行校验位k=1部分等于 "字节奇偶为1的字节下标" 的异或; 按字处理时
+  *         下标高位由字下标给出, 低2位由累加字中各字节的奇偶给出
+  */
+static void mtd_ecc_hamming_calc(const struct mtd_ecc_engine *eng, const uint8_t *data, uint8_t *ecc)
+{
+    uint32_t nbits = (eng->step == 512U) ? 9U : 8U;
+    uint32_t nwords = eng->step / 4U;
+    uint32_t acc = 0;
+    uint32_t idx = 0;
+    uint32_t code = 0;
+    uint32_t w;
+    uint32_t j;
+    uint32_t k;
+    uint32_t lp;
+    uint32_t all;
+    uint8_t b[4];
+    uint8_t col;
+
+    for (j = 0; j < nwords; j++) {
+        memcpy(&w, data + 4U * j, 4);
+        acc ^= w;
+        w ^= w >> 16;
+        w ^= w >> 8;
+        if (MTD_ECC_PARITY8(w & 0xFFU))
+            idx ^= j;
+    }
+
+    memcpy(b, &acc, 4);
+    col = (uint8_t)(b[0] ^ b[1] ^ b[2] ^ b[3]);
+    all = MTD_ECC_PARITY8(col);
+
+    for (k = 0; k < nbits; k++) {
+        if (k == 0)
+            lp = MTD_ECC_PARITY8((uint32_t)(b[1] ^ b[3]));
+        else if (k == 1)
+            lp = MTD_ECC_PARITY8((uint32_t)(b[2] ^ b[3]));
+        else
+            lp = (idx >> (k - 2U)) & 1U;
+        code |= (lp << (2U * k)) | ((lp ^ all) << (2U * k + 1U));
+    }
+
+    for (k = 0; k < 3U; k++) {
+        lp = MTD_ECC_PARITY8((uint32_t)(col & (k == 0 ? 0xAAU : (k == 1 ? 0xCCU : 0xF0U))));
+        code |= (lp << (2U * (nbits + k))) | ((lp ^ all) << (2U * (nbits + k) + 1U));
+    }
+
+    code = ~code;
+    ecc[0] = (uint8_t)code;
+    ecc[1] = (uint8_t)(code >> 8);
+    ecc[2] = (uint8_t)(code >> 16);
+}
+
+/**
+  * @brief  Hamming纠错: 每对校验位恰好一位不同时为单个数据位错误
+  */
+static int mtd_ecc_hamming_correct(const struct mtd_ecc_engine *eng, uint8_t *data,
+                                   const uint8_t *read_ecc, const uint8_t *calc_ecc)
+{
+    uint32_t nbits = (eng->step == 512U) ? 9U : 8U;
+    uint32_t mask = (1UL << (2U * (nbits + 3U))) - 1U;
+    uint32_t pairs = 0x555555UL & mask;
+    uint32_t s;
+    uint32_t byte = 0;
+    uint32_t bit = 0;
+    uint32_t k;
+
+    s = (uint32_t)(read_ecc[0] ^ calc_ecc[0]) |
+        ((uint32_t)(read_ecc[1] ^ calc_ecc[1]) << 8) |
+        ((uint32_t)(read_ecc[2] ^ calc_ecc[2]) << 16);
+    s &= mask;
+
+    if (!s)
+        return 0;
+
+    if (((s ^ (s >> 1)) & pairs) == pairs) {
+        for (k = 0; k < nbits; k++)
+            byte |= ((s >> (2U * k)) & 1U) << k;
+        for (k = 0; k < 3U; k++)
+            bit |= ((s >> (2U * (nbits + k))) & 1U) << k;
+        data[byte] ^= (uint8_t)(1U << bit);
+        return 1;
+    }
+
+    /* ECC自身的单个位错误 */
+    if (!(s & (s - 1U)))
+        return 1;
+
+    return -ERR_IO;
+}
+
+#if MTD_ECC_SUPPORT_BCH
+static uint16_t bch_mul(uint16_t a, uint16_t b)
+{
+    if (!a || !b)
+        return 0;
+
+    return bch_exp[((uint32_t)bch_log[a] + bch_log[b]) % BCH_N];
+}
+
+static uint16_t bch_div(uint16_t a, uint16_t b)
+{
+    if (!a)
+        return 0;
+
+    return bch_exp[((uint32_t)bch_log[a] + BCH_N - bch_log[b]) % BCH_N];
+}
+
+/**
+  * @brief  余式寄存器左移n位 (n<32), 低位补0
+  */
+static void bch_shl(uint32_t *r, uint32_t words, uint32_t n)
+{
+    uint32_t i;
+
+    for (i = 0; i + 1U < words; i++)
+        r[i] = (r[i] << n) | (r[i + 1U] >> (32U - n));
+    r[words - 1U] <<= n;
+}
+
+/**
+  * @brief  逐位推进LFSR, 仅用于建表
+  */
+static void bch_lfsr_bits(const struct mtd_ecc_bch *bch, uint32_t *r, uint8_t v)
+{
+    uint32_t words = (bch->deg + 31U) / 32U;
+    uint32_t fb;
+    uint32_t i;
+    int bit;
+
+    for (bit = 7; bit >= 0; bit--) {
+        fb = (r[0] >> 31) ^ ((uint32_t)v >> bit);
+        bch_shl(r, words, 1);
+        if (fb & 1U) {
+            for (i = 0; i < words; i++)
+                r[i] ^= bch->gen[i];
+        }
+    }
+}
+
+/**
+  * @brief  生成GF表、生成多项式 g(x) = lcm(m1, m3, ..., m(2t-1)) 与LFSR查找表
+  */
+static int mtd_ecc_bch_init(const struct mtd_ecc_engine *eng)
+{
+    struct mtd_ecc_bch *bch = (struct mtd_ecc_bch *)eng->priv;
+    uint32_t g[BCH_WORDS + 1U];                 /* g[k/32] bit k%32 = x^k 系数 */
+    uint32_t prod[BCH_WORDS + 1U];
+    uint16_t m[BCH_M + 1];
+    uint32_t deg = 0;
+    uint32_t mdeg;
+    uint32_t i;
+    uint32_t j;
+    uint32_t k;
+    uint32_t c;
+    uint32_t x;
+    uint8_t raw[MTD_ECC_MAX_BYTES];
+    uint8_t ff[BCH_STEP];
+    int seen;
+
+    if (bch->ready)
+        return 0;
+
+    if (!bch_exp[0]) {
+        x = 1;
+        for (i = 0; i < BCH_N; i++) {
+            bch_exp[i] = (uint16_t)x;
+            bch_log[x] = (uint16_t)i;
+            x <<= 1;
+            if (x & (1UL << BCH_M))
+                x ^= BCH_POLY;
+        }
+        bch_exp[BCH_N] = 1;
+    }
+
+    memset(g, 0, sizeof(g));
+    g[0] = 1;
+
+    for (i = 1; i < 2U * bch->t; i += 2U) {
+        /* 共轭类中已有更小的奇数指数, 最小多项式已乘入 */
+        seen = 0;
+        c = i;
+        for (k = 0; k < BCH_M; k++) {
+            if ((c & 1U) && c < i)
+                seen = 1;
+            c = (c * 2U) % BCH_N;
+        }
+        if (seen)
+            continue;
+
+        memset(m, 0, sizeof(m));
+        m[0] = 1;
+        mdeg = 0;
+        c = i;
+        do {
+            for (j = mdeg + 1U; j > 0; j--)
+                m[j] = m[j - 1U] ^ bch_mul(m[j], bch_exp[c]);
+            m[0] = bch_mul(m[0], bch_exp[c]);
+            mdeg++;
+            c = (c * 2U) % BCH_N;
+        } while (c != i);
+
+        memset(prod, 0, sizeof(prod));
+        for (j = 0; j <= mdeg; j++) {
+            if (!m[j])
+                continue;
+            for (k = 0; k <= deg; k++) {
+                if ((g[k / 32U] >> (k % 32U)) & 1U)
+                    prod[(k + j) / 32U] ^= 1UL << ((k + j) % 32U);
+            }
+        }
+        memcpy(g, prod, sizeof(g));
+        deg += mdeg;
+    }
+
+    if (deg > BCH_M * BCH_T_MAX || (deg + 7U) / 8U != eng->bytes)
+        return -ERR_INVAL;
+
+    bch->deg = (uint16_t)deg;
+
+    memset(bch->gen, 0, sizeof(bch->gen));
+    for (k = 0; k < deg; k++) {
+        if ((g[k / 32U] >> (k % 32U)) & 1U) {
+            j = deg - 1U - k;
+            bch->gen[j / 32U] |= 0x80000000UL >> (j % 32U);
+        }
+    }
+
+    for (i = 0; i < 256U; i++) {
+        memset(bch->tab[i], 0, sizeof(bch->tab[i]));
+        bch_lfsr_bits(bch, bch->tab[i], (uint8_t)i);
+    }
+
+    /* 先用全0掩码算出擦除页的ECC, 再取反作掩码 */
+    memset(bch->mask, 0, sizeof(bch->mask));
+    memset(ff, 0xFF, sizeof(ff));
+    mtd_ecc_bch_calc(eng, ff, raw);
+    for (i = 0; i < eng->bytes; i++)
+        bch->mask[i] = (uint8_t)~raw[i];
+
+    bch->ready = 1;
+
+    return 0;
+}
+
+/**
+  * @brief  BCH编码: 余式 = data(x) * x^deg mod g(x), 每字节一次查表
+  */
+static void mtd_ecc_bch_calc(const struct mtd_ecc_engine *eng, const uint8_t *data, uint8_t *ecc)
+{
+    const struct mtd_ecc_bch *bch = (const struct mtd_ecc_bch *)eng->priv;
+    uint32_t words = (bch->deg + 31U) / 32U;
+    uint32_t r[BCH_WORDS] = { 0 };
+    const uint32_t *p;
+    uint32_t i;
+    uint32_t j;
+
+    for (i = 0; i < BCH_STEP; i++) {
+        p = bch->tab[(r[0] >> 24) ^ data[i]];
+        for (j = 0; j + 1U < words; j++)
+            r[j] = ((r[j] << 8) | (r[j + 1U] >> 24)) ^ p[j];
+        r[j] = (r[j] << 8) ^ p[j];
+    }
+
+    for (i = 0; i < eng->bytes; i++)
+        ecc[i] = (uint8_t)(r[i / 4U] >> (24U - 8U * (i % 4U))) ^ bch->mask[i];
+}
+
+/**
+  * @brief  BCH纠错
+  * @note   接收码字余式 = 读出ECC ^ 重算ECC; 由其求 2t 个伴随式,
+  *         BM迭代得错误位置多项式, Chien搜索在码长范围内求根
+  */
+static int mtd_ecc_bch_correct(const struct mtd_ecc_engine *eng, uint8_t *data,
+                               const uint8_t *read_ecc, const uint8_t *calc_ecc)
+{
+    const struct mtd_ecc_bch *bch = (const struct mtd_ecc_bch *)eng->priv;
+    uint32_t t = bch->t;
+    uint32_t deg = bch->deg;
+    uint32_t ntot = 8U * BCH_STEP + deg;
+    uint16_t s[2 * BCH_T_MAX + 1];
+    uint16_t c[2 * BCH_T_MAX + 1];
+    uint16_t b[2 * BCH_T_MAX + 1];
+    uint16_t tmp[2 * BCH_T_MAX + 1];
+    uint16_t pos[BCH_T_MAX];
+    uint32_t term[BCH_T_MAX + 1];
+    uint16_t d;
+    uint16_t bb = 1;
+    uint16_t sum;
+    uint32_t l = 0;
+    uint32_t mstep = 1;
+    uint32_t nerr = 0;
+    uint32_t e;
+    uint32_t q;
+    uint32_t i;
+    uint32_t j;
+    uint32_t n;
+    uint32_t p;
+    uint8_t diff;
+    int any = 0;
+
+    memset(s, 0, sizeof(s));
+    for (i = 0; i < eng->bytes; i++) {
+        diff = read_ecc[i] ^ calc_ecc[i];
+        if (i == eng->bytes - 1U && (deg % 8U))
+            diff &= (uint8_t)(0xFFU << (8U - deg % 8U));
+        if (!diff)
+            continue;
+        any = 1;
+        for (j = 0; j < 8U; j++) {
+            if (!(diff & (0x80U >> j)))
+                continue;
+            e = 8U * i + j;
+            q = deg - 1U - e;
+            for (n = 1; n < 2U * t; n += 2U)
+                s[n] ^= bch_exp[(q * n) % BCH_N];
+        }
+    }
+
+    if (!any)
+        return 0;
+
+    for (n = 2; n <= 2U * t; n += 2U)
+        s[n] = bch_mul(s[n / 2U], s[n / 2U]);
+
+    /* Berlekamp-Massey */
+    memset(c, 0, sizeof(c));
+    memset(b, 0, sizeof(b));
+    c[0] = 1;
+    b[0] = 1;
+    for (n = 0; n < 2U * t; n++) {
+        d = s[n + 1U];
+        for (i = 1; i <= l; i++)
+            d ^= bch_mul(c[i], s[n + 1U - i]);
+
+        if (!d) {
+            mstep++;
+            continue;
+        }
+
+        memcpy(tmp, c, sizeof(c));
+        for (i = 0; i + mstep <= 2U * t; i++)
+            c[i + mstep] ^= bch_mul(bch_div(d, bb), b[i]);
+
+        if (2U * l <= n) {
+            l = n + 1U - l;
+            memcpy(b, tmp, sizeof(b));
+            bb = d;
+            mstep = 1;
+        } else {
+            mstep++;
+        }
+    }
+
+    if (l > t)
+        return -ERR_IO;
+
+    /* Chien搜索: sigma(alpha^-p) == 0 表示幂次p处有错 */
+    for (i = 1; i <= l; i++)
+        term[i] = c[i] ? bch_log[c[i]] : BCH_N;
+
+    for (p = 0; p < ntot && nerr < l; p++) {
+        sum = c[0];
+        for (i = 1; i <= l; i++) {
+            if (term[i] == BCH_N)
+                continue;
+            sum ^= bch_exp[term[i]];
+            term[i] = (term[i] >= i) ? term[i] - i : term[i] + BCH_N - i;
+        }
+        if (!sum)
+            pos[nerr++] = (uint16_t)p;
+    }
+
+    if (nerr != l)
+        return -ERR_IO;
+
+    for (i = 0; i < nerr; i++) {
+        if (pos[i] < deg)
+            continue;                           /* 错在ECC字节中 */
+        e = ntot - 1U - pos[i];
+        data[e / 8U] ^= (uint8_t)(0x80U >> (e % 8U));
+    }
+
+    return (int)nerr;
+}
+#endif /* MTD_ECC_SUPPORT_BCH */
+
+/**
+  * @brief  无法纠正时检查是否为带少量翻转的擦除页
+  * @retval 翻转位数 (data已恢复为0xFF), -ERR_IO=不是擦除页
+  */
+static int mtd_ecc_check_erased(uint8_t *data, size_t len, const uint8_t *ecc, size_t ecclen,
+                                uint32_t strength)
+{
+    uint32_t zeros = 0;
+    uint32_t v;
+    size_t i;
+
+    for (i = 0; i < len + ecclen; i++) {
+        v = (uint8_t)~(i < len ? data[i] : ecc[i - len]);
+        while (v) {
+            zeros++;
+            v &= v - 1U;
+        }
+        if (zeros > strength)
+            return -ERR_IO;
+    }
+
+    memset(data, 0xFF, len);
+
+    return (int)zeros;
+}
+
+/**
+  * @brief  对 en->page 逐步纠错并更新统计
+  * @retval 本页最大单步翻转数, -ERR_IO=有步无法纠正
+  */
+static int mtd_ecc_nand_fix(struct mtd_ecc_nand *en, struct mtd_oob_ops *ops)
+{
+    const struct mtd_ecc_engine *eng = en->eng;
+    uint8_t calc[MTD_ECC_MAX_BYTES];
+    uint8_t *data;
+    uint8_t *ecc;
+    uint32_t i;
+    int max = 0;
+    int failed = 0;
+    int n;
+
+#if !MTD_SUPPORT_ECC_STATS
+    (void)ops;
+#endif
+
+    for (i = 0; i < en->steps; i++) {
+        data = en->page + i * eng->step;
+        ecc = en->oob + MTD_ECC_OOB_OFFSET + i * eng->bytes;
+
+        eng->calculate(eng, data, calc);
+        n = eng->correct(eng, data, ecc, calc);
+        if (n < 0)
+            n = mtd_ecc_check_erased(data, eng->step, ecc, eng->bytes, eng->strength);
+
+        if (n < 0) {
+            failed = 1;
+#if MTD_SUPPORT_ECC_STATS
+            en->mtd.ecc_stats.failed++;
+            if (ops->stats)
+                ops->stats->uncorrectable_errors++;
+#endif
+            continue;
+        }
+
+#if MTD_SUPPORT_ECC_STATS
+        en->mtd.ecc_stats.corrected += (uint32_t)n;
+        if (ops->stats)
+            ops->stats->corrected_bitflips += (uint32_t)n;
+#endif
+        if (n > max)
+            max = n;
+    }
+
+    return failed ? -ERR_IO : max;
+}
+
+/**
+  * @brief  按页读出原始数据+OOB, 非RAW模式下纠错
+  * @retval 最大单步翻转数, 负数=错误码; 有页无法纠正时读完全部页后返回 -ERR_IO
+  */
+static int mtd_ecc_nand_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops)
+{
+    struct mtd_ecc_nand *en = (struct mtd_ecc_nand *)mtd->priv;
+    struct mtd_oob_ops raw_ops;
+    uint32_t ws = mtd->writesize;
+    uint32_t win = mtd_oobavail(mtd, ops);
+    uint32_t base = (ops->mode == MTD_OPS_AUTO_OOB) ? en->free_offs : 0U;
+    uint32_t col = (uint32_t)(from % ws);
+    uint32_t ooboff = ops->ooboffs;
+    mtd_addr_t page = from - col;
+    size_t n;
+    int max = 0;
+    int failed = 0;
+    int ret;
+
+    while (ops->retlen < ops->len || ops->oobretlen < ops->ooblen) {
+        memset(&raw_ops, 0, sizeof(raw_ops));
+        raw_ops.mode = MTD_OPS_RAW;
+        raw_ops.ooblen = mtd->oobsize;
+        raw_ops.oobbuf = en->oob;
+        if (ops->retlen < ops->len) {
+            raw_ops.len = ws;
+            raw_ops.datbuf = en->page;
+        }
+
+        ret = mtd_read_oob(en->raw, page, &raw_ops);
+        if (ret < 0 && ret != -ERR_UCLEAN)
+            return ret;
+
+        if (raw_ops.len && ops->mode != MTD_OPS_RAW) {
+            ret = mtd_ecc_nand_fix(en, ops);
+            if (ret < 0)
+                failed = 1;
+            else if (ret > max)
+                max = ret;
+        }
+
+        if (raw_ops.len) {
+            n = ws - col;
+            if (n > ops->len - ops->retlen)
+                n = ops->len - ops->retlen;
+            memcpy(ops->datbuf + ops->retlen, en->page + col, n);
+            ops->retlen += n;
+            col = 0;
+        }
+
+        if (ops->oobretlen < ops->ooblen) {
+            n = win - ooboff;
+            if (n > ops->ooblen - ops->oobretlen)
+                n = ops->ooblen - ops->oobretlen;
+            memcpy(ops->oobbuf + ops->oobretlen, en->oob + base + ooboff, n);
+            ops->oobretlen += n;
+            ooboff = 0;
+        }
+
+        page += ws;
+    }
+
+    return failed ? -ERR_IO : max;
+}
+
+/**
+  * @brief  按页写入数据+OOB, 非RAW模式下ECC覆盖OOB中的ECC区
+  * @note   数据须整页对齐; 只写OOB时ECC区保持0xFF, 之后仍可写入数据
+  */
+static int mtd_ecc_nand_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops)
+{
+    struct mtd_ecc_nand *en = (struct mtd_ecc_nand *)mtd->priv;
+    const struct mtd_ecc_engine *eng = en->eng;
+    struct mtd_oob_ops raw_ops;
+    uint32_t ws = mtd->writesize;
+    uint32_t win = mtd_oobavail(mtd, ops);
+    uint32_t base = (ops->mode == MTD_OPS_AUTO_OOB) ? en->free_offs : 0U;
+    uint32_t ooboff = ops->ooboffs;
+    mtd_addr_t page = to - to % ws;
+    const uint8_t *data;
+    uint32_t i;
+    size_t n;
+    int ret;
+
+    if (ops->len && ((to % ws) || (ops->len % ws)))
+        return -ERR_INVAL;
+
+    while (ops->retlen < ops->len || ops->oobretlen < ops->ooblen) {
+        memset(en->oob, 0xFF, mtd->oobsize);
+
+        if (ops->oobretlen < ops->ooblen) {
+            n = win - ooboff;
+            if (n > ops->ooblen - ops->oobretlen)
+                n = ops->ooblen - ops->oobretlen;
+            memcpy(en->oob + base + ooboff, ops->oobbuf + ops->oobretlen, n);
+            ops->oobretlen += n;
+            ooboff = 0;
+        }
+
+        memset(&raw_ops, 0, sizeof(raw_ops));
+        raw_ops.mode = MTD_OPS_RAW;
+        raw_ops.ooblen = mtd->oobsize;
+        raw_ops.oobbuf = en->oob;
+
+        if (ops->retlen < ops->len) {
+            data = ops->datbuf + ops->retlen;
+            if (ops->mode != MTD_OPS_RAW) {
+                for (i = 0; i < en->steps; i++)
+                    eng->calculate(eng, data + i * eng->step,
+                                   en->oob + MTD_ECC_OOB_OFFSET + i * eng->bytes);
+            }
+            raw_ops.len = ws;
+            raw_ops.datbuf = (uint8_t *)data;
+        }
+
+        ret = mtd_write_oob(en->raw, page, &raw_ops);
+        if (ret)
+            return ret;
+
+        ops->retlen += raw_ops.len;
+        page += ws;
+    }
+
+    return 0;
+}
+
+static int mtd_ecc_nand_read(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, uint8_t *buf)
+{
+    struct mtd_oob_ops ops = {
+        .len = len,
+        .datbuf = buf,
+    };
+    int ret;
+
+    ret = mtd_ecc_nand_read_oob(mtd, from, &ops);
+    *retlen = ops.retlen;
+
+    return ret;
+}
+
+static int mtd_ecc_nand_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, const uint8_t *buf)
+{
+    struct mtd_oob_ops ops = {
+        .len = len,
+        .datbuf = (uint8_t *)buf,
+    };
+    int ret;
+
+    ret = mtd_ecc_nand_write_oob(mtd, to, &ops);
+    *retlen = ops.retlen;
+
+    return ret;
+}
+
+static int mtd_ecc_nand_erase(struct mtd_info *mtd, struct erase_info *instr)
+{
+    return mtd_erase(((struct mtd_ecc_nand *)mtd->priv)->raw, instr);
+}
+
+#if MTD_SUPPORT_NAND
+static int mtd_ecc_nand_block_isbad(struct mtd_info *mtd, mtd_addr_t offs)
+{
+    return mtd_block_isbad(((struct mtd_ecc_nand *)mtd->priv)->raw, offs);
+}
+
+static int mtd_ecc_nand_block_markbad(struct mtd_info *mtd, mtd_addr_t offs)
+{
+    return mtd_block_markbad(((struct mtd_ecc_nand *)mtd->priv)->raw, offs);
+}
+#endif /* MTD_SUPPORT_NAND */
+
+#endif /* MTD_SUPPORT_OOB */
@@ -0,0 +1,147 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_file.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 以主机文件为存储的仿真MTD设备
+  * @attention   : 文件布局: [数据区 size 字节][各页OOB], 不足部分以0xFF补齐
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "mtd_file.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "mtd_file"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int mtd_file_load(void *ctx, uint32_t off, void *buf, size_t len);
+static int mtd_file_save(void *ctx, uint32_t off, const void *buf, size_t len);
+
+static const struct mtd_sim_store mtd_file_store = {
+    .load = mtd_file_load,
+    .save = mtd_file_save,
+};
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  打开 (不存在则创建) 文件仿真设备
+  * @param  file 设备 (调用者分配)
+  * @param  cfg 几何与延时配置
+  * @param  path 文件路径
+  * @retval 0=成功, 负数=错误码
+  * @note   新建文件整体置为擦除态; 已有文件比所需短时以0xFF补齐
+  */
+int mtd_file_open(struct mtd_file *file, const struct mtd_sim_config *cfg, const char *path)
+{
+    uint8_t ff[64];
+    size_t need;
+    long have;
+    size_t n;
+    int ret;
+
+    if (!file || !cfg || !path)
+        return -ERR_INVAL;
+
+    file->fp = fopen(path, "r+b");
+    if (!file->fp)
+        file->fp = fopen(path, "w+b");
+    if (!file->fp) {
+        log_e("mtd_file_open: cannot open %s.", path);
+        return -ERR_IO;
+    }
+
+    ret = mtd_sim_init(&file->sim, cfg, &mtd_file_store, file);
+    if (ret)
+        goto fail;
+
+    need = (size_t)cfg->size;
+    if (cfg->type == MTD_NANDFLASH)
+        need += (size_t)(cfg->size / cfg->writesize) * cfg->oobsize;
+
+    if (fseek(file->fp, 0, SEEK_END) || (have = ftell(file->fp)) < 0) {
+        ret = -ERR_IO;
+        goto fail;
+    }
+
+    memset(ff, 0xFF, sizeof(ff));
+    while ((size_t)have < need) {
+        n = need - (size_t)have;
+        if (n > sizeof(ff))
+            n = sizeof(ff);
+        if (fwrite(ff, 1, n, file->fp) != n) {
+            ret = -ERR_IO;
+            goto fail;
+        }
+        have += (long)n;
+    }
+
+    if (fflush(file->fp)) {
+        ret = -ERR_IO;
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    fclose(file->fp);
+    file->fp = NULL;
+    return ret;
+}
+
+/**
+  * @brief  关闭文件仿真设备
+  */
+int mtd_file_close(struct mtd_file *file)
+{
+    int ret;
+
+    if (!file || !file->fp)
+        return -ERR_INVAL;
+
+    ret = fclose(file->fp);
+    file->fp = NULL;
+
+    return ret ? -ERR_IO : 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static int mtd_file_load(void *ctx, uint32_t off, void *buf, size_t len)
+{
+    struct mtd_file *file = (struct mtd_file *)ctx;
+
+    if (!file->fp || fseek(file->fp, (long)off, SEEK_SET))
+        return -ERR_IO;
+
+    return (fread(buf, 1, len, file->fp) == len) ? 0 : -ERR_IO;
+}
+
+static int mtd_file_save(void *ctx, uint32_t off, const void *buf, size_t len)
+{
+    struct mtd_file *file = (struct mtd_file *)ctx;
+
+    if (!file->fp || fseek(file->fp, (long)off, SEEK_SET))
+        return -ERR_IO;
+
+    if (fwrite(buf, 1, len, file->fp) != len)
+        return -ERR_IO;
+
+    /* 逐次刷出, 进程被杀时文件内容与仿真掉电点一致 */
+    return fflush(file->fp) ? -ERR_IO : 0;
+}
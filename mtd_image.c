@@ -0,0 +1,236 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_image.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : Flash镜像流式校验 / 加载
+  * @attention   : 第 i 块的 mtd_read_wait() 返回后立即发起第 i+1 块的读, 再计算第 i 块,
+  *                总耗时约为 max(读, 计算) 而非两者之和; 只读一遍Flash
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "mtd_image.h"
+#include "crc32.h"
+#if MTD_IMAGE_SUPPORT_SHA256
+#include "sha256.h"
+#endif
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "mtd_image"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+/* Private typedef -----------------------------------------------------------*/
+struct mtd_image_hash {
+    enum mtd_image_algo algo;
+    uint32_t crc;
+#if MTD_IMAGE_SUPPORT_SHA256
+    struct sha256_ctx sha;
+#endif
+};
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+uint32_t HAL_GetTick(void);
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int mtd_image_run(struct mtd_info *mtd, mtd_addr_t from, size_t len, enum mtd_image_algo algo,
+                         const void *expect, uint8_t *base, size_t chunk, int ping_pong,
+                         struct mtd_image_result *res);
+static void mtd_image_hash_update(struct mtd_image_hash *h, const uint8_t *data, size_t len);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  校验Flash中的镜像, 数据不保留
+  * @param  mtd MTD设备
+  * @param  from 镜像起始地址
+  * @param  len 镜像长度
+  * @param  algo 校验算法
+  * @param  expect 期望值, NULL=只计算不比较
+  * @param  buf 工作缓冲, 分为两半交替使用
+  * @param  bufsize 缓冲大小, 不小于2; 越大单次总线事务越长, 调度开销越小
+  * @param  res 结果, 可为NULL
+  * @retval 0=校验通过, MTD_IMAGE_MISMATCH=不符, 负数=读错误
+  */
+int mtd_image_verify(struct mtd_info *mtd, mtd_addr_t from, size_t len, enum mtd_image_algo algo,
+                     const void *expect, uint8_t *buf, size_t bufsize, struct mtd_image_result *res)
+{
+    if (!mtd || !buf || bufsize < 2U) {
+        log_e("mtd_image_verify: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    return mtd_image_run(mtd, from, len, algo, expect, buf, bufsize / 2U, 1, res);
+}
+
+/**
+  * @brief  将镜像加载到RAM并校验
+  * @param  mtd MTD设备
+  * @param  from 镜像起始地址
+  * @param  len 镜像长度
+  * @param  algo 校验算法
+  * @param  expect 期望值, NULL=只计算不比较
+  * @param  dst 目标地址, 至少len字节
+  * @param  chunk 每次读取的字节数
+  * @param  res 结果, 可为NULL
+  * @retval 0=校验通过, MTD_IMAGE_MISMATCH=不符, 负数=读错误
+  * @note   数据直接读入dst, 计算已到达的块时下一块继续传输
+  */
+int mtd_image_load(struct mtd_info *mtd, mtd_addr_t from, size_t len, enum mtd_image_algo algo,
+                   const void *expect, uint8_t *dst, size_t chunk, struct mtd_image_result *res)
+{
+    if (!mtd || !dst || !chunk) {
+        log_e("mtd_image_load: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    return mtd_image_run(mtd, from, len, algo, expect, dst, chunk, 0, res);
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  读取与计算流水线
+  * @param  base ping_pong=1 时为两个chunk大小的缓冲, 否则为目标地址
+  */
+static int mtd_image_run(struct mtd_info *mtd, mtd_addr_t from, size_t len, enum mtd_image_algo algo,
+                         const void *expect, uint8_t *base, size_t chunk, int ping_pong,
+                         struct mtd_image_result *res)
+{
+    struct mtd_image_hash h;
+    struct mtd_image_result r;
+    uint8_t *cur;
+    size_t off = 0;
+    size_t n;
+    size_t retlen;
+    uint32_t idx = 0;
+    uint32_t start;
+#if MTD_SUPPORT_READ_ASYNC
+    uint8_t *next;
+    size_t nn;
+    int async = 0;
+#endif
+    int ret = 0;
+
+    if (from >= mtd->size || len > mtd->size - from)
+        return -ERR_INVAL;
+
+    (void)memset(&h, 0, sizeof(h));
+    (void)memset(&r, 0, sizeof(r));
+    h.algo = algo;
+    switch (algo) {
+    case MTD_IMAGE_CRC32:
+        break;
+#if MTD_IMAGE_SUPPORT_SHA256
+    case MTD_IMAGE_SHA256:
+        sha256_init(&h.sha);
+        break;
+#endif
+    default:
+        return -ERR_INVAL;
+    }
+
+    start = HAL_GetTick();
+
+#if MTD_SUPPORT_READ_ASYNC
+    if (len) {
+        n = (len < chunk) ? len : chunk;
+        ret = mtd_read_start(mtd, from, n, base);
+        if (!ret)
+            async = 1;
+        else if (ret != -ERR_NOTSUPP)
+            return ret;
+        ret = 0;
+    }
+#endif
+
+    while (off < len) {
+        n = (len - off < chunk) ? (len - off) : chunk;
+        cur = ping_pong ? (base + (idx & 1U) * chunk) : (base + off);
+        retlen = 0;
+
+#if MTD_SUPPORT_READ_ASYNC
+        if (async) {
+            ret = mtd_read_wait(mtd, &retlen);
+        } else
+#endif
+        {
+            ret = mtd_read(mtd, from + off, n, &retlen, cur);
+        }
+
+        if (ret == -ERR_UCLEAN) {
+            r.uclean = 1;
+        } else if (ret) {
+            log_e("mtd_image: read 0x%08lx+%lu failed (%d).", (unsigned long)(from + off),
+                  (unsigned long)n, ret);
+            break;
+        }
+
+        /* 下一块先上总线, 再计算本块 */
+#if MTD_SUPPORT_READ_ASYNC
+        if (async && off + n < len) {
+            nn = (len - off - n < chunk) ? (len - off - n) : chunk;
+            next = ping_pong ? (base + ((idx + 1U) & 1U) * chunk) : (base + off + n);
+            ret = mtd_read_start(mtd, from + off + n, nn, next);
+            if (ret) {
+                log_e("mtd_image: read 0x%08lx+%lu failed (%d).", (unsigned long)(from + off + n),
+                      (unsigned long)nn, ret);
+                break;
+            }
+            r.overlapped = 1;
+        }
+#endif
+
+        mtd_image_hash_update(&h, cur, n);
+        off += n;
+        idx++;
+    }
+
+    r.bytes = off;
+    r.elapsed_ms = HAL_GetTick() - start;
+    r.kbps = (uint32_t)(off / (r.elapsed_ms ? r.elapsed_ms : 1U));
+
+    if (algo == MTD_IMAGE_CRC32) {
+        r.crc = h.crc;
+#if MTD_IMAGE_SUPPORT_SHA256
+    } else {
+        sha256_final(&h.sha, r.sha256);
+#endif
+    }
+
+    if (res)
+        *res = r;
+
+    if (ret && ret != -ERR_UCLEAN)
+        return ret;
+
+    if (!expect)
+        return 0;
+
+#if MTD_IMAGE_SUPPORT_SHA256
+    if (algo == MTD_IMAGE_SHA256)
+        return memcmp(r.sha256, expect, sizeof(r.sha256)) ? MTD_IMAGE_MISMATCH : 0;
+#endif
+
+    return (memcmp(&r.crc, expect, sizeof(r.crc))) ? MTD_IMAGE_MISMATCH : 0;
+}
+
+static void mtd_image_hash_update(struct mtd_image_hash *h, const uint8_t *data, size_t len)
+{
+#if MTD_IMAGE_SUPPORT_SHA256
+    if (h->algo == MTD_IMAGE_SHA256) {
+        sha256_update(&h->sha, data, len);
+        return;
+    }
+#endif
+    h->crc = crc32(h->crc, data, len);
+}
@@ -0,0 +1,96 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_ram.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 以RAM为存储的仿真MTD设备
+  * @attention   : 掉电不保持, 初始化时整体置为擦除态
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "mtd_ram.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "mtd_ram"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static int mtd_ram_load(void *ctx, uint32_t off, void *buf, size_t len);
+static int mtd_ram_save(void *ctx, uint32_t off, const void *buf, size_t len);
+
+static const struct mtd_sim_store mtd_ram_store = {
+    .load = mtd_ram_load,
+    .save = mtd_ram_save,
+};
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  初始化RAM仿真设备
+  * @param  ram 设备 (调用者分配)
+  * @param  cfg 几何与延时配置
+  * @param  mem 存储, 不小于 mtd_ram_mem_size(cfg)
+  * @param  mem_size 存储大小
+  * @retval 0=成功, 负数=错误码
+  */
+int mtd_ram_init(struct mtd_ram *ram, const struct mtd_sim_config *cfg, uint8_t *mem, size_t mem_size)
+{
+    int ret;
+
+    if (!ram || !cfg || !mem)
+        return -ERR_INVAL;
+
+    if (mem_size < mtd_ram_mem_size(cfg)) {
+        log_e("mtd_ram_init: %zu bytes needed, %zu given.", mtd_ram_mem_size(cfg), mem_size);
+        return -ERR_INVAL;
+    }
+
+    ram->mem = mem;
+    ram->mem_size = mem_size;
+
+    ret = mtd_sim_init(&ram->sim, cfg, &mtd_ram_store, ram);
+    if (ret)
+        return ret;
+
+    return mtd_sim_format(&ram->sim);
+}
+
+/* Private functions ---------------------------------------------------------*/
+static int mtd_ram_load(void *ctx, uint32_t off, void *buf, size_t len)
+{
+    struct mtd_ram *ram = (struct mtd_ram *)ctx;
+
+    if (off > ram->mem_size || len > ram->mem_size - off)
+        return -ERR_INVAL;
+
+    memcpy(buf, ram->mem + off, len);
+
+    return 0;
+}
+
+static int mtd_ram_save(void *ctx, uint32_t off, const void *buf, size_t len)
+{
+    struct mtd_ram *ram = (struct mtd_ram *)ctx;
+
+    if (off > ram->mem_size || len > ram->mem_size - off)
+        return -ERR_INVAL;
+
+    memcpy(ram->mem + off, buf, len);
+
+    return 0;
+}
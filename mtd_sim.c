@@ -0,0 +1,633 @@
+/**
+  ******************************************************************************
+  * @file        : mtd_sim.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 仿真MTD设备
+  * @attention   : - 编程只能把1写为0 (与原内容按位与), 擦除恢复为0xFF
+  *                - NAND按整页编程, 支持OOB与坏块
+  *                - 延时按模型累加到 stats.elapsed_ns, 可选真实阻塞
+  *                - 写/擦除故障模拟掉电撕裂, 读故障模拟位翻转
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "mtd_sim.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "mtd_sim"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define MTD_SIM_CHUNK           64U
+
+/* Private macro -------------------------------------------------------------*/
+#define MTD_SIM_IS_NAND(sim)    ((sim)->cfg.type == MTD_NANDFLASH)
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void mtd_sim_account(struct mtd_sim *sim, uint32_t ops_us, size_t bytes);
+static uint32_t mtd_sim_pages(struct mtd_sim *sim, mtd_addr_t addr, size_t len);
+static int mtd_sim_fault_hit(struct mtd_sim *sim, long *counter);
+static int mtd_sim_check_blocks(struct mtd_sim *sim, mtd_addr_t addr, size_t len);
+static int mtd_sim_fill(struct mtd_sim *sim, uint32_t off, size_t len);
+static int mtd_sim_program(struct mtd_sim *sim, uint32_t off, const uint8_t *buf, size_t len);
+static int mtd_sim_load(struct mtd_sim *sim, uint32_t off, uint8_t *buf, size_t len);
+static int mtd_sim_read(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, uint8_t *buf);
+static int mtd_sim_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, const uint8_t *buf);
+static int mtd_sim_erase(struct mtd_info *mtd, struct erase_info *instr);
+#if MTD_SUPPORT_IOVEC
+static int mtd_sim_readv(struct mtd_info *mtd, const struct mtd_iovec *vec, uint32_t cnt);
+#endif
+#if MTD_SUPPORT_ERASE_ASYNC
+static int mtd_sim_erase_start(struct mtd_info *mtd, mtd_addr_t addr);
+static int mtd_sim_erase_wait(struct mtd_info *mtd);
+#endif
+#if MTD_SUPPORT_OOB
+static int mtd_sim_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops);
+static int mtd_sim_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops);
+#endif
+#if MTD_SUPPORT_NAND
+static int mtd_sim_block_isbad(struct mtd_info *mtd, mtd_addr_t offs);
+static int mtd_sim_block_markbad(struct mtd_info *mtd, mtd_addr_t offs);
+#endif
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  初始化仿真设备
+  * @param  sim 仿真设备 (调用者分配)
+  * @param  cfg 几何与延时配置
+  * @param  store 存储后端, 容量须不小于 size + 页数 x oobsize
+  * @param  ctx 传给后端的上下文
+  * @retval 0=成功, 负数=错误码
+  * @note   不改动存储内容, 全新存储需调用 mtd_sim_format()
+  */
+int mtd_sim_init(struct mtd_sim *sim, const struct mtd_sim_config *cfg,
+                 const struct mtd_sim_store *store, void *ctx)
+{
+    struct mtd_info *mtd;
+
+    if (!sim || !cfg || !store || !store->load || !store->save) {
+        log_e("mtd_sim_init: invalid argument.");
+        return -ERR_INVAL;
+    }
+
+    if (!cfg->erasesize || !cfg->writesize || cfg->erasesize % cfg->writesize ||
+        !cfg->size || cfg->size % cfg->erasesize ||
+        cfg->size / cfg->erasesize > MTD_SIM_MAX_BLOCKS) {
+        log_e("mtd_sim_init: bad geometry.");
+        return -ERR_INVAL;
+    }
+
+    if (cfg->type != MTD_NORFLASH && cfg->type != MTD_NANDFLASH)
+        return -ERR_NOTSUPP;
+
+    memset(sim, 0, sizeof(*sim));
+    sim->cfg = *cfg;
+    sim->store = store;
+    sim->ctx = ctx;
+    sim->nblocks = (uint32_t)(cfg->size / cfg->erasesize);
+    sim->fault.write_fail_after = MTD_SIM_FAULT_OFF;
+    sim->fault.erase_fail_after = MTD_SIM_FAULT_OFF;
+
+    if (cfg->type != MTD_NANDFLASH)
+        sim->cfg.oobsize = 0;
+
+    mtd = &sim->mtd;
+    mtd->name = cfg->name ? cfg->name : "mtd_sim";
+    mtd->type = cfg->type;
+    mtd->flags = MTD_SIM_IS_NAND(sim) ? MTD_CAP_NANDFLASH : MTD_CAP_NORFLASH;
+    mtd->size = cfg->size;
+    mtd->erasesize = cfg->erasesize;
+    mtd->writesize = MTD_SIM_IS_NAND(sim) ? cfg->writesize : 1;
+    mtd->writesize_shift = 0;
+    if (!(mtd->writesize & (mtd->writesize - 1))) {
+        while ((1UL << mtd->writesize_shift) < mtd->writesize)
+            mtd->writesize_shift++;
+    }
+
+    mtd->_read = mtd_sim_read;
+    mtd->_write = mtd_sim_write;
+    mtd->_erase = mtd_sim_erase;
+#if MTD_SUPPORT_IOVEC
+    if (!MTD_SIM_IS_NAND(sim))
+        mtd->_readv = mtd_sim_readv;
+#endif
+#if MTD_SUPPORT_ERASE_ASYNC
+    mtd->_erase_start = mtd_sim_erase_start;
+    mtd->_erase_wait = mtd_sim_erase_wait;
+#endif
+
+#if MTD_SUPPORT_OOB
+    mtd->oobsize = sim->cfg.oobsize;
+    mtd->oobavail = sim->cfg.oobsize;
+    if (sim->cfg.oobsize) {
+        mtd->_read_oob = mtd_sim_read_oob;
+        mtd->_write_oob = mtd_sim_write_oob;
+    }
+#endif
+
+#if MTD_SUPPORT_NAND
+    if (MTD_SIM_IS_NAND(sim)) {
+        mtd->block_isbad = mtd_sim_block_isbad;
+        mtd->block_markbad = mtd_sim_block_markbad;
+    }
+#endif
+
+    mtd->priv = sim;
+
+    return 0;
+}
+
+/**
+  * @brief  把整个存储 (含OOB) 置为擦除态, 不计入擦除次数与耗时
+  */
+int mtd_sim_format(struct mtd_sim *sim)
+{
+    if (!sim || !sim->store)
+        return -ERR_INVAL;
+
+    return mtd_sim_fill(sim, 0, (size_t)sim->cfg.size +
+                        (size_t)(sim->cfg.size / sim->cfg.writesize) * sim->cfg.oobsize);
+}
+
+/**
+  * @brief  模拟重新上电: 清除掉电状态并关闭写/擦除故障
+  */
+void mtd_sim_power_cycle(struct mtd_sim *sim)
+{
+    if (!sim)
+        return;
+
+    sim->fault.powered_off = 0;
+    sim->fault.write_fail_after = MTD_SIM_FAULT_OFF;
+    sim->fault.erase_fail_after = MTD_SIM_FAULT_OFF;
+}
+
+/**
+  * @brief  设置/清除坏块 (仿真出厂坏块或使用中损坏)
+  */
+int mtd_sim_set_bad(struct mtd_sim *sim, uint32_t block, int bad)
+{
+    if (!sim || block >= sim->nblocks)
+        return -ERR_INVAL;
+
+    if (bad)
+        sim->bad[block / 8] |= (uint8_t)(1U << (block % 8));
+    else
+        sim->bad[block / 8] &= (uint8_t)~(1U << (block % 8));
+
+    return 0;
+}
+
+void mtd_sim_reset_stats(struct mtd_sim *sim)
+{
+    if (sim)
+        memset(&sim->stats, 0, sizeof(sim->stats));
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  按延时模型累计设备时间
+  * @param  ops_us 阵列操作时间 (tR/tPP/tSE 之和)
+  * @param  bytes 总线传输字节数
+  */
+static void mtd_sim_account(struct mtd_sim *sim, uint32_t ops_us, size_t bytes)
+{
+    const struct mtd_sim_timing *t = &sim->cfg.timing;
+    uint64_t ns = t->cmd_ns + (uint64_t)ops_us * 1000U;
+
+    if (t->bus_kbps)
+        ns += (uint64_t)bytes * 1000000U / t->bus_kbps;
+
+    sim->stats.elapsed_ns += ns;
+
+    if (t->delay_us && ns >= 1000U)
+        t->delay_us((uint32_t)(ns / 1000U));
+}
+
+/**
+  * @brief  区间覆盖的页数
+  */
+static uint32_t mtd_sim_pages(struct mtd_sim *sim, mtd_addr_t addr, size_t len)
+{
+    uint32_t ps = sim->cfg.writesize;
+
+    if (!len)
+        return 0;
+
+    return (uint32_t)((addr + len - 1U) / ps - addr / ps + 1U);
+}
+
+/**
+  * @brief  故障计数递减, 到0时进入掉电状态
+  * @retval 1=本次操作被撕裂, 0=正常
+  */
+static int mtd_sim_fault_hit(struct mtd_sim *sim, long *counter)
+{
+    if (*counter == MTD_SIM_FAULT_OFF)
+        return 0;
+
+    if (*counter > 0) {
+        (*counter)--;
+        return 0;
+    }
+
+    *counter = MTD_SIM_FAULT_OFF;
+    sim->fault.powered_off = 1;
+    sim->stats.faults++;
+
+    return 1;
+}
+
+/**
+  * @brief  区间内不能有坏块
+  */
+static int mtd_sim_check_blocks(struct mtd_sim *sim, mtd_addr_t addr, size_t len)
+{
+    uint32_t b;
+    uint32_t last;
+
+    if (!len)
+        return 0;
+
+    last = (uint32_t)((addr + len - 1U) / sim->cfg.erasesize);
+    for (b = (uint32_t)(addr / sim->cfg.erasesize); b <= last; b++) {
+        if (sim->bad[b / 8] & (1U << (b % 8)))
+            return -ERR_IO;
+    }
+
+    return 0;
+}
+
+static int mtd_sim_fill(struct mtd_sim *sim, uint32_t off, size_t len)
+{
+    uint8_t ff[MTD_SIM_CHUNK];
+    size_t n;
+    int ret;
+
+    memset(ff, 0xFF, sizeof(ff));
+
+    while (len) {
+        n = (len > sizeof(ff)) ? sizeof(ff) : len;
+        ret = sim->store->save(sim->ctx, off, ff, n);
+        if (ret)
+            return ret;
+        off += (uint32_t)n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  按位与写入 (只能把1写为0)
+  */
+static int mtd_sim_program(struct mtd_sim *sim, uint32_t off, const uint8_t *buf, size_t len)
+{
+    uint8_t cell[MTD_SIM_CHUNK];
+    size_t n;
+    size_t i;
+    int over = 0;
+    int ret;
+
+    while (len) {
+        n = (len > sizeof(cell)) ? sizeof(cell) : len;
+        ret = sim->store->load(sim->ctx, off, cell, n);
+        if (ret)
+            return ret;
+
+        for (i = 0; i < n; i++) {
+            if (buf[i] & (uint8_t)~cell[i])
+                over = 1;
+            cell[i] &= buf[i];
+        }
+
+        ret = sim->store->save(sim->ctx, off, cell, n);
+        if (ret)
+            return ret;
+
+        off += (uint32_t)n;
+        buf += n;
+        len -= n;
+    }
+
+    if (over)
+        sim->stats.overprogram++;
+
+    return 0;
+}
+
+/**
+  * @brief  读取存储, 按配置注入单比特翻转 (只影响返回数据)
+  */
+static int mtd_sim_load(struct mtd_sim *sim, uint32_t off, uint8_t *buf, size_t len)
+{
+    struct mtd_sim_fault *f = &sim->fault;
+    uint32_t bit;
+    int ret;
+
+    ret = sim->store->load(sim->ctx, off, buf, len);
+    if (ret || !len)
+        return ret;
+
+    sim->stats.reads++;
+    if (f->read_flip_every && sim->stats.reads % f->read_flip_every == 0) {
+        /* xorshift32, 可复现 */
+        f->seed = f->seed ? f->seed : 0x2545F491UL;
+        f->seed ^= f->seed << 13;
+        f->seed ^= f->seed >> 17;
+        f->seed ^= f->seed << 5;
+        bit = f->seed % ((uint32_t)len * 8U);
+        buf[bit / 8] ^= (uint8_t)(1U << (bit % 8));
+        sim->stats.flips++;
+    }
+
+    return 0;
+}
+
+static int mtd_sim_read(struct mtd_info *mtd, mtd_addr_t from, size_t len, size_t *retlen, uint8_t *buf)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+    int ret;
+
+    if (sim->fault.powered_off)
+        return -ERR_IO;
+
+    if (from >= sim->cfg.size || len > sim->cfg.size - from)
+        return -ERR_INVAL;
+
+    ret = mtd_sim_load(sim, (uint32_t)from, buf, len);
+    if (ret)
+        return ret;
+
+    sim->stats.read_bytes += len;
+    mtd_sim_account(sim, MTD_SIM_IS_NAND(sim) ? mtd_sim_pages(sim, from, len) * sim->cfg.timing.read_us : 0,
+                    len);
+    *retlen = len;
+
+    return 0;
+}
+
+static int mtd_sim_write(struct mtd_info *mtd, mtd_addr_t to, size_t len, size_t *retlen, const uint8_t *buf)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+    int ret;
+
+    if (sim->fault.powered_off)
+        return -ERR_IO;
+
+    if (to >= sim->cfg.size || len > sim->cfg.size - to)
+        return -ERR_INVAL;
+
+    if (MTD_SIM_IS_NAND(sim) && ((to | len) % sim->cfg.writesize))
+        return -ERR_INVAL;
+
+    ret = mtd_sim_check_blocks(sim, to, len);
+    if (ret)
+        return ret;
+
+    sim->stats.writes++;
+    mtd_sim_account(sim, mtd_sim_pages(sim, to, len) * sim->cfg.timing.prog_us, len);
+
+    if (mtd_sim_fault_hit(sim, &sim->fault.write_fail_after)) {
+        mtd_sim_program(sim, (uint32_t)to, buf, len / 2U);
+        return -ERR_IO;
+    }
+
+    ret = mtd_sim_program(sim, (uint32_t)to, buf, len);
+    if (ret)
+        return ret;
+
+    sim->stats.write_bytes += len;
+    *retlen = len;
+
+    return 0;
+}
+
+#if MTD_SUPPORT_IOVEC
+/**
+  * @brief  NOR多段读, 整批按一次总线事务计时
+  */
+static int mtd_sim_readv(struct mtd_info *mtd, const struct mtd_iovec *vec, uint32_t cnt)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+    size_t bytes = 0;
+    uint32_t i;
+    int ret;
+
+    if (sim->fault.powered_off)
+        return -ERR_IO;
+
+    for (i = 0; i < cnt; i++) {
+        if (vec[i].offset >= sim->cfg.size || vec[i].len > sim->cfg.size - vec[i].offset)
+            return -ERR_INVAL;
+
+        ret = mtd_sim_load(sim, (uint32_t)vec[i].offset, (uint8_t *)vec[i].buf, vec[i].len);
+        if (ret)
+            return ret;
+        bytes += vec[i].len;
+    }
+
+    sim->stats.read_bytes += bytes;
+    mtd_sim_account(sim, 0, bytes);
+
+    return 0;
+}
+#endif
+
+static int mtd_sim_erase(struct mtd_info *mtd, struct erase_info *instr)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+    uint32_t es = sim->cfg.erasesize;
+    uint32_t pages = es / sim->cfg.writesize;
+    mtd_addr_t addr;
+    uint32_t b;
+    int ret;
+
+    if ((instr->addr | instr->len) % es)
+        return -ERR_INVAL;
+
+    for (addr = instr->addr; addr < instr->addr + instr->len; addr += es) {
+        b = (uint32_t)(addr / es);
+
+        if (sim->fault.powered_off) {
+            instr->fail_addr = addr;
+            return -ERR_IO;
+        }
+
+        if ((sim->bad[b / 8] & (1U << (b % 8))) ||
+            (sim->cfg.erase_limit && sim->erase_count[b] >= sim->cfg.erase_limit)) {
+            instr->fail_addr = addr;
+            return -ERR_IO;
+        }
+
+        sim->stats.erases++;
+        mtd_sim_account(sim, sim->cfg.timing.erase_us, 0);
+
+        if (mtd_sim_fault_hit(sim, &sim->fault.erase_fail_after)) {
+            mtd_sim_fill(sim, (uint32_t)addr, es / 2U);
+            instr->fail_addr = addr;
+            return -ERR_IO;
+        }
+
+        ret = mtd_sim_fill(sim, (uint32_t)addr, es);
+        if (!ret && sim->cfg.oobsize)
+            ret = mtd_sim_fill(sim, (uint32_t)sim->cfg.size + b * pages * sim->cfg.oobsize,
+                               (size_t)pages * sim->cfg.oobsize);
+        if (ret) {
+            instr->fail_addr = addr;
+            return ret;
+        }
+
+        sim->erase_count[b]++;
+    }
+
+    return 0;
+}
+
+#if MTD_SUPPORT_ERASE_ASYNC
+/**
+  * @brief  分段擦除: 立即完成擦除, 结果留到 _erase_wait 返回 (不模拟并行耗时)
+  */
+static int mtd_sim_erase_start(struct mtd_info *mtd, mtd_addr_t addr)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+    struct erase_info instr;
+
+    if (sim->erase_pending)
+        return -ERR_BUSY;
+
+    instr.addr = addr;
+    instr.len = sim->cfg.erasesize;
+    instr.fail_addr = MTD_FAIL_ADDR_UNKNOWN;
+    sim->erase_result = mtd_sim_erase(mtd, &instr);
+    sim->erase_pending = 1;
+
+    return 0;
+}
+
+static int mtd_sim_erase_wait(struct mtd_info *mtd)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+
+    if (!sim->erase_pending)
+        return 0;
+
+    sim->erase_pending = 0;
+
+    return sim->erase_result;
+}
+#endif /* MTD_SUPPORT_ERASE_ASYNC */
+
+#if MTD_SUPPORT_OOB
+/**
+  * @brief  数据与OOB读, OOB按页连续拼接, 首页从 ooboffs 开始
+  */
+static int mtd_sim_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+    uint32_t page = (uint32_t)(from / sim->cfg.writesize);
+    uint32_t off = ops->ooboffs;
+    size_t n;
+    int ret;
+
+    if (ops->len) {
+        ret = mtd_sim_read(mtd, from, ops->len, &ops->retlen, ops->datbuf);
+        if (ret)
+            return ret;
+    }
+
+    while (ops->oobretlen < ops->ooblen) {
+        if (sim->fault.powered_off)
+            return -ERR_IO;
+
+        n = sim->cfg.oobsize - off;
+        if (n > ops->ooblen - ops->oobretlen)
+            n = ops->ooblen - ops->oobretlen;
+
+        ret = mtd_sim_load(sim, (uint32_t)sim->cfg.size + page * sim->cfg.oobsize + off,
+                           ops->oobbuf + ops->oobretlen, n);
+        if (ret)
+            return ret;
+
+        /* 仅读OOB时同样需要整页载入 */
+        mtd_sim_account(sim, ops->len ? 0 : sim->cfg.timing.read_us, n);
+        ops->oobretlen += n;
+        off = 0;
+        page++;
+    }
+
+    return 0;
+}
+
+static int mtd_sim_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+    uint32_t page = (uint32_t)(to / sim->cfg.writesize);
+    uint32_t off = ops->ooboffs;
+    size_t n;
+    int ret;
+
+    if (ops->len) {
+        ret = mtd_sim_write(mtd, to, ops->len, &ops->retlen, ops->datbuf);
+        if (ret)
+            return ret;
+    }
+
+    while (ops->oobretlen < ops->ooblen) {
+        if (sim->fault.powered_off)
+            return -ERR_IO;
+
+        ret = mtd_sim_check_blocks(sim, (mtd_addr_t)page * sim->cfg.writesize, 1);
+        if (ret)
+            return ret;
+
+        n = sim->cfg.oobsize - off;
+        if (n > ops->ooblen - ops->oobretlen)
+            n = ops->ooblen - ops->oobretlen;
+
+        ret = mtd_sim_program(sim, (uint32_t)sim->cfg.size + page * sim->cfg.oobsize + off,
+                              ops->oobbuf + ops->oobretlen, n);
+        if (ret)
+            return ret;
+
+        mtd_sim_account(sim, ops->len ? 0 : sim->cfg.timing.prog_us, n);
+        ops->oobretlen += n;
+        off = 0;
+        page++;
+    }
+
+    return 0;
+}
+#endif /* MTD_SUPPORT_OOB */
+
+#if MTD_SUPPORT_NAND
+static int mtd_sim_block_isbad(struct mtd_info *mtd, mtd_addr_t offs)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+    uint32_t b = (uint32_t)(offs / sim->cfg.erasesize);
+
+    if (b >= sim->nblocks)
+        return -ERR_INVAL;
+
+    return (sim->bad[b / 8] >> (b % 8)) & 1U;
+}
+
+static int mtd_sim_block_markbad(struct mtd_info *mtd, mtd_addr_t offs)
+{
+    struct mtd_sim *sim = (struct mtd_sim *)mtd->priv;
+
+    return mtd_sim_set_bad(sim, (uint32_t)(offs / sim->cfg.erasesize), 1);
+}
+#endif /* MTD_SUPPORT_NAND */
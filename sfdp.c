@@ -13,6 +13,10 @@
   */
 /* Includes ------------------------------------------------------------------*/
 #include "sfdp.h"
+#include "spi_nor.h"
+#include "errno-base.h"
+#include <string.h>
+
 /* Private typedef -----------------------------------------------------------*/
 
 /* Private define ------------------------------------------------------------*/
@@ -38,15 +42,551 @@
                                      */
 
 #define SFDP_SIGNATURE		0x50444653U
+
+#define SFDP_PARAM_HEADER_MAX	8	/* 最多处理的参数头数量 (含BFPT) */
+#define SFDP_READ_DUMMY		8	/* RDSFDP 固定 8 个 dummy 周期 */
+
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
+/* BFPT中快速读能力位与设置字的位置 */
+static const struct sfdp_bfpt_read {
+    uint32_t    hwcaps;
+    uint32_t    supported_dword;
+    uint32_t    supported_bit;
+    uint32_t    settings_dword;
+    uint32_t    settings_shift;
+    enum spi_nor_protocol proto;
+    uint8_t     cmd;
+} sfdp_bfpt_reads[] = {
+    { SNOR_HWCAPS_READ_1_1_2, SFDP_DWORD(1), BFPT_DWORD1_FAST_READ_1_1_2,
+      SFDP_DWORD(4), 0, SNOR_PROTO_1_1_2, SNOR_CMD_READ_1_1_2 },
+    { SNOR_HWCAPS_READ_1_2_2, SFDP_DWORD(1), BFPT_DWORD1_FAST_READ_1_2_2,
+      SFDP_DWORD(4), 16, SNOR_PROTO_1_2_2, SNOR_CMD_READ_1_2_2 },
+    { SNOR_HWCAPS_READ_1_1_4, SFDP_DWORD(1), BFPT_DWORD1_FAST_READ_1_1_4,
+      SFDP_DWORD(3), 16, SNOR_PROTO_1_1_4, SNOR_CMD_READ_1_1_4 },
+    { SNOR_HWCAPS_READ_1_4_4, SFDP_DWORD(1), BFPT_DWORD1_FAST_READ_1_4_4,
+      SFDP_DWORD(3), 0, SNOR_PROTO_1_4_4, SNOR_CMD_READ_1_4_4 },
+};
+
+/* DTR快速读: BFPT仅有DWORD1总支持位, 操作码与dummy周期需由厂商修正提供 */
+static const struct sfdp_bfpt_dtr_read {
+    uint32_t    hwcaps;
+    uint8_t     cmd;
+} sfdp_bfpt_dtr_reads[] = {
+    { SNOR_HWCAPS_READ_1_1_1_DTR, SNOR_CMD_READ_1_1_1_DTR },
+    { SNOR_HWCAPS_READ_1_2_2_DTR, SNOR_CMD_READ_1_2_2_DTR },
+    { SNOR_HWCAPS_READ_1_4_4_DTR, SNOR_CMD_READ_1_4_4_DTR },
+};
+
+/* BFPT延迟字段的单位: 128ns/1us/8us/64us */
+static const uint16_t sfdp_latency_units_ns[] = { 128, 1000, 8000, 64000 };
+
+/* 4BAIT中各协议对应的能力位 */
+static const struct sfdp_4bait {
+    uint32_t    hwcaps;
+    uint32_t    supported_bit;
+} sfdp_4bait_caps[] = {
+    { SNOR_HWCAPS_READ,             BAIT_DWORD1_READ },
+    { SNOR_HWCAPS_READ_FAST,        BAIT_DWORD1_READ_FAST },
+    { SNOR_HWCAPS_READ_1_1_1_DTR,   BAIT_DWORD1_READ_1_1_1_DTR },
+    { SNOR_HWCAPS_READ_1_1_2,       BAIT_DWORD1_READ_1_1_2 },
+    { SNOR_HWCAPS_READ_1_2_2,       BAIT_DWORD1_READ_1_2_2 },
+    { SNOR_HWCAPS_READ_1_2_2_DTR,   BAIT_DWORD1_READ_1_2_2_DTR },
+    { SNOR_HWCAPS_READ_1_1_4,       BAIT_DWORD1_READ_1_1_4 },
+    { SNOR_HWCAPS_READ_1_4_4,       BAIT_DWORD1_READ_1_4_4 },
+    { SNOR_HWCAPS_READ_1_4_4_DTR,   BAIT_DWORD1_READ_1_4_4_DTR },
+    { SNOR_HWCAPS_PP,               BAIT_DWORD1_PP },
+    { SNOR_HWCAPS_PP_1_1_4,         BAIT_DWORD1_PP_1_1_4 },
+    { SNOR_HWCAPS_PP_1_4_4,         BAIT_DWORD1_PP_1_4_4 },
+};
 
 /* Exported variables  -------------------------------------------------------*/
 
 /* Private function prototypes -----------------------------------------------*/
+static int sfdp_read(struct spi_nor *nor, uint32_t addr, size_t len, void *buf);
+static void sfdp_le32_to_cpu_array(uint32_t *dwords, size_t count);
+static int sfdp_parse_bfpt(struct spi_nor *nor,
+                           const struct sfdp_parameter_header *bfpt_header);
+static int sfdp_parse_4bait(struct spi_nor *nor,
+                            const struct sfdp_parameter_header *param_header);
+static int sfdp_smpt_map_in_use(struct spi_nor *nor, const uint32_t *smpt,
+                                uint32_t ndwords);
+static int sfdp_parse_smpt(struct spi_nor *nor,
+                           const struct sfdp_parameter_header *param_header);
 
 /* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  Parse the SFDP tables and fill nor->params.
+ * @param  nor  SPI NOR device, params must already hold the defaults
+ * @retval 0 on success, negative error code if SFDP is absent or invalid.
+ *         On failure nor->params is restored to the defaults passed in.
+ */
+int spi_nor_parse_sfdp(struct spi_nor *nor)
+{
+    struct sfdp_header header;
+    struct sfdp_parameter_header param_headers[SFDP_PARAM_HEADER_MAX];
+    struct spi_nor_flash_parameter saved;
+    const struct sfdp_parameter_header *bfpt_header;
+    const struct sfdp_parameter_header *param_header;
+    uint32_t nph;
+    uint32_t i;
+    int ret;
+
+    if (!nor || !nor->spi)
+        return -EINVAL;
+
+    ret = sfdp_read(nor, 0, sizeof(header), &header);
+    if (ret < 0)
+        return ret;
+
+    sfdp_le32_to_cpu_array(&header.signature, 1);
+    if (header.signature != SFDP_SIGNATURE ||
+        header.major != SFDP_JESD216_MAJOR)
+            return -ENOTSUPP;
+
+    /* BFPT必须为第一个参数头, 且至少满足JESD216的9个DWORD */
+    bfpt_header = &header.bfpt_header;
+    if (SFDP_PARAM_HEADER_ID(bfpt_header) != SFDP_BFPT_ID ||
+        bfpt_header->major != SFDP_JESD216_MAJOR)
+            return -EINVAL;
+
+    nph = header.nph;
+    if (nph >= SFDP_PARAM_HEADER_MAX)
+        nph = SFDP_PARAM_HEADER_MAX - 1U;
+
+    if (nph) {
+        ret = sfdp_read(nor, sizeof(header),
+                        nph * sizeof(param_headers[0]), param_headers);
+        if (ret < 0)
+            return ret;
+    }
+
+    /* 选用同一主版本下最新的BFPT */
+    for (i = 0; i < nph; i++) {
+        param_header = &param_headers[i];
+
+        if (SFDP_PARAM_HEADER_ID(param_header) == SFDP_BFPT_ID &&
+            param_header->major == SFDP_JESD216_MAJOR &&
+            param_header->minor >= bfpt_header->minor &&
+            param_header->length >= bfpt_header->length)
+                bfpt_header = param_header;
+    }
+
+    saved = nor->params;
+    ret = sfdp_parse_bfpt(nor, bfpt_header);
+    if (ret < 0) {
+        nor->params = saved;
+        return ret;
+    }
+
+    nor->flags |= SNOR_F_HAS_SFDP;
+
+    /* 可选参数表解析失败不影响BFPT结果 */
+    for (i = 0; i < nph; i++) {
+        param_header = &param_headers[i];
+
+        switch (SFDP_PARAM_HEADER_ID(param_header)) {
+        case SFDP_4BAIT_ID:
+            if (sfdp_parse_4bait(nor, param_header) == 0)
+                nor->flags |= SNOR_F_HAS_4BAIT;
+            break;
+
+        case SFDP_SECTOR_MAP_ID:
+            nor->params.smpt_addr = SFDP_PARAM_HEADER_PTP(param_header);
+            nor->params.smpt_len = SFDP_PARAM_HEADER_PARAM_LEN(param_header);
+            nor->flags |= SNOR_F_HAS_SMPT;
+            /* 解析失败时按均匀扇区处理 */
+            (void)sfdp_parse_smpt(nor, param_header);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return 0;
+}
 
 /* Private functions ---------------------------------------------------------*/
+static int sfdp_read(struct spi_nor *nor, uint32_t addr, size_t len, void *buf)
+{
+    struct spi_nor_op op = {
+        .opcode = SPINOR_CMD_RDSFDP,
+        .addr_nbytes = 3,
+        .dummy_cycles = SFDP_READ_DUMMY,
+        .addr = addr,
+        .proto = SNOR_PROTO_1_1_1,
+        .rx_buf = buf,
+        .len = len,
+    };
+
+    return spi_nor_exec_op(nor, &op);
+}
+
+static void sfdp_le32_to_cpu_array(uint32_t *dwords, size_t count)
+{
+    const uint8_t *p;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        p = (const uint8_t *)&dwords[i];
+        dwords[i] = ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) |
+                    ((uint32_t)p[1] << 8) | (uint32_t)p[0];
+    }
+}
+
+static void sfdp_set_read_settings(struct spi_nor_read_command *read,
+                                   uint16_t half, enum spi_nor_protocol proto)
+{
+    read->num_mode_clocks = (half & BFPT_SETTINGS_MODE_CLOCKS_MASK) >>
+                            BFPT_SETTINGS_MODE_CLOCKS_SHIFT;
+    read->num_wait_states = half & BFPT_SETTINGS_WAIT_STATES_MASK;
+    read->opcode = (half >> BFPT_SETTINGS_OPCODE_SHIFT) & 0xFFU;
+    read->proto = proto;
+}
+
+static int sfdp_parse_bfpt(struct spi_nor *nor,
+                           const struct sfdp_parameter_header *bfpt_header)
+{
+    struct spi_nor_flash_parameter *params = &nor->params;
+    struct sfdp_bfpt bfpt;
+    const struct sfdp_bfpt_read *rd;
+    struct spi_nor_erase_type *erase;
+    uint32_t addr;
+    size_t len;
+    uint64_t bits;
+    uint16_t half;
+    uint32_t i;
+    int ret;
+
+    if (bfpt_header->length < BFPT_DWORD_MAX_JESD216)
+        return -EINVAL;
+
+    len = SFDP_PARAM_HEADER_PARAM_LEN(bfpt_header);
+    if (len > sizeof(bfpt))
+        len = sizeof(bfpt);
+
+    addr = SFDP_PARAM_HEADER_PTP(bfpt_header);
+    (void)memset(&bfpt, 0, sizeof(bfpt));
+    ret = sfdp_read(nor, addr, len, &bfpt);
+    if (ret < 0)
+        return ret;
+
+    sfdp_le32_to_cpu_array(bfpt.dwords, BFPT_DWORD_MAX);
+
+    /* 地址字节数 */
+    switch (bfpt.dwords[SFDP_DWORD(1)] & BFPT_DWORD1_ADDRESS_BYTES_MASK) {
+    case BFPT_DWORD1_ADDRESS_BYTES_3_ONLY:
+    case BFPT_DWORD1_ADDRESS_BYTES_3_OR_4:
+        params->addr_nbytes = 3;
+        break;
+    case BFPT_DWORD1_ADDRESS_BYTES_4_ONLY:
+        params->addr_nbytes = 4;
+        break;
+    default:
+        break;
+    }
+
+    /* 容量 */
+    if (bfpt.dwords[SFDP_DWORD(2)] & BFPT_DWORD2_DENSITY_4G_MORE) {
+        i = bfpt.dwords[SFDP_DWORD(2)] & ~BFPT_DWORD2_DENSITY_4G_MORE;
+        if (i > 35U)
+            return -EINVAL;
+        bits = 1ULL << i;
+    } else {
+        bits = (uint64_t)bfpt.dwords[SFDP_DWORD(2)] + 1U;
+    }
+    bits >>= 3;
+    if (bits == 0U || bits > 0xFFFFFFFFULL)
+        return -EINVAL;
+    params->size = (uint32_t)bits;
+
+    /* 快速读协议 */
+    for (i = 0; i < sizeof(sfdp_bfpt_reads) / sizeof(sfdp_bfpt_reads[0]); i++) {
+        rd = &sfdp_bfpt_reads[i];
+
+        if (!(bfpt.dwords[rd->supported_dword] & rd->supported_bit)) {
+            params->hwcaps &= ~rd->hwcaps;
+            continue;
+        }
+
+        params->hwcaps |= rd->hwcaps;
+        half = (uint16_t)(bfpt.dwords[rd->settings_dword] >> rd->settings_shift);
+        sfdp_set_read_settings(&params->reads[rd->cmd], half, rd->proto);
+    }
+
+    /* DTR读: 器件不支持或修正未给出操作码时不参与协议选择 */
+    for (i = 0; i < sizeof(sfdp_bfpt_dtr_reads) / sizeof(sfdp_bfpt_dtr_reads[0]); i++) {
+        if (!(bfpt.dwords[SFDP_DWORD(1)] & BFPT_DWORD1_DTR) ||
+            params->reads[sfdp_bfpt_dtr_reads[i].cmd].opcode == 0U)
+                params->hwcaps &= ~sfdp_bfpt_dtr_reads[i].hwcaps;
+    }
+
+    /* 擦除类型: DWORD8/9 各含两个 */
+    for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+        erase = &params->erase_types[i];
+        half = (uint16_t)(bfpt.dwords[SFDP_DWORD(8) + (i >> 1)] >> ((i & 1U) * 16U));
+
+        erase->size_shift = half & BFPT_ERASE_SIZE_SHIFT_MASK;
+        erase->opcode = (half >> BFPT_ERASE_OPCODE_SHIFT) & 0xFFU;
+        erase->size = (erase->size_shift && erase->size_shift < 32U) ?
+                      (1UL << erase->size_shift) : 0U;
+    }
+
+    /* JESD216 初版到此为止 */
+    if (bfpt_header->length < BFPT_DWORD_MAX_JESD216B) {
+        params->quad_enable = spi_nor_sr2_bit1_quad_enable;
+        return 0;
+    }
+
+    /* 页大小 */
+    params->page_size = 1UL << ((bfpt.dwords[SFDP_DWORD(11)] & BFPT_DWORD11_PAGE_SIZE_MASK) >>
+                                BFPT_DWORD11_PAGE_SIZE_SHIFT);
+
+    /* 典型/最大 擦除与页编程时间 */
+    for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+        static const uint16_t erase_units_ms[] = { 1, 16, 128, 1000 };
+        uint32_t field;
+
+        erase = &params->erase_types[i];
+        if (!erase->size)
+            continue;
+
+        field = bfpt.dwords[SFDP_DWORD(10)] >> BFPT_DWORD10_ERASE_TYP_SHIFT(i);
+        erase->typ_ms = ((field & BFPT_ERASE_TYP_COUNT_MASK) + 1U) *
+                        erase_units_ms[(field >> BFPT_ERASE_TYP_UNIT_SHIFT) & 0x3U];
+        erase->max_ms = erase->typ_ms * 2U *
+                        ((bfpt.dwords[SFDP_DWORD(10)] & BFPT_DWORD10_ERASE_MULT_MASK) + 1U);
+    }
+
+    {
+        uint32_t field = bfpt.dwords[SFDP_DWORD(11)] >> BFPT_DWORD11_PP_TYP_SHIFT;
+
+        params->page_program_typ_us = ((field & BFPT_DWORD11_PP_TYP_COUNT_MASK) + 1U) *
+                                      ((field & BFPT_DWORD11_PP_TYP_UNIT_64US) ? 64U : 8U);
+        params->page_program_max_us = params->page_program_typ_us * 2U *
+                        ((bfpt.dwords[SFDP_DWORD(11)] & BFPT_DWORD11_PROGRAM_MULT_MASK) + 1U);
+    }
+
+    /* 擦写暂停/恢复 */
+    if (!(bfpt.dwords[SFDP_DWORD(12)] & BFPT_DWORD12_SUSPEND_UNSUPPORTED)) {
+        uint32_t field = bfpt.dwords[SFDP_DWORD(12)] >> BFPT_DWORD12_SUSPEND_LAT_SHIFT;
+        uint32_t dw13 = bfpt.dwords[SFDP_DWORD(13)];
+
+        params->suspend_latency_us = (((field & BFPT_DWORD12_SUSPEND_LAT_COUNT_MASK) + 1U) *
+                                      sfdp_latency_units_ns[(field >> BFPT_DWORD12_SUSPEND_LAT_UNIT_SHIFT) & 0x3U] +
+                                      999U) / 1000U;
+        params->resume_to_suspend_us = (((bfpt.dwords[SFDP_DWORD(12)] >>
+                                          BFPT_DWORD12_RESUME_TO_SUSPEND_SHIFT) &
+                                         BFPT_DWORD12_RESUME_TO_SUSPEND_MASK) + 1U) * 64U;
+        params->erase_suspend_opcode = (dw13 >> BFPT_DWORD13_ERASE_SUSPEND_SHIFT) & 0xFFU;
+        params->erase_resume_opcode = (dw13 >> BFPT_DWORD13_ERASE_RESUME_SHIFT) & 0xFFU;
+        params->program_suspend_opcode = (dw13 >> BFPT_DWORD13_PROGRAM_SUSPEND_SHIFT) & 0xFFU;
+        params->program_resume_opcode = (dw13 >> BFPT_DWORD13_PROGRAM_RESUME_SHIFT) & 0xFFU;
+        nor->flags |= SNOR_F_SUSPEND;
+    } else {
+        nor->flags &= ~SNOR_F_SUSPEND;
+    }
+
+    /* 深度掉电退出时间 (tRES1) */
+    if (bfpt.dwords[SFDP_DWORD(14)] & BFPT_DWORD14_DPD_UNSUPPORTED) {
+        nor->flags |= SNOR_F_NO_DPD;
+    } else {
+        uint32_t field = bfpt.dwords[SFDP_DWORD(14)] >> BFPT_DWORD14_DPD_EXIT_SHIFT;
+
+        params->release_power_down_us = (((field & BFPT_DWORD14_DPD_EXIT_COUNT_MASK) + 1U) *
+                                         sfdp_latency_units_ns[(field >> BFPT_DWORD14_DPD_EXIT_UNIT_SHIFT) & 0x3U] +
+                                         999U) / 1000U;
+    }
+
+    /* QE位要求 */
+    switch (bfpt.dwords[SFDP_DWORD(15)] & BFPT_DWORD15_QER_MASK) {
+    case BFPT_DWORD15_QER_NONE:
+        params->quad_enable = NULL;
+        break;
+    case BFPT_DWORD15_QER_SR1_BIT6:
+        params->quad_enable = spi_nor_sr1_bit6_quad_enable;
+        break;
+    case BFPT_DWORD15_QER_SR2_BIT7:
+        params->quad_enable = spi_nor_sr2_bit7_quad_enable;
+        break;
+    case BFPT_DWORD15_QER_SR2_BIT1_BUGGY:
+    case BFPT_DWORD15_QER_SR2_BIT1_NO_RD:
+    case BFPT_DWORD15_QER_SR2_BIT1:
+    default:
+        params->quad_enable = spi_nor_sr2_bit1_quad_enable;
+        break;
+    }
+
+    return 0;
+}
+
+static int sfdp_parse_4bait(struct spi_nor *nor,
+                            const struct sfdp_parameter_header *param_header)
+{
+    struct spi_nor_flash_parameter *params = &nor->params;
+    uint32_t dwords[BAIT_DWORD_MAX];
+    uint32_t i;
+    int ret;
+
+    if (param_header->length < BAIT_DWORD_MAX)
+        return -EINVAL;
+
+    ret = sfdp_read(nor, SFDP_PARAM_HEADER_PTP(param_header),
+                    sizeof(dwords), dwords);
+    if (ret < 0)
+        return ret;
+
+    sfdp_le32_to_cpu_array(dwords, BAIT_DWORD_MAX);
+
+    params->bait_hwcaps = 0;
+    for (i = 0; i < sizeof(sfdp_4bait_caps) / sizeof(sfdp_4bait_caps[0]); i++) {
+        if (dwords[SFDP_DWORD(1)] & sfdp_4bait_caps[i].supported_bit)
+            params->bait_hwcaps |= sfdp_4bait_caps[i].hwcaps;
+    }
+
+    /* DWORD2 依次为擦除类型1~4的4字节地址命令 */
+    for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+        if (dwords[SFDP_DWORD(1)] & BAIT_DWORD1_ERASE_TYPE(i))
+            params->bait_erase_opcodes[i] = (dwords[SFDP_DWORD(2)] >> (i * 8U)) & 0xFFU;
+        else
+            params->bait_erase_opcodes[i] = 0;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief  依次执行配置检测命令拼出配置号, 查找对应的配置映射
+ * @retval 映射头在smpt中的下标, 负数=错误码
+ */
+static int sfdp_smpt_map_in_use(struct spi_nor *nor, const uint32_t *smpt,
+                                uint32_t ndwords)
+{
+    struct spi_nor_op op;
+    uint32_t dummy;
+    uint32_t i;
+    uint8_t map_id = 0;
+    uint8_t data;
+    int ret;
+
+    for (i = 0; i + 1U < ndwords; i += 2U) {
+        if (smpt[i] & SMPT_DESC_TYPE_MAP)
+            break;
+
+        (void)memset(&op, 0, sizeof(op));
+        op.opcode = (smpt[i] >> SMPT_CMD_OPCODE_SHIFT) & 0xFFU;
+
+        switch (smpt[i] & SMPT_CMD_ADDRESS_LEN_MASK) {
+        case SMPT_CMD_ADDRESS_LEN_0:
+            op.addr_nbytes = 0;
+            break;
+        case SMPT_CMD_ADDRESS_LEN_3:
+            op.addr_nbytes = 3;
+            break;
+        case SMPT_CMD_ADDRESS_LEN_4:
+            op.addr_nbytes = 4;
+            break;
+        default:
+            op.addr_nbytes = nor->params.addr_nbytes;
+            break;
+        }
+
+        /* 可变延迟取上电默认的8个周期 */
+        dummy = (smpt[i] & SMPT_CMD_READ_DUMMY_MASK) >> SMPT_CMD_READ_DUMMY_SHIFT;
+        op.dummy_cycles = (dummy == SMPT_CMD_READ_DUMMY_IS_VARIABLE) ?
+                          SFDP_READ_DUMMY : (uint8_t)dummy;
+        op.addr = smpt[i + 1U];
+        op.proto = SNOR_PROTO_1_1_1;
+        op.rx_buf = &data;
+        op.len = 1;
+
+        ret = spi_nor_exec_op(nor, &op);
+        if (ret < 0)
+            return ret;
+
+        map_id = (uint8_t)(map_id << 1) |
+                 ((data & (smpt[i] >> SMPT_CMD_READ_DATA_SHIFT)) ? 1U : 0U);
+    }
+
+    /* 没有检测命令时只有一种配置, 配置号为0 */
+    while (i < ndwords && (smpt[i] & SMPT_DESC_TYPE_MAP)) {
+        if (((smpt[i] & SMPT_MAP_ID_MASK) >> SMPT_MAP_ID_SHIFT) == map_id)
+            return (int)i;
+        if (smpt[i] & SMPT_DESC_END)
+            break;
+        i += ((smpt[i] & SMPT_MAP_REGION_COUNT_MASK) >> SMPT_MAP_REGION_COUNT_SHIFT) + 2U;
+    }
+
+    return -EINVAL;
+}
+
+/**
+ * @brief  解析扇区映射表, 生成当前配置下的擦除区域
+ * @note   区域边界未按某擦除类型对齐时 (与参数扇区重叠的大扇区), 该类型不在此区域使用
+ */
+static int sfdp_parse_smpt(struct spi_nor *nor,
+                           const struct sfdp_parameter_header *param_header)
+{
+    struct spi_nor_flash_parameter *params = &nor->params;
+    const struct spi_nor_erase_type *erase;
+    uint32_t smpt[SMPT_DWORD_MAX];
+    uint32_t ndwords = param_header->length;
+    uint32_t nregions;
+    uint32_t offset = 0;
+    uint32_t size;
+    uint32_t i;
+    uint32_t j;
+    uint8_t mask;
+    int idx;
+    int ret;
+
+    params->n_regions = 0;
+
+    if (!ndwords || ndwords > SMPT_DWORD_MAX)
+        return -ENOTSUPP;
+
+    ret = sfdp_read(nor, SFDP_PARAM_HEADER_PTP(param_header),
+                    ndwords * sizeof(smpt[0]), smpt);
+    if (ret < 0)
+        return ret;
+
+    sfdp_le32_to_cpu_array(smpt, ndwords);
+
+    idx = sfdp_smpt_map_in_use(nor, smpt, ndwords);
+    if (idx < 0)
+        return idx;
+
+    nregions = ((smpt[idx] & SMPT_MAP_REGION_COUNT_MASK) >> SMPT_MAP_REGION_COUNT_SHIFT) + 1U;
+    if (nregions > SNOR_ERASE_REGION_MAX || (uint32_t)idx + nregions >= ndwords)
+        return -EINVAL;
+
+    for (i = 0; i < nregions; i++) {
+        size = (((smpt[idx + 1 + i] & SMPT_MAP_REGION_SIZE_MASK) >>
+                 SMPT_MAP_REGION_SIZE_SHIFT) + 1U) * 256U;
+        mask = (uint8_t)(smpt[idx + 1 + i] & SMPT_MAP_REGION_ERASE_TYPE_MASK);
+
+        for (j = 0; j < SNOR_ERASE_TYPE_MAX; j++) {
+            erase = &params->erase_types[j];
+            if (!(mask & BIT(j)))
+                continue;
+            if (!erase->size || ((offset | size) & (erase->size - 1U)))
+                mask &= (uint8_t)~BIT(j);
+        }
+        if (!mask)
+            return -EINVAL;
+
+        params->regions[i].offset = offset;
+        params->regions[i].size = size;
+        params->regions[i].erase_mask = mask;
+        offset += size;
+    }
+
+    if (offset != params->size)
+        return -EINVAL;
+
+    params->n_regions = (uint8_t)nregions;
 
+    return 0;
+}
@@ -0,0 +1,184 @@
+/**
+  ******************************************************************************
+  * @file        : sha256.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SHA-256 (FIPS 180-4) 流式摘要
+  * @attention   : 整块数据直接从输入缓冲压缩, 不经过 ctx->buf 拷贝
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "sha256.h"
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+#define ROR32(x, n)     (((x) >> (n)) | ((x) << (32U - (n))))
+#define CH(x, y, z)     (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z)    (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define EP0(x)          (ROR32(x, 2) ^ ROR32(x, 13) ^ ROR32(x, 22))
+#define EP1(x)          (ROR32(x, 6) ^ ROR32(x, 11) ^ ROR32(x, 25))
+#define SIG0(x)         (ROR32(x, 7) ^ ROR32(x, 18) ^ ((x) >> 3))
+#define SIG1(x)         (ROR32(x, 17) ^ ROR32(x, 19) ^ ((x) >> 10))
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void sha256_transform(uint32_t state[8], const uint8_t *blk);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  初始化摘要上下文
+  * @param  ctx 上下文
+  */
+void sha256_init(struct sha256_ctx *ctx)
+{
+    ctx->state[0] = 0x6a09e667;
+    ctx->state[1] = 0xbb67ae85;
+    ctx->state[2] = 0x3c6ef372;
+    ctx->state[3] = 0xa54ff53a;
+    ctx->state[4] = 0x510e527f;
+    ctx->state[5] = 0x9b05688c;
+    ctx->state[6] = 0x1f83d9ab;
+    ctx->state[7] = 0x5be0cd19;
+    ctx->count = 0;
+    ctx->buflen = 0;
+}
+
+/**
+  * @brief  输入数据
+  * @param  ctx 上下文
+  * @param  data 数据
+  * @param  len 长度
+  */
+void sha256_update(struct sha256_ctx *ctx, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    size_t n;
+
+    ctx->count += len;
+
+    if (ctx->buflen) {
+        n = SHA256_BLOCK_SIZE - ctx->buflen;
+        if (n > len)
+            n = len;
+        (void)memcpy(&ctx->buf[ctx->buflen], p, n);
+        ctx->buflen += (uint32_t)n;
+        p += n;
+        len -= n;
+        if (ctx->buflen < SHA256_BLOCK_SIZE)
+            return;
+        sha256_transform(ctx->state, ctx->buf);
+        ctx->buflen = 0;
+    }
+
+    while (len >= SHA256_BLOCK_SIZE) {
+        sha256_transform(ctx->state, p);
+        p += SHA256_BLOCK_SIZE;
+        len -= SHA256_BLOCK_SIZE;
+    }
+
+    if (len) {
+        (void)memcpy(ctx->buf, p, len);
+        ctx->buflen = (uint32_t)len;
+    }
+}
+
+/**
+  * @brief  补位并输出摘要
+  * @param  ctx 上下文, 调用后须重新 sha256_init() 才能再次使用
+  * @param  digest 32字节摘要 (大端)
+  */
+void sha256_final(struct sha256_ctx *ctx, uint8_t digest[SHA256_DIGEST_SIZE])
+{
+    uint64_t bits = ctx->count * 8U;
+    uint32_t i;
+
+    ctx->buf[ctx->buflen++] = 0x80;
+    if (ctx->buflen > SHA256_BLOCK_SIZE - 8U) {
+        (void)memset(&ctx->buf[ctx->buflen], 0, SHA256_BLOCK_SIZE - ctx->buflen);
+        sha256_transform(ctx->state, ctx->buf);
+        ctx->buflen = 0;
+    }
+    (void)memset(&ctx->buf[ctx->buflen], 0, SHA256_BLOCK_SIZE - 8U - ctx->buflen);
+
+    for (i = 0; i < 8U; i++)
+        ctx->buf[SHA256_BLOCK_SIZE - 1U - i] = (uint8_t)(bits >> (i * 8U));
+    sha256_transform(ctx->state, ctx->buf);
+
+    for (i = 0; i < 8U; i++) {
+        digest[i * 4U] = (uint8_t)(ctx->state[i] >> 24);
+        digest[i * 4U + 1U] = (uint8_t)(ctx->state[i] >> 16);
+        digest[i * 4U + 2U] = (uint8_t)(ctx->state[i] >> 8);
+        digest[i * 4U + 3U] = (uint8_t)ctx->state[i];
+    }
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  压缩一个64字节块
+  * @note   消息扩展使用16字的循环窗口, 栈占用64字节
+  */
+static void sha256_transform(uint32_t state[8], const uint8_t *blk)
+{
+    uint32_t w[16];
+    uint32_t a, b, c, d, e, f, g, h;
+    uint32_t t1, t2;
+    uint32_t i;
+
+    for (i = 0; i < 16U; i++)
+        w[i] = ((uint32_t)blk[i * 4U] << 24) | ((uint32_t)blk[i * 4U + 1U] << 16) |
+               ((uint32_t)blk[i * 4U + 2U] << 8) | (uint32_t)blk[i * 4U + 3U];
+
+    a = state[0];
+    b = state[1];
+    c = state[2];
+    d = state[3];
+    e = state[4];
+    f = state[5];
+    g = state[6];
+    h = state[7];
+
+    for (i = 0; i < 64U; i++) {
+        if (i >= 16U)
+            w[i & 15U] += SIG1(w[(i - 2U) & 15U]) + w[(i - 7U) & 15U] + SIG0(w[(i - 15U) & 15U]);
+        t1 = h + EP1(e) + CH(e, f, g) + sha256_k[i] + w[i & 15U];
+        t2 = EP0(a) + MAJ(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
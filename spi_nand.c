@@ -0,0 +1,960 @@
+/**
+  ******************************************************************************
+  * @file        : spi_nand.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SPI NAND Flash驱动实现
+  * @attention   : - 读: 13h 载入缓存 -> 03h/0Bh/3Bh/6Bh 读缓存; 数据与OOB在缓存中
+  *                  连续, 一条消息读出
+  *                - 多页顺序读: 支持 30h 的器件在读出第N页的同时载入第N+1页,
+  *                  最后一页用 3Fh 结束; Winbond 用 BUF=0 连续读一次读完
+  *                - 写: WREN + 载入 + 10h 合并为一条消息; 擦除: WREN + D8h
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "spi_nand.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "spi_nand"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
+
+/* Private typedef -----------------------------------------------------------*/
+/**
+ * @brief 单次操作: 命令 + 地址 + dummy + 数据 (+ 紧随的第二段数据)
+ */
+struct spi_nand_op {
+    uint8_t opcode;
+    uint8_t addr_nbytes;                // 0表示无地址阶段
+    uint8_t dummy_cycles;
+    uint8_t data_nbits;
+    uint32_t addr;
+    const void *tx_buf;                 // 写数据, 与rx_buf二选一
+    void *rx_buf;
+    size_t len;
+    const void *tx_buf2;                // 缓存中紧接其后的数据 (OOB), 可为NULL
+    void *rx_buf2;
+    size_t len2;
+};
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_NAND_READ_TIMEOUT_MS    5       /* tR / tRCBSY 上限 */
+#define SPI_NAND_PROG_TIMEOUT_MS    10      /* tPROG 上限 */
+#define SPI_NAND_ERASE_TIMEOUT_MS   50      /* tBERS 上限 */
+#define SPI_NAND_RESET_TIMEOUT_MS   5
+#define SPI_NAND_CACHE_DUMMY        8       /* 读缓存命令的dummy周期 */
+#define SPI_NAND_CONT_DUMMY         32      /* 连续读模式的dummy周期 (4字节) */
+#define SPI_NAND_PLANE_BIT          12      /* 双plane器件列地址中的plane选择位 */
+#define SPI_NAND_OP_XFERS           4
+
+/* Private macro -------------------------------------------------------------*/
+uint32_t HAL_GetTick(void);
+
+#define SPI_NAND_WAIT_TIMEOUT(timeout_ms) \
+    uint32_t start = HAL_GetTick(); \
+    while((HAL_GetTick() - start) < timeout_ms)
+
+/* Private function prototypes -----------------------------------------------*/
+static int spi_nand_ecc_status_2bit(const struct spi_nand *nand, uint8_t sr);
+static int spi_nand_ecc_status_micron(const struct spi_nand *nand, uint8_t sr);
+static int spi_nand_op_add_xfers(const struct spi_nand_op *op, struct spi_transfer *t,
+                                 uint8_t *addr, struct spi_message *m);
+static int spi_nand_exec_op(struct spi_nand *nand, const struct spi_nand_op *op);
+static int spi_nand_row_op(struct spi_nand *nand, uint8_t opcode, uint32_t page);
+static int spi_nand_wait_ready(struct spi_nand *nand, uint32_t timeout_ms, uint8_t *sr);
+static int spi_nand_set_cfg(struct spi_nand *nand, uint8_t cfg);
+static uint16_t spi_nand_column(struct spi_nand *nand, uint32_t page, uint32_t col);
+static int spi_nand_read_cache(struct spi_nand *nand, uint32_t page, uint32_t col,
+                               uint8_t *buf, size_t len, uint8_t *oob);
+static int spi_nand_program_page(struct spi_nand *nand, uint32_t page, uint32_t col,
+                                 const uint8_t *buf, size_t len, const uint8_t *oob);
+static void spi_nand_account(struct spi_nand *nand, struct mtd_oob_ops *ops, int n,
+                             int *max, int *failed);
+static int spi_nand_read_cont(struct spi_nand *nand, uint32_t page, uint32_t npages,
+                              struct mtd_oob_ops *ops);
+static int spi_nand_read_pages(struct spi_nand *nand, uint32_t page, uint32_t col,
+                               uint32_t npages, struct mtd_oob_ops *ops);
+static int spi_nand_mtd_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops);
+static int spi_nand_mtd_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops);
+static int spi_nand_mtd_read(struct mtd_info *mtd, mtd_addr_t from, size_t len,
+                             size_t *retlen, uint8_t *buf);
+static int spi_nand_mtd_write(struct mtd_info *mtd, mtd_addr_t to, size_t len,
+                              size_t *retlen, const uint8_t *buf);
+static int spi_nand_mtd_erase(struct mtd_info *mtd, struct erase_info *instr);
+#if MTD_SUPPORT_NAND
+static int spi_nand_mtd_block_isbad(struct mtd_info *mtd, mtd_addr_t offs);
+static int spi_nand_mtd_block_markbad(struct mtd_info *mtd, mtd_addr_t offs);
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static const struct spi_nand_info spi_nand_ids[] = {
+    /* 每16字节OOB: 0-1 坏块标记, 2-7 用户区, 8-15 ECC */
+    { "W25N01GV", 0xEF, 0xAA21, 2, SPINAND_F_CONT_READ,
+      2048, 64, 64, 1024, 1, 2, 6, spi_nand_ecc_status_2bit },
+    /* OOB前半为用户区, 后半为ECC */
+    { "MT29F1G01ABAFD", 0x2C, 0x1400, 1, SPINAND_F_CACHE_RANDOM,
+      2048, 128, 64, 1024, 8, 2, 62, spi_nand_ecc_status_micron },
+    { "MT29F2G01ABAGD", 0x2C, 0x2400, 1, SPINAND_F_CACHE_RANDOM | SPINAND_F_TWO_PLANES,
+      2048, 128, 64, 2048, 8, 2, 62, spi_nand_ecc_status_micron },
+};
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Exported functions --------------------------------------------------------*/
+/**
+ * @brief  探测器件, 解除块保护, 打开片上ECC并选择读/写命令
+ * @param  nand   SPI NAND设备, nand->spi 必须已挂接
+ * @param  hwcaps 板级支持的多线命令 (SPINAND_HWCAPS_xxx), 与控制器能力取交集
+ * @retval 0=成功, 负数=错误码
+ */
+int spi_nand_scan(struct spi_nand *nand, uint32_t hwcaps)
+{
+    const struct spi_nand_info *info = NULL;
+    uint32_t caps;
+    uint16_t dev;
+    uint8_t id[3];
+    uint8_t cfg;
+    uint32_t i;
+    int ret;
+    struct spi_nand_op op = {
+        .opcode = SPINAND_CMD_RDID,
+        .dummy_cycles = 8,
+        .rx_buf = id,
+        .len = sizeof(id),
+    };
+
+    if (!nand || !nand->spi)
+        return -ERR_INVAL;
+
+    ret = spi_nand_reset(nand);
+    if (ret)
+        return ret;
+
+    ret = spi_nand_exec_op(nand, &op);
+    if (ret)
+        return ret;
+
+    dev = ((uint16_t)id[1] << 8) | id[2];
+    for (i = 0; i < sizeof(spi_nand_ids) / sizeof(spi_nand_ids[0]); i++) {
+        if (spi_nand_ids[i].mfr_id != id[0])
+            continue;
+        if (spi_nand_ids[i].dev_id == (spi_nand_ids[i].dev_id_len == 1U ? (dev & 0xFF00U) : dev)) {
+            info = &spi_nand_ids[i];
+            break;
+        }
+    }
+    if (!info) {
+        log_e("spi_nand_scan: unknown id %02X %02X %02X.", id[0], id[1], id[2]);
+        return -ERR_NOTSUPP;
+    }
+
+    if (info->oob_size > SPI_NAND_MAX_OOB)
+        return -ERR_NOTSUPP;
+
+    nand->info = info;
+    nand->manufacturer_id = id[0];
+    nand->device_id = dev;
+    nand->page_shift = 0;
+    while ((1UL << nand->page_shift) < info->page_size)
+        nand->page_shift++;
+    nand->block_shift = 0;
+    while ((1UL << nand->block_shift) < info->pages_per_block)
+        nand->block_shift++;
+    (void)memset(&nand->stats, 0, sizeof(nand->stats));
+
+    caps = spi_get_caps(nand->spi);
+    if ((hwcaps & SPINAND_HWCAPS_READ_X4) && (caps & SPI_CAP_RX_QUAD)) {
+        nand->read_opcode = SPINAND_CMD_READ_FROM_CACHE_X4;
+        nand->read_nbits = SPI_NBITS_QUAD;
+    } else if ((hwcaps & SPINAND_HWCAPS_READ_X2) && (caps & (SPI_CAP_RX_DUAL | SPI_CAP_RX_QUAD))) {
+        nand->read_opcode = SPINAND_CMD_READ_FROM_CACHE_X2;
+        nand->read_nbits = SPI_NBITS_DUAL;
+    } else {
+        nand->read_opcode = SPINAND_CMD_READ_FROM_CACHE_FAST;
+        nand->read_nbits = SPI_NBITS_SINGLE;
+    }
+    if ((hwcaps & SPINAND_HWCAPS_PROG_X4) && (caps & SPI_CAP_TX_QUAD)) {
+        nand->program_opcode = SPINAND_CMD_PROG_LOAD_X4;
+        nand->program_nbits = SPI_NBITS_QUAD;
+    } else {
+        nand->program_opcode = SPINAND_CMD_PROG_LOAD;
+        nand->program_nbits = SPI_NBITS_SINGLE;
+    }
+
+    /* 上电默认全片写保护 */
+    ret = spi_nand_set_feature(nand, SPINAND_REG_PROT, 0);
+    if (ret)
+        return ret;
+
+    ret = spi_nand_get_feature(nand, SPINAND_REG_CFG, &cfg);
+    if (ret)
+        return ret;
+
+    cfg |= SPINAND_CFG_ECC_EN;
+    cfg &= (uint8_t)~SPINAND_CFG_OTP_EN;
+    if (info->flags & SPINAND_F_CONT_READ)
+        cfg |= SPINAND_CFG_BUF;
+
+    ret = spi_nand_set_feature(nand, SPINAND_REG_CFG, cfg);
+    if (ret)
+        return ret;
+
+    nand->cfg = cfg;
+    return 0;
+}
+
+int spi_nand_reset(struct spi_nand *nand)
+{
+    struct spi_nand_op op = {
+        .opcode = SPINAND_CMD_RESET,
+    };
+    int ret;
+
+    if (!nand || !nand->spi)
+        return -ERR_INVAL;
+
+    ret = spi_nand_exec_op(nand, &op);
+    if (ret)
+        return ret;
+
+    return spi_nand_wait_ready(nand, SPI_NAND_RESET_TIMEOUT_MS, NULL);
+}
+
+int spi_nand_get_feature(struct spi_nand *nand, uint8_t reg, uint8_t *val)
+{
+    struct spi_nand_op op = {
+        .opcode = SPINAND_CMD_GET_FEATURE,
+        .addr_nbytes = 1,
+        .addr = reg,
+        .rx_buf = val,
+        .len = 1,
+    };
+
+    if (!nand || !nand->spi || !val)
+        return -ERR_INVAL;
+
+    return spi_nand_exec_op(nand, &op);
+}
+
+int spi_nand_set_feature(struct spi_nand *nand, uint8_t reg, uint8_t val)
+{
+    struct spi_nand_op op = {
+        .opcode = SPINAND_CMD_SET_FEATURE,
+        .addr_nbytes = 1,
+        .addr = reg,
+        .tx_buf = &val,
+        .len = 1,
+    };
+
+    if (!nand || !nand->spi)
+        return -ERR_INVAL;
+
+    return spi_nand_exec_op(nand, &op);
+}
+
+/**
+ * @brief  初始化内嵌的 mtd_info, 须在 spi_nand_scan() 成功后调用
+ * @param  nand SPI NAND设备
+ * @param  name MTD设备名, NULL时使用器件型号
+ * @retval 0=成功, 负数=错误码
+ * @note   片上ECC无法给出准确翻转数的器件按纠错能力上报, 上层会尽快搬移数据
+ */
+int spi_nand_mtd_init(struct spi_nand *nand, const char *name)
+{
+    const struct spi_nand_info *info;
+    struct mtd_info *mtd;
+
+    if (!nand || !nand->spi || !nand->info)
+        return -ERR_INVAL;
+
+    info = nand->info;
+    mtd = &nand->mtd;
+    (void)memset(mtd, 0, sizeof(*mtd));
+
+    mtd->name = name ? name : info->name;
+    mtd->type = MTD_NANDFLASH;
+    mtd->flags = MTD_CAP_NANDFLASH;
+    mtd->size = (mtd_addr_t)info->nblocks * info->pages_per_block * info->page_size;
+    mtd->erasesize = (uint32_t)info->pages_per_block * info->page_size;
+    mtd->writesize = info->page_size;
+    mtd->writesize_shift = nand->page_shift;
+    mtd->oobsize = info->oob_size;
+    mtd->oobavail = info->oob_free_len;
+#if MTD_SUPPORT_ECC_STATS
+    mtd->ecc_strength = info->ecc_strength;
+    mtd->bitflip_threshold = (info->ecc_strength * 3U + 3U) / 4U;
+#endif
+    mtd->_read = spi_nand_mtd_read;
+    mtd->_write = spi_nand_mtd_write;
+    mtd->_erase = spi_nand_mtd_erase;
+    mtd->_read_oob = spi_nand_mtd_read_oob;
+    mtd->_write_oob = spi_nand_mtd_write_oob;
+#if MTD_SUPPORT_NAND
+    mtd->block_isbad = spi_nand_mtd_block_isbad;
+    mtd->block_markbad = spi_nand_mtd_block_markbad;
+#endif
+    mtd->priv = nand;
+
+    return 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  2位ECC状态: 00=无翻转, 01=已纠正 (位数未知, 按纠错能力上报), 其余=无法纠正
+ */
+static int spi_nand_ecc_status_2bit(const struct spi_nand *nand, uint8_t sr)
+{
+    switch ((sr & SPINAND_SR_ECC_MASK) >> SPINAND_SR_ECC_SHIFT) {
+    case 0:
+        return 0;
+    case 1:
+        return nand->info->ecc_strength;
+    default:
+        return -ERR_IO;
+    }
+}
+
+/**
+ * @brief  Micron 3位ECC状态, 按区间上限上报翻转数
+ */
+static int spi_nand_ecc_status_micron(const struct spi_nand *nand, uint8_t sr)
+{
+    (void)nand;
+
+    switch ((sr & SPINAND_SR_ECC_MASK) >> SPINAND_SR_ECC_SHIFT) {
+    case 0:
+        return 0;
+    case 1:
+        return 3;
+    case 3:
+        return 6;
+    case 5:
+        return 8;
+    default:
+        return -ERR_IO;
+    }
+}
+
+/**
+ * @brief  把一次操作拆成 命令/地址/数据 传输并追加到消息末尾
+ * @param  t    至少 SPI_NAND_OP_XFERS 个传输描述, 生命周期须覆盖消息执行
+ * @param  addr 至少3字节地址缓冲, 生命周期同上
+ * @retval 实际使用的传输描述个数
+ */
+static int spi_nand_op_add_xfers(const struct spi_nand_op *op, struct spi_transfer *t,
+                                 uint8_t *addr, struct spi_message *m)
+{
+    uint32_t i;
+    int n = 0;
+
+    (void)memset(t, 0, SPI_NAND_OP_XFERS * sizeof(*t));
+
+    t[n].tx_buf = &op->opcode;
+    t[n].len = 1;
+    spi_message_add_tail(&t[n++], m);
+
+    if (op->addr_nbytes) {
+        for (i = 0; i < op->addr_nbytes; i++)
+            addr[i] = (uint8_t)(op->addr >> ((op->addr_nbytes - 1U - i) * 8U));
+        t[n].tx_buf = addr;
+        t[n].len = op->addr_nbytes;
+        spi_message_add_tail(&t[n++], m);
+    }
+
+    if (op->len) {
+        t[n].tx_buf = op->tx_buf;
+        t[n].rx_buf = op->rx_buf;
+        t[n].len = op->len;
+        if (op->rx_buf)
+            t[n].rx_nbits = op->data_nbits;
+        else
+            t[n].tx_nbits = op->data_nbits;
+        t[n].dummy_cycles = op->dummy_cycles;
+        spi_message_add_tail(&t[n++], m);
+    }
+
+    /* 缓存地址自动递增, 第二段无需重新发命令 */
+    if (op->len2) {
+        t[n].tx_buf = op->tx_buf2;
+        t[n].rx_buf = op->rx_buf2;
+        t[n].len = op->len2;
+        if (op->rx_buf2)
+            t[n].rx_nbits = op->data_nbits;
+        else
+            t[n].tx_nbits = op->data_nbits;
+        spi_message_add_tail(&t[n++], m);
+    }
+
+    return n;
+}
+
+static int spi_nand_exec_op(struct spi_nand *nand, const struct spi_nand_op *op)
+{
+    struct spi_message m;
+    struct spi_transfer t[SPI_NAND_OP_XFERS];
+    uint8_t addr[3];
+
+    spi_message_init(&m);
+    (void)spi_nand_op_add_xfers(op, t, addr, &m);
+
+    return (spi_sync(nand->spi, &m) < 0) ? -ERR_IO : 0;
+}
+
+/**
+ * @brief  带3字节行地址 (页号) 的无数据命令: 13h / 30h / 10h / D8h
+ */
+static int spi_nand_row_op(struct spi_nand *nand, uint8_t opcode, uint32_t page)
+{
+    struct spi_nand_op op = {
+        .opcode = opcode,
+        .addr_nbytes = 3,
+        .addr = page,
+    };
+
+    return spi_nand_exec_op(nand, &op);
+}
+
+static int spi_nand_wait_ready(struct spi_nand *nand, uint32_t timeout_ms, uint8_t *sr)
+{
+    uint8_t status;
+    int ret;
+
+    SPI_NAND_WAIT_TIMEOUT(timeout_ms) {
+        ret = spi_nand_get_feature(nand, SPINAND_REG_STATUS, &status);
+        if (ret)
+            return ret;
+
+        if (!(status & SPINAND_SR_OIP)) {
+            if (sr)
+                *sr = status;
+            return 0;
+        }
+    }
+
+    return -ERR_TIMEOUT;
+}
+
+/**
+ * @brief  写配置寄存器, 与缓存值相同时跳过
+ */
+static int spi_nand_set_cfg(struct spi_nand *nand, uint8_t cfg)
+{
+    int ret;
+
+    if (cfg == nand->cfg)
+        return 0;
+
+    ret = spi_nand_set_feature(nand, SPINAND_REG_CFG, cfg);
+    if (ret)
+        return ret;
+
+    nand->cfg = cfg;
+    return 0;
+}
+
+static uint16_t spi_nand_column(struct spi_nand *nand, uint32_t page, uint32_t col)
+{
+    if (nand->info->flags & SPINAND_F_TWO_PLANES)
+        col |= ((page >> nand->block_shift) & 1U) << SPI_NAND_PLANE_BIT;
+
+    return (uint16_t)col;
+}
+
+/**
+ * @brief  从缓存读出 [col, col+len), oob非NULL时紧接着读出整个OOB
+ * @note   需要OOB时 col+len 须等于页大小, 两段在同一条消息中读出
+ */
+static int spi_nand_read_cache(struct spi_nand *nand, uint32_t page, uint32_t col,
+                               uint8_t *buf, size_t len, uint8_t *oob)
+{
+    struct spi_nand_op op = {
+        .opcode = nand->read_opcode,
+        .addr_nbytes = 2,
+        .addr = spi_nand_column(nand, page, col),
+        .dummy_cycles = SPI_NAND_CACHE_DUMMY,
+        .data_nbits = nand->read_nbits,
+        .rx_buf = buf,
+        .len = len,
+    };
+
+    if (oob) {
+        op.rx_buf2 = oob;
+        op.len2 = nand->info->oob_size;
+        if (!len) {
+            op.rx_buf = oob;
+            op.len = op.len2;
+            op.len2 = 0;
+        }
+    }
+
+    return spi_nand_exec_op(nand, &op);
+}
+
+/**
+ * @brief  WREN + 载入 + 执行编程 合并为一条消息, 再等待完成
+ * @note   载入命令先把缓存置为0xFF, 未载入的字节保持擦除状态;
+ *         oob非NULL时紧接数据载入整个OOB, 此时 col+len 须等于页大小
+ */
+static int spi_nand_program_page(struct spi_nand *nand, uint32_t page, uint32_t col,
+                                 const uint8_t *buf, size_t len, const uint8_t *oob)
+{
+    static const uint8_t wren = SPINAND_CMD_WREN;
+    struct spi_message m;
+    struct spi_transfer t[1 + SPI_NAND_OP_XFERS + 2];
+    uint8_t load_addr[3];
+    uint8_t exec_addr[3];
+    uint8_t exec_opcode = SPINAND_CMD_PROG_EXEC;
+    uint8_t sr;
+    int n;
+    int ret;
+    struct spi_nand_op op = {
+        .opcode = nand->program_opcode,
+        .addr_nbytes = 2,
+        .addr = spi_nand_column(nand, page, col),
+        .data_nbits = nand->program_nbits,
+        .tx_buf = buf,
+        .len = len,
+    };
+
+    if (oob) {
+        op.tx_buf2 = oob;
+        op.len2 = nand->info->oob_size;
+        if (!len) {
+            op.tx_buf = oob;
+            op.len = op.len2;
+            op.len2 = 0;
+        }
+    }
+
+    spi_message_init(&m);
+
+    (void)memset(&t[0], 0, sizeof(t[0]));
+    t[0].tx_buf = &wren;
+    t[0].len = 1;
+    t[0].cs_change = 1;
+    spi_message_add_tail(&t[0], &m);
+
+    n = 1 + spi_nand_op_add_xfers(&op, &t[1], load_addr, &m);
+    t[n - 1].cs_change = 1;
+
+    exec_addr[0] = (uint8_t)(page >> 16);
+    exec_addr[1] = (uint8_t)(page >> 8);
+    exec_addr[2] = (uint8_t)page;
+    (void)memset(&t[n], 0, 2U * sizeof(t[0]));
+    t[n].tx_buf = &exec_opcode;
+    t[n].len = 1;
+    spi_message_add_tail(&t[n], &m);
+    t[n + 1].tx_buf = exec_addr;
+    t[n + 1].len = sizeof(exec_addr);
+    spi_message_add_tail(&t[n + 1], &m);
+
+    if (spi_sync(nand->spi, &m) < 0)
+        return -ERR_IO;
+
+    ret = spi_nand_wait_ready(nand, SPI_NAND_PROG_TIMEOUT_MS, &sr);
+    if (ret)
+        return ret;
+
+    return (sr & SPINAND_SR_P_FAIL) ? -ERR_IO : 0;
+}
+
+/**
+ * @brief  记录一页的ECC结果
+ */
+static void spi_nand_account(struct spi_nand *nand, struct mtd_oob_ops *ops, int n,
+                             int *max, int *failed)
+{
+#if !MTD_SUPPORT_ECC_STATS
+    (void)nand;
+    (void)ops;
+#endif
+
+    if (n < 0) {
+        *failed = 1;
+#if MTD_SUPPORT_ECC_STATS
+        nand->mtd.ecc_stats.failed++;
+        if (ops->stats)
+            ops->stats->uncorrectable_errors++;
+#endif
+        return;
+    }
+
+#if MTD_SUPPORT_ECC_STATS
+    nand->mtd.ecc_stats.corrected += (uint32_t)n;
+    if (ops->stats)
+        ops->stats->corrected_bitflips += (uint32_t)n;
+#endif
+    if (n > *max)
+        *max = n;
+}
+
+/**
+ * @brief  Winbond连续读: BUF=0 后一条读命令跨页读完全部数据
+ * @retval 0=成功且无ECC事件, 1=有ECC事件需逐页重读, 负数=错误码
+ * @note   连续读的ECC状态是全部页的累计结果, 无法定位到页
+ */
+static int spi_nand_read_cont(struct spi_nand *nand, uint32_t page, uint32_t npages,
+                              struct mtd_oob_ops *ops)
+{
+    struct spi_nand_op op = {
+        .opcode = nand->read_opcode,
+        .dummy_cycles = SPI_NAND_CONT_DUMMY,
+        .data_nbits = nand->read_nbits,
+        .rx_buf = ops->datbuf,
+        .len = ops->len,
+    };
+    uint8_t sr = 0;
+    int ret;
+
+    ret = spi_nand_set_cfg(nand, nand->cfg & (uint8_t)~SPINAND_CFG_BUF);
+    if (ret)
+        return ret;
+
+    ret = spi_nand_row_op(nand, SPINAND_CMD_PAGE_READ, page);
+    if (!ret)
+        ret = spi_nand_wait_ready(nand, SPI_NAND_READ_TIMEOUT_MS, NULL);
+    if (!ret)
+        ret = spi_nand_exec_op(nand, &op);
+    /* 片选拉高即结束连续读, 器件可能仍在预取下一页 */
+    if (!ret)
+        ret = spi_nand_wait_ready(nand, SPI_NAND_READ_TIMEOUT_MS, &sr);
+
+    if (spi_nand_set_cfg(nand, nand->cfg | SPINAND_CFG_BUF) && !ret)
+        ret = -ERR_IO;
+    if (ret)
+        return ret;
+
+    if (sr & SPINAND_SR_ECC_MASK) {
+        nand->stats.cont_fallback++;
+        return 1;
+    }
+
+    nand->stats.cont_reads += npages;
+    ops->retlen = ops->len;
+    return 0;
+}
+
+/**
+ * @brief  逐页读出数据与OOB; 支持 30h 时流水进行
+ * @note   流水读: 13h(P0) -> [30h(Pi+1) -> 等待 -> 读缓存(Pi)]... -> 3Fh -> 读缓存(Pn-1),
+ *         读缓存期间器件在后台把下一页载入数据寄存器
+ * @retval 最大单页翻转数, 负数=错误码; 有页无法纠正时读完全部页后返回 -ERR_IO
+ */
+static int spi_nand_read_pages(struct spi_nand *nand, uint32_t page, uint32_t col,
+                               uint32_t npages, struct mtd_oob_ops *ops)
+{
+    const struct spi_nand_info *info = nand->info;
+    uint32_t ws = info->page_size;
+    uint32_t win = mtd_oobavail(&nand->mtd, ops);
+    uint32_t base = (ops->mode == MTD_OPS_AUTO_OOB) ? info->oob_free_offs : 0U;
+    uint32_t ooboff = ops->ooboffs;
+    int pipelined = (info->flags & SPINAND_F_CACHE_RANDOM) && npages > 1U;
+    uint8_t *oob;
+    uint8_t sr;
+    uint32_t i;
+    size_t n;
+    int max = 0;
+    int failed = 0;
+    int ret;
+
+    if (pipelined) {
+        ret = spi_nand_row_op(nand, SPINAND_CMD_PAGE_READ, page);
+        if (!ret)
+            ret = spi_nand_wait_ready(nand, SPI_NAND_READ_TIMEOUT_MS, NULL);
+        if (ret)
+            return ret;
+    }
+
+    for (i = 0; i < npages; i++) {
+        if (!pipelined)
+            ret = spi_nand_row_op(nand, SPINAND_CMD_PAGE_READ, page + i);
+        else if (i + 1U < npages)
+            ret = spi_nand_row_op(nand, SPINAND_CMD_READ_CACHE_RANDOM, page + i + 1U);
+        else
+            ret = spi_nand_row_op(nand, SPINAND_CMD_READ_CACHE_LAST, 0);
+        if (!ret)
+            ret = spi_nand_wait_ready(nand, SPI_NAND_READ_TIMEOUT_MS, &sr);
+        if (ret)
+            goto abort;
+
+        if (ops->mode != MTD_OPS_RAW)
+            spi_nand_account(nand, ops, info->ecc_status(nand, sr), &max, &failed);
+
+        n = 0;
+        if (ops->retlen < ops->len) {
+            n = ws - col;
+            if (n > ops->len - ops->retlen)
+                n = ops->len - ops->retlen;
+        }
+        oob = NULL;
+        if (ops->oobretlen < ops->ooblen)
+            oob = nand->oob;
+
+        /* 数据未读到页尾时OOB单独读 */
+        if (oob && n && col + n != ws) {
+            ret = spi_nand_read_cache(nand, page + i, ws, NULL, 0, oob);
+            oob = NULL;
+            if (ret)
+                goto abort;
+        }
+        if (n || oob) {
+            ret = spi_nand_read_cache(nand, page + i, n ? col : ws,
+                                      n ? ops->datbuf + ops->retlen : NULL, n, oob);
+            if (ret)
+                goto abort;
+        }
+        ops->retlen += n;
+        col = 0;
+
+        if (ops->oobretlen < ops->ooblen) {
+            n = win - ooboff;
+            if (n > ops->ooblen - ops->oobretlen)
+                n = ops->ooblen - ops->oobretlen;
+            memcpy(ops->oobbuf + ops->oobretlen, nand->oob + base + ooboff, n);
+            ops->oobretlen += n;
+            ooboff = 0;
+        }
+
+        if (pipelined)
+            nand->stats.cache_reads++;
+        else
+            nand->stats.page_reads++;
+    }
+
+    return failed ? -ERR_IO : max;
+
+abort:
+    /* 结束未完成的cache read, 器件回到普通读状态 */
+    if (pipelined && i + 1U < npages) {
+        if (!spi_nand_row_op(nand, SPINAND_CMD_READ_CACHE_LAST, 0))
+            (void)spi_nand_wait_ready(nand, SPI_NAND_READ_TIMEOUT_MS, NULL);
+    }
+    return ret;
+}
+
+static int spi_nand_mtd_read_oob(struct mtd_info *mtd, mtd_addr_t from, struct mtd_oob_ops *ops)
+{
+    struct spi_nand *nand = (struct spi_nand *)mtd->priv;
+    uint32_t ws = mtd->writesize;
+    uint32_t win = mtd_oobavail(mtd, ops);
+    uint32_t page = (uint32_t)(from >> nand->page_shift);
+    uint32_t col = (uint32_t)(from & (ws - 1U));
+    uint32_t npages = 0;
+    uint32_t n;
+    int ret;
+
+    if (ops->len)
+        npages = (uint32_t)((col + ops->len + ws - 1U) >> nand->page_shift);
+    if (ops->ooblen) {
+        n = (uint32_t)((ops->ooboffs + ops->ooblen + win - 1U) / win);
+        if (n > npages)
+            npages = n;
+    }
+    if (!npages)
+        return 0;
+
+    if (ops->mode == MTD_OPS_RAW) {
+        ret = spi_nand_set_cfg(nand, nand->cfg & (uint8_t)~SPINAND_CFG_ECC_EN);
+        if (ret)
+            return ret;
+    } else if ((nand->info->flags & SPINAND_F_CONT_READ) && npages > 1U && !col && !ops->ooblen) {
+        ret = spi_nand_read_cont(nand, page, npages, ops);
+        if (ret <= 0)
+            return ret;
+    }
+
+    ret = spi_nand_read_pages(nand, page, col, npages, ops);
+
+    if (ops->mode == MTD_OPS_RAW) {
+        if (spi_nand_set_cfg(nand, nand->cfg | SPINAND_CFG_ECC_EN) && ret >= 0)
+            ret = -ERR_IO;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief  按页写入数据+OOB
+ * @note   数据须整页对齐 (片上ECC按页内扇区计算); 只写OOB时数据区保持0xFF
+ */
+static int spi_nand_mtd_write_oob(struct mtd_info *mtd, mtd_addr_t to, struct mtd_oob_ops *ops)
+{
+    struct spi_nand *nand = (struct spi_nand *)mtd->priv;
+    uint32_t ws = mtd->writesize;
+    uint32_t win = mtd_oobavail(mtd, ops);
+    uint32_t base = (ops->mode == MTD_OPS_AUTO_OOB) ? nand->info->oob_free_offs : 0U;
+    uint32_t ooboff = ops->ooboffs;
+    uint32_t page = (uint32_t)(to >> nand->page_shift);
+    const uint8_t *data;
+    const uint8_t *oob;
+    size_t len;
+    size_t n;
+    int ret = 0;
+
+    if (ops->len && ((to & (ws - 1U)) || (ops->len & (ws - 1U))))
+        return -ERR_INVAL;
+
+    if (ops->mode == MTD_OPS_RAW) {
+        ret = spi_nand_set_cfg(nand, nand->cfg & (uint8_t)~SPINAND_CFG_ECC_EN);
+        if (ret)
+            return ret;
+    }
+
+    while (ops->retlen < ops->len || ops->oobretlen < ops->ooblen) {
+        oob = NULL;
+        if (ops->oobretlen < ops->ooblen) {
+            memset(nand->oob, 0xFF, mtd->oobsize);
+            n = win - ooboff;
+            if (n > ops->ooblen - ops->oobretlen)
+                n = ops->ooblen - ops->oobretlen;
+            memcpy(nand->oob + base + ooboff, ops->oobbuf + ops->oobretlen, n);
+            ops->oobretlen += n;
+            ooboff = 0;
+            oob = nand->oob;
+        }
+
+        data = NULL;
+        len = 0;
+        if (ops->retlen < ops->len) {
+            data = ops->datbuf + ops->retlen;
+            len = ws;
+        }
+
+        ret = spi_nand_program_page(nand, page, data ? 0U : ws, data, len, oob);
+        if (ret)
+            break;
+
+        ops->retlen += len;
+        page++;
+    }
+
+    if (ops->mode == MTD_OPS_RAW) {
+        if (spi_nand_set_cfg(nand, nand->cfg | SPINAND_CFG_ECC_EN) && !ret)
+            ret = -ERR_IO;
+    }
+
+    return ret;
+}
+
+static int spi_nand_mtd_read(struct mtd_info *mtd, mtd_addr_t from, size_t len,
+                             size_t *retlen, uint8_t *buf)
+{
+    struct mtd_oob_ops ops = {
+        .len = len,
+        .datbuf = buf,
+    };
+    int ret;
+
+    ret = spi_nand_mtd_read_oob(mtd, from, &ops);
+    *retlen = ops.retlen;
+
+    return ret;
+}
+
+static int spi_nand_mtd_write(struct mtd_info *mtd, mtd_addr_t to, size_t len,
+                              size_t *retlen, const uint8_t *buf)
+{
+    struct mtd_oob_ops ops = {
+        .len = len,
+        .datbuf = (uint8_t *)buf,
+    };
+    int ret;
+
+    ret = spi_nand_mtd_write_oob(mtd, to, &ops);
+    *retlen = ops.retlen;
+
+    return ret;
+}
+
+static int spi_nand_mtd_erase(struct mtd_info *mtd, struct erase_info *instr)
+{
+    static const uint8_t wren = SPINAND_CMD_WREN;
+    struct spi_nand *nand = (struct spi_nand *)mtd->priv;
+    struct spi_nand_op op = {
+        .opcode = SPINAND_CMD_BLOCK_ERASE,
+        .addr_nbytes = 3,
+    };
+    struct spi_message m;
+    struct spi_transfer t[1 + SPI_NAND_OP_XFERS];
+    uint8_t addr[3];
+    mtd_addr_t ofs = instr->addr;
+    mtd_addr_t end = instr->addr + instr->len;
+    uint8_t sr;
+    int ret;
+
+    if ((ofs % mtd->erasesize) || (instr->len % mtd->erasesize))
+        return -ERR_INVAL;
+
+    for (; ofs < end; ofs += mtd->erasesize) {
+        op.addr = (uint32_t)(ofs >> nand->page_shift);
+
+        spi_message_init(&m);
+        (void)memset(&t[0], 0, sizeof(t[0]));
+        t[0].tx_buf = &wren;
+        t[0].len = 1;
+        t[0].cs_change = 1;
+        spi_message_add_tail(&t[0], &m);
+        (void)spi_nand_op_add_xfers(&op, &t[1], addr, &m);
+
+        ret = (spi_sync(nand->spi, &m) < 0) ? -ERR_IO : 0;
+        if (!ret)
+            ret = spi_nand_wait_ready(nand, SPI_NAND_ERASE_TIMEOUT_MS, &sr);
+        if (!ret && (sr & SPINAND_SR_E_FAIL))
+            ret = -ERR_IO;
+        if (ret) {
+            instr->fail_addr = ofs;
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
+#if MTD_SUPPORT_NAND
+/**
+ * @brief  块首页OOB第0字节非0xFF即为坏块 (出厂标记不受ECC保护)
+ */
+static int spi_nand_mtd_block_isbad(struct mtd_info *mtd, mtd_addr_t offs)
+{
+    struct spi_nand *nand = (struct spi_nand *)mtd->priv;
+    uint32_t page = (uint32_t)(offs >> nand->page_shift);
+    uint8_t marker[2];
+    struct spi_nand_op op = {
+        .opcode = nand->read_opcode,
+        .addr_nbytes = 2,
+        .addr = spi_nand_column(nand, page, mtd->writesize),
+        .dummy_cycles = SPI_NAND_CACHE_DUMMY,
+        .data_nbits = nand->read_nbits,
+        .rx_buf = marker,
+        .len = sizeof(marker),
+    };
+    int ret;
+
+    ret = spi_nand_row_op(nand, SPINAND_CMD_PAGE_READ, page);
+    if (!ret)
+        ret = spi_nand_wait_ready(nand, SPI_NAND_READ_TIMEOUT_MS, NULL);
+    if (!ret)
+        ret = spi_nand_exec_op(nand, &op);
+    if (ret)
+        return ret;
+
+    return marker[0] != 0xFF;
+}
+
+static int spi_nand_mtd_block_markbad(struct mtd_info *mtd, mtd_addr_t offs)
+{
+    struct spi_nand *nand = (struct spi_nand *)mtd->priv;
+    uint32_t page = (uint32_t)(offs >> nand->page_shift);
+
+    memset(nand->oob, 0xFF, mtd->oobsize);
+    nand->oob[0] = 0x00;
+    nand->oob[1] = 0x00;
+
+    return spi_nand_program_page(nand, page, mtd->writesize, NULL, 0, nand->oob);
+}
+#endif /* MTD_SUPPORT_NAND */
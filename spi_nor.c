@@ -13,6 +13,10 @@
   */
 /* Includes ------------------------------------------------------------------*/
 #include "spi_nor.h"
+#include "sfdp.h"
+#include "bsp_dwt.h"
+#include "errno-base.h"
+#include <string.h>
 
 /* Private typedef -----------------------------------------------------------*/
 
@@ -20,6 +24,13 @@
 #define SPI_NOR_TIMEOUT_MS          1000    /* 操作超时时间(ms) */
 #define SPI_NOR_WRITE_TIMEOUT_MS    3000    /* 写操作超时时间(ms) */
 #define SPI_NOR_ERASE_TIMEOUT_MS    5000    /* 擦除操作超时时间(ms) */
+#define SPI_NOR_CHIP_ERASE_TIMEOUT_MS   200000  /* 整片擦除超时时间(ms) */
+#define SPI_NOR_RESET_US            30      /* 软件复位恢复时间 tRST(us) */
+#define SPI_NOR_3B_ADDR_LIMIT       0x1000000UL /* 3字节地址可寻址上限 (16MB) */
+#define SPI_NOR_SR_BURST            32      /* 连续读SR1的最大突发字节数 */
+#define SPI_NOR_POLL_INTERVAL_US    1       /* 硬件状态轮询间隔(us) */
+#define SPI_NOR_TDP_US              10      /* 默认进入深度掉电时间 tDP(us) */
+#define SPI_NOR_TRES1_US            30      /* 默认退出深度掉电时间 tRES1(us) */
 
 /* Private macro -------------------------------------------------------------*/
 uint32_t HAL_GetTick(void);
@@ -29,220 +40,2709 @@ uint32_t HAL_GetTick(void);
     while((HAL_GetTick() - start) < timeout_ms)
 
 /* Private variables ---------------------------------------------------------*/
+/* 3字节地址指令 -> 专用4字节地址指令 */
+/* 已收录的厂商, 按JEDEC厂商ID匹配 */
+static const struct spi_nor_manufacturer *const spi_nor_manufacturers[] = {
+    &spi_nor_winbond,
+};
+
+static const uint8_t spi_nor_3to4_read[][2] = {
+    { SPINOR_CMD_READ,          SPINOR_CMD_READ_4B },
+    { SPINOR_CMD_READ_FAST,     SPINOR_CMD_READ_FAST_4B },
+    { SPINOR_CMD_READ_1_1_2,    SPINOR_CMD_READ_1_1_2_4B },
+    { SPINOR_CMD_READ_1_2_2,    SPINOR_CMD_READ_1_2_2_4B },
+    { SPINOR_CMD_READ_1_1_4,    SPINOR_CMD_READ_1_1_4_4B },
+    { SPINOR_CMD_READ_1_4_4,    SPINOR_CMD_READ_1_4_4_4B },
+    { SPINOR_CMD_READ_1_1_1_DTR, SPINOR_CMD_READ_1_1_1_DTR_4B },
+    { SPINOR_CMD_READ_1_2_2_DTR, SPINOR_CMD_READ_1_2_2_DTR_4B },
+    { SPINOR_CMD_READ_1_4_4_DTR, SPINOR_CMD_READ_1_4_4_DTR_4B },
+};
+
+static const uint8_t spi_nor_3to4_program[][2] = {
+    { SPINOR_CMD_PP,            SPINOR_CMD_PP_4B },
+    { SPINOR_CMD_PP_1_1_4,      SPINOR_CMD_PP_1_1_4_4B },
+    { SPINOR_CMD_PP_1_4_4,      SPINOR_CMD_PP_1_4_4_4B },
+};
 
 /* Private function prototypes -----------------------------------------------*/
 static int spi_nor_wait_ready(struct spi_nor *nor, uint32_t timeout_ms);
 static int spi_nor_write_enable(struct spi_nor *nor);
+static void spi_nor_init_default_params(struct spi_nor *nor);
+static void spi_nor_match_id(struct spi_nor *nor);
+static void spi_nor_info_init_params(struct spi_nor *nor);
+static void spi_nor_default_init_fixups(struct spi_nor *nor);
+static void spi_nor_post_sfdp_fixups(struct spi_nor *nor);
+static int spi_nor_late_init_fixups(struct spi_nor *nor);
+static void spi_nor_init_unique_id(struct spi_nor *nor);
+static uint32_t spi_nor_bus_hwcaps(struct spi_nor *nor);
+static int spi_nor_select_protocols(struct spi_nor *nor, uint32_t hwcaps);
+static void spi_nor_set_read(struct spi_nor_read_command *read, uint8_t num_mode_clocks,
+                             uint8_t num_wait_states, uint8_t opcode,
+                             enum spi_nor_protocol proto);
+static void spi_nor_set_pp(struct spi_nor_pp_command *pp, uint8_t opcode,
+                           enum spi_nor_protocol proto);
+static void spi_nor_set_erase_type(struct spi_nor_erase_type *erase, uint32_t size,
+                                   uint8_t opcode, uint32_t typ_ms, uint32_t max_ms);
+static uint8_t spi_nor_erase_mask_at(struct spi_nor *nor, uint32_t addr, uint32_t *end);
+static uint32_t spi_nor_min_erase_size(struct spi_nor *nor, uint8_t mask);
+static int spi_nor_async_start(struct spi_nor *nor, uint32_t typ_us, uint32_t max_ms,
+                               spi_nor_done_t done, void *arg);
+static void spi_nor_async_schedule(struct spi_nor *nor, uint32_t delay_ms);
+static void spi_nor_async_timer_cb(void *arg);
+static void spi_nor_async_status_done(void *context);
+static void spi_nor_async_finish(struct spi_nor *nor, int status);
+static int spi_nor_op_add_xfers(const struct spi_nor_op *op, struct spi_transfer *t,
+                                uint8_t *addr, struct spi_message *m);
+static int spi_nor_write_op(struct spi_nor *nor, const struct spi_nor_op *op);
+static int spi_nor_write_op_prefix(struct spi_nor *nor, uint8_t prefix,
+                                   const struct spi_nor_op *op);
+static int spi_nor_write_sr_op(struct spi_nor *nor, uint8_t opcode, const uint8_t *sr,
+                               uint32_t len, bool vol);
+static uint8_t spi_nor_otp_addr_nbytes(struct spi_nor *nor);
+static int spi_nor_otp_offs_to_addr(struct spi_nor *nor, uint32_t offs, uint32_t len,
+                                    uint32_t *addr, uint32_t *n);
+static int spi_nor_pp_op(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *data);
+static int spi_nor_erase_op(struct spi_nor *nor, uint8_t opcode, uint32_t addr);
+static const struct spi_nor_erase_type *spi_nor_select_erase_type(struct spi_nor *nor,
+                                                                  uint32_t addr, uint32_t len);
+static uint8_t spi_nor_convert_opcode(uint8_t opcode, const uint8_t table[][2], size_t size);
+static int spi_nor_set_4byte_opcodes(struct spi_nor *nor);
+static int spi_nor_set_addr_nbytes(struct spi_nor *nor);
+static int spi_nor_mtd_errno(int err);
+#if MTD_SUPPORT_ERASE_REGIONS
+static void spi_nor_init_erase_regions(struct spi_nor *nor);
+#endif
+static int spi_nor_mtd_read(struct mtd_info *mtd, mtd_addr_t from, size_t len,
+                            size_t *retlen, uint8_t *buf);
+static int spi_nor_mtd_write(struct mtd_info *mtd, mtd_addr_t to, size_t len,
+                             size_t *retlen, const uint8_t *buf);
+static int spi_nor_mtd_erase(struct mtd_info *mtd, struct erase_info *instr);
+#if MTD_SUPPORT_IOVEC
+static int spi_nor_mtd_readv(struct mtd_info *mtd, const struct mtd_iovec *vec, uint32_t cnt);
+#endif
+#if MTD_SUPPORT_ERASE_ASYNC
+static int spi_nor_mtd_erase_start(struct mtd_info *mtd, mtd_addr_t addr);
+static int spi_nor_mtd_erase_wait(struct mtd_info *mtd);
+#endif
+#if MTD_SUPPORT_READ_ASYNC
+static int spi_nor_mtd_read_start(struct mtd_info *mtd, mtd_addr_t from, size_t len, uint8_t *buf);
+static int spi_nor_mtd_read_wait(struct mtd_info *mtd, size_t *retlen);
+#endif
+#if MTD_SUPPORT_POINT
+static int spi_nor_mtd_point(struct mtd_info *mtd, mtd_addr_t from, size_t len,
+                             size_t *retlen, const void **virt);
+static int spi_nor_mtd_unpoint(struct mtd_info *mtd, mtd_addr_t from, size_t len);
+#endif
+static int spi_nor_wait_pp_ready(struct spi_nor *nor, uint32_t len);
+static int spi_nor_send_cmd(struct spi_nor *nor, uint8_t opcode);
+static int spi_nor_sync(struct spi_nor *nor, struct spi_message *m);
+static int spi_nor_w8r8(struct spi_nor *nor, uint8_t cmd);
+static int spi_nor_pm_init(struct spi_nor *nor);
+static int spi_nor_pm_get(struct spi_nor *nor);
+static void spi_nor_pm_put(struct spi_nor *nor);
+static int spi_nor_pm_wake(struct spi_nor *nor);
+static void spi_nor_pm_set_state(struct spi_nor *nor, uint8_t state);
+static void spi_nor_pm_schedule(struct spi_nor *nor, uint32_t delay_ms);
+static void spi_nor_pm_timer_cb(void *arg);
+static int spi_nor_read_op(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data);
 
 /* Exported functions --------------------------------------------------------*/
 
-/* 基本电源管理与控制命令 */
-int spi_nor_power_down(struct spi_nor *nor)
+/* 探测与底层操作 */
+/**
+ * @brief  探测Flash并选择最快的读/写协议
+ * @param  nor    SPI NOR设备, nor->spi 必须已挂接
+ * @param  hwcaps 板级/控制器支持的协议 (SNOR_HWCAPS_xxx), 0表示使用默认
+ * @retval 0=成功, 负数=错误码
+ * @note   参数来源优先级: 默认值 < 型号表 < 厂商default_init < SFDP < 厂商post_sfdp
+ */
+int spi_nor_scan(struct spi_nor *nor, uint32_t hwcaps)
 {
+    int ret;
+    
     if (!nor || !nor->spi)
         return -EINVAL;
-        
-    return spi_w8r8(nor->spi, SPINOR_CMD_POWER_DOWN);
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (!hwcaps)
+        hwcaps = SNOR_HWCAPS_DEFAULT;
+    
+    nor->flags = 0;
+    
+    ret = spi_nor_pm_init(nor);
+    if (ret < 0)
+        return ret;
+    
+    ret = spi_nor_read_jedec_id(nor);
+    if (ret < 0)
+        return ret;
+    
+    spi_nor_init_default_params(nor);
+    spi_nor_match_id(nor);
+    spi_nor_info_init_params(nor);
+    spi_nor_default_init_fixups(nor);
+    
+    /* 无SFDP时沿用默认参数 */
+    (void)spi_nor_parse_sfdp(nor);
+    spi_nor_post_sfdp_fixups(nor);
+    
+    /* 无法判断暂停是否生效时不启用, 否则擦写会被当作已完成 */
+    if (!nor->params.suspend_status)
+        nor->flags &= ~SNOR_F_SUSPEND;
+    
+    ret = spi_nor_select_protocols(nor, hwcaps);
+    if (ret < 0)
+        return ret;
+    
+    nor->capacity = nor->params.size;
+    nor->page_size = (uint16_t)nor->params.page_size;
+    
+    ret = spi_nor_set_addr_nbytes(nor);
+    if (ret < 0)
+        return ret;
+    
+    if ((spi_nor_get_protocol_data_nbits(nor->read_proto) == 4 ||
+         spi_nor_get_protocol_data_nbits(nor->write_proto) == 4) &&
+        nor->params.quad_enable) {
+        ret = nor->params.quad_enable(nor);
+        if (ret < 0)
+            return ret;
+    }
+    
+    ret = spi_nor_late_init_fixups(nor);
+    if (ret < 0)
+        return ret;
+    
+    spi_nor_init_unique_id(nor);
+    
+    return SPI_NOR_OK;
 }
 
-int spi_nor_release_power_down(struct spi_nor *nor)
+/**
+ * @brief  执行一次 命令+地址+dummy+数据 操作
+ * @param  nor SPI NOR设备
+ * @param  op  操作描述
+ * @retval 0=成功, 负数=错误码
+ */
+int spi_nor_exec_op(struct spi_nor *nor, const struct spi_nor_op *op)
 {
-    if (!nor || !nor->spi)
+    struct spi_message m;
+    struct spi_transfer t[3];
+    uint8_t addr[4];
+    int ret;
+    
+    if (!nor || !nor->spi || !op)
         return -EINVAL;
-        
-    return spi_w8r8(nor->spi, SPINOR_CMD_RELEASE_POWER_DOWN);
+    
+    spi_message_init(&m);
+    ret = spi_nor_op_add_xfers(op, t, addr, &m);
+    if (ret < 0)
+        return ret;
+    
+    return spi_nor_sync(nor, &m);
 }
 
-int spi_nor_software_reset(struct spi_nor *nor)
+/**
+ * @brief  QE位于SR2 bit1, 通过 31h 写SR2
+ */
+int spi_nor_sr2_bit1_quad_enable(struct spi_nor *nor)
 {
     int ret;
     
-    if (!nor || !nor->spi)
-        return -EINVAL;
+    ret = spi_nor_read_sr2(nor);
+    if (ret < 0)
+        return ret;
+    
+    if (ret & SPINOR_SR2_QUAD_EN_BIT1)
+        return SPI_NOR_OK;
+    
+    return spi_nor_write_sr2(nor, (uint8_t)ret | SPINOR_SR2_QUAD_EN_BIT1);
+}
+
+/**
+ * @brief  QE位于SR1 bit6 (Macronix)
+ */
+int spi_nor_sr1_bit6_quad_enable(struct spi_nor *nor)
+{
+    int ret;
     
-    /* 发送复位使能命令 */
-    ret = spi_w8r8(nor->spi, SPINOR_CMD_SRSTEN);
+    ret = spi_nor_read_sr1(nor);
     if (ret < 0)
         return ret;
-        
-    /* 发送复位命令 */
-    return spi_w8r8(nor->spi, SPINOR_CMD_SRST);
+    
+    if (ret & SPINOR_SR1_QUAD_EN_BIT6)
+        return SPI_NOR_OK;
+    
+    return spi_nor_write_sr1(nor, (uint8_t)ret | SPINOR_SR1_QUAD_EN_BIT6);
 }
 
-/* 状态寄存器操作 */
-int spi_nor_read_sr1(struct spi_nor *nor)
+/**
+ * @brief  QE位于SR2 bit7, 通过 3Fh/3Eh 读写SR2
+ */
+int spi_nor_sr2_bit7_quad_enable(struct spi_nor *nor)
 {
-    if (!nor || !nor->spi)
-        return -EINVAL;
-        
-    return spi_w8r8(nor->spi, SPINOR_CMD_RDSR);
+    uint8_t sr2;
+    int ret;
+    struct spi_nor_op op = {
+        .opcode = SPINOR_CMD_RDSR2_BIT7,
+        .proto = SNOR_PROTO_1_1_1,
+        .rx_buf = &sr2,
+        .len = 1,
+    };
+    
+    ret = spi_nor_exec_op(nor, &op);
+    if (ret < 0)
+        return ret;
+    
+    if (sr2 & SPINOR_SR2_QUAD_EN_BIT7)
+        return SPI_NOR_OK;
+    
+    ret = spi_nor_write_enable(nor);
+    if (ret < 0)
+        return ret;
+    
+    sr2 |= SPINOR_SR2_QUAD_EN_BIT7;
+    op.opcode = SPINOR_CMD_WRSR2_BIT7;
+    op.rx_buf = NULL;
+    op.tx_buf = &sr2;
+    ret = spi_nor_exec_op(nor, &op);
+    if (ret < 0)
+        return ret;
+    
+    return spi_nor_wait_ready(nor, SPI_NOR_TIMEOUT_MS);
 }
 
-int spi_nor_read_sr2(struct spi_nor *nor)
+/* 基本电源管理与控制命令 */
+/**
+ * @brief  立即进入深度掉电
+ * @retval 0=成功, SPI_NOR_ERR_BUSY=擦写进行中或内存映射中, 负数=错误码
+ * @note   之后的访问会自动唤醒, 与 spi_nor_pm_enable() 是否开启无关
+ */
+int spi_nor_power_down(struct spi_nor *nor)
 {
+    uint8_t cmd = SPINOR_CMD_POWER_DOWN;
+    int ret;
+    
     if (!nor || !nor->spi)
         return -EINVAL;
-        
-    return spi_w8r8(nor->spi, SPINOR_CMD_RDSR2);
+    
+    if (nor->async.busy || nor->pm.active)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (nor->pm.state == SNOR_PM_POWER_DOWN)
+        return SPI_NOR_OK;
+    
+    stimer_stop(&nor->pm.timer);
+    
+    /* B9h 后不能再有时钟, 且不经过访问计数 (会先唤醒器件) */
+    ret = spi_write(nor->spi, &cmd, 1);
+    if (ret < 0)
+        return ret;
+    
+    spi_nor_pm_set_state(nor, SNOR_PM_POWER_DOWN);
+    nor->pm.stats.power_downs++;
+    
+    return SPI_NOR_OK;
 }
 
-int spi_nor_read_sr3(struct spi_nor *nor)
+/**
+ * @brief  退出深度掉电, 返回前已等待 tRES1
+ */
+int spi_nor_release_power_down(struct spi_nor *nor)
 {
     if (!nor || !nor->spi)
         return -EINVAL;
-        
-    return spi_w8r8(nor->spi, SPINOR_CMD_RDSR3);
+    
+    return spi_nor_pm_wake(nor);
 }
 
-int spi_nor_write_sr1(struct spi_nor *nor, uint8_t status)
+/**
+ * @brief  开启/关闭空闲自动掉电
+ * @param  nor     SPI NOR设备, 须已 spi_nor_scan()
+ * @param  idle_ms 最后一次访问结束后经过该时间进入深度掉电, 0=关闭
+ * @retval 0=成功, SPI_NOR_ERR_NOT_SUPPORTED=器件不支持深度掉电, 负数=错误码
+ * @note   掉电后的任何访问先发 ABh 并等待 tRES1, 调用方无需感知;
+ *         异步擦写/分段读进行中与内存映射期间不会掉电. 关闭时若已掉电则立即唤醒
+ */
+int spi_nor_pm_enable(struct spi_nor *nor, uint32_t idle_ms)
 {
-    int ret;
+    struct spi_nor_pm *pm;
     
     if (!nor || !nor->spi)
         return -EINVAL;
     
-    ret = spi_nor_write_enable(nor);
-    if (ret < 0)
-        return ret;
+    if (idle_ms && (nor->flags & SNOR_F_NO_DPD))
+        return SPI_NOR_ERR_NOT_SUPPORTED;
     
-    uint8_t cmd[2] = {SPINOR_CMD_WRSR, status};
-    ret = spi_write(nor->spi, cmd, sizeof(cmd));
-    if (ret < 0)
-        return ret;
-        
-    return spi_nor_wait_ready(nor, SPI_NOR_TIMEOUT_MS);
+    pm = &nor->pm;
+    pm->idle_ms = idle_ms;
+    
+    if (idle_ms) {
+        spi_nor_pm_schedule(nor, idle_ms);
+        return SPI_NOR_OK;
+    }
+    
+    stimer_stop(&pm->timer);
+    
+    if (pm->state == SNOR_PM_POWER_DOWN)
+        return spi_nor_pm_wake(nor);
+    
+    return SPI_NOR_OK;
 }
 
-/* 擦除操作 */
-int spi_nor_chip_erase(struct spi_nor *nor)
+/**
+ * @brief  取空闲掉电统计, 当前状态的时间计到调用时刻
+ */
+void spi_nor_pm_get_stats(struct spi_nor *nor, struct spi_nor_pm_stats *stats)
+{
+    if (!nor || !stats)
+        return;
+    
+    *stats = nor->pm.stats;
+    stats->time_ms[nor->pm.state] += HAL_GetTick() - nor->pm.state_ms;
+}
+
+int spi_nor_software_reset(struct spi_nor *nor)
 {
     int ret;
     
     if (!nor || !nor->spi)
         return -EINVAL;
     
-    ret = spi_nor_write_enable(nor);
+    /* 66h/99h 均为单字节命令, 其后不能再读出数据 */
+    ret = spi_nor_send_cmd(nor, SPINOR_CMD_SRSTEN);
     if (ret < 0)
         return ret;
-    
-    ret = spi_w8r8(nor->spi, SPINOR_CMD_CHIP_ERASE);
+        
+    ret = spi_nor_send_cmd(nor, SPINOR_CMD_SRST);
     if (ret < 0)
         return ret;
-        
-    return spi_nor_wait_ready(nor, SPI_NOR_ERASE_TIMEOUT_MS);
+    
+    bsp_dwt_delay_us(SPI_NOR_RESET_US);
+    
+    /* 复位后器件回到3字节地址模式 */
+    if (nor->flags & SNOR_F_4B_MODE) {
+        ret = spi_nor_enter_4byte_address_mode(nor);
+        if (ret < 0)
+            return ret;
+    }
+    
+    /* 状态寄存器恢复为非易失值, 易失写入的QE随之清除 */
+    if ((spi_nor_get_protocol_data_nbits(nor->read_proto) == 4 ||
+         spi_nor_get_protocol_data_nbits(nor->write_proto) == 4) &&
+        nor->params.quad_enable)
+        return nor->params.quad_enable(nor);
+    
+    return SPI_NOR_OK;
 }
 
-int spi_nor_sector_erase(struct spi_nor *nor, uint32_t addr)
+/**
+ * @brief  暂停进行中的异步擦除/页编程, 以便读取其它区域
+ * @retval 0=已暂停或无需暂停, 负数=错误码
+ * @note   暂停期间轮询不解析WIP; 必须与 spi_nor_resume() 成对使用
+ */
+int spi_nor_suspend(struct spi_nor *nor)
 {
+    struct spi_nor_async *async;
+    uint8_t opcode;
     int ret;
-    uint8_t cmd[4];
     
     if (!nor || !nor->spi)
         return -EINVAL;
     
-    ret = spi_nor_write_enable(nor);
-    if (ret < 0)
+    async = &nor->async;
+    if (!async->busy || async->suspended)
+        return SPI_NOR_OK;
+    
+    if (!(nor->flags & SNOR_F_SUSPEND))
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    /* tRS: 恢复后须给擦写留出推进时间, 否则连续读会让擦除饿死 */
+    if ((HAL_GetTick() - async->resume_ms) < 1U)
+        bsp_dwt_delay_us(nor->params.resume_to_suspend_us);
+    
+    opcode = async->is_erase ? nor->params.erase_suspend_opcode :
+                               nor->params.program_suspend_opcode;
+    
+    /* 先置标志, 已排队的RDSR完成时不会把暂停误判为完成 */
+    async->suspended = 1;
+    async->suspend_ms = HAL_GetTick();
+    
+    ret = spi_nor_send_cmd(nor, opcode);
+    if (ret < 0) {
+        async->suspended = 0;
         return ret;
+    }
     
-    cmd[0] = SPINOR_CMD_BE_4K;
-    cmd[1] = (addr >> 16) & 0xFF;
-    cmd[2] = (addr >> 8) & 0xFF;
-    cmd[3] = addr & 0xFF;
+    bsp_dwt_delay_us(nor->params.suspend_latency_us);
     
-    ret = spi_write(nor->spi, cmd, sizeof(cmd));
+    /* 暂停状态位因厂商而异 (SR2/安全寄存器/FSR), 由修正提供读法 */
+    ret = nor->params.suspend_status(nor);
     if (ret < 0)
-        return ret;
-        
-    return spi_nor_wait_ready(nor, SPI_NOR_ERASE_TIMEOUT_MS);
+        goto err_resume;
+    
+    if (ret)
+        return SPI_NOR_OK;
+    
+    /* 未进入暂停: 若WIP已清除说明擦写恰好完成, 交由轮询收尾 */
+    ret = spi_nor_read_sr1(nor);
+    if (ret < 0)
+        goto err_resume;
+    
+    if (ret & SPINOR_SR1_WIP) {
+        ret = SPI_NOR_ERR_BUSY;
+        goto err_resume;
+    }
+    
+    async->suspended = 0;
+    return SPI_NOR_OK;
+    
+err_resume:
+    (void)spi_nor_resume(nor);
+    return ret;
 }
 
-/* 编程操作 */
-int spi_nor_page_program(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data)
+/**
+ * @brief  恢复被 spi_nor_suspend() 暂停的擦除/页编程
+ * @retval 0=成功, 负数=错误码
+ */
+int spi_nor_resume(struct spi_nor *nor)
 {
+    struct spi_nor_async *async;
+    uint8_t opcode;
     int ret;
-    uint8_t cmd[4];
     
-    if (!nor || !nor->spi || !data)
+    if (!nor || !nor->spi)
         return -EINVAL;
     
-    if (len > nor->page_size)
-        len = nor->page_size;
+    async = &nor->async;
+    if (!async->suspended)
+        return SPI_NOR_OK;
     
-    ret = spi_nor_write_enable(nor);
+    opcode = async->is_erase ? nor->params.erase_resume_opcode :
+                               nor->params.program_resume_opcode;
+    
+    ret = spi_nor_send_cmd(nor, opcode);
     if (ret < 0)
         return ret;
     
-    cmd[0] = SPINOR_CMD_PP;
-    cmd[1] = (addr >> 16) & 0xFF;
-    cmd[2] = (addr >> 8) & 0xFF;
-    cmd[3] = addr & 0xFF;
+    async->resume_ms = HAL_GetTick();
+    async->start_ms += async->resume_ms - async->suspend_ms;
+    async->suspended = 0;
     
-    struct spi_message msg_tx = {
-        .send_buf = cmd,
-        .length = sizeof(cmd),
-        .cs_change = 0,
-        .next = NULL
-    };
+    return SPI_NOR_OK;
+}
+
+/* 状态寄存器操作 */
+int spi_nor_read_sr1(struct spi_nor *nor)
+{
+    if (!nor || !nor->spi)
+        return -EINVAL;
+        
+    return spi_nor_w8r8(nor, SPINOR_CMD_RDSR);
+}
+
+int spi_nor_read_sr2(struct spi_nor *nor)
+{
+    if (!nor || !nor->spi)
+        return -EINVAL;
+        
+    return spi_nor_w8r8(nor, SPINOR_CMD_RDSR2);
+}
+
+int spi_nor_read_sr3(struct spi_nor *nor)
+{
+    if (!nor || !nor->spi)
+        return -EINVAL;
+        
+    return spi_nor_w8r8(nor, SPINOR_CMD_RDSR3);
+}
+
+int spi_nor_write_sr1(struct spi_nor *nor, uint8_t status)
+{
+    return spi_nor_write_sr_op(nor, SPINOR_CMD_WRSR, &status, 1, false);
+}
+
+int spi_nor_write_sr2(struct spi_nor *nor, uint8_t status)
+{
+    return spi_nor_write_sr_op(nor, SPINOR_CMD_WRSR2, &status, 1, false);
+}
+
+int spi_nor_write_sr3(struct spi_nor *nor, uint8_t status)
+{
+    return spi_nor_write_sr_op(nor, SPINOR_CMD_WRSR3, &status, 1, false);
+}
+
+/**
+ * @brief  易失写状态寄存器: 50h 后紧跟写命令, 只改变寄存器当前值, 不写入非易失单元
+ * @note   不消耗擦写寿命, 也没有 tW 的非易失写时间; 掉电后恢复非易失值.
+ *         需器件支持 (SNOR_F_SR_VOLATILE)
+ */
+int spi_nor_write_volatile_sr1(struct spi_nor *nor, uint8_t status)
+{
+    return spi_nor_write_sr_op(nor, SPINOR_CMD_WRSR, &status, 1, true);
+}
+
+int spi_nor_write_volatile_sr2(struct spi_nor *nor, uint8_t status)
+{
+    return spi_nor_write_sr_op(nor, SPINOR_CMD_WRSR2, &status, 1, true);
+}
+
+int spi_nor_write_volatile_sr3(struct spi_nor *nor, uint8_t status)
+{
+    return spi_nor_write_sr_op(nor, SPINOR_CMD_WRSR3, &status, 1, true);
+}
+
+int spi_nor_write_enable_for_volatile_sr(struct spi_nor *nor)
+{
+    if (!nor || !nor->spi)
+        return -EINVAL;
     
-    struct spi_message msg_data = {
-        .send_buf = data,
-        .length = len,
-        .cs_change = 1,
-        .next = NULL
-    };
+    if (!(nor->flags & SNOR_F_SR_VOLATILE))
+        return SPI_NOR_ERR_NOT_SUPPORTED;
     
-    msg_tx.next = &msg_data;
+    return spi_nor_send_cmd(nor, SPINOR_CMD_EWSR);
+}
+
+/**
+ * @brief  01h 一次写入SR1与SR2
+ * @param  vol true=易失写 (50h), false=非易失写 (WREN)
+ * @note   部分器件单字节 01h 会把SR2清零 (含QE), 同时修改两者时应使用本函数
+ */
+int spi_nor_write_sr1_sr2(struct spi_nor *nor, uint8_t sr1, uint8_t sr2, bool vol)
+{
+    uint8_t sr[2] = {sr1, sr2};
     
-    ret = spi_transfer_message(nor->spi, &msg_tx);
-    if (ret < 0)
-        return ret;
-        
-    return spi_nor_wait_ready(nor, SPI_NOR_WRITE_TIMEOUT_MS);
+    return spi_nor_write_sr_op(nor, SPINOR_CMD_WRSR, sr, sizeof(sr), vol);
 }
 
-/* 读取操作 */
-int spi_nor_read_data(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data)
+/* 安全寄存器操作 */
+/**
+ * @brief  读安全寄存器
+ * @param  offs 各区域首尾相接后的偏移, 区域n从 n * otp.len 开始
+ * @retval 0=成功, 负数=错误码
+ */
+int spi_nor_read_security_register(struct spi_nor *nor, uint32_t offs, uint32_t len, uint8_t *buf)
 {
-    uint8_t cmd[4];
+    uint32_t addr;
+    uint32_t n;
+    int ret;
     
-    if (!nor || !nor->spi || !data)
+    if (!nor || !nor->spi || (!buf && len))
         return -EINVAL;
     
-    cmd[0] = SPINOR_CMD_READ;
-    cmd[1] = (addr >> 16) & 0xFF;
-    cmd[2] = (addr >> 8) & 0xFF;
-    cmd[3] = addr & 0xFF;
+    if (!nor->params.otp.n_regions || !nor->params.otp.ops->read)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    while (len) {
+        ret = spi_nor_otp_offs_to_addr(nor, offs, len, &addr, &n);
+        if (ret < 0)
+            return ret;
+        
+        ret = nor->params.otp.ops->read(nor, addr, n, buf);
+        if (ret < 0)
+            return ret;
+        
+        offs += n;
+        buf += n;
+        len -= n;
+    }
     
-    return spi_write_then_read(nor->spi, cmd, sizeof(cmd), data, len);
+    return SPI_NOR_OK;
 }
 
-/* Private functions ---------------------------------------------------------*/
-static int spi_nor_wait_ready(struct spi_nor *nor, uint32_t timeout_ms)
+/**
+ * @brief  编程安全寄存器, 已锁定的区域返回 -EACCES
+ */
+int spi_nor_program_security_register(struct spi_nor *nor, uint32_t offs, uint32_t len,
+                                      const uint8_t *buf)
 {
+    const struct spi_nor_otp *otp;
+    uint32_t addr;
+    uint32_t n;
     int ret;
     
-    SPI_NOR_WAIT_TIMEOUT(timeout_ms) {
-        ret = spi_nor_read_sr1(nor);
+    if (!nor || !nor->spi || (!buf && len))
+        return -EINVAL;
+    
+    otp = &nor->params.otp;
+    if (!otp->n_regions || !otp->ops->write)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    while (len) {
+        ret = spi_nor_otp_offs_to_addr(nor, offs, len, &addr, &n);
+        if (ret < 0)
+            return ret;
+        
+        if (otp->ops->is_locked) {
+            ret = otp->ops->is_locked(nor, offs / otp->len);
+            if (ret < 0)
+                return ret;
+            if (ret)
+                return -EACCES;
+        }
+        
+        ret = otp->ops->write(nor, addr, n, buf);
         if (ret < 0)
             return ret;
-            
-        if (!(ret & SPINOR_SR1_WIP))
-            return SPI_NOR_OK;
+        
+        offs += n;
+        buf += n;
+        len -= n;
     }
     
-    return SPI_NOR_ERR_TIMEOUT;
+    return SPI_NOR_OK;
 }
 
-static int spi_nor_write_enable(struct spi_nor *nor)
+/**
+ * @brief  擦除一个安全寄存器区域, 已锁定的区域返回 -EACCES
+ */
+int spi_nor_erase_security_register(struct spi_nor *nor, uint32_t region)
 {
+    const struct spi_nor_otp *otp;
     int ret;
-    uint8_t cmd = SPINOR_CMD_WREN;
     
-    ret = spi_write(nor->spi, &cmd, 1);
+    if (!nor || !nor->spi)
+        return -EINVAL;
+    
+    otp = &nor->params.otp;
+    if (!otp->n_regions || !otp->ops->erase)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    if (region >= otp->n_regions)
+        return SPI_NOR_ERR_INVALID_ADDR;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (otp->ops->is_locked) {
+        ret = otp->ops->is_locked(nor, region);
+        if (ret < 0)
+            return ret;
+        if (ret)
+            return -EACCES;
+    }
+    
+    return otp->ops->erase(nor, otp->base + region * otp->offset);
+}
+
+/**
+ * @brief  48h 读安全寄存器, 8个dummy周期
+ */
+int spi_nor_otp_read_secr(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *buf)
+{
+    struct spi_nor_op op;
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = SPINOR_CMD_RSECR;
+    op.addr_nbytes = spi_nor_otp_addr_nbytes(nor);
+    op.dummy_cycles = 8;
+    op.addr = addr;
+    op.proto = SNOR_PROTO_1_1_1;
+    op.rx_buf = buf;
+    op.len = len;
+    
+    return spi_nor_exec_op(nor, &op);
+}
+
+/**
+ * @brief  42h 编程安全寄存器, 按页边界拆分
+ */
+int spi_nor_otp_write_secr(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *buf)
+{
+    struct spi_nor_op op;
+    uint32_t page_size = nor->page_size ? nor->page_size : 256U;
+    uint32_t n;
+    int ret;
+    
+    while (len) {
+        n = page_size - (addr & (page_size - 1U));
+        if (n > len)
+            n = len;
+        
+        (void)memset(&op, 0, sizeof(op));
+        op.opcode = SPINOR_CMD_PSECR;
+        op.addr_nbytes = spi_nor_otp_addr_nbytes(nor);
+        op.addr = addr;
+        op.proto = SNOR_PROTO_1_1_1;
+        op.tx_buf = buf;
+        op.len = n;
+        
+        ret = spi_nor_write_op(nor, &op);
+        if (ret < 0)
+            return ret;
+        
+        ret = spi_nor_wait_pp_ready(nor, n);
+        if (ret < 0)
+            return ret;
+        
+        addr += n;
+        buf += n;
+        len -= n;
+    }
+    
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  44h 擦除 addr 所在的安全寄存器区域
+ */
+int spi_nor_otp_erase_secr(struct spi_nor *nor, uint32_t addr)
+{
+    struct spi_nor_op op;
+    int ret;
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = SPINOR_CMD_ESECR;
+    op.addr_nbytes = spi_nor_otp_addr_nbytes(nor);
+    op.addr = addr;
+    op.proto = SNOR_PROTO_1_1_1;
+    
+    ret = spi_nor_write_op(nor, &op);
+    if (ret < 0)
+        return ret;
+    
+    ret = spi_nor_wait_ready(nor, SPI_NOR_ERASE_TIMEOUT_MS);
+    
+    return (ret == SPI_NOR_ERR_TIMEOUT) ? SPI_NOR_ERR_ERASE : ret;
+}
+
+/* 设备ID与参数读取 */
+/**
+ * @brief  4Bh 读出厂唯一ID
+ * @param  unique_id 至少 params.unique_id_len 字节
+ * @retval 负数=错误码, 否则为ID字节数
+ */
+int spi_nor_read_unique_id(struct spi_nor *nor, uint8_t *unique_id)
+{
+    struct spi_nor_op op;
+    int ret;
+    
+    if (!nor || !nor->spi || !unique_id)
+        return -EINVAL;
+    
+    if (!nor->params.unique_id_len)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = SPINOR_CMD_RDUID;
+    op.dummy_cycles = nor->params.unique_id_dummy;
+    op.proto = SNOR_PROTO_1_1_1;
+    op.rx_buf = unique_id;
+    op.len = nor->params.unique_id_len;
+    
+    ret = spi_nor_exec_op(nor, &op);
+    if (ret < 0)
+        return ret;
+    
+    return nor->params.unique_id_len;
+}
+
+int spi_nor_read_jedec_id(struct spi_nor *nor)
+{
+    uint8_t id[3];
+    int ret;
+    struct spi_nor_op op = {
+        .opcode = SPINOR_CMD_RDID,
+        .proto = SNOR_PROTO_1_1_1,
+        .rx_buf = id,
+        .len = sizeof(id),
+    };
+    
+    if (!nor || !nor->spi)
+        return -EINVAL;
+    
+    ret = spi_nor_exec_op(nor, &op);
+    if (ret < 0)
+        return ret;
+    
+    /* 总线悬空或器件未上电 */
+    if ((id[0] == 0x00 && id[1] == 0x00) || (id[0] == 0xFF && id[1] == 0xFF))
+        return -ENODEV;
+    
+    nor->manufacturer_id = id[0];
+    nor->device_id = ((uint16_t)id[1] << 8) | id[2];
+    
+    return SPI_NOR_OK;
+}
+
+/* 擦除操作 */
+int spi_nor_chip_erase(struct spi_nor *nor)
+{
+    int ret;
+    
+    if (!nor || !nor->spi)
+        return -EINVAL;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    ret = spi_nor_write_enable(nor);
+    if (ret < 0)
+        return ret;
+    
+    ret = spi_nor_send_cmd(nor, SPINOR_CMD_CHIP_ERASE);
+    if (ret < 0)
+        return ret;
+        
+    return spi_nor_wait_ready(nor, SPI_NOR_CHIP_ERASE_TIMEOUT_MS);
+}
+
+/**
+ * @brief  擦除 addr 起的一个扇区 (sector_size), 小扇区区域内拆成多条命令
+ */
+int spi_nor_sector_erase(struct spi_nor *nor, uint32_t addr)
+{
+    if (!nor || !nor->spi)
+        return -EINVAL;
+    
+    return spi_nor_erase(nor, addr, nor->sector_size, NULL);
+}
+
+/**
+ * @brief  区域擦除, 尽量使用大块擦除命令
+ * @param  nor  SPI NOR设备
+ * @param  addr 起始地址, 须按所在区域的最小擦除粒度对齐
+ * @param  len  长度, 结束地址须按所在区域的最小擦除粒度对齐
+ * @param  fail_addr 失败时写入出错的块地址, 可为NULL
+ * @retval 0=成功, 负数=错误码
+ * @note   每一步取与当前地址对齐且不超出剩余长度的最大擦除类型,
+ *         区域两端自然退化为小块擦除; 非均匀扇区的器件只使用各擦除区域支持的类型
+ */
+int spi_nor_erase(struct spi_nor *nor, uint32_t addr, uint32_t len, uint32_t *fail_addr)
+{
+    const struct spi_nor_erase_type *erase;
+    uint32_t timeout_ms;
+    int ret;
+    
+    if (!nor || !nor->spi || !nor->sector_size)
+        return -EINVAL;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (addr >= nor->capacity || len > nor->capacity - addr)
+        return SPI_NOR_ERR_INVALID_ADDR;
+    
+    /* 起止地址分别按所在区域的最小擦除粒度对齐 */
+    if (len) {
+        uint32_t end;
+        uint32_t head;
+        uint32_t tail;
+        
+        head = spi_nor_min_erase_size(nor, spi_nor_erase_mask_at(nor, addr, &end));
+        tail = spi_nor_min_erase_size(nor, spi_nor_erase_mask_at(nor, addr + len - 1U, &end));
+        if (!head || !tail || (addr % head) || ((addr + len) % tail))
+            return SPI_NOR_ERR_NOT_ALIGNED;
+    }
+    
+    while (len) {
+        erase = spi_nor_select_erase_type(nor, addr, len);
+        if (!erase)
+            return SPI_NOR_ERR_NOT_ALIGNED;
+        
+        ret = spi_nor_erase_op(nor, erase->opcode, addr);
+        if (ret >= 0) {
+            timeout_ms = erase->max_ms ? erase->max_ms : SPI_NOR_ERASE_TIMEOUT_MS;
+            ret = spi_nor_wait_ready(nor, timeout_ms);
+        }
+        if (ret < 0) {
+            if (fail_addr)
+                *fail_addr = addr;
+            return ret;
+        }
+        
+        addr += erase->size;
+        len -= erase->size;
+    }
+    
+    return SPI_NOR_OK;
+}
+
+/* 编程操作 */
+int spi_nor_page_program(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data)
+{
+    int ret;
+    
+    if (!nor || !nor->spi || !data)
+        return -EINVAL;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (len > nor->page_size)
+        len = nor->page_size;
+    
+    ret = spi_nor_pp_op(nor, addr, len, data);
+    if (ret < 0)
+        return ret;
+        
+    return spi_nor_wait_pp_ready(nor, len);
+}
+
+/**
+ * @brief  任意地址/长度写入, 按页边界拆分
+ * @param  nor  SPI NOR设备
+ * @param  addr 起始地址, 无对齐要求
+ * @param  len  字节数
+ * @param  buf  数据
+ * @retval 0=成功, 负数=错误码
+ * @note   目标区域须已擦除; 每页一条 WREN+PP 消息
+ */
+int spi_nor_write(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *buf)
+{
+    uint32_t chunk;
+    int ret;
+    
+    if (!nor || !nor->spi || !buf || !nor->page_size)
+        return -EINVAL;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (addr >= nor->capacity || len > nor->capacity - addr)
+        return SPI_NOR_ERR_INVALID_ADDR;
+    
+    while (len) {
+        /* 跨页会回卷到本页起始 */
+        chunk = nor->page_size - (addr % nor->page_size);
+        if (chunk > len)
+            chunk = len;
+        
+        ret = spi_nor_pp_op(nor, addr, chunk, buf);
+        if (ret < 0)
+            return ret;
+        
+        ret = spi_nor_wait_pp_ready(nor, chunk);
+        if (ret < 0)
+            return ret;
+        
+        addr += chunk;
+        buf += chunk;
+        len -= chunk;
+    }
+    
+    return SPI_NOR_OK;
+}
+
+/* 异步擦写 */
+/**
+ * @brief  发起扇区擦除后立即返回, 由软件定时器按典型擦除时间轮询WIP
+ * @param  nor  SPI NOR设备
+ * @param  addr 扇区地址 (按sector_size对齐)
+ * @param  done 完成回调, 在定时器或SPI完成上下文中调用
+ * @param  arg  回调参数
+ * @retval 0=已发起, SPI_NOR_ERR_NOT_SUPPORTED=该扇区位于小扇区区域, 需多条命令,
+ *         其他负数=错误码 (此时不会调用done)
+ */
+int spi_nor_erase_async(struct spi_nor *nor, uint32_t addr, spi_nor_done_t done, void *arg)
+{
+    const struct spi_nor_erase_type *erase;
+    int ret;
+    
+    if (!nor || !nor->spi || !nor->sector_size)
+        return -EINVAL;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (addr % nor->sector_size)
+        return SPI_NOR_ERR_NOT_ALIGNED;
+    
+    if (addr >= nor->capacity)
+        return SPI_NOR_ERR_INVALID_ADDR;
+    
+    erase = spi_nor_select_erase_type(nor, addr, nor->sector_size);
+    if (!erase)
+        return SPI_NOR_ERR_NOT_ALIGNED;
+    if (erase->size != nor->sector_size)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    ret = spi_nor_erase_op(nor, erase->opcode, addr);
+    if (ret < 0)
+        return ret;
+    
+    nor->async.addr = addr;
+    nor->async.len = nor->sector_size;
+    nor->async.is_erase = 1;
+    
+    if (erase->typ_ms)
+        return spi_nor_async_start(nor, erase->typ_ms * 1000U, erase->max_ms, done, arg);
+    
+    return spi_nor_async_start(nor, 45000U, SPI_NOR_ERASE_TIMEOUT_MS, done, arg);
+}
+
+/**
+ * @brief  发起页编程后立即返回, 数据不得跨页
+ * @param  nor  SPI NOR设备
+ * @param  addr 起始地址
+ * @param  len  长度 (不超过到页尾的剩余字节)
+ * @param  data 数据, 函数返回后即可释放
+ * @param  done 完成回调
+ * @param  arg  回调参数
+ * @retval 0=已发起, 负数=错误码 (此时不会调用done)
+ */
+int spi_nor_program_async(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *data,
+                          spi_nor_done_t done, void *arg)
+{
+    uint32_t max_ms;
+    int ret;
+    
+    if (!nor || !nor->spi || !data || !len || !nor->page_size)
+        return -EINVAL;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if ((addr % nor->page_size) + len > nor->page_size)
+        return SPI_NOR_ERR_NOT_ALIGNED;
+    
+    ret = spi_nor_pp_op(nor, addr, len, data);
+    if (ret < 0)
+        return ret;
+    
+    nor->async.addr = addr;
+    nor->async.len = len;
+    nor->async.is_erase = 0;
+    
+    max_ms = (nor->params.page_program_max_us + 999U) / 1000U;
+    return spi_nor_async_start(nor, nor->params.page_program_typ_us,
+                               max_ms ? max_ms : SPI_NOR_WRITE_TIMEOUT_MS, done, arg);
+}
+
+/**
+ * @brief  是否有异步擦写正在进行
+ */
+bool spi_nor_is_busy(struct spi_nor *nor)
+{
+    return nor && nor->async.busy;
+}
+
+/* 读取操作 */
+/**
+ * @brief  读数据; 若有异步擦写进行且支持暂停, 则暂停 -> 读 -> 恢复
+ * @retval 0=成功, SPI_NOR_ERR_BUSY=与擦写区域重叠或器件不支持暂停
+ */
+int spi_nor_read_data(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data)
+{
+    struct spi_nor_async *async;
+    int ret;
+    int ret_resume;
+    
+    if (!nor || !nor->spi || !data)
+        return -EINVAL;
+    
+    async = &nor->async;
+    if (!async->busy)
+        return spi_nor_read_op(nor, addr, len, data);
+    
+    /* 正在擦写的区域内容不确定 */
+    if (addr < async->addr + async->len && async->addr < addr + len)
+        return SPI_NOR_ERR_BUSY;
+    
+    ret = spi_nor_suspend(nor);
+    if (ret == SPI_NOR_ERR_NOT_SUPPORTED)
+        return SPI_NOR_ERR_BUSY;
+    if (ret < 0)
+        return ret;
+    
+    ret = spi_nor_read_op(nor, addr, len, data);
+    ret_resume = spi_nor_resume(nor);
+    
+    return (ret < 0) ? ret : ret_resume;
+}
+
+/* 直接映射读 */
+/**
+ * @brief  通过控制器的内存映射窗口取得只读指针 (XIP/零拷贝)
+ * @param  nor  SPI NOR设备
+ * @param  addr 起始地址
+ * @param  len  期望长度
+ * @param  retlen 窗口内实际可连续访问的长度, 可为NULL
+ * @param  virt 返回指针
+ * @retval 0=成功, -ENOTSUPP=控制器无映射窗口, 负数=错误码
+ * @note   映射使用已选定的读命令; spi_nor_unpoint() 之前不得擦写
+ */
+int spi_nor_point(struct spi_nor *nor, uint32_t addr, uint32_t len,
+                  uint32_t *retlen, const void **virt)
+{
+    struct spi_mmap_info info;
+    const void *base;
+    size_t size;
+    int ret;
+    
+    if (!nor || !nor->spi || !virt)
+        return -EINVAL;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (addr >= nor->capacity || len > nor->capacity - addr)
+        return SPI_NOR_ERR_INVALID_ADDR;
+    
+    (void)memset(&info, 0, sizeof(info));
+    info.opcode = nor->read_opcode;
+    info.addr_nbytes = nor->addr_nbytes;
+    info.dummy_cycles = nor->read_dummy;
+    info.cmd_nbits = spi_nor_get_protocol_inst_nbits(nor->read_proto);
+    info.addr_nbits = spi_nor_get_protocol_addr_nbits(nor->read_proto);
+    info.data_nbits = spi_nor_get_protocol_data_nbits(nor->read_proto);
+    info.dtr = spi_nor_protocol_is_dtr(nor->read_proto);
+    
+    /* 映射期间的读不经过驱动, 首次映射持有一次访问计数直到最后一次 spi_nor_unpoint() */
+    if (!nor->pm.pointed) {
+        ret = spi_nor_pm_get(nor);
+        if (ret < 0)
+            return ret;
+    }
+    
+    ret = spi_mmap_enable(nor->spi, &info, &base, &size);
+    if (ret < 0) {
+        if (!nor->pm.pointed)
+            spi_nor_pm_put(nor);
+        return ret;
+    }
+    nor->pm.pointed++;
+    
+    if (addr >= size) {
+        (void)spi_nor_unpoint(nor);
+        return SPI_NOR_ERR_INVALID_ADDR;
+    }
+    
+    *virt = (const uint8_t *)base + addr;
+    if (retlen)
+        *retlen = (len > size - addr) ? (uint32_t)(size - addr) : len;
+    
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  释放一次 spi_nor_point() 取得的映射, 须与其成对调用
+ */
+int spi_nor_unpoint(struct spi_nor *nor)
+{
+    if (!nor || !nor->spi)
+        return -EINVAL;
+    
+    if (!nor->pm.pointed)
+        return SPI_NOR_OK;
+    
+    /* spi_mmap_enable() 按次计数, 与每次 spi_nor_point() 一一对应 */
+    spi_mmap_disable(nor->spi);
+    
+    if (--nor->pm.pointed == 0U)
+        spi_nor_pm_put(nor);
+    
+    return SPI_NOR_OK;
+}
+
+/* MTD接口 */
+/**
+ * @brief  初始化内嵌的 mtd_info, 须在 spi_nor_scan() 成功后调用
+ * @param  nor  SPI NOR设备
+ * @param  name MTD设备名, NULL时使用 nor->name
+ * @retval 0=成功, 负数=错误码
+ * @note   erasesize取全片都能单独擦除的最小块 (sector_size), mtd_erase() 内部自动合并为
+ *         大块擦除; 非均匀扇区的器件另外给出 eraseregions
+ */
+int spi_nor_mtd_init(struct spi_nor *nor, const char *name)
+{
+    struct mtd_info *mtd;
+    
+    if (!nor || !nor->spi || !nor->capacity || !nor->sector_size)
+        return -EINVAL;
+    
+    mtd = &nor->mtd;
+    (void)memset(mtd, 0, sizeof(*mtd));
+    
+    mtd->name = name ? name : nor->name;
+    mtd->type = MTD_NORFLASH;
+    mtd->flags = MTD_CAP_NORFLASH;
+    mtd->size = nor->capacity;
+    mtd->erasesize = nor->sector_size;
+#if MTD_SUPPORT_ERASE_REGIONS
+    spi_nor_init_erase_regions(nor);
+#endif
+    mtd->writesize = 1;
+    mtd->writesize_shift = 0;
+    mtd->_read = spi_nor_mtd_read;
+    mtd->_write = spi_nor_mtd_write;
+    mtd->_erase = spi_nor_mtd_erase;
+#if MTD_SUPPORT_IOVEC
+    mtd->_readv = spi_nor_mtd_readv;
+#endif
+#if MTD_SUPPORT_ERASE_ASYNC
+    mtd->_erase_start = spi_nor_mtd_erase_start;
+    mtd->_erase_wait = spi_nor_mtd_erase_wait;
+#endif
+#if MTD_SUPPORT_READ_ASYNC
+    mtd->_read_start = spi_nor_mtd_read_start;
+    mtd->_read_wait = spi_nor_mtd_read_wait;
+#endif
+#if MTD_SUPPORT_POINT
+    if (spi_mmap_supported(nor->spi)) {
+        mtd->_point = spi_nor_mtd_point;
+        mtd->_unpoint = spi_nor_mtd_unpoint;
+    }
+#endif
+    mtd->priv = nor;
+    
+    return SPI_NOR_OK;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void spi_nor_set_read(struct spi_nor_read_command *read, uint8_t num_mode_clocks,
+                             uint8_t num_wait_states, uint8_t opcode,
+                             enum spi_nor_protocol proto)
+{
+    read->num_mode_clocks = num_mode_clocks;
+    read->num_wait_states = num_wait_states;
+    read->opcode = opcode;
+    read->proto = proto;
+}
+
+static void spi_nor_set_pp(struct spi_nor_pp_command *pp, uint8_t opcode,
+                           enum spi_nor_protocol proto)
+{
+    pp->opcode = opcode;
+    pp->proto = proto;
+}
+
+static void spi_nor_set_erase_type(struct spi_nor_erase_type *erase, uint32_t size,
+                                   uint8_t opcode, uint32_t typ_ms, uint32_t max_ms)
+{
+    uint8_t shift = 0;
+    
+    while (size > (1UL << shift))
+        shift++;
+    
+    erase->size = size;
+    erase->size_shift = shift;
+    erase->opcode = opcode;
+    erase->typ_ms = typ_ms;
+    erase->max_ms = max_ms;
+}
+
+/**
+ * @brief  addr 处可用的擦除类型
+ * @param  end 返回所在区域的结束地址, 之后的擦除类型可能不同
+ */
+static uint8_t spi_nor_erase_mask_at(struct spi_nor *nor, uint32_t addr, uint32_t *end)
+{
+    const struct spi_nor_flash_parameter *params = &nor->params;
+    const struct spi_nor_erase_region *region;
+    uint8_t mask = 0;
+    uint32_t i;
+    
+    *end = params->size;
+    
+    if (params->n_regions) {
+        for (i = 0; i < params->n_regions; i++) {
+            region = &params->regions[i];
+            if (addr - region->offset < region->size) {
+                *end = region->offset + region->size;
+                return region->erase_mask;
+            }
+        }
+        return 0;
+    }
+    
+    for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+        if (params->erase_types[i].size)
+            mask |= (uint8_t)BIT(i);
+    }
+    
+    return mask;
+}
+
+/**
+ * @brief  mask 中最小的擦除尺寸, 0表示没有可用类型
+ */
+static uint32_t spi_nor_min_erase_size(struct spi_nor *nor, uint8_t mask)
+{
+    uint32_t size = 0;
+    uint32_t i;
+    
+    for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+        if (!(mask & BIT(i)) || !nor->params.erase_types[i].size)
+            continue;
+        if (!size || nor->params.erase_types[i].size < size)
+            size = nor->params.erase_types[i].size;
+    }
+    
+    return size;
+}
+
+/**
+ * @brief  未解析SFDP时的保守参数, 按JEDEC ID第三字节估算容量
+ */
+static void spi_nor_init_default_params(struct spi_nor *nor)
+{
+    struct spi_nor_flash_parameter *params = &nor->params;
+    uint8_t capacity_shift = (uint8_t)(nor->device_id & 0xFF);
+    
+    (void)memset(params, 0, sizeof(*params));
+    
+    params->size = (capacity_shift >= 16 && capacity_shift < 32) ?
+                   (1UL << capacity_shift) : nor->capacity;
+    params->page_size = nor->page_size ? nor->page_size : 256;
+    params->addr_nbytes = 3;
+    params->quad_enable = spi_nor_sr2_bit1_quad_enable;
+    
+    params->hwcaps = SNOR_HWCAPS_READ | SNOR_HWCAPS_READ_FAST | SNOR_HWCAPS_PP;
+    spi_nor_set_read(&params->reads[SNOR_CMD_READ], 0, 0,
+                     SPINOR_CMD_READ, SNOR_PROTO_1_1_1);
+    spi_nor_set_read(&params->reads[SNOR_CMD_READ_FAST], 0, 8,
+                     SPINOR_CMD_READ_FAST, SNOR_PROTO_1_1_1);
+    spi_nor_set_pp(&params->page_programs[SNOR_CMD_PP],
+                   SPINOR_CMD_PP, SNOR_PROTO_1_1_1);
+    
+    /* 典型/最大时间取常见25系列器件的数据手册值 */
+    params->page_program_typ_us = 700;
+    params->page_program_max_us = SPI_NOR_WRITE_TIMEOUT_MS * 1000U;
+    spi_nor_set_erase_type(&params->erase_types[0], 4096, SPINOR_CMD_BE_4K,
+                           45, 400);
+    spi_nor_set_erase_type(&params->erase_types[1], 32768, SPINOR_CMD_BE_32K,
+                           120, 1600);
+    spi_nor_set_erase_type(&params->erase_types[2], 65536, SPINOR_CMD_BE_64K,
+                           150, 2000);
+    /* 暂停/恢复需SFDP或型号表声明支持, 且修正提供 suspend_status */
+    params->erase_suspend_opcode = SPINOR_CMD_SUSPEND;
+    params->erase_resume_opcode = SPINOR_CMD_RESUME;
+    params->program_suspend_opcode = SPINOR_CMD_SUSPEND;
+    params->program_resume_opcode = SPINOR_CMD_RESUME;
+    params->suspend_latency_us = 30;
+    params->resume_to_suspend_us = 100;
+    params->power_down_us = SPI_NOR_TDP_US;
+    params->release_power_down_us = SPI_NOR_TRES1_US;
+}
+
+/**
+ * @brief  按JEDEC ID查找厂商与型号表项
+ */
+static void spi_nor_match_id(struct spi_nor *nor)
+{
+    const struct spi_nor_manufacturer *mfr;
+    uint32_t i;
+    uint32_t j;
+    
+    nor->manufacturer = NULL;
+    nor->info = NULL;
+    
+    for (i = 0; i < sizeof(spi_nor_manufacturers) / sizeof(spi_nor_manufacturers[0]); i++) {
+        mfr = spi_nor_manufacturers[i];
+        if (mfr->id != nor->manufacturer_id)
+            continue;
+        
+        nor->manufacturer = mfr;
+        for (j = 0; j < mfr->nparts; j++) {
+            if (mfr->parts[j].id == nor->device_id) {
+                nor->info = &mfr->parts[j];
+                break;
+            }
+        }
+        break;
+    }
+}
+
+/**
+ * @brief  型号表补充的参数, 用于无SFDP的器件; 有SFDP时被其覆盖
+ */
+static void spi_nor_info_init_params(struct spi_nor *nor)
+{
+    struct spi_nor_flash_parameter *params = &nor->params;
+    const struct flash_info *info = nor->info;
+    
+    if (!info)
+        return;
+    
+    if (info->size)
+        params->size = info->size;
+    
+    if (info->flags & SNOR_INFO_DUAL_READ) {
+        params->hwcaps |= SNOR_HWCAPS_READ_1_1_2;
+        spi_nor_set_read(&params->reads[SNOR_CMD_READ_1_1_2], 0, 8,
+                         SPINOR_CMD_READ_1_1_2, SNOR_PROTO_1_1_2);
+    }
+    
+    if (info->flags & SNOR_INFO_QUAD_READ) {
+        params->hwcaps |= SNOR_HWCAPS_READ_1_1_4;
+        spi_nor_set_read(&params->reads[SNOR_CMD_READ_1_1_4], 0, 8,
+                         SPINOR_CMD_READ_1_1_4, SNOR_PROTO_1_1_4);
+    }
+    
+    if (info->flags & SNOR_INFO_QUAD_PP) {
+        params->hwcaps |= SNOR_HWCAPS_PP_1_1_4;
+        spi_nor_set_pp(&params->page_programs[SNOR_CMD_PP_1_1_4],
+                       SPINOR_CMD_PP_1_1_4, SNOR_PROTO_1_1_4);
+    }
+    
+    if (info->flags & SNOR_INFO_SR_VOLATILE)
+        nor->flags |= SNOR_F_SR_VOLATILE;
+    
+    if (info->flags & SNOR_INFO_SUSPEND)
+        nor->flags |= SNOR_F_SUSPEND;
+}
+
+/* 厂商修正先于型号修正, 后者可覆盖前者 */
+static void spi_nor_default_init_fixups(struct spi_nor *nor)
+{
+    if (nor->manufacturer && nor->manufacturer->fixups &&
+        nor->manufacturer->fixups->default_init)
+        nor->manufacturer->fixups->default_init(nor);
+    
+    if (nor->info && nor->info->fixups && nor->info->fixups->default_init)
+        nor->info->fixups->default_init(nor);
+}
+
+static void spi_nor_post_sfdp_fixups(struct spi_nor *nor)
+{
+    if (nor->manufacturer && nor->manufacturer->fixups &&
+        nor->manufacturer->fixups->post_sfdp)
+        nor->manufacturer->fixups->post_sfdp(nor);
+    
+    if (nor->info && nor->info->fixups && nor->info->fixups->post_sfdp)
+        nor->info->fixups->post_sfdp(nor);
+}
+
+static int spi_nor_late_init_fixups(struct spi_nor *nor)
+{
+    int ret;
+    
+    if (nor->manufacturer && nor->manufacturer->fixups &&
+        nor->manufacturer->fixups->late_init) {
+        ret = nor->manufacturer->fixups->late_init(nor);
+        if (ret < 0)
+            return ret;
+    }
+    
+    if (nor->info && nor->info->fixups && nor->info->fixups->late_init)
+        return nor->info->fixups->late_init(nor);
+    
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  读唯一ID并按32位异或折叠到 nor->unique_id, 不支持或失败时为0
+ */
+static void spi_nor_init_unique_id(struct spi_nor *nor)
+{
+    uint8_t uid[SPI_NOR_UID_MAX];
+    uint32_t i;
+    int ret;
+    
+    nor->unique_id = 0;
+    
+    if (nor->params.unique_id_len > SPI_NOR_UID_MAX)
+        nor->params.unique_id_len = 0;
+    
+    ret = spi_nor_read_unique_id(nor, uid);
+    if (ret <= 0)
+        return;
+    
+    for (i = 0; i < (uint32_t)ret; i++)
+        nor->unique_id ^= (uint32_t)uid[i] << ((i & 3U) * 8U);
+}
+
+/**
+ * @brief  当前SPI总线能执行的协议
+ */
+static uint32_t spi_nor_bus_hwcaps(struct spi_nor *nor)
+{
+    uint32_t caps = spi_get_caps(nor->spi);
+    uint32_t hwcaps = SNOR_HWCAPS_READ | SNOR_HWCAPS_READ_FAST | SNOR_HWCAPS_PP;
+    int tx2 = (caps & (SPI_CAP_TX_DUAL | SPI_CAP_TX_QUAD)) != 0U;
+    int rx2 = (caps & (SPI_CAP_RX_DUAL | SPI_CAP_RX_QUAD)) != 0U;
+    int tx4 = (caps & SPI_CAP_TX_QUAD) != 0U;
+    int rx4 = (caps & SPI_CAP_RX_QUAD) != 0U;
+    int dtr = (caps & SPI_CAP_DTR) && (caps & SPI_CAP_DUMMY);
+    
+    if (rx2)
+        hwcaps |= SNOR_HWCAPS_READ_1_1_2;
+    if (tx2 && rx2)
+        hwcaps |= SNOR_HWCAPS_READ_1_2_2;
+    if (rx4)
+        hwcaps |= SNOR_HWCAPS_READ_1_1_4;
+    if (tx4 && rx4)
+        hwcaps |= SNOR_HWCAPS_READ_1_4_4;
+    if (tx4)
+        hwcaps |= SNOR_HWCAPS_PP_1_1_4 | SNOR_HWCAPS_PP_1_4_4;
+    
+    if (dtr) {
+        hwcaps |= SNOR_HWCAPS_READ_1_1_1_DTR;
+        if (tx2 && rx2)
+            hwcaps |= SNOR_HWCAPS_READ_1_2_2_DTR;
+        if (tx4 && rx4)
+            hwcaps |= SNOR_HWCAPS_READ_1_4_4_DTR;
+    }
+    
+    return hwcaps;
+}
+
+/**
+ * @brief  在 板级能力 & Flash能力 & 总线能力 中选取最快的读/写命令及最小擦除粒度
+ */
+static int spi_nor_select_protocols(struct spi_nor *nor, uint32_t hwcaps)
+{
+    struct spi_nor_flash_parameter *params = &nor->params;
+    const struct spi_nor_read_command *read;
+    const struct spi_nor_pp_command *pp;
+    const struct spi_nor_erase_type *erase = NULL;
+    uint32_t shared;
+    int idx;
+    uint32_t i;
+    
+    shared = hwcaps & params->hwcaps & spi_nor_bus_hwcaps(nor);
+    
+    /* hwcaps位序即速度优先级, 取最高位 */
+    for (idx = SNOR_CMD_READ_MAX - 1; idx >= 0; idx--) {
+        if (shared & BIT(idx))
+            break;
+    }
+    if (idx < 0)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    nor->hwcaps = BIT(idx);
+    read = &params->reads[idx];
+    nor->read_opcode = read->opcode;
+    nor->read_proto = read->proto;
+    nor->read_dummy = read->num_mode_clocks + read->num_wait_states;
+    
+    for (idx = SNOR_CMD_PP_MAX - 1; idx >= 0; idx--) {
+        if (shared & BIT(SNOR_HWCAPS_PP_SHIFT + idx))
+            break;
+    }
+    if (idx < 0)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    nor->hwcaps |= BIT(SNOR_HWCAPS_PP_SHIFT + idx);
+    pp = &params->page_programs[idx];
+    nor->program_opcode = pp->opcode;
+    nor->write_proto = pp->proto;
+    
+    /* 均匀扇区使用最小擦除粒度 */
+    if (!params->n_regions) {
+        for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+            if (params->erase_types[i].size == 0U)
+                continue;
+            if (!erase || params->erase_types[i].size < erase->size)
+                erase = &params->erase_types[i];
+        }
+        if (!erase)
+            return SPI_NOR_ERR_NOT_SUPPORTED;
+        
+        nor->erase_opcode = erase->opcode;
+        nor->sector_size = erase->size;
+        
+        return SPI_NOR_OK;
+    }
+    
+    /* 非均匀扇区: 取各区域最小擦除粒度中的最大者, 保证任一扇区都能擦除 */
+    nor->sector_size = 0;
+    for (i = 0; i < params->n_regions; i++) {
+        uint32_t size = spi_nor_min_erase_size(nor, params->regions[i].erase_mask);
+        
+        if (!size)
+            return SPI_NOR_ERR_NOT_SUPPORTED;
+        if (size > nor->sector_size)
+            nor->sector_size = size;
+    }
+    nor->erase_opcode = 0;
+    
+    return SPI_NOR_OK;
+}
+
+static uint8_t spi_nor_convert_opcode(uint8_t opcode, const uint8_t table[][2], size_t size)
+{
+    size_t i;
+    
+    for (i = 0; i < size; i++) {
+        if (table[i][0] == opcode)
+            return table[i][1];
+    }
+    
+    return 0;
+}
+
+/**
+ * @brief  依据4BAIT把已选读/写/擦除指令换成专用4字节地址指令
+ * @retval 0=成功, SPI_NOR_ERR_NOT_SUPPORTED=指令表不完整, 参数保持不变
+ */
+static int spi_nor_set_4byte_opcodes(struct spi_nor *nor)
+{
+    struct spi_nor_flash_parameter *params = &nor->params;
+    uint8_t read_opcode;
+    uint8_t program_opcode;
+    uint32_t i;
+    
+    if (!(nor->flags & SNOR_F_HAS_4BAIT))
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    if ((params->bait_hwcaps & nor->hwcaps) != nor->hwcaps)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    read_opcode = spi_nor_convert_opcode(nor->read_opcode, spi_nor_3to4_read,
+                      sizeof(spi_nor_3to4_read) / sizeof(spi_nor_3to4_read[0]));
+    program_opcode = spi_nor_convert_opcode(nor->program_opcode, spi_nor_3to4_program,
+                      sizeof(spi_nor_3to4_program) / sizeof(spi_nor_3to4_program[0]));
+    if (!read_opcode || !program_opcode)
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    /* 擦除规划会用到所有擦除类型, 必须全部有4字节指令 */
+    for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+        if (params->erase_types[i].size && !params->bait_erase_opcodes[i])
+            return SPI_NOR_ERR_NOT_SUPPORTED;
+    }
+    
+    for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+        if (!params->erase_types[i].size)
+            continue;
+        if (params->erase_types[i].opcode == nor->erase_opcode)
+            nor->erase_opcode = params->bait_erase_opcodes[i];
+        params->erase_types[i].opcode = params->bait_erase_opcodes[i];
+    }
+    
+    nor->read_opcode = read_opcode;
+    nor->program_opcode = program_opcode;
+    nor->flags |= SNOR_F_4B_OPCODES;
+    
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  确定地址字节数; 超过16MB时优先使用专用4字节指令, 否则进入EN4B模式
+ */
+static int spi_nor_set_addr_nbytes(struct spi_nor *nor)
+{
+    if (nor->params.addr_nbytes != 4U && nor->params.size <= SPI_NOR_3B_ADDR_LIMIT) {
+        nor->addr_nbytes = 3;
+        return SPI_NOR_OK;
+    }
+    
+    nor->addr_nbytes = 4;
+    
+    if (spi_nor_set_4byte_opcodes(nor) == SPI_NOR_OK)
+        return SPI_NOR_OK;
+    
+    /* 仅支持4字节地址的器件, 标准指令即带4字节地址 */
+    if (nor->params.addr_nbytes == 4U)
+        return SPI_NOR_OK;
+    
+    return spi_nor_enter_4byte_address_mode(nor);
+}
+
+/**
+ * @brief  进入4字节地址模式(B7h), 之后标准3字节指令均携带4字节地址
+ * @retval 0=成功, 负数=错误码
+ */
+int spi_nor_enter_4byte_address_mode(struct spi_nor *nor)
+{
+    int ret;
+    
+    if (!nor || !nor->spi)
+        return -EINVAL;
+    
+    ret = spi_nor_send_cmd(nor, SPINOR_CMD_ENTER_4B);
+    if (ret < 0)
+        return ret;
+    
+    nor->flags |= SNOR_F_4B_MODE;
+    nor->addr_nbytes = 4;
+    
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  退出4字节地址模式(E9h)
+ * @note   超过16MB且未使用专用4字节指令的器件, 退出后高地址不可访问, 拒绝执行
+ * @retval 0=成功, SPI_NOR_ERR_NOT_SUPPORTED=容量需要4字节地址, 负数=错误码
+ */
+int spi_nor_exit_4byte_address_mode(struct spi_nor *nor)
+{
+    int ret;
+    
+    if (!nor || !nor->spi)
+        return -EINVAL;
+    
+    if (!(nor->flags & SNOR_F_4B_OPCODES) &&
+        (nor->params.addr_nbytes == 4U || nor->params.size > SPI_NOR_3B_ADDR_LIMIT))
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    ret = spi_nor_send_cmd(nor, SPINOR_CMD_EXIT_4B);
+    if (ret < 0)
+        return ret;
+    
+    nor->flags &= ~SNOR_F_4B_MODE;
+    nor->addr_nbytes = (nor->flags & SNOR_F_4B_OPCODES) ? 4U : 3U;
+    
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  命令已发出, 进入异步等待: 首次在典型时间后轮询, 之后按典型时间的1/4
+ */
+static int spi_nor_async_start(struct spi_nor *nor, uint32_t typ_us, uint32_t max_ms,
+                               spi_nor_done_t done, void *arg)
+{
+    struct spi_nor_async *async = &nor->async;
+    uint32_t first_ms = typ_us / 1000U;
+    
+    if (!first_ms)
+        first_ms = 1;
+    
+    async->rdsr_opcode = SPINOR_CMD_RDSR;
+    async->start_ms = HAL_GetTick();
+    async->timeout_ms = max_ms;
+    async->interval_ms = first_ms / 4U ? first_ms / 4U : 1U;
+    async->done = done;
+    async->arg = arg;
+    async->status = SPI_NOR_OK;
+    async->suspended = 0;
+    async->resume_ms = async->start_ms - 1U;
+    async->busy = 1;
+    
+    spi_nor_async_schedule(nor, first_ms);
+    
+    return SPI_NOR_OK;
+}
+
+static void spi_nor_async_schedule(struct spi_nor *nor, uint32_t delay_ms)
+{
+    struct spi_nor_async *async = &nor->async;
+    
+    stimer_stop(&async->timer);
+    stimer_create(&async->timer, delay_ms, STIMER_AUTO_RELOAD,
+                  spi_nor_async_timer_cb, nor);
+    stimer_start(&async->timer);
+}
+
+/**
+ * @brief  定时器到期: 将RDSR排入SPI控制器队列, 不占用总线等待
+ */
+static void spi_nor_async_timer_cb(void *arg)
+{
+    struct spi_nor *nor = arg;
+    struct spi_nor_async *async = &nor->async;
+    int ret;
+    
+    stimer_stop(&async->timer);
+    
+    spi_message_init(&async->msg);
+    (void)memset(async->xfer, 0, sizeof(async->xfer));
+    async->xfer[0].tx_buf = &async->rdsr_opcode;
+    async->xfer[0].len = 1;
+    async->xfer[1].rx_buf = &async->sr;
+    async->xfer[1].len = 1;
+    spi_message_add_tail(&async->xfer[0], &async->msg);
+    spi_message_add_tail(&async->xfer[1], &async->msg);
+    async->msg.complete = spi_nor_async_status_done;
+    async->msg.context = nor;
+    
+    ret = spi_async(nor->spi, &async->msg);
+    if (ret < 0)
+        spi_nor_async_finish(nor, ret);
+}
+
+static void spi_nor_async_status_done(void *context)
+{
+    struct spi_nor *nor = context;
+    struct spi_nor_async *async = &nor->async;
+    
+    if (async->msg.status < 0) {
+        spi_nor_async_finish(nor, async->msg.status);
+        return;
+    }
+    
+    /* 暂停期间WIP为0, 不代表完成 */
+    if (async->suspended) {
+        spi_nor_async_schedule(nor, async->interval_ms);
+        return;
+    }
+    
+    if (!(async->sr & SPINOR_SR1_WIP)) {
+        spi_nor_async_finish(nor, SPI_NOR_OK);
+        return;
+    }
+    
+    if ((HAL_GetTick() - async->start_ms) >= async->timeout_ms) {
+        spi_nor_async_finish(nor, SPI_NOR_ERR_TIMEOUT);
+        return;
+    }
+    
+    spi_nor_async_schedule(nor, async->interval_ms);
+}
+
+static void spi_nor_async_finish(struct spi_nor *nor, int status)
+{
+    struct spi_nor_async *async = &nor->async;
+    spi_nor_done_t done = async->done;
+    void *arg = async->arg;
+    
+    async->status = status;
+    async->busy = 0;
+    
+    /* 空闲计时从擦写结束开始 */
+    nor->pm.last_ms = HAL_GetTick();
+    
+    if (done)
+        done(nor, status, arg);
+}
+
+/**
+ * @brief  把一次操作拆成 命令/地址/数据 三段传输并追加到消息末尾
+ * @param  t    至少3个传输描述, 生命周期须覆盖消息执行
+ * @param  addr 至少4字节地址缓冲, 生命周期同上
+ */
+static int spi_nor_op_add_xfers(const struct spi_nor_op *op, struct spi_transfer *t,
+                                uint8_t *addr, struct spi_message *m)
+{
+    uint8_t data_nbits;
+    uint32_t i;
+    int dtr;
+    
+    if (op->addr_nbytes > 4U || (!op->len && op->dummy_cycles))
+        return -EINVAL;
+    
+    data_nbits = spi_nor_get_protocol_data_nbits(op->proto);
+    dtr = spi_nor_protocol_is_dtr(op->proto);
+    
+    for (i = 0; i < op->addr_nbytes; i++)
+        addr[i] = (uint8_t)(op->addr >> ((op->addr_nbytes - 1U - i) * 8U));
+    
+    (void)memset(t, 0, 3U * sizeof(*t));
+    
+    /* 命令阶段 */
+    t[0].tx_buf = &op->opcode;
+    t[0].len = 1;
+    t[0].tx_nbits = spi_nor_get_protocol_inst_nbits(op->proto);
+    spi_message_add_tail(&t[0], m);
+    
+    /* 地址阶段 */
+    if (op->addr_nbytes) {
+        t[1].tx_buf = addr;
+        t[1].len = op->addr_nbytes;
+        t[1].tx_nbits = spi_nor_get_protocol_addr_nbits(op->proto);
+        t[1].dtr = dtr;
+        spi_message_add_tail(&t[1], m);
+    }
+    
+    /* dummy周期按数据线宽挂在数据阶段之前 */
+    if (op->len) {
+        t[2].tx_buf = op->tx_buf;
+        t[2].rx_buf = op->rx_buf;
+        t[2].len = op->len;
+        if (op->rx_buf)
+            t[2].rx_nbits = data_nbits;
+        else
+            t[2].tx_nbits = data_nbits;
+        t[2].dummy_cycles = op->dummy_cycles;
+        t[2].dtr = dtr;
+        spi_message_add_tail(&t[2], m);
+    }
+    
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  WREN 与写类操作合并为一条消息发出, 中间靠 cs_change 拉高片选
+ * @note   不等待操作完成
+ */
+static int spi_nor_write_op(struct spi_nor *nor, const struct spi_nor_op *op)
+{
+    return spi_nor_write_op_prefix(nor, SPINOR_CMD_WREN, op);
+}
+
+/**
+ * @brief  同 spi_nor_write_op, 前导命令可为 WREN 或 50h (易失写状态寄存器)
+ */
+static int spi_nor_write_op_prefix(struct spi_nor *nor, uint8_t prefix,
+                                   const struct spi_nor_op *op)
+{
+    struct spi_message m;
+    struct spi_transfer t[4];
+    uint8_t addr_buf[4];
+    int ret;
+    
+    spi_message_init(&m);
+    
+    (void)memset(&t[0], 0, sizeof(t[0]));
+    t[0].tx_buf = &prefix;
+    t[0].len = 1;
+    t[0].tx_nbits = spi_nor_get_protocol_inst_nbits(op->proto);
+    t[0].cs_change = 1;
+    spi_message_add_tail(&t[0], &m);
+    
+    ret = spi_nor_op_add_xfers(op, &t[1], addr_buf, &m);
+    if (ret < 0)
+        return ret;
+    
+    return spi_nor_sync(nor, &m);
+}
+
+/**
+ * @brief  写状态寄存器并等待完成
+ */
+static int spi_nor_write_sr_op(struct spi_nor *nor, uint8_t opcode, const uint8_t *sr,
+                               uint32_t len, bool vol)
+{
+    struct spi_nor_op op;
+    int ret;
+    
+    if (!nor || !nor->spi)
+        return -EINVAL;
+    
+    if (nor->async.busy)
+        return SPI_NOR_ERR_BUSY;
+    
+    if (vol && !(nor->flags & SNOR_F_SR_VOLATILE))
+        return SPI_NOR_ERR_NOT_SUPPORTED;
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = opcode;
+    op.proto = SNOR_PROTO_1_1_1;
+    op.tx_buf = sr;
+    op.len = len;
+    
+    ret = spi_nor_write_op_prefix(nor, vol ? SPINOR_CMD_EWSR : SPINOR_CMD_WREN, &op);
+    if (ret < 0)
+        return ret;
+    
+    return spi_nor_wait_ready(nor, SPI_NOR_TIMEOUT_MS);
+}
+
+/**
+ * @brief  48h/42h/44h 的地址宽度: 仅EN4B模式下为4字节, 与是否使用4字节专用指令无关
+ */
+static uint8_t spi_nor_otp_addr_nbytes(struct spi_nor *nor)
+{
+    return (nor->flags & SNOR_F_4B_MODE) ? 4U : 3U;
+}
+
+/**
+ * @brief  线性偏移转换为Flash地址, n返回不跨区域的长度
+ */
+static int spi_nor_otp_offs_to_addr(struct spi_nor *nor, uint32_t offs, uint32_t len,
+                                    uint32_t *addr, uint32_t *n)
+{
+    const struct spi_nor_otp *otp = &nor->params.otp;
+    uint32_t region = offs / otp->len;
+    uint32_t rem = offs % otp->len;
+    
+    if (region >= otp->n_regions)
+        return SPI_NOR_ERR_INVALID_ADDR;
+    
+    *addr = otp->base + region * otp->offset + rem;
+    *n = otp->len - rem;
+    if (*n > len)
+        *n = len;
+    
+    return SPI_NOR_OK;
+}
+
+static int spi_nor_pp_op(struct spi_nor *nor, uint32_t addr, uint32_t len, const uint8_t *data)
+{
+    struct spi_nor_op op;
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = nor->program_opcode;
+    op.addr_nbytes = nor->addr_nbytes;
+    op.addr = addr;
+    op.proto = nor->write_proto;
+    op.tx_buf = data;
+    op.len = len;
+    
+    return spi_nor_write_op(nor, &op);
+}
+
+static int spi_nor_erase_op(struct spi_nor *nor, uint8_t opcode, uint32_t addr)
+{
+    struct spi_nor_op op;
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = opcode;
+    op.addr_nbytes = nor->addr_nbytes;
+    op.addr = addr;
+    op.proto = SNOR_PROTO_1_1_1;
+    
+    return spi_nor_write_op(nor, &op);
+}
+
+/**
+ * @brief  选取能覆盖 addr 起的剩余区域的最大对齐擦除类型
+ * @retval NULL=地址未按最小擦除粒度对齐
+ */
+static const struct spi_nor_erase_type *spi_nor_select_erase_type(struct spi_nor *nor,
+                                                                  uint32_t addr, uint32_t len)
+{
+    const struct spi_nor_erase_type *best = NULL;
+    const struct spi_nor_erase_type *erase;
+    uint32_t end;
+    uint32_t i;
+    uint8_t mask;
+    
+    /* 不跨出当前擦除区域 */
+    mask = spi_nor_erase_mask_at(nor, addr, &end);
+    if (len > end - addr)
+        len = end - addr;
+    
+    for (i = 0; i < SNOR_ERASE_TYPE_MAX; i++) {
+        erase = &nor->params.erase_types[i];
+        if (!(mask & BIT(i)))
+            continue;
+        if (erase->size == 0U || erase->size > len)
+            continue;
+        if (addr & (erase->size - 1U))
+            continue;
+        if (!best || erase->size > best->size)
+            best = erase;
+    }
+    
+    return best;
+}
+
+/**
+ * @brief  等待页编程完成
+ * @note   tPP近似与字节数成正比, 先空等一半典型时间再轮询SR1,
+ *         避免编程初期的无效RDSR占用总线
+ */
+static int spi_nor_wait_pp_ready(struct spi_nor *nor, uint32_t len)
+{
+    uint32_t typ_us = nor->params.page_program_typ_us;
+    
+    if (nor->page_size)
+        typ_us = (uint32_t)(((uint64_t)typ_us * len) / nor->page_size);
+    
+    if (typ_us >= 2U)
+        bsp_dwt_delay_us(typ_us / 2U);
+    
+    return spi_nor_wait_ready(nor, SPI_NOR_WRITE_TIMEOUT_MS);
+}
+
+static int spi_nor_send_cmd(struct spi_nor *nor, uint8_t opcode)
+{
+    struct spi_nor_op op;
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = opcode;
+    op.proto = SNOR_PROTO_1_1_1;
+    
+    return spi_nor_exec_op(nor, &op);
+}
+
+static int spi_nor_read_op(struct spi_nor *nor, uint32_t addr, uint32_t len, uint8_t *data)
+{
+    struct spi_nor_op op;
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = nor->read_opcode;
+    op.addr_nbytes = nor->addr_nbytes;
+    op.dummy_cycles = nor->read_dummy;
+    op.addr = addr;
+    op.proto = nor->read_proto;
+    op.rx_buf = data;
+    op.len = len;
+    
+    return spi_nor_exec_op(nor, &op);
+}
+
+/**
+ * @brief  等待WIP清零
+ * @note   控制器支持硬件状态轮询时由其按间隔比较SR1, 匹配即返回, 不占用CPU;
+ *         否则保持片选连续读SR1 (CS有效期间Flash重复输出状态), 一次传输完成多次查询.
+ *         突发长度从1字节起每轮翻倍至 SPI_NOR_SR_BURST: 短操作的响应延迟与逐次RDSR相同,
+ *         长时间擦除的消息数约减少为 1/SPI_NOR_SR_BURST
+ */
+static int spi_nor_wait_ready(struct spi_nor *nor, uint32_t timeout_ms)
+{
+    struct spi_poll_info poll;
+    struct spi_message m;
+    struct spi_transfer t[2];
+    uint8_t opcode = SPINOR_CMD_RDSR;
+    uint8_t sr[SPI_NOR_SR_BURST];
+    uint32_t burst = 1;
+    uint32_t i;
+    int ret;
+    
+    if (spi_poll_supported(nor->spi)) {
+        (void)memset(&poll, 0, sizeof(poll));
+        poll.opcode = SPINOR_CMD_RDSR;
+        poll.mask = SPINOR_SR1_WIP;
+        poll.match = 0;
+        poll.interval_us = SPI_NOR_POLL_INTERVAL_US;
+        poll.timeout_ms = timeout_ms;
+        
+        ret = spi_nor_pm_get(nor);
+        if (ret < 0)
+            return ret;
+        
+        ret = spi_poll_status(nor->spi, &poll, NULL);
+        spi_nor_pm_put(nor);
+        if (ret == -ETIMEDOUT)
+            return SPI_NOR_ERR_TIMEOUT;
+        if (ret != -ENOTSUPP)
+            return ret;
+    }
+    
+    spi_message_init(&m);
+    (void)memset(t, 0, sizeof(t));
+    t[0].tx_buf = &opcode;
+    t[0].len = 1;
+    t[1].rx_buf = sr;
+    spi_message_add_tail(&t[0], &m);
+    spi_message_add_tail(&t[1], &m);
+    
+    SPI_NOR_WAIT_TIMEOUT(timeout_ms) {
+        t[1].len = burst;
+        ret = spi_nor_sync(nor, &m);
+        if (ret < 0)
+            return ret;
+        
+        for (i = 0; i < burst; i++) {
+            if (!(sr[i] & SPINOR_SR1_WIP))
+                return SPI_NOR_OK;
+        }
+        
+        if (burst < SPI_NOR_SR_BURST)
+            burst <<= 1;
+    }
+    
+    return SPI_NOR_ERR_TIMEOUT;
+}
+
+static int spi_nor_write_enable(struct spi_nor *nor)
+{
+    int ret;
+    uint8_t cmd = SPINOR_CMD_WREN;
+    
+    ret = spi_nor_pm_get(nor);
+    if (ret < 0)
+        return ret;
+    
+    ret = spi_write(nor->spi, &cmd, 1);
+    spi_nor_pm_put(nor);
+    
+    if (ret < 0)
+        return ret;
+    
+    return ret;
+}
+
+/**
+ * @brief  spi_sync() 加上空闲掉电的访问计数, 已掉电时先唤醒
+ */
+static int spi_nor_sync(struct spi_nor *nor, struct spi_message *m)
+{
+    int ret;
+    
+    ret = spi_nor_pm_get(nor);
+    if (ret < 0)
+        return ret;
+    
+    ret = spi_sync(nor->spi, m);
+    spi_nor_pm_put(nor);
+    
+    return ret;
+}
+
+static int spi_nor_w8r8(struct spi_nor *nor, uint8_t cmd)
+{
+    int ret;
+    
+    ret = spi_nor_pm_get(nor);
+    if (ret < 0)
+        return ret;
+    
+    ret = spi_w8r8(nor->spi, cmd);
+    spi_nor_pm_put(nor);
+    
+    return ret;
+}
+
+/**
+ * @brief  探测前复位空闲掉电状态并唤醒器件, 需重新 spi_nor_pm_enable()
+ * @note   MCU复位而Flash未断电时Flash可能仍在深度掉电, 读不到ID
+ */
+static int spi_nor_pm_init(struct spi_nor *nor)
+{
+    struct spi_nor_pm *pm = &nor->pm;
+    uint8_t cmd = SPINOR_CMD_RELEASE_POWER_DOWN;
+    int ret;
+    
+    stimer_stop(&pm->timer);
+    (void)memset(&pm->stats, 0, sizeof(pm->stats));
+    pm->idle_ms = 0;
+    pm->active = 0;
+    pm->pointed = 0;
+    pm->state = SNOR_PM_STANDBY;
+    pm->state_ms = HAL_GetTick();
+    pm->last_ms = pm->state_ms;
     
+    ret = spi_write(nor->spi, &cmd, 1);
     if (ret < 0)
         return ret;
     
+    bsp_dwt_delay_us(SPI_NOR_TRES1_US);
+    
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  总线访问开始, 已掉电时先唤醒
+ * @note   计数先于状态检查: 定时器在此之后到期时看到计数不为0, 不会掉电
+ */
+static int spi_nor_pm_get(struct spi_nor *nor)
+{
+    struct spi_nor_pm *pm = &nor->pm;
+    int ret;
+    
+    pm->active++;
+    if (pm->state != SNOR_PM_POWER_DOWN)
+        return SPI_NOR_OK;
+    
+    ret = spi_nor_pm_wake(nor);
+    if (ret < 0)
+        pm->active--;
+    
     return ret;
 }
 
+/**
+ * @brief  总线访问结束, 空闲计时从此刻开始
+ */
+static void spi_nor_pm_put(struct spi_nor *nor)
+{
+    nor->pm.last_ms = HAL_GetTick();
+    nor->pm.active--;
+}
+
+/**
+ * @brief  发出 ABh 并等待 tRES1; 刚排队的 B9h 可能未满 tDP, 同一毫秒内先补足
+ */
+static int spi_nor_pm_wake(struct spi_nor *nor)
+{
+    struct spi_nor_pm *pm = &nor->pm;
+    uint8_t cmd = SPINOR_CMD_RELEASE_POWER_DOWN;
+    int ret;
+    
+    if (pm->state == SNOR_PM_POWER_DOWN && (HAL_GetTick() - pm->state_ms) < 1U)
+        bsp_dwt_delay_us(nor->params.power_down_us);
+    
+    ret = spi_write(nor->spi, &cmd, 1);
+    if (ret < 0)
+        return ret;
+    
+    bsp_dwt_delay_us(nor->params.release_power_down_us);
+    
+    if (pm->state == SNOR_PM_POWER_DOWN) {
+        spi_nor_pm_set_state(nor, SNOR_PM_STANDBY);
+        pm->stats.wakeups++;
+    }
+    
+    pm->last_ms = HAL_GetTick();
+    if (pm->idle_ms)
+        spi_nor_pm_schedule(nor, pm->idle_ms);
+    
+    return SPI_NOR_OK;
+}
+
+static void spi_nor_pm_set_state(struct spi_nor *nor, uint8_t state)
+{
+    struct spi_nor_pm *pm = &nor->pm;
+    uint32_t now = HAL_GetTick();
+    
+    pm->stats.time_ms[pm->state] += now - pm->state_ms;
+    pm->state_ms = now;
+    pm->state = state;
+}
+
+static void spi_nor_pm_schedule(struct spi_nor *nor, uint32_t delay_ms)
+{
+    struct spi_nor_pm *pm = &nor->pm;
+    
+    stimer_stop(&pm->timer);
+    stimer_create(&pm->timer, delay_ms, STIMER_AUTO_RELOAD,
+                  spi_nor_pm_timer_cb, nor);
+    stimer_start(&pm->timer);
+}
+
+/**
+ * @brief  空闲定时器到期: 确认无访问后将 B9h 排入SPI控制器队列
+ * @note   之后的访问排在 B9h 之后, 由 spi_nor_pm_get() 先发 ABh
+ */
+static void spi_nor_pm_timer_cb(void *arg)
+{
+    struct spi_nor *nor = arg;
+    struct spi_nor_pm *pm = &nor->pm;
+    uint32_t idle;
+    bool busy;
+    
+    stimer_stop(&pm->timer);
+    
+    if (!pm->idle_ms || pm->state != SNOR_PM_STANDBY)
+        return;
+    
+    /* 访问进行中或擦写未完成, 整段推迟 */
+    busy = pm->active || nor->async.busy;
+#if MTD_SUPPORT_READ_ASYNC
+    busy = busy || nor->rd.busy;
+#endif
+    if (busy) {
+        spi_nor_pm_schedule(nor, pm->idle_ms);
+        return;
+    }
+    
+    idle = HAL_GetTick() - pm->last_ms;
+    if (idle < pm->idle_ms) {
+        spi_nor_pm_schedule(nor, pm->idle_ms - idle);
+        return;
+    }
+    
+    pm->opcode = SPINOR_CMD_POWER_DOWN;
+    spi_message_init(&pm->msg);
+    (void)memset(&pm->xfer, 0, sizeof(pm->xfer));
+    pm->xfer.tx_buf = &pm->opcode;
+    pm->xfer.len = 1;
+    spi_message_add_tail(&pm->xfer, &pm->msg);
+    
+    spi_nor_pm_set_state(nor, SNOR_PM_POWER_DOWN);
+    if (spi_async(nor->spi, &pm->msg) < 0) {
+        spi_nor_pm_set_state(nor, SNOR_PM_STANDBY);
+        spi_nor_pm_schedule(nor, pm->idle_ms);
+        return;
+    }
+    
+    pm->stats.power_downs++;
+}
+
+#if MTD_SUPPORT_ERASE_REGIONS
+/**
+ * @brief  由SMPT区域生成 mtd 擦除区域, 相邻且擦除粒度相同的区域合并
+ * @note   只有一种粒度时视为均匀, numeraseregions=0
+ */
+static void spi_nor_init_erase_regions(struct spi_nor *nor)
+{
+    const struct spi_nor_erase_region *region;
+    struct mtd_erase_region_info *info = nor->eraseregions;
+    struct mtd_info *mtd = &nor->mtd;
+    uint32_t n = 0;
+    uint32_t size;
+    uint32_t i;
+    
+    for (i = 0; i < nor->params.n_regions; i++) {
+        region = &nor->params.regions[i];
+        size = spi_nor_min_erase_size(nor, region->erase_mask);
+        
+        if (n && info[n - 1U].erasesize == size) {
+            info[n - 1U].numblocks += region->size / size;
+            continue;
+        }
+        
+        info[n].offset = region->offset;
+        info[n].erasesize = size;
+        info[n].numblocks = region->size / size;
+        n++;
+    }
+    
+    mtd->numeraseregions = (n > 1U) ? n : 0U;
+    mtd->eraseregions = (n > 1U) ? info : NULL;
+}
+#endif
+
+/**
+ * @brief  SPI_NOR_ERR_xxx 转换为MTD层错误码
+ */
+static int spi_nor_mtd_errno(int err)
+{
+    switch (err) {
+    case SPI_NOR_OK:
+        return 0;
+    case SPI_NOR_ERR_TIMEOUT:
+        return -ERR_TIMEOUT;
+    case SPI_NOR_ERR_BUSY:
+        return -ERR_BUSY;
+    case SPI_NOR_ERR_NOT_ALIGNED:
+    case SPI_NOR_ERR_INVALID_ADDR:
+        return -ERR_INVAL;
+    case SPI_NOR_ERR_NOT_SUPPORTED:
+        return -ERR_NOTSUPP;
+    case SPI_NOR_ERR_WRITE:
+    case SPI_NOR_ERR_ERASE:
+        return -ERR_IO;
+    default:
+        /* 低于 SPI_NOR_ERR_BUSY 的是SPI/通用errno(如 -EINVAL), 原样透传 */
+        return (err < SPI_NOR_ERR_BUSY) ? err : -ERR_IO;
+    }
+}
+
+static int spi_nor_mtd_read(struct mtd_info *mtd, mtd_addr_t from, size_t len,
+                            size_t *retlen, uint8_t *buf)
+{
+    int ret;
+    
+    ret = spi_nor_read_data((struct spi_nor *)mtd->priv, from, len, buf);
+    if (ret < 0)
+        return spi_nor_mtd_errno(ret);
+    
+    *retlen = len;
+    return 0;
+}
+
+static int spi_nor_mtd_write(struct mtd_info *mtd, mtd_addr_t to, size_t len,
+                             size_t *retlen, const uint8_t *buf)
+{
+    int ret;
+    
+    ret = spi_nor_write((struct spi_nor *)mtd->priv, to, len, buf);
+    if (ret < 0)
+        return spi_nor_mtd_errno(ret);
+    
+    *retlen = len;
+    return 0;
+}
+
+static int spi_nor_mtd_erase(struct mtd_info *mtd, struct erase_info *instr)
+{
+    uint32_t fail_addr = MTD_FAIL_ADDR_UNKNOWN;
+    int ret;
+    
+    ret = spi_nor_erase((struct spi_nor *)mtd->priv, instr->addr, instr->len, &fail_addr);
+    if (ret < 0) {
+        instr->fail_addr = fail_addr;
+        return spi_nor_mtd_errno(ret);
+    }
+    
+    return 0;
+}
+
+#if MTD_SUPPORT_IOVEC
+/**
+ * @brief  多段读合并为一条消息: 每段一组 命令+地址+数据, 段间 cs_change 拉高片选;
+ *         地址紧接上一段的只追加数据阶段, 沿用同一条读命令
+ */
+static int spi_nor_mtd_readv(struct mtd_info *mtd, const struct mtd_iovec *vec, uint32_t cnt)
+{
+    struct spi_nor *nor = (struct spi_nor *)mtd->priv;
+    struct spi_message m;
+    struct spi_transfer t[MTD_IOV_BATCH * 3U];
+    uint8_t addr[MTD_IOV_BATCH][4];
+    struct spi_transfer *last = NULL;
+    struct spi_nor_op op;
+    uint32_t next = 0;
+    uint32_t nt = 0;
+    uint32_t i;
+    int ret;
+    
+    if (cnt > MTD_IOV_BATCH)
+        return -ERR_INVAL;
+    
+    /* 擦写进行中须逐段 暂停 -> 读 -> 恢复 */
+    if (nor->async.busy) {
+        for (i = 0; i < cnt; i++) {
+            ret = spi_nor_read_data(nor, vec[i].offset, vec[i].len, (uint8_t *)vec[i].buf);
+            if (ret < 0)
+                return spi_nor_mtd_errno(ret);
+        }
+        return 0;
+    }
+    
+    (void)memset(&op, 0, sizeof(op));
+    op.opcode = nor->read_opcode;
+    op.addr_nbytes = nor->addr_nbytes;
+    op.dummy_cycles = nor->read_dummy;
+    op.proto = nor->read_proto;
+    
+    spi_message_init(&m);
+    
+    for (i = 0; i < cnt; i++) {
+        if (!vec[i].len)
+            continue;
+        
+        if (last && vec[i].offset == next) {
+            (void)memset(&t[nt], 0, sizeof(t[nt]));
+            t[nt].rx_buf = vec[i].buf;
+            t[nt].len = vec[i].len;
+            t[nt].rx_nbits = spi_nor_get_protocol_data_nbits(op.proto);
+            t[nt].dtr = spi_nor_protocol_is_dtr(op.proto);
+            spi_message_add_tail(&t[nt], &m);
+            last = &t[nt];
+            nt++;
+        } else {
+            if (last)
+                last->cs_change = 1;
+            op.addr = vec[i].offset;
+            op.rx_buf = vec[i].buf;
+            op.len = vec[i].len;
+            ret = spi_nor_op_add_xfers(&op, &t[nt], addr[i], &m);
+            if (ret < 0)
+                return spi_nor_mtd_errno(ret);
+            last = &t[nt + 2U];
+            nt += 3U;
+        }
+        next = vec[i].offset + vec[i].len;
+    }
+    
+    if (!last)
+        return 0;
+    
+    return spi_nor_mtd_errno(spi_nor_sync(nor, &m));
+}
+#endif
+
+#if MTD_SUPPORT_ERASE_ASYNC
+static int spi_nor_mtd_erase_start(struct mtd_info *mtd, mtd_addr_t addr)
+{
+    struct spi_nor *nor = (struct spi_nor *)mtd->priv;
+    int ret;
+    
+    ret = spi_nor_erase_async(nor, addr, NULL, NULL);
+    
+    /* 小扇区区域的擦除块需多条命令, 就地擦完, 结果由 _erase_wait 返回 */
+    if (ret == SPI_NOR_ERR_NOT_SUPPORTED) {
+        nor->async.status = spi_nor_erase(nor, addr, mtd->erasesize, NULL);
+        return 0;
+    }
+    
+    return spi_nor_mtd_errno(ret);
+}
+
+/**
+ * @brief  等待异步擦除结束; WIP轮询由软件定时器在中断上下文推进
+ * @note   定时器在擦除类型的 max_ms 到期时自行报告超时, 这里多留 SPI_NOR_TIMEOUT_MS
+ *         只为兜住定时器或总线停摆; 超时后擦除状态保持忙, 不再复用该器件
+ */
+static int spi_nor_mtd_erase_wait(struct mtd_info *mtd)
+{
+    struct spi_nor *nor = (struct spi_nor *)mtd->priv;
+    struct spi_nor_async *async = &nor->async;
+    
+    while (spi_nor_is_busy(nor)) {
+        /* 暂停期间不计时, 恢复时 start_ms 已顺延 */
+        if (!async->suspended &&
+            (HAL_GetTick() - async->start_ms) > async->timeout_ms + SPI_NOR_TIMEOUT_MS)
+            return -ERR_TIMEOUT;
+    }
+    
+    return spi_nor_mtd_errno(async->status);
+}
+#endif
+
+#if MTD_SUPPORT_READ_ASYNC
+/**
+ * @brief  发起读: 命令+地址+数据排入SPI控制器队列后立即返回, 数据阶段由DMA完成;
+ *         擦写进行中时需要 暂停 -> 读 -> 恢复, 改为当场同步读完
+ */
+static int spi_nor_mtd_read_start(struct mtd_info *mtd, mtd_addr_t from, size_t len, uint8_t *buf)
+{
+    struct spi_nor *nor = (struct spi_nor *)mtd->priv;
+    struct spi_nor_read_async *rd = &nor->rd;
+    int ret;
+    
+    if (rd->busy)
+        return -ERR_BUSY;
+    
+    rd->len = len;
+    rd->sync = 0;
+    
+    if (nor->async.busy) {
+        rd->sync = 1;
+        rd->status = spi_nor_read_data(nor, from, len, buf);
+        rd->busy = 1;
+        return 0;
+    }
+    
+    (void)memset(&rd->op, 0, sizeof(rd->op));
+    rd->op.opcode = nor->read_opcode;
+    rd->op.addr_nbytes = nor->addr_nbytes;
+    rd->op.dummy_cycles = nor->read_dummy;
+    rd->op.addr = from;
+    rd->op.proto = nor->read_proto;
+    rd->op.rx_buf = buf;
+    rd->op.len = len;
+    
+    spi_message_init(&rd->msg);
+    ret = spi_nor_op_add_xfers(&rd->op, rd->xfer, rd->addr, &rd->msg);
+    if (ret < 0)
+        return spi_nor_mtd_errno(ret);
+    
+    /* 消息在途期间由 rd->busy 阻止掉电 */
+    ret = spi_nor_pm_get(nor);
+    if (ret < 0)
+        return spi_nor_mtd_errno(ret);
+    
+    ret = spi_async(nor->spi, &rd->msg);
+    spi_nor_pm_put(nor);
+    if (ret < 0)
+        return spi_nor_mtd_errno(ret);
+    
+    rd->busy = 1;
+    return 0;
+}
+
+static int spi_nor_mtd_read_wait(struct mtd_info *mtd, size_t *retlen)
+{
+    struct spi_nor *nor = (struct spi_nor *)mtd->priv;
+    struct spi_nor_read_async *rd = &nor->rd;
+    int ret;
+    
+    if (!rd->busy)
+        return -ERR_INVAL;
+    
+    if (rd->sync) {
+        rd->busy = 0;
+        ret = rd->status;
+        if (ret < 0)
+            return spi_nor_mtd_errno(ret);
+    } else {
+        /* 超时后消息仍挂在控制器队列上, 保持 rd->busy 以免 rd 被下一次读改写 */
+        SPI_NOR_WAIT_TIMEOUT(SPI_NOR_WRITE_TIMEOUT_MS) {
+            if (rd->msg.status != SPI_MSG_PENDING)
+                break;
+        }
+        if (rd->msg.status == SPI_MSG_PENDING)
+            return -ERR_TIMEOUT;
+        
+        /* msg.status 是SPI层的errno, 不是 SPI_NOR_ERR_xxx */
+        rd->busy = 0;
+        if (rd->msg.status < 0)
+            return -ERR_IO;
+    }
+    
+    *retlen = rd->len;
+    return 0;
+}
+#endif
+
+#if MTD_SUPPORT_POINT
+static int spi_nor_mtd_point(struct mtd_info *mtd, mtd_addr_t from, size_t len,
+                             size_t *retlen, const void **virt)
+{
+    uint32_t mapped = 0;
+    int ret;
+    
+    ret = spi_nor_point((struct spi_nor *)mtd->priv, from, len, &mapped, virt);
+    if (ret < 0)
+        return spi_nor_mtd_errno(ret);
+    
+    *retlen = mapped;
+    return 0;
+}
+
+static int spi_nor_mtd_unpoint(struct mtd_info *mtd, mtd_addr_t from, size_t len)
+{
+    (void)from;
+    (void)len;
+    
+    return spi_nor_mtd_errno(spi_nor_unpoint((struct spi_nor *)mtd->priv));
+}
+#endif
@@ -0,0 +1,303 @@
+/**
+  ******************************************************************************
+  * @file        : bench_mtd.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : MTD栈基准: 裸设备 / 读缓存 / 写合并 / 分散读 / FTL / KV / 镜像校验
+  * @attention   : "设备时间"取自 mtd_sim 延时模型 (典型四线NOR参数),
+  *                "主机时间"为本机实测, 只反映软件开销
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "host.h"
+#include "mtd_ram.h"
+#include "ftl.h"
+#include "kvstore.h"
+#include "mtd_image.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_NOR_SIZE          (1024U * 1024U)
+#define BENCH_SMALL_SIZE        (256U * 1024U)      /* FTL 区域上限 */
+
+/* Private variables ---------------------------------------------------------*/
+static struct mtd_ram ram;
+static uint8_t mem[BENCH_NOR_SIZE];
+static uint8_t buf[64 * 1024];
+
+/* 四线 80MHz NOR: 约40MB/s总线, tPP 0.7ms, tSE 45ms */
+static const struct mtd_sim_config bench_cfg = {
+    .name = "bench", .type = MTD_NORFLASH, .size = BENCH_NOR_SIZE,
+    .erasesize = 4096, .writesize = 256,
+    .timing = { .bus_kbps = 40000, .cmd_ns = 500, .prog_us = 700, .erase_us = 45000 },
+};
+
+/* Private functions ---------------------------------------------------------*/
+static struct mtd_info *bench_open(mtd_addr_t size)
+{
+    struct mtd_sim_config cfg = bench_cfg;
+
+    cfg.size = size;
+    if (mtd_ram_init(&ram, &cfg, mem, sizeof(mem))) {
+        fprintf(stderr, "mtd_ram_init failed\n");
+        exit(1);
+    }
+    mtd_cache_invalidate(mtd_ram_to_mtd(&ram));
+    return mtd_ram_to_mtd(&ram);
+}
+
+static void bench_check(int ret, const char *what)
+{
+    if (ret < 0) {
+        fprintf(stderr, "%s failed: %d\n", what, ret);
+        exit(1);
+    }
+}
+
+/**
+  * @brief  打印一行: 设备耗时/吞吐取自仿真统计, 主机耗时为实测
+  */
+static void bench_report(const char *name, uint32_t ops, uint64_t bytes, uint64_t wall_ns)
+{
+    uint64_t dev_ns = ram.sim.stats.elapsed_ns;
+    double dev_s = (double)dev_ns / 1e9;
+
+    printf("%-28s %8u ops %10.3f ms dev %9.2f MB/s dev %8.1f ns/op host\n",
+           name, ops, dev_s * 1e3,
+           dev_ns ? (double)bytes / dev_s / 1e6 : 0.0,
+           ops ? (double)wall_ns / ops : 0.0);
+}
+
+static void bench_raw(void)
+{
+    struct mtd_info *mtd = bench_open(BENCH_NOR_SIZE);
+    struct erase_info ei;
+    uint64_t t0;
+    mtd_addr_t a;
+    size_t n;
+
+    memset(buf, 0x5A, sizeof(buf));
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (a = 0; a < BENCH_NOR_SIZE; a += 256)
+        bench_check(mtd_write(mtd, a, 256, &n, buf), "write");
+    bench_report("raw write 256B pages", BENCH_NOR_SIZE / 256, BENCH_NOR_SIZE, host_wall_ns() - t0);
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (a = 0; a < BENCH_NOR_SIZE; a += 4096)
+        bench_check(mtd_read(mtd, a, 4096, &n, buf), "read");
+    bench_report("raw read 4KB", BENCH_NOR_SIZE / 4096, BENCH_NOR_SIZE, host_wall_ns() - t0);
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (a = 0; a < BENCH_NOR_SIZE; a += 4096) {
+        ei.addr = a;
+        ei.len = 4096;
+        bench_check(mtd_erase(mtd, &ei), "erase");
+    }
+    bench_report("raw erase 4KB", BENCH_NOR_SIZE / 4096, BENCH_NOR_SIZE, host_wall_ns() - t0);
+}
+
+/**
+  * @brief  16字节顺序小读: 经读缓存 vs 直接调用驱动
+  */
+static void bench_small_reads(void)
+{
+    struct mtd_info *mtd = bench_open(BENCH_NOR_SIZE);
+    struct mtd_cache_stats cs;
+    const uint32_t ops = 16384;
+    uint64_t t0;
+    uint32_t i;
+    size_t n;
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++)
+        bench_check(mtd->_read(mtd, (mtd_addr_t)i * 16U, 16, &n, buf), "_read");
+    bench_report("read 16B direct", ops, (uint64_t)ops * 16U, host_wall_ns() - t0);
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++)
+        bench_check(mtd_read(mtd, (mtd_addr_t)i * 16U, 16, &n, buf), "mtd_read");
+    bench_report("read 16B cached", ops, (uint64_t)ops * 16U, host_wall_ns() - t0);
+
+    mtd_cache_get_stats(mtd, &cs);
+    printf("%-28s hits %u misses %u readahead %u bypass %u\n", "", cs.hits, cs.misses,
+           cs.readahead, cs.bypass);
+}
+
+/**
+  * @brief  16字节顺序小写: 直写 vs 写合并缓冲
+  */
+static void bench_small_writes(void)
+{
+    static struct mtd_wbuf wbuf;
+    struct mtd_info *mtd;
+    const uint32_t ops = 16384;
+    uint64_t t0;
+    uint32_t i;
+    size_t n;
+
+    memset(buf, 0x33, 16);
+
+    mtd = bench_open(BENCH_NOR_SIZE);
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++)
+        bench_check(mtd_write(mtd, (mtd_addr_t)i * 16U, 16, &n, buf), "write");
+    bench_report("write 16B direct", ops, (uint64_t)ops * 16U, host_wall_ns() - t0);
+    printf("%-28s device programs %u\n", "", ram.sim.stats.writes);
+
+    mtd = bench_open(BENCH_NOR_SIZE);
+    bench_check(mtd_wbuf_attach(mtd, &wbuf), "wbuf_attach");
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++)
+        bench_check(mtd_write(mtd, (mtd_addr_t)i * 16U, 16, &n, buf), "write");
+    bench_check(mtd_sync(mtd), "sync");
+    bench_report("write 16B wbuf", ops, (uint64_t)ops * 16U, host_wall_ns() - t0);
+    printf("%-28s device programs %u\n", "", ram.sim.stats.writes);
+    mtd_wbuf_attach(mtd, NULL);
+}
+
+/**
+  * @brief  每次4段32字节的分散读: 逐段 vs mtd_readv 合并为一次事务
+  */
+static void bench_readv(void)
+{
+    struct mtd_info *mtd = bench_open(BENCH_NOR_SIZE);
+    struct mtd_iovec vec[4];
+    const uint32_t ops = 4096;
+    uint64_t t0;
+    uint32_t i;
+    uint32_t k;
+    size_t n;
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++) {
+        for (k = 0; k < 4; k++)
+            bench_check(mtd->_read(mtd, (mtd_addr_t)(i * 4U + k) * 64U, 32, &n, buf + k * 32U), "_read");
+    }
+    bench_report("scatter 4x32B single", ops, (uint64_t)ops * 128U, host_wall_ns() - t0);
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++) {
+        for (k = 0; k < 4; k++) {
+            vec[k].offset = (mtd_addr_t)(i * 4U + k) * 64U;
+            vec[k].len = 32;
+            vec[k].buf = buf + k * 32U;
+        }
+        bench_check(mtd_readv(mtd, vec, 4, &n), "readv");
+    }
+    bench_report("scatter 4x32B readv", ops, (uint64_t)ops * 128U, host_wall_ns() - t0);
+}
+
+/**
+  * @brief  FTL单扇区随机覆盖写, 统计写放大
+  */
+static void bench_ftl(void)
+{
+    static struct ftl ftl;
+    struct mtd_info *mtd = bench_open(BENCH_SMALL_SIZE);
+    const uint32_t ops = 4096;
+    uint32_t seed = 1;
+    uint64_t t0;
+    uint32_t i;
+
+    bench_check(ftl_mount(&ftl, mtd), "ftl_mount");
+    memset(buf, 0xC3, FTL_SECTOR_SIZE);
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++) {
+        seed = seed * 1103515245U + 12345U;
+        bench_check(ftl_write(&ftl, (seed >> 8) % ftl_sector_count(&ftl), buf, 1), "ftl_write");
+    }
+    bench_report("ftl random 256B write", ops, (uint64_t)ops * FTL_SECTOR_SIZE, host_wall_ns() - t0);
+    printf("%-28s write amplification %.2f, erases %u\n", "",
+           (double)ram.sim.stats.write_bytes / ((double)ops * FTL_SECTOR_SIZE), ram.sim.stats.erases);
+}
+
+static void bench_kv(void)
+{
+    static struct kv_store kv;
+    struct mtd_info *mtd = bench_open(KV_MAX_SECTORS * 4096U);
+    const uint32_t ops = 2048;
+    char key[16];
+    uint64_t t0;
+    uint32_t i;
+    size_t len;
+
+    bench_check(kv_mount(&kv, mtd), "kv_mount");
+    memset(buf, 0x7E, 32);
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++) {
+        snprintf(key, sizeof(key), "key%u", (unsigned)(i % 64U));
+        bench_check(kv_set(&kv, key, buf, 32), "kv_set");
+    }
+    bench_report("kv set 32B (64 keys)", ops, (uint64_t)ops * 32U, host_wall_ns() - t0);
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    for (i = 0; i < ops; i++) {
+        snprintf(key, sizeof(key), "key%u", (unsigned)(i % 64U));
+        bench_check(kv_get(&kv, key, buf, 32, &len), "kv_get");
+    }
+    bench_report("kv get 32B", ops, (uint64_t)ops * 32U, host_wall_ns() - t0);
+}
+
+static void bench_image(void)
+{
+    struct mtd_info *mtd = bench_open(BENCH_NOR_SIZE);
+    static uint8_t chunk[4096];
+    struct mtd_image_result res;
+    uint32_t crc;
+    uint64_t t0;
+    size_t n;
+    mtd_addr_t a;
+
+    for (a = 0; a < BENCH_NOR_SIZE; a += sizeof(buf)) {
+        for (n = 0; n < sizeof(buf); n++)
+            buf[n] = (uint8_t)(a + n * 7U);
+        bench_check(mtd_write(mtd, a, sizeof(buf), &n, buf), "write");
+    }
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    bench_check(mtd_image_verify(mtd, 0, BENCH_NOR_SIZE, MTD_IMAGE_CRC32, NULL, chunk, sizeof(chunk), &res),
+                "verify crc");
+    bench_report("image verify CRC-32 1MB", 1, BENCH_NOR_SIZE, host_wall_ns() - t0);
+    crc = res.crc;
+
+    mtd_sim_reset_stats(&ram.sim);
+    t0 = host_wall_ns();
+    bench_check(mtd_image_verify(mtd, 0, BENCH_NOR_SIZE, MTD_IMAGE_SHA256, NULL, chunk, sizeof(chunk), &res),
+                "verify sha");
+    bench_report("image verify SHA-256 1MB", 1, BENCH_NOR_SIZE, host_wall_ns() - t0);
+    printf("%-28s crc %08x overlapped %u\n", "", (unsigned)crc, res.overlapped);
+}
+
+int main(void)
+{
+    bench_raw();
+    bench_small_reads();
+    bench_small_writes();
+    bench_readv();
+    bench_ftl();
+    bench_kv();
+    bench_image();
+
+    return 0;
+}
@@ -0,0 +1,253 @@
+/**
+  ******************************************************************************
+  * @file        : host.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 主机端测试平台
+  * @attention   : 提供驱动依赖的 HAL_GetTick / bsp_dwt_delay_us / stimer /
+  *                CMSIS 中断接口; 定时器在虚拟时钟越过到期时刻时触发,
+  *                中断被屏蔽或已在回调中时推迟到下一次推进
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "host.h"
+#include "stimer.h"
+#include "bsp_dwt.h"
+#include "cmsis_compiler.h"
+#include "elog.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define HOST_IRQ_NUM_TIMER      15U     /* 回调期间 __get_IPSR() 的返回值 (SysTick) */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+static uint64_t host_clock_ns;
+static stimer_t *host_timers;
+static uint32_t host_primask;
+static uint32_t host_ipsr;
+
+/* Exported variables  -------------------------------------------------------*/
+int host_log_level = ELOG_LVL_WARN;
+
+/* Private function prototypes -----------------------------------------------*/
+static stimer_t *host_next_timer(uint64_t until);
+static void host_unlink_timer(stimer_t *timer);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  当前虚拟时刻 (ns)
+  */
+uint64_t host_now_ns(void)
+{
+    return host_clock_ns;
+}
+
+/**
+  * @brief  推进虚拟时钟, 依次触发期间到期的定时器
+  * @note   中断被屏蔽或已在回调中时只推进时钟, 到期的定时器留到下次
+  */
+void host_advance_ns(uint64_t ns)
+{
+    uint64_t until = host_clock_ns + ns;
+    stimer_t *timer;
+
+    if (host_primask || host_ipsr) {
+        host_clock_ns = until;
+        return;
+    }
+
+    while ((timer = host_next_timer(until)) != NULL) {
+        if (timer->expires_ns > host_clock_ns)
+            host_clock_ns = timer->expires_ns;
+
+        if (timer->mode == STIMER_AUTO_RELOAD) {
+            timer->expires_ns += (uint64_t)timer->period * 1000000ULL;
+        } else {
+            host_unlink_timer(timer);
+            timer->active = 0;
+        }
+
+        host_ipsr = HOST_IRQ_NUM_TIMER;
+        timer->cb(timer->arg);
+        host_ipsr = 0;
+    }
+
+    host_clock_ns = until;
+}
+
+void host_advance_us(uint32_t us)
+{
+    host_advance_ns((uint64_t)us * 1000ULL);
+}
+
+void host_advance_ms(uint32_t ms)
+{
+    host_advance_ns((uint64_t)ms * 1000000ULL);
+}
+
+/**
+  * @brief  停止全部定时器, 时钟归零
+  */
+void host_reset(void)
+{
+    while (host_timers)
+        stimer_stop(host_timers);
+
+    host_clock_ns = 0;
+    host_primask = 0;
+    host_ipsr = 0;
+}
+
+/**
+  * @brief  主机真实时间 (ns), 供基准测试计时
+  */
+uint64_t host_wall_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+void host_log(int level, const char *fmt, ...)
+{
+    va_list ap;
+
+    if (level > host_log_level)
+        return;
+
+    va_start(ap, fmt);
+    vfprintf(stderr, fmt, ap);
+    va_end(ap);
+    fputc('\n', stderr);
+}
+
+/* ---------------------------------------------------------------- 平台接口 */
+uint32_t HAL_GetTick(void)
+{
+    host_advance_ns(HOST_TICK_COST_NS);
+    return (uint32_t)(host_clock_ns / 1000000ULL);
+}
+
+void bsp_dwt_delay_us(uint32_t us)
+{
+    host_advance_us(us);
+}
+
+/* 主机测试只使用硬件片选, spi.c 对软件片选的引脚配置不会走到这里 */
+int gpio_set_mode(size_t pin, int mode, int pull)
+{
+    (void)pin;
+    (void)mode;
+    (void)pull;
+    return 0;
+}
+
+uint32_t __get_IPSR(void)
+{
+    return host_ipsr;
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return host_primask;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    host_primask = primask;
+}
+
+void __disable_irq(void)
+{
+    host_primask = 1;
+}
+
+void __enable_irq(void)
+{
+    host_primask = 0;
+}
+
+int stimer_create(stimer_t *timer, uint32_t period, uint8_t mode, void (*cb)(void *arg), void *arg)
+{
+    if (!timer || !cb || !period)
+        return -1;
+
+    stimer_stop(timer);
+    timer->period = period;
+    timer->mode = mode;
+    timer->cb = cb;
+    timer->arg = arg;
+    return 0;
+}
+
+int stimer_start(stimer_t *timer)
+{
+    if (!timer || !timer->cb)
+        return -1;
+
+    if (!timer->active) {
+        timer->next = host_timers;
+        host_timers = timer;
+        timer->active = 1;
+    }
+    timer->expires_ns = host_clock_ns + (uint64_t)timer->period * 1000000ULL;
+    return 0;
+}
+
+int stimer_stop(stimer_t *timer)
+{
+    if (!timer)
+        return -1;
+
+    if (timer->active) {
+        host_unlink_timer(timer);
+        timer->active = 0;
+    }
+    return 0;
+}
+
+int stimer_get_status(stimer_t *timer)
+{
+    return (timer && timer->active) ? 1 : 0;
+}
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  最早在 until 之前到期的定时器
+  */
+static stimer_t *host_next_timer(uint64_t until)
+{
+    stimer_t *best = NULL;
+    stimer_t *t;
+
+    for (t = host_timers; t; t = t->next) {
+        if (t->expires_ns <= until && (!best || t->expires_ns < best->expires_ns))
+            best = t;
+    }
+
+    return best;
+}
+
+static void host_unlink_timer(stimer_t *timer)
+{
+    stimer_t **pp;
+
+    for (pp = &host_timers; *pp; pp = &(*pp)->next) {
+        if (*pp == timer) {
+            *pp = timer->next;
+            break;
+        }
+    }
+    timer->next = NULL;
+}
@@ -0,0 +1,52 @@
+/**
+  ******************************************************************************
+  * @file        : host.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 主机端测试平台 (虚拟时钟 + 软件定时器 + 中断屏蔽模拟)
+  * @attention   : - 时间只由总线传输、延时和 HAL_GetTick() 推进, 结果可复现
+  *                - 定时器回调视为中断, 在时钟推进时于调用者上下文执行
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+
+/* Exported define -----------------------------------------------------------*/
+/**
+ * @brief 每次 HAL_GetTick() 计入的CPU时间, 保证忙等循环能推进虚拟时钟
+ */
+#define HOST_TICK_COST_NS       100U
+
+/* Exported typedef ----------------------------------------------------------*/
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+extern int host_log_level;          /* 高于此级别的日志不输出, 默认 ELOG_LVL_WARN */
+
+/* Exported function prototypes ----------------------------------------------*/
+uint64_t host_now_ns(void);
+void host_advance_ns(uint64_t ns);
+void host_advance_us(uint32_t us);
+void host_advance_ms(uint32_t ms);
+void host_reset(void);
+
+uint64_t host_wall_ns(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __HOST_H__ */
@@ -0,0 +1,616 @@
+/**
+  ******************************************************************************
+  * @file        : nand_sim.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SPI NAND Flash 器件模型
+  * @attention   : 编程只能把1写为0; 擦除整块; 保护寄存器的 BP 位非0时擦写失败
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "nand_sim.h"
+#include "host.h"
+#include "spi_nand.h"
+#include "errno-base.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define NAND_SIM_COL_MASK       0x0FFFU     /* 列地址 bit11:0 */
+#define NAND_SIM_PLANE_BIT      12U
+#define NAND_SIM_PROT_BP        0x78U       /* BP0~BP3 */
+#define NAND_SIM_ID_DUMMY       8U
+#define NAND_SIM_CACHE_DUMMY    8U
+#define NAND_SIM_CONT_DUMMY     32U
+
+/* SR的ECC状态 (未移位) */
+#define NAND_SIM_ECC_NONE       0U
+#define NAND_SIM_ECC_FIXED      1U
+#define NAND_SIM_ECC_FAILED     2U
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void nand_sim_select(void *ctx, int active);
+static void nand_sim_write(void *ctx, const uint8_t *buf, size_t len, uint8_t nbits);
+static void nand_sim_read(void *ctx, uint8_t *buf, size_t len, uint8_t nbits);
+static void nand_sim_dummy(void *ctx, uint32_t cycles);
+static int nand_sim_cont_mode(const struct nand_sim *nand);
+static int nand_sim_is_cache_read(uint8_t op);
+static uint8_t nand_sim_addr_len(const struct nand_sim *nand, uint8_t op);
+static uint32_t nand_sim_frame_addr(const struct nand_sim *nand);
+static void nand_sim_violation(struct nand_sim *nand);
+static void nand_sim_start_busy(struct nand_sim *nand, uint64_t start, uint64_t ns);
+static uint8_t nand_sim_ecc_code(const struct nand_sim *nand, uint32_t flips);
+static void nand_sim_load(struct nand_sim *nand, uint32_t page);
+static void nand_sim_take(struct nand_sim *nand, uint8_t b);
+static uint8_t nand_sim_status(const struct nand_sim *nand);
+static uint8_t nand_sim_out(struct nand_sim *nand);
+static void nand_sim_commit(struct nand_sim *nand);
+static void nand_sim_program(struct nand_sim *nand, uint32_t page);
+static void nand_sim_erase(struct nand_sim *nand, uint32_t page);
+
+const struct spi_host_model nand_sim_model = {
+    .select = nand_sim_select,
+    .write = nand_sim_write,
+    .read = nand_sim_read,
+    .dummy = nand_sim_dummy,
+};
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  按配置上电, 阵列为擦除态
+  * @retval 0=成功, 负数=错误码
+  */
+int nand_sim_init(struct nand_sim *nand, const struct nand_sim_config *cfg)
+{
+    size_t size;
+    void *mem;
+
+    if (!nand || !cfg || !cfg->page_size || !cfg->pages_per_block || !cfg->nblocks ||
+        cfg->page_size + cfg->oob_size > NAND_SIM_COL_MASK + 1U)
+        return -EINVAL;
+
+    memset(nand, 0, sizeof(*nand));
+    nand->cfg = *cfg;
+    nand->npages = (uint32_t)cfg->nblocks * cfg->pages_per_block;
+    nand->page_bytes = (uint32_t)cfg->page_size + cfg->oob_size;
+
+    size = (size_t)nand->npages * nand->page_bytes;
+    mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mem == MAP_FAILED)
+        return -ENOMEM;
+
+    nand->mem = mem;
+    nand->nop = calloc(nand->npages, 1);
+    nand->flips = calloc(nand->npages, 1);
+    nand->cache = malloc(nand->page_bytes);
+    if (!nand->nop || !nand->flips || !nand->cache) {
+        nand_sim_free(nand);
+        return -ENOMEM;
+    }
+
+    memset(nand->cache, 0xFF, nand->page_bytes);
+    nand->prot = cfg->prot;
+    nand->cfg_reg = cfg->cfg;
+
+    return 0;
+}
+
+/**
+  * @brief  断电, 释放阵列
+  * @note   未初始化 (全0) 或已释放的结构可重复调用
+  */
+void nand_sim_free(struct nand_sim *nand)
+{
+    if (nand->mem)
+        munmap(nand->mem, (size_t)nand->npages * nand->page_bytes);
+    free(nand->nop);
+    free(nand->flips);
+    free(nand->cache);
+    nand->mem = NULL;
+    nand->nop = NULL;
+    nand->flips = NULL;
+    nand->cache = NULL;
+}
+
+/**
+  * @brief  OIP
+  */
+int nand_sim_busy(const struct nand_sim *nand)
+{
+    return host_now_ns() < nand->busy_until;
+}
+
+void nand_sim_reset_stats(struct nand_sim *nand)
+{
+    memset(&nand->stats, 0, sizeof(nand->stats));
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void nand_sim_select(void *ctx, int active)
+{
+    struct nand_sim *nand = (struct nand_sim *)ctx;
+
+    if (active) {
+        nand->frame_len = 0;
+        nand->alen = 0;
+        nand->rpos = 0;
+        nand->dummy = 0;
+        nand->frame_bad = 0;
+        nand->cs = 1;
+        return;
+    }
+
+    if (nand->cs)
+        nand_sim_commit(nand);
+    nand->cs = 0;
+}
+
+static void nand_sim_write(void *ctx, const uint8_t *buf, size_t len, uint8_t nbits)
+{
+    struct nand_sim *nand = (struct nand_sim *)ctx;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        nand_sim_take(nand, buf[i]);
+}
+
+static void nand_sim_read(void *ctx, uint8_t *buf, size_t len, uint8_t nbits)
+{
+    struct nand_sim *nand = (struct nand_sim *)ctx;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = nand_sim_out(nand);
+        nand->rpos++;
+    }
+}
+
+static void nand_sim_dummy(void *ctx, uint32_t cycles)
+{
+    struct nand_sim *nand = (struct nand_sim *)ctx;
+
+    nand->dummy += cycles;
+}
+
+/**
+  * @brief  BUF=0: 读缓存命令为无地址的连续读
+  */
+static int nand_sim_cont_mode(const struct nand_sim *nand)
+{
+    return (nand->cfg.flags & NAND_SIM_F_CONT_READ) && !(nand->cfg_reg & SPINAND_CFG_BUF);
+}
+
+static int nand_sim_is_cache_read(uint8_t op)
+{
+    return op == SPINAND_CMD_READ_FROM_CACHE || op == SPINAND_CMD_READ_FROM_CACHE_FAST ||
+           op == SPINAND_CMD_READ_FROM_CACHE_X2 || op == SPINAND_CMD_READ_FROM_CACHE_X4;
+}
+
+/**
+  * @brief  命令的地址字节数, 0=无地址
+  * @note   驱动在 3Fh 后附带3字节行地址, 器件忽略
+  */
+static uint8_t nand_sim_addr_len(const struct nand_sim *nand, uint8_t op)
+{
+    switch (op) {
+    case SPINAND_CMD_GET_FEATURE:
+    case SPINAND_CMD_SET_FEATURE:
+        return 1U;
+    case SPINAND_CMD_PROG_LOAD:
+    case SPINAND_CMD_PROG_LOAD_X4:
+        return 2U;
+    case SPINAND_CMD_PAGE_READ:
+    case SPINAND_CMD_READ_CACHE_RANDOM:
+    case SPINAND_CMD_READ_CACHE_LAST:
+    case SPINAND_CMD_PROG_EXEC:
+    case SPINAND_CMD_BLOCK_ERASE:
+        return 3U;
+    default:
+        if (nand_sim_is_cache_read(op))
+            return nand_sim_cont_mode(nand) ? 0U : 2U;
+        return 0U;
+    }
+}
+
+static uint32_t nand_sim_frame_addr(const struct nand_sim *nand)
+{
+    uint32_t addr = 0;
+    uint8_t i;
+
+    for (i = 0; i < nand->alen; i++)
+        addr = (addr << 8) | nand->frame[1U + i];
+
+    return addr;
+}
+
+/**
+  * @brief  每帧最多计一次
+  */
+static void nand_sim_violation(struct nand_sim *nand)
+{
+    if (!nand->frame_bad) {
+        nand->frame_bad = 1;
+        nand->stats.violations++;
+    }
+}
+
+static void nand_sim_start_busy(struct nand_sim *nand, uint64_t start, uint64_t ns)
+{
+    nand->busy_until = start + ns;
+    nand->stats.busy_ns += nand->busy_until - host_now_ns();
+}
+
+/**
+  * @brief  按注入的翻转数给出 SR 的 ECC 状态
+  * @note   3位状态: 001=1~3位, 011=4~6位, 101=7~8位, 010=无法纠正
+  */
+static uint8_t nand_sim_ecc_code(const struct nand_sim *nand, uint32_t flips)
+{
+    if (!(nand->cfg_reg & SPINAND_CFG_ECC_EN) || !flips)
+        return NAND_SIM_ECC_NONE;
+    if (flips > nand->cfg.ecc_strength)
+        return NAND_SIM_ECC_FAILED;
+    if (!(nand->cfg.flags & NAND_SIM_F_ECC_3BIT) || flips <= 3U)
+        return NAND_SIM_ECC_FIXED;
+
+    return flips <= 6U ? 3U : 5U;
+}
+
+/**
+  * @brief  页 -> 缓存, 未纠正的翻转分散在数据区
+  */
+static void nand_sim_load(struct nand_sim *nand, uint32_t page)
+{
+    uint32_t bits = (uint32_t)nand->cfg.page_size * 8U;
+    uint32_t n = nand->flips[page];
+    uint32_t i, b;
+    uint8_t code;
+
+    if (nand->nop[page])
+        memcpy(nand->cache, &nand->mem[(size_t)page * nand->page_bytes], nand->page_bytes);
+    else
+        memset(nand->cache, 0xFF, nand->page_bytes);
+
+    code = nand_sim_ecc_code(nand, n);
+    if (n && (code == NAND_SIM_ECC_NONE || code == NAND_SIM_ECC_FAILED)) {
+        for (i = 0; i < n; i++) {
+            b = (i * (bits / n) + page * 131U) % bits;
+            nand->cache[b / 8U] ^= (uint8_t)(1U << (b % 8U));
+        }
+    }
+
+    if (code == NAND_SIM_ECC_FAILED)
+        nand->stats.ecc_failed++;
+    else if (code != NAND_SIM_ECC_NONE)
+        nand->stats.ecc_corrected++;
+
+    nand->ecc = code;
+    nand->cache_page = page;
+    nand->cache_valid = 1;
+}
+
+/**
+  * @brief  收到一个字节: 命令/地址存入帧头, 载入命令的数据直接写缓存
+  */
+static void nand_sim_take(struct nand_sim *nand, uint8_t b)
+{
+    uint8_t op = nand->frame[0];
+    size_t hdr = 1U + nand->alen;
+
+    if (!nand->frame_len) {
+        nand->frame[0] = b;
+        nand->alen = nand_sim_addr_len(nand, b);
+        nand->frame_len = 1;
+        return;
+    }
+
+    if (nand->frame_len < hdr) {
+        nand->frame[nand->frame_len++] = b;
+        /* 载入命令先把整个缓存置为0xFF */
+        if (nand->frame_len == hdr &&
+            (op == SPINAND_CMD_PROG_LOAD || op == SPINAND_CMD_PROG_LOAD_X4)) {
+            nand->col = nand_sim_frame_addr(nand) & NAND_SIM_COL_MASK;
+            nand->load_plane = (uint8_t)((nand_sim_frame_addr(nand) >> NAND_SIM_PLANE_BIT) & 1U);
+            memset(nand->cache, 0xFF, nand->page_bytes);
+            nand->cache_valid = 0;
+        }
+        return;
+    }
+
+    switch (op) {
+    case SPINAND_CMD_PROG_LOAD:
+    case SPINAND_CMD_PROG_LOAD_X4:
+        if (nand->col >= nand->page_bytes) {
+            nand_sim_violation(nand);
+            return;
+        }
+        nand->cache[nand->col++] = b;
+        break;
+    case SPINAND_CMD_SET_FEATURE:
+        if (nand->frame_len != hdr) {
+            nand_sim_violation(nand);
+            return;
+        }
+        nand->frame[nand->frame_len] = b;
+        break;
+    default:
+        nand_sim_violation(nand);
+        return;
+    }
+    nand->frame_len++;
+}
+
+/**
+  * @brief  状态寄存器 (C0h)
+  */
+static uint8_t nand_sim_status(const struct nand_sim *nand)
+{
+    uint8_t sr = nand->fail | (uint8_t)(nand->ecc << SPINAND_SR_ECC_SHIFT);
+
+    if (nand_sim_busy(nand))
+        sr |= SPINAND_SR_OIP;
+    if (nand->wel)
+        sr |= SPINAND_SR_WEL;
+    if ((nand->cfg.flags & NAND_SIM_F_CACHE_RANDOM) && host_now_ns() < nand->bg_until)
+        sr |= SPINAND_SR_CRBSY;
+
+    return sr;
+}
+
+/**
+  * @brief  输出下一个字节
+  * @note   忙期间只应答特性寄存器读, 其余输出 0xFF 并计违规
+  */
+static uint8_t nand_sim_out(struct nand_sim *nand)
+{
+    uint8_t op = nand->frame[0];
+    uint32_t addr;
+    uint32_t off;
+    uint32_t next;
+    uint8_t code;
+
+    if (!nand->frame_len)
+        return 0xFF;
+
+    if (op == SPINAND_CMD_GET_FEATURE) {
+        if (nand->frame_len != 2U) {
+            nand_sim_violation(nand);
+            return 0xFF;
+        }
+        switch (nand->frame[1]) {
+        case SPINAND_REG_PROT:
+            return nand->prot;
+        case SPINAND_REG_CFG:
+            return nand->cfg_reg;
+        case SPINAND_REG_STATUS:
+            return nand_sim_status(nand);
+        default:
+            return 0x00;
+        }
+    }
+
+    if (nand_sim_busy(nand)) {
+        nand_sim_violation(nand);
+        return 0xFF;
+    }
+
+    if (op == SPINAND_CMD_RDID) {
+        if (nand->rpos == 0 && nand->dummy != NAND_SIM_ID_DUMMY)
+            nand_sim_violation(nand);
+        return nand->rpos < 3U ? nand->cfg.id[nand->rpos] : 0xFF;
+    }
+
+    if (!nand_sim_is_cache_read(op)) {
+        nand_sim_violation(nand);
+        return 0xFF;
+    }
+
+    addr = nand_sim_frame_addr(nand);
+    if (nand->rpos == 0) {
+        if (nand->frame_len != 1U + nand->alen || !nand->cache_valid ||
+            nand->dummy != (nand_sim_cont_mode(nand) ? NAND_SIM_CONT_DUMMY : NAND_SIM_CACHE_DUMMY))
+            nand_sim_violation(nand);
+        if ((nand->cfg.flags & NAND_SIM_F_TWO_PLANES) && !nand_sim_cont_mode(nand) &&
+            ((addr >> NAND_SIM_PLANE_BIT) & 1U) !=
+            ((nand->cache_page / nand->cfg.pages_per_block) & 1U))
+            nand_sim_violation(nand);
+        if (nand_sim_cont_mode(nand))
+            nand->stats.cont_pages++;
+    }
+
+    if (!nand_sim_cont_mode(nand)) {
+        off = (addr & NAND_SIM_COL_MASK) + (uint32_t)nand->rpos;
+        return off < nand->page_bytes ? nand->cache[off] : 0xFF;
+    }
+
+    /* 连续读: 只输出数据区, 读到页尾时载入下一页, ECC状态取最差 */
+    off = (uint32_t)(nand->rpos % nand->cfg.page_size);
+    if (off == 0U && nand->rpos) {
+        next = nand->cache_page + 1U;
+        if (next >= nand->npages) {
+            nand_sim_violation(nand);
+            return 0xFF;
+        }
+        code = nand->ecc;
+        nand_sim_load(nand, next);
+        if (code == NAND_SIM_ECC_FAILED || nand->ecc == NAND_SIM_ECC_FAILED)
+            nand->ecc = NAND_SIM_ECC_FAILED;
+        else if (code != NAND_SIM_ECC_NONE)
+            nand->ecc = NAND_SIM_ECC_FIXED;
+        nand->stats.cont_pages++;
+    }
+
+    return nand->cache[off];
+}
+
+/**
+  * @brief  片选释放: 执行收到的命令
+  */
+static void nand_sim_commit(struct nand_sim *nand)
+{
+    uint8_t op = nand->frame[0];
+    uint32_t row;
+    uint64_t start;
+
+    if (!nand->frame_len)
+        return;
+
+    nand->stats.ops[op]++;
+
+    /* 读类命令在输出时已处理 */
+    if (nand->rpos)
+        return;
+
+    if (nand_sim_busy(nand) && op != SPINAND_CMD_RESET) {
+        nand_sim_violation(nand);
+        return;
+    }
+
+    if (nand->frame_len < 1U + nand->alen) {
+        nand_sim_violation(nand);
+        return;
+    }
+
+    row = nand_sim_frame_addr(nand);
+    if (nand->alen == 3U && op != SPINAND_CMD_READ_CACHE_LAST && row >= nand->npages) {
+        nand_sim_violation(nand);
+        return;
+    }
+
+    /* 流水读未以 3Fh 结束前只接受 30h/3Fh 和读缓存 */
+    if (nand->seq && op != SPINAND_CMD_READ_CACHE_RANDOM && op != SPINAND_CMD_READ_CACHE_LAST &&
+        op != SPINAND_CMD_RESET) {
+        nand_sim_violation(nand);
+        return;
+    }
+
+    switch (op) {
+    case SPINAND_CMD_RESET:
+        nand->wel = 0;
+        nand->fail = 0;
+        nand->seq = 0;
+        nand->bg_until = 0;
+        nand->cfg_reg = nand->cfg.cfg;
+        nand_sim_start_busy(nand, host_now_ns(), (uint64_t)nand->cfg.timing.trst_us * 1000ULL);
+        break;
+    case SPINAND_CMD_WREN:
+        nand->wel = 1;
+        break;
+    case SPINAND_CMD_WRDI:
+        nand->wel = 0;
+        break;
+    case SPINAND_CMD_SET_FEATURE:
+        if (nand->frame_len != 3U) {
+            nand_sim_violation(nand);
+            break;
+        }
+        if (nand->frame[1] == SPINAND_REG_PROT)
+            nand->prot = nand->frame[2];
+        else if (nand->frame[1] == SPINAND_REG_CFG)
+            nand->cfg_reg = nand->frame[2];
+        else
+            nand_sim_violation(nand);
+        break;
+    case SPINAND_CMD_PAGE_READ:
+        nand_sim_load(nand, row);
+        nand->data_reg = row;
+        nand->stats.page_loads++;
+        nand_sim_start_busy(nand, host_now_ns(), (uint64_t)nand->cfg.timing.tr_us * 1000ULL);
+        break;
+    case SPINAND_CMD_READ_CACHE_RANDOM:
+    case SPINAND_CMD_READ_CACHE_LAST:
+        if (!(nand->cfg.flags & NAND_SIM_F_CACHE_RANDOM)) {
+            nand_sim_violation(nand);
+            break;
+        }
+        /* 等上一次后台载入完成, 数据寄存器 -> 缓存, 再开始载入下一页 */
+        start = host_now_ns() > nand->bg_until ? host_now_ns() : nand->bg_until;
+        nand_sim_load(nand, nand->data_reg);
+        nand->stats.cache_loads++;
+        nand_sim_start_busy(nand, start, (uint64_t)nand->cfg.timing.trcbsy_us * 1000ULL);
+        if (op == SPINAND_CMD_READ_CACHE_RANDOM) {
+            nand->data_reg = row;
+            nand->bg_until = nand->busy_until + (uint64_t)nand->cfg.timing.tr_us * 1000ULL;
+            nand->seq = 1;
+        } else {
+            nand->bg_until = 0;
+            nand->seq = 0;
+        }
+        break;
+    case SPINAND_CMD_PROG_EXEC:
+        nand_sim_program(nand, row);
+        break;
+    case SPINAND_CMD_BLOCK_ERASE:
+        nand_sim_erase(nand, row);
+        break;
+    default:
+        break;
+    }
+}
+
+static void nand_sim_program(struct nand_sim *nand, uint32_t page)
+{
+    uint8_t *p = &nand->mem[(size_t)page * nand->page_bytes];
+    uint32_t i;
+
+    if (!nand->wel || nand->nop[page] >= NAND_SIM_NOP ||
+        ((nand->cfg.flags & NAND_SIM_F_TWO_PLANES) &&
+         nand->load_plane != ((page / nand->cfg.pages_per_block) & 1U))) {
+        nand_sim_violation(nand);
+        nand->fail = SPINAND_SR_P_FAIL;
+        return;
+    }
+
+    nand->wel = 0;
+    if (nand->prot & NAND_SIM_PROT_BP) {
+        nand->fail = SPINAND_SR_P_FAIL;
+        return;
+    }
+
+    if (!nand->nop[page])
+        memset(p, 0xFF, nand->page_bytes);
+    for (i = 0; i < nand->page_bytes; i++)
+        p[i] &= nand->cache[i];
+
+    nand->nop[page]++;
+    nand->fail = 0;
+    nand->stats.programs++;
+    nand_sim_start_busy(nand, host_now_ns(), (uint64_t)nand->cfg.timing.tprog_us * 1000ULL);
+}
+
+static void nand_sim_erase(struct nand_sim *nand, uint32_t page)
+{
+    uint32_t first = page - page % nand->cfg.pages_per_block;
+
+    if (!nand->wel) {
+        nand_sim_violation(nand);
+        nand->fail = SPINAND_SR_E_FAIL;
+        return;
+    }
+
+    nand->wel = 0;
+    if (nand->prot & NAND_SIM_PROT_BP) {
+        nand->fail = SPINAND_SR_E_FAIL;
+        return;
+    }
+
+    memset(&nand->nop[first], 0, nand->cfg.pages_per_block);
+    memset(&nand->flips[first], 0, nand->cfg.pages_per_block);
+    nand->fail = 0;
+    nand->stats.erases++;
+    nand_sim_start_busy(nand, host_now_ns(), (uint64_t)nand->cfg.timing.tbers_us * 1000ULL);
+}
@@ -0,0 +1,123 @@
+/**
+  ******************************************************************************
+  * @file        : nand_sim.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SPI NAND Flash 器件模型 (W25N / MT29F 命令集), 挂在 spi_host 上
+  * @attention   : - 13h 把页载入缓存并按 tR 置忙, 读缓存命令按输出字节实时应答
+  *                - 30h/3Fh 在后台载入下一页 (CRBSY), 只有 tRCBSY 期间 OIP 置位
+  *                - BUF=0 时读缓存命令为连续读, 跨页自动载入, ECC状态为累计值
+  *                - 注入的翻转数 <= 纠错能力时读出数据正确, 否则 (或ECC关闭) 数据带翻转
+  *                - 忙期间的非状态命令、缺少WREN、dummy周期/plane位不符计为违规
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __NAND_SIM_H__
+#define __NAND_SIM_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "spi_host.h"
+
+/* Exported define -----------------------------------------------------------*/
+/* struct nand_sim_config::flags */
+#define NAND_SIM_F_CACHE_RANDOM (1U << 0)   /* 30h/3Fh 流水读 */
+#define NAND_SIM_F_CONT_READ    (1U << 1)   /* BUF=0 连续读 */
+#define NAND_SIM_F_TWO_PLANES   (1U << 2)   /* 列地址bit12须等于块号bit0 */
+#define NAND_SIM_F_ECC_3BIT     (1U << 3)   /* Micron 3位ECC状态, 否则为2位 */
+
+#define NAND_SIM_NOP            4U          /* 每页擦除后允许的编程次数 */
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 阵列操作时间 (0表示立即完成)
+ */
+struct nand_sim_timing {
+    uint32_t tr_us;             /* 阵列 -> 缓存 (含ECC) */
+    uint32_t trcbsy_us;         /* 30h/3Fh 数据寄存器 -> 缓存 */
+    uint32_t tprog_us;
+    uint32_t tbers_us;
+    uint32_t trst_us;
+};
+
+struct nand_sim_config {
+    uint8_t id[3];              /* 9Fh + 8 dummy 周期后输出 */
+    uint32_t flags;             /* NAND_SIM_F_xxx */
+    uint16_t page_size;
+    uint16_t oob_size;
+    uint16_t pages_per_block;
+    uint16_t nblocks;
+    uint8_t ecc_strength;       /* 片上ECC可纠正的翻转数 */
+    uint8_t prot;               /* 上电时的保护寄存器, BP位非0时全片保护 */
+    uint8_t cfg;                /* 上电时的配置寄存器 */
+    struct nand_sim_timing timing;
+};
+
+struct nand_sim_stats {
+    uint32_t ops[256];          /* 按命令统计已完成的帧 */
+    uint32_t violations;
+    uint32_t page_loads;        /* 13h */
+    uint32_t cache_loads;       /* 30h/3Fh */
+    uint32_t cont_pages;        /* 连续读输出的页 */
+    uint32_t programs;
+    uint32_t erases;
+    uint32_t ecc_corrected;     /* 载入时纠正过的页 */
+    uint32_t ecc_failed;        /* 载入时无法纠正的页 */
+    uint64_t busy_ns;           /* 累计 OIP 时间 */
+};
+
+struct nand_sim {
+    struct nand_sim_config cfg;
+    uint32_t npages;
+    uint32_t page_bytes;        /* 数据 + OOB */
+    uint8_t *mem;               /* 匿名映射, 只有编程过的页占用内存 */
+    uint8_t *nop;               /* 每页擦除后的编程次数, 0=擦除态 */
+    uint8_t *flips;             /* 每页注入的翻转数, 擦除时清零 */
+    uint8_t *cache;             /* 缓存寄存器 */
+    uint32_t cache_page;
+    uint8_t cache_valid;
+    uint32_t data_reg;          /* 数据寄存器中的页 (30h 后台载入) */
+    uint8_t seq;                /* 处于 30h 流水读中, 须以 3Fh 结束 */
+    uint8_t prot;
+    uint8_t cfg_reg;
+    uint8_t wel;
+    uint8_t fail;               /* SR 的 E_FAIL/P_FAIL */
+    uint8_t ecc;                /* SR 的 ECC 状态位 (未移位) */
+    uint8_t load_plane;         /* 最近一次载入命令列地址的 plane 位 */
+    uint64_t busy_until;        /* OIP 结束时刻 (ns) */
+    uint64_t bg_until;          /* 后台载入结束时刻 (ns) */
+    uint8_t cs;
+    uint8_t frame[5];           /* 命令 + 地址 + 特性寄存器数据 */
+    uint8_t alen;               /* 本帧命令的地址字节数 */
+    size_t frame_len;           /* 已收到的字节数 (含载入数据) */
+    uint32_t col;               /* 载入命令的缓存写位置 */
+    size_t rpos;                /* 本帧已输出字节数 */
+    uint32_t dummy;             /* 本帧收到的dummy周期 */
+    uint8_t frame_bad;          /* 本帧已计过违规 */
+    struct nand_sim_stats stats;
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+extern const struct spi_host_model nand_sim_model;
+
+/* Exported function prototypes ----------------------------------------------*/
+int nand_sim_init(struct nand_sim *nand, const struct nand_sim_config *cfg);
+void nand_sim_free(struct nand_sim *nand);
+int nand_sim_busy(const struct nand_sim *nand);
+void nand_sim_reset_stats(struct nand_sim *nand);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __NAND_SIM_H__ */
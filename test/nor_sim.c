@@ -0,0 +1,778 @@
+/**
+  ******************************************************************************
+  * @file        : nor_sim.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SPI NOR Flash 器件模型
+  * @attention   : 编程只能把1写为0, 页内地址回绕; 擦除地址按块大小向下对齐
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "nor_sim.h"
+#include "host.h"
+#include "spi_nor.h"
+#include "errno-base.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+#define NOR_SIM_TSUS_NS         20000ULL    /* 75h 到 SUS 置位 */
+#define NOR_SIM_CMD_CHIP_ERASE2 0x60        /* C7h 的别名 */
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void nor_sim_select(void *ctx, int active);
+static void nor_sim_write(void *ctx, const uint8_t *buf, size_t len, uint8_t nbits);
+static void nor_sim_read(void *ctx, uint8_t *buf, size_t len, uint8_t nbits);
+static void nor_sim_dummy(void *ctx, uint32_t cycles);
+static int nor_sim_mmap(void *ctx, const struct spi_mmap_info *info,
+                        const void **base, size_t *size);
+static void nor_sim_unmap(void *ctx);
+static uint8_t nor_sim_addr_len(const struct nor_sim *nor, uint8_t op);
+static int nor_sim_read_dummy(const struct nor_sim *nor, uint8_t op);
+static uint32_t nor_sim_erase_size(uint8_t op);
+static uint32_t nor_sim_frame_addr(const struct nor_sim *nor, uint8_t alen);
+static void nor_sim_violation(struct nor_sim *nor);
+static void nor_sim_start_busy(struct nor_sim *nor, uint64_t ns);
+static uint8_t nor_sim_out(struct nor_sim *nor);
+static void nor_sim_commit(struct nor_sim *nor);
+static void nor_sim_program(struct nor_sim *nor, uint8_t alen);
+static void nor_sim_erase(struct nor_sim *nor, uint8_t op, uint8_t alen);
+static int nor_sim_erase_allowed(const struct nor_sim *nor, uint32_t addr, uint32_t size);
+static int nor_sim_otp_region(const struct nor_sim *nor, uint32_t addr);
+static int nor_sim_otp_check(struct nor_sim *nor, uint32_t addr);
+static void nor_sim_otp_program(struct nor_sim *nor, uint8_t alen);
+static void nor_sim_otp_erase(struct nor_sim *nor, uint8_t alen);
+static void nor_sim_write_sr(struct nor_sim *nor, uint8_t op);
+static void nor_sim_reset(struct nor_sim *nor);
+static void nor_sim_power_down(struct nor_sim *nor);
+static void nor_sim_release(struct nor_sim *nor);
+
+const struct spi_host_model nor_sim_model = {
+    .select = nor_sim_select,
+    .write = nor_sim_write,
+    .read = nor_sim_read,
+    .dummy = nor_sim_dummy,
+    .mmap = nor_sim_mmap,
+    .unmap = nor_sim_unmap,
+};
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  按配置上电
+  * @note   匿名映射或新建的文件为擦除态, 已有的同大小文件保留内容 (模拟断电重启)
+  * @retval 0=成功, 负数=错误码
+  */
+int nor_sim_init(struct nor_sim *nor, const struct nor_sim_config *cfg)
+{
+    struct stat st;
+    int fresh = 1;
+    void *mem;
+
+    if (!nor || !cfg || !cfg->size || cfg->size % 65536U)
+        return -EINVAL;
+
+    memset(nor, 0, sizeof(*nor));
+    nor->cfg = *cfg;
+    nor->fd = -1;
+
+    if (cfg->path) {
+        nor->fd = open(cfg->path, O_RDWR | O_CREAT, 0644);
+        if (nor->fd < 0)
+            return -EIO;
+        if (fstat(nor->fd, &st) == 0 && (uint64_t)st.st_size == cfg->size)
+            fresh = 0;
+        else if (ftruncate(nor->fd, cfg->size) < 0)
+            goto err;
+        mem = mmap(NULL, cfg->size, PROT_READ | PROT_WRITE, MAP_SHARED, nor->fd, 0);
+    } else {
+        mem = mmap(NULL, cfg->size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (mem == MAP_FAILED)
+        goto err;
+
+    nor->mem = mem;
+    if (fresh)
+        memset(nor->mem, 0xFF, cfg->size);
+    memset(nor->otp, 0xFF, sizeof(nor->otp));
+    memcpy(nor->sr, cfg->sr, sizeof(nor->sr));
+    memcpy(nor->nv_sr, cfg->sr, sizeof(nor->nv_sr));
+
+    return 0;
+
+err:
+    close(nor->fd);
+    nor->fd = -1;
+    return -EIO;
+}
+
+/**
+  * @brief  断电: 解除映射, 文件内容保留
+  * @note   未初始化 (全0) 或已释放的结构可重复调用
+  */
+void nor_sim_free(struct nor_sim *nor)
+{
+    if (nor->mem)
+        munmap(nor->mem, nor->cfg.size);
+    if (nor->mem && nor->fd >= 0)
+        close(nor->fd);
+    nor->mem = NULL;
+    nor->fd = -1;
+}
+
+/**
+  * @brief  阵列是否忙 (WIP)
+  */
+int nor_sim_busy(const struct nor_sim *nor)
+{
+    return host_now_ns() < nor->busy_until;
+}
+
+/**
+  * @brief  是否处于深度掉电或 tDP/tRES1 过渡中 (只接受 ABh 或不接受命令)
+  */
+int nor_sim_asleep(const struct nor_sim *nor)
+{
+    return nor->dpd || host_now_ns() < nor->dpd_until;
+}
+
+void nor_sim_reset_stats(struct nor_sim *nor)
+{
+    memset(&nor->stats, 0, sizeof(nor->stats));
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void nor_sim_select(void *ctx, int active)
+{
+    struct nor_sim *nor = (struct nor_sim *)ctx;
+
+    if (active) {
+        if (nor->mapped)
+            nor->stats.violations++;
+        nor->frame_len = 0;
+        nor->rpos = 0;
+        nor->dummy = 0;
+        nor->frame_bad = 0;
+        nor->cs = 1;
+        return;
+    }
+
+    if (nor->cs)
+        nor_sim_commit(nor);
+    nor->cs = 0;
+}
+
+static void nor_sim_write(void *ctx, const uint8_t *buf, size_t len, uint8_t nbits)
+{
+    struct nor_sim *nor = (struct nor_sim *)ctx;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        if (nor->frame_len >= sizeof(nor->frame)) {
+            nor_sim_violation(nor);
+            return;
+        }
+        nor->frame[nor->frame_len++] = buf[i];
+    }
+}
+
+static void nor_sim_read(void *ctx, uint8_t *buf, size_t len, uint8_t nbits)
+{
+    struct nor_sim *nor = (struct nor_sim *)ctx;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = nor_sim_out(nor);
+        nor->rpos++;
+    }
+}
+
+static void nor_sim_dummy(void *ctx, uint32_t cycles)
+{
+    struct nor_sim *nor = (struct nor_sim *)ctx;
+
+    nor->dummy += cycles;
+}
+
+/**
+  * @brief  进入映射模式, 窗口即阵列本身
+  * @note   读命令模板须与器件当前的地址模式/dummy周期一致
+  */
+static int nor_sim_mmap(void *ctx, const struct spi_mmap_info *info,
+                        const void **base, size_t *size)
+{
+    struct nor_sim *nor = (struct nor_sim *)ctx;
+    int dummy = nor_sim_read_dummy(nor, info->opcode);
+
+    if (info->opcode == SPINOR_CMD_RDSFDP || info->opcode == SPINOR_CMD_RDUID ||
+        info->opcode == SPINOR_CMD_RSECR || info->opcode == SPINOR_CMD_RD_EVCR || dummy < 0 ||
+        (uint32_t)dummy != info->dummy_cycles ||
+        info->addr_nbytes != nor_sim_addr_len(nor, info->opcode)) {
+        nor->stats.violations++;
+        return -EINVAL;
+    }
+
+    if (nor_sim_busy(nor) || nor_sim_asleep(nor))
+        nor->stats.violations++;
+
+    nor->mapped = 1;
+    nor->map = *info;
+    nor->stats.mmaps++;
+    *base = nor->mem;
+    *size = nor->cfg.size;
+
+    return 0;
+}
+
+static void nor_sim_unmap(void *ctx)
+{
+    struct nor_sim *nor = (struct nor_sim *)ctx;
+
+    nor->mapped = 0;
+}
+
+/**
+  * @brief  命令的地址字节数, 0=无地址
+  */
+static uint8_t nor_sim_addr_len(const struct nor_sim *nor, uint8_t op)
+{
+    switch (op) {
+    case SPINOR_CMD_READ:
+    case SPINOR_CMD_READ_FAST:
+    case SPINOR_CMD_READ_1_1_2:
+    case SPINOR_CMD_READ_1_2_2:
+    case SPINOR_CMD_READ_1_1_4:
+    case SPINOR_CMD_READ_1_4_4:
+    case SPINOR_CMD_PP:
+    case SPINOR_CMD_PP_1_1_4:
+    case SPINOR_CMD_PP_1_4_4:
+    case SPINOR_CMD_BE_4K:
+    case SPINOR_CMD_BE_32K:
+    case SPINOR_CMD_BE_64K:
+    case SPINOR_CMD_RSECR:
+    case SPINOR_CMD_PSECR:
+    case SPINOR_CMD_ESECR:
+    case SPINOR_CMD_RD_EVCR:
+        return nor->addr4 ? 4U : 3U;
+    case SPINOR_CMD_READ_4B:
+    case SPINOR_CMD_READ_FAST_4B:
+    case SPINOR_CMD_READ_1_1_2_4B:
+    case SPINOR_CMD_READ_1_2_2_4B:
+    case SPINOR_CMD_READ_1_1_4_4B:
+    case SPINOR_CMD_READ_1_4_4_4B:
+    case SPINOR_CMD_PP_4B:
+    case SPINOR_CMD_PP_1_1_4_4B:
+    case SPINOR_CMD_PP_1_4_4_4B:
+    case SPINOR_CMD_BE_4K_4B:
+    case SPINOR_CMD_BE_32K_4B:
+    case SPINOR_CMD_BE_64K_4B:
+        return 4U;
+    case SPINOR_CMD_RDSFDP:
+        return 3U;
+    default:
+        return 0U;
+    }
+}
+
+/**
+  * @brief  读类命令要求的dummy周期, -1=不是读数据命令
+  * @note   BBh/EBh 的模式位周期计入dummy (驱动不使用连续读模式)
+  */
+static int nor_sim_read_dummy(const struct nor_sim *nor, uint8_t op)
+{
+    switch (op) {
+    case SPINOR_CMD_READ:
+    case SPINOR_CMD_READ_4B:
+        return 0;
+    case SPINOR_CMD_READ_FAST:
+    case SPINOR_CMD_READ_FAST_4B:
+    case SPINOR_CMD_READ_1_1_2:
+    case SPINOR_CMD_READ_1_1_2_4B:
+    case SPINOR_CMD_READ_1_1_4:
+    case SPINOR_CMD_READ_1_1_4_4B:
+    case SPINOR_CMD_RDSFDP:
+    case SPINOR_CMD_RSECR:
+    case SPINOR_CMD_RD_EVCR:
+        return 8;
+    case SPINOR_CMD_READ_1_2_2:
+    case SPINOR_CMD_READ_1_2_2_4B:
+        return 4;
+    case SPINOR_CMD_READ_1_4_4:
+    case SPINOR_CMD_READ_1_4_4_4B:
+        return 6;
+    case SPINOR_CMD_RDUID:
+        return nor->addr4 ? 40 : 32;
+    default:
+        return -1;
+    }
+}
+
+static uint32_t nor_sim_erase_size(uint8_t op)
+{
+    switch (op) {
+    case SPINOR_CMD_BE_4K:
+    case SPINOR_CMD_BE_4K_4B:
+        return 4096U;
+    case SPINOR_CMD_BE_32K:
+    case SPINOR_CMD_BE_32K_4B:
+        return 32768U;
+    case SPINOR_CMD_BE_64K:
+    case SPINOR_CMD_BE_64K_4B:
+        return 65536U;
+    default:
+        return 0U;
+    }
+}
+
+static uint32_t nor_sim_frame_addr(const struct nor_sim *nor, uint8_t alen)
+{
+    uint32_t addr = 0;
+    uint8_t i;
+
+    for (i = 0; i < alen; i++)
+        addr = (addr << 8) | nor->frame[1U + i];
+
+    return addr;
+}
+
+/**
+  * @brief  每帧最多计一次
+  */
+static void nor_sim_violation(struct nor_sim *nor)
+{
+    if (!nor->frame_bad) {
+        nor->frame_bad = 1;
+        nor->stats.violations++;
+    }
+}
+
+static void nor_sim_start_busy(struct nor_sim *nor, uint64_t ns)
+{
+    nor->busy_until = host_now_ns() + ns;
+    nor->stats.busy_ns += ns;
+}
+
+/**
+  * @brief  输出下一个字节
+  * @note   忙期间只应答状态寄存器读, 其余输出 0xFF 并计违规; 深度掉电时一律输出 0xFF
+  */
+static uint8_t nor_sim_out(struct nor_sim *nor)
+{
+    uint8_t op = nor->frame[0];
+    uint8_t alen;
+    uint32_t addr;
+    int dummy;
+    int region;
+
+    if (!nor->frame_len)
+        return 0xFF;
+
+    if (nor_sim_asleep(nor)) {
+        nor_sim_violation(nor);
+        return 0xFF;
+    }
+
+    if (op == SPINOR_CMD_RDSR)
+        return nor->sr[0] | (nor_sim_busy(nor) ? (SPINOR_SR1_WIP | SPINOR_SR1_WEL) : 0U) |
+               (nor->wel ? SPINOR_SR1_WEL : 0U);
+    if (op == SPINOR_CMD_RDSR2)
+        return nor->sr[1];
+    if (op == SPINOR_CMD_RDSR3)
+        return nor->sr[2];
+
+    if (nor_sim_busy(nor)) {
+        nor_sim_violation(nor);
+        return 0xFF;
+    }
+
+    alen = nor_sim_addr_len(nor, op);
+    dummy = nor_sim_read_dummy(nor, op);
+    if (nor->rpos == 0 && dummy >= 0 &&
+        ((uint32_t)dummy != nor->dummy || nor->frame_len != 1U + alen))
+        nor_sim_violation(nor);
+
+    addr = nor_sim_frame_addr(nor, alen) + (uint32_t)nor->rpos;
+
+    switch (op) {
+    case SPINOR_CMD_RDID:
+        return nor->rpos < 3U ? nor->cfg.id[nor->rpos] : 0xFF;
+    case SPINOR_CMD_RDUID:
+        return nor->cfg.uid[nor->rpos % sizeof(nor->cfg.uid)];
+    case SPINOR_CMD_RDSFDP:
+        return (nor->cfg.sfdp && addr < nor->cfg.sfdp_len) ? nor->cfg.sfdp[addr] : 0xFF;
+    case SPINOR_CMD_RD_EVCR:
+        return (nor->cfg.regs && addr < nor->cfg.regs_len) ? nor->cfg.regs[addr] : 0xFF;
+    case SPINOR_CMD_RSECR:
+        /* 字节地址在区域内回绕 */
+        region = nor_sim_otp_region(nor, addr - (uint32_t)nor->rpos);
+        if (region < 0) {
+            nor_sim_violation(nor);
+            return 0xFF;
+        }
+        return nor->otp[region][addr % NOR_SIM_OTP_LEN];
+    default:
+        if (dummy >= 0)
+            return nor->mem[addr % nor->cfg.size];
+        return 0xFF;
+    }
+}
+
+/**
+  * @brief  片选释放: 执行收到的命令
+  */
+static void nor_sim_commit(struct nor_sim *nor)
+{
+    uint8_t op = nor->frame[0];
+    uint8_t alen;
+    uint8_t reset_enable = nor->reset_enable;
+
+    if (!nor->frame_len)
+        return;
+
+    nor->stats.ops[op]++;
+    nor->reset_enable = (op == SPINOR_CMD_SRSTEN);
+
+    /* 深度掉电只响应 ABh, tDP/tRES1 期间不响应任何命令 */
+    if (host_now_ns() < nor->dpd_until ||
+        (nor->dpd && op != SPINOR_CMD_RELEASE_POWER_DOWN)) {
+        nor_sim_violation(nor);
+        return;
+    }
+
+    /* 读类命令在输出时已处理 */
+    if (nor->rpos)
+        return;
+
+    if (nor_sim_busy(nor) && op != SPINOR_CMD_SUSPEND &&
+        op != SPINOR_CMD_SRSTEN && op != SPINOR_CMD_SRST) {
+        nor_sim_violation(nor);
+        return;
+    }
+
+    alen = nor_sim_addr_len(nor, op);
+    if (alen && nor->frame_len < 1U + alen) {
+        nor_sim_violation(nor);
+        return;
+    }
+
+    switch (op) {
+    case SPINOR_CMD_WREN:
+        nor->wel = 1;
+        break;
+    case SPINOR_CMD_WRDI:
+        nor->wel = 0;
+        break;
+    case SPINOR_CMD_EWSR:
+        nor->vwel = 1;
+        break;
+    case SPINOR_CMD_WRSR:
+    case SPINOR_CMD_WRSR2:
+    case SPINOR_CMD_WRSR3:
+        nor_sim_write_sr(nor, op);
+        break;
+    case SPINOR_CMD_ENTER_4B:
+        nor->addr4 = 1;
+        break;
+    case SPINOR_CMD_EXIT_4B:
+        nor->addr4 = 0;
+        break;
+    case SPINOR_CMD_GBULK:
+        if (!nor->wel)
+            nor_sim_violation(nor);
+        nor->wel = 0;
+        break;
+    case SPINOR_CMD_SUSPEND:
+        if (nor_sim_busy(nor) && !nor->suspended_ns) {
+            nor->suspended_ns = nor->busy_until - host_now_ns();
+            nor->busy_until = host_now_ns() + NOR_SIM_TSUS_NS;
+            nor->sr[1] |= SPINOR_SR2_SUS;
+        }
+        break;
+    case SPINOR_CMD_RESUME:
+        if (nor->suspended_ns) {
+            nor->busy_until = host_now_ns() + nor->suspended_ns;
+            nor->suspended_ns = 0;
+            nor->sr[1] &= (uint8_t)~SPINOR_SR2_SUS;
+        }
+        break;
+    case SPINOR_CMD_SRST:
+        if (reset_enable)
+            nor_sim_reset(nor);
+        break;
+    case SPINOR_CMD_POWER_DOWN:
+        nor_sim_power_down(nor);
+        break;
+    case SPINOR_CMD_RELEASE_POWER_DOWN:
+        nor_sim_release(nor);
+        break;
+    case SPINOR_CMD_PP:
+    case SPINOR_CMD_PP_1_1_4:
+    case SPINOR_CMD_PP_1_4_4:
+    case SPINOR_CMD_PP_4B:
+    case SPINOR_CMD_PP_1_1_4_4B:
+    case SPINOR_CMD_PP_1_4_4_4B:
+        nor_sim_program(nor, alen);
+        break;
+    case SPINOR_CMD_BE_4K:
+    case SPINOR_CMD_BE_32K:
+    case SPINOR_CMD_BE_64K:
+    case SPINOR_CMD_BE_4K_4B:
+    case SPINOR_CMD_BE_32K_4B:
+    case SPINOR_CMD_BE_64K_4B:
+    case SPINOR_CMD_CHIP_ERASE:
+    case NOR_SIM_CMD_CHIP_ERASE2:
+        nor_sim_erase(nor, op, alen);
+        break;
+    case SPINOR_CMD_PSECR:
+        nor_sim_otp_program(nor, alen);
+        break;
+    case SPINOR_CMD_ESECR:
+        nor_sim_otp_erase(nor, alen);
+        break;
+    default:
+        break;
+    }
+}
+
+static void nor_sim_program(struct nor_sim *nor, uint8_t alen)
+{
+    uint32_t addr = nor_sim_frame_addr(nor, alen) % nor->cfg.size;
+    uint32_t page = addr & ~(NOR_SIM_PAGE_SIZE - 1U);
+    const uint8_t *data = &nor->frame[1U + alen];
+    size_t n = nor->frame_len - 1U - alen;
+    size_t i;
+
+    if (!nor->wel) {
+        nor_sim_violation(nor);
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+        nor->mem[page + ((addr + i) & (NOR_SIM_PAGE_SIZE - 1U))] &= data[i];
+
+    nor->wel = 0;
+    nor->stats.programs++;
+    nor_sim_start_busy(nor, (uint64_t)nor->cfg.timing.tpp_us * 1000ULL);
+}
+
+static void nor_sim_erase(struct nor_sim *nor, uint8_t op, uint8_t alen)
+{
+    uint32_t size = nor_sim_erase_size(op);
+    uint32_t addr;
+    uint64_t ns;
+
+    /* 暂停的擦除之上不能再擦除 */
+    if (!nor->wel || nor->suspended_ns) {
+        nor_sim_violation(nor);
+        return;
+    }
+
+    if (size) {
+        addr = (nor_sim_frame_addr(nor, alen) % nor->cfg.size) & ~(size - 1U);
+        if (!nor_sim_erase_allowed(nor, addr, size)) {
+            nor_sim_violation(nor);
+            nor->wel = 0;
+            return;
+        }
+        ns = (size == 4096U) ? nor->cfg.timing.tse_us :
+             (size == 32768U) ? nor->cfg.timing.tbe32_us : nor->cfg.timing.tbe64_us;
+        ns *= 1000ULL;
+    } else {
+        addr = 0;
+        size = nor->cfg.size;
+        ns = (uint64_t)nor->cfg.timing.tce_ms * 1000000ULL;
+    }
+
+    memset(&nor->mem[addr], 0xFF, size);
+    nor->wel = 0;
+    nor->stats.erases++;
+    nor->stats.erase_ns += ns;
+    nor_sim_start_busy(nor, ns);
+}
+
+/**
+  * @brief  擦除块是否整个落在一个支持该大小的区域内
+  */
+static int nor_sim_erase_allowed(const struct nor_sim *nor, uint32_t addr, uint32_t size)
+{
+    const struct nor_sim_region *r;
+    uint8_t bit = (size == 4096U) ? NOR_SIM_ERASE_4K :
+                  (size == 32768U) ? NOR_SIM_ERASE_32K : NOR_SIM_ERASE_64K;
+    size_t i;
+
+    if (!nor->cfg.regions)
+        return 1;
+
+    for (i = 0; i < nor->cfg.nregions; i++) {
+        r = &nor->cfg.regions[i];
+        if (addr >= r->offset && addr - r->offset < r->size)
+            return (r->erase & bit) && addr + size <= r->offset + r->size;
+    }
+
+    return 0;
+}
+
+/**
+  * @brief  安全寄存器地址所在区域, -1=地址无效
+  * @note   A15~A12 为区域号 (1~3), A11~A8 须为0, A7~A0 为字节地址
+  */
+static int nor_sim_otp_region(const struct nor_sim *nor, uint32_t addr)
+{
+    uint32_t region = addr / NOR_SIM_OTP_BASE;
+
+    if (region < 1U || region > NOR_SIM_OTP_REGIONS || (addr & 0xF00U))
+        return -1;
+
+    return (int)region - 1;
+}
+
+/**
+  * @brief  已锁定的区域只读, 驱动应先检查 LB 位
+  */
+static int nor_sim_otp_check(struct nor_sim *nor, uint32_t addr)
+{
+    int region = nor_sim_otp_region(nor, addr);
+
+    if (!nor->wel || region < 0 || (nor->sr[1] & (SPINOR_SR2_LB1 << region))) {
+        nor_sim_violation(nor);
+        nor->wel = 0;
+        return -1;
+    }
+
+    return region;
+}
+
+static void nor_sim_otp_program(struct nor_sim *nor, uint8_t alen)
+{
+    uint32_t addr = nor_sim_frame_addr(nor, alen);
+    const uint8_t *data = &nor->frame[1U + alen];
+    size_t n = nor->frame_len - 1U - alen;
+    int region = nor_sim_otp_check(nor, addr);
+    size_t i;
+
+    if (region < 0)
+        return;
+
+    for (i = 0; i < n; i++)
+        nor->otp[region][(addr + i) % NOR_SIM_OTP_LEN] &= data[i];
+
+    nor->wel = 0;
+    nor->stats.otp_programs++;
+    nor_sim_start_busy(nor, (uint64_t)nor->cfg.timing.tpp_us * 1000ULL);
+}
+
+static void nor_sim_otp_erase(struct nor_sim *nor, uint8_t alen)
+{
+    int region = nor_sim_otp_check(nor, nor_sim_frame_addr(nor, alen));
+
+    if (region < 0)
+        return;
+
+    memset(nor->otp[region], 0xFF, NOR_SIM_OTP_LEN);
+    nor->wel = 0;
+    nor->stats.otp_erases++;
+    nor_sim_start_busy(nor, (uint64_t)nor->cfg.timing.tse_us * 1000ULL);
+}
+
+/**
+  * @brief  01h/31h/11h: WREN 后为非易失写, 50h 后为易失写
+  * @note   SR2 的 LB1~LB3 为一次性编程位, 只能置位; SUS 只读
+  */
+static void nor_sim_write_sr(struct nor_sim *nor, uint8_t op)
+{
+    const uint8_t *d = &nor->frame[1];
+    size_t n = nor->frame_len - 1U;
+    uint8_t sr[3];
+    uint8_t lb;
+
+    if ((!nor->wel && !nor->vwel) || !n) {
+        nor_sim_violation(nor);
+        return;
+    }
+
+    memcpy(sr, nor->sr, sizeof(sr));
+    if (op == SPINOR_CMD_WRSR) {
+        sr[0] = d[0] & 0xFCU;
+        if (n > 1)
+            sr[1] = d[1];
+    } else if (op == SPINOR_CMD_WRSR2) {
+        sr[1] = d[0];
+    } else {
+        sr[2] = d[0];
+    }
+
+    lb = (uint8_t)((nor->sr[1] | sr[1]) & (SPINOR_SR2_LB1 | SPINOR_SR2_LB2 | SPINOR_SR2_LB3));
+    sr[1] = (uint8_t)((sr[1] & 0x43U) | lb | (nor->sr[1] & SPINOR_SR2_SUS));
+
+    memcpy(nor->sr, sr, sizeof(sr));
+    nor->nv_sr[1] |= lb;
+
+    if (nor->wel) {
+        memcpy(nor->nv_sr, sr, sizeof(sr));
+        nor->nv_sr[1] &= (uint8_t)~SPINOR_SR2_SUS;
+        nor->stats.nv_sr_writes++;
+        nor_sim_start_busy(nor, (uint64_t)nor->cfg.timing.tw_us * 1000ULL);
+    } else {
+        nor->stats.v_sr_writes++;
+    }
+
+    nor->wel = 0;
+    nor->vwel = 0;
+}
+
+/**
+  * @brief  66h+99h: 中止擦写, 状态寄存器恢复为非易失值, 回到3字节地址模式
+  */
+static void nor_sim_reset(struct nor_sim *nor)
+{
+    nor->wel = 0;
+    nor->vwel = 0;
+    nor->addr4 = 0;
+    nor->busy_until = host_now_ns();
+    nor->suspended_ns = 0;
+    memcpy(nor->sr, nor->nv_sr, sizeof(nor->sr));
+}
+
+/**
+  * @brief  B9h: 片选在第8个时钟后释放才进入深度掉电
+  */
+static void nor_sim_power_down(struct nor_sim *nor)
+{
+    if (nor->frame_len != 1U || nor->dummy) {
+        nor_sim_violation(nor);
+        return;
+    }
+
+    nor->dpd = 1;
+    nor->dpd_since = host_now_ns();
+    nor->dpd_until = nor->dpd_since + (uint64_t)nor->cfg.timing.tdp_us * 1000ULL;
+    nor->stats.power_downs++;
+}
+
+/**
+  * @brief  ABh: 经 tRES1 后恢复待机, 未掉电时无操作
+  */
+static void nor_sim_release(struct nor_sim *nor)
+{
+    if (!nor->dpd)
+        return;
+
+    nor->dpd = 0;
+    nor->dpd_until = host_now_ns() + (uint64_t)nor->cfg.timing.tres1_us * 1000ULL;
+    nor->stats.dpd_ns += host_now_ns() - nor->dpd_since;
+    nor->stats.releases++;
+}
@@ -0,0 +1,146 @@
+/**
+  ******************************************************************************
+  * @file        : nor_sim.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SPI NOR Flash 器件模型 (Winbond W25Q 命令集), 挂在 spi_host 上
+  * @attention   : - 命令在片选释放时生效, 读类命令按输出字节实时应答
+  *                - 擦写按配置时间置忙, WIP 由虚拟时钟决定
+  *                - 忙期间的非状态命令、缺少WREN、dummy周期不符计为违规
+  *                - 阵列为 mmap 映射 (可指定文件), 控制器映射窗口直接指向它;
+  *                  映射期间收到片选也计为违规 (控制器须先退出映射模式)
+  *                - 48h/42h/44h 访问3组256字节安全寄存器 (0x1000/0x2000/0x3000),
+  *                  SR2 LB1~LB3 置位后对应区域只读, 向锁定区域擦写计为违规
+  *                - 可配置非均匀扇区: 擦除块须落在一个区域内且该区域支持此大小, 否则计违规
+  *                - B9h 须为单字节帧; 深度掉电期间只接受 ABh, tDP/tRES1 内的任何命令计为违规
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __NOR_SIM_H__
+#define __NOR_SIM_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "spi_host.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define NOR_SIM_PAGE_SIZE       256U
+#define NOR_SIM_FRAME_MAX       (1U + 4U + NOR_SIM_PAGE_SIZE)
+
+#define NOR_SIM_OTP_BASE        0x1000U     /* 区域n的地址为 (n+1) * 0x1000 */
+#define NOR_SIM_OTP_LEN         256U
+#define NOR_SIM_OTP_REGIONS     3U
+
+/* struct nor_sim_region::erase */
+#define NOR_SIM_ERASE_4K        (1U << 0)
+#define NOR_SIM_ERASE_32K       (1U << 1)
+#define NOR_SIM_ERASE_64K       (1U << 2)
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 阵列操作时间 (0表示立即完成)
+ */
+struct nor_sim_timing {
+    uint32_t tpp_us;            /* 页编程 */
+    uint32_t tse_us;            /* 4KB 扇区擦除 */
+    uint32_t tbe32_us;          /* 32KB 块擦除 */
+    uint32_t tbe64_us;          /* 64KB 块擦除 */
+    uint32_t tce_ms;            /* 整片擦除 */
+    uint32_t tw_us;             /* 非易失写状态寄存器 */
+    uint32_t tdp_us;            /* B9h 到进入深度掉电 */
+    uint32_t tres1_us;          /* ABh 到恢复待机 */
+};
+
+/**
+ * @brief 擦除区域 (如底部/顶部的4KB参数扇区)
+ */
+struct nor_sim_region {
+    uint32_t offset;
+    uint32_t size;
+    uint8_t erase;              /* NOR_SIM_ERASE_xxx, 整片擦除不受限 */
+};
+
+struct nor_sim_config {
+    uint8_t id[3];              /* 9Fh: 厂商, 存储类型, 容量 */
+    uint32_t size;
+    uint8_t sr[3];              /* 上电时 (非易失) 的 SR1~SR3 */
+    uint8_t uid[8];             /* 4Bh */
+    const char *path;           /* 阵列映射的文件, NULL=匿名映射; 文件大小不符时重建为擦除态 */
+    const uint8_t *sfdp;        /* 5Ah 地址空间, NULL=不支持 (读出0xFF) */
+    size_t sfdp_len;
+    const uint8_t *regs;        /* 65h 地址空间 (8个dummy周期), NULL=不支持 */
+    size_t regs_len;
+    const struct nor_sim_region *regions;   /* NULL=均匀扇区 */
+    size_t nregions;
+    struct nor_sim_timing timing;
+};
+
+struct nor_sim_stats {
+    uint32_t ops[256];          /* 按命令统计已完成的帧 */
+    uint32_t violations;
+    uint32_t mmaps;             /* 进入映射模式次数 */
+    uint32_t programs;
+    uint32_t erases;
+    uint32_t nv_sr_writes;      /* 非易失状态寄存器写 */
+    uint32_t v_sr_writes;       /* 50h 易失写 */
+    uint32_t otp_programs;
+    uint32_t otp_erases;
+    uint32_t power_downs;       /* 进入深度掉电次数 */
+    uint32_t releases;          /* 由 ABh 唤醒次数 */
+    uint64_t dpd_ns;            /* 累计深度掉电时间 (B9h 到 ABh) */
+    uint64_t busy_ns;           /* 累计阵列忙时间 */
+    uint64_t erase_ns;          /* 其中擦除命令按 tSE/tBE32/tBE64/tCE 计的部分 */
+};
+
+struct nor_sim {
+    struct nor_sim_config cfg;
+    uint8_t *mem;
+    uint8_t otp[NOR_SIM_OTP_REGIONS][NOR_SIM_OTP_LEN];  /* 上电为擦除态, 不随文件保存 */
+    int fd;                     /* path 打开的文件, -1=匿名映射 */
+    uint8_t sr[3];              /* 当前值, SR1 不含 WIP/WEL */
+    uint8_t nv_sr[3];
+    uint8_t wel;
+    uint8_t vwel;               /* 50h 之后的一条写状态寄存器命令为易失写 */
+    uint8_t addr4;              /* B7h 4字节地址模式 */
+    uint8_t reset_enable;       /* 66h 之后的 99h 才复位 */
+    uint8_t cs;
+    uint8_t mapped;             /* 控制器处于映射模式 */
+    uint8_t dpd;                /* 深度掉电 (B9h 之后, ABh 之前) */
+    uint64_t dpd_since;         /* 收到 B9h 的时刻 (ns) */
+    uint64_t dpd_until;         /* tDP/tRES1 结束时刻 (ns), 之前不接受命令 */
+    struct spi_mmap_info map;   /* 最近一次映射使用的读命令 */
+    uint64_t busy_until;        /* 阵列忙结束时刻 (ns) */
+    uint64_t suspended_ns;      /* 暂停时剩余的忙时间, 0=未暂停 */
+    uint8_t frame[NOR_SIM_FRAME_MAX];
+    size_t frame_len;           /* 已收到的命令/地址/数据字节 */
+    size_t rpos;                /* 本帧已输出字节数 */
+    uint32_t dummy;             /* 本帧收到的dummy周期 */
+    uint8_t frame_bad;          /* 本帧已计过违规 */
+    struct nor_sim_stats stats;
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+extern const struct spi_host_model nor_sim_model;
+
+/* Exported function prototypes ----------------------------------------------*/
+int nor_sim_init(struct nor_sim *nor, const struct nor_sim_config *cfg);
+void nor_sim_free(struct nor_sim *nor);
+int nor_sim_busy(const struct nor_sim *nor);
+int nor_sim_asleep(const struct nor_sim *nor);
+void nor_sim_reset_stats(struct nor_sim *nor);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __NOR_SIM_H__ */
@@ -0,0 +1,234 @@
+/**
+  ******************************************************************************
+  * @file        : spi_host.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 主机端SPI控制器
+  * @attention   : 时间 = 累计时钟数 / 器件时钟, 换算前不取整, 长传输无累积误差
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "spi_host.h"
+#include "host.h"
+#include "errno-base.h"
+#include <string.h>
+
+/* Private typedef -----------------------------------------------------------*/
+
+/* Private define ------------------------------------------------------------*/
+
+/* Private macro -------------------------------------------------------------*/
+
+/* Private variables ---------------------------------------------------------*/
+
+/* Exported variables  -------------------------------------------------------*/
+
+/* Private function prototypes -----------------------------------------------*/
+static void spi_host_clock(struct spi_host *host, uint8_t nbits, uint64_t clocks);
+static int spi_host_setup(struct spi_controller *ctrl, struct spi_device *dev);
+static void spi_host_set_cs(struct spi_controller *ctrl, struct spi_device *dev, uint8_t enable);
+static ssize_t spi_host_transfer_one(struct spi_controller *ctrl, struct spi_device *dev,
+                                     struct spi_transfer *t);
+static int spi_host_poll_status(struct spi_controller *ctrl, struct spi_device *dev,
+                                const struct spi_poll_info *info, uint8_t *status);
+static int spi_host_mmap_enable(struct spi_controller *ctrl, struct spi_device *dev,
+                                const struct spi_mmap_info *info, const void **base, size_t *size);
+static void spi_host_mmap_disable(struct spi_controller *ctrl, struct spi_device *dev);
+
+/* Exported functions --------------------------------------------------------*/
+/**
+  * @brief  注册控制器
+  * @param  caps SPI_CAP_xxx, SPI_CAP_DUMMY 总是加上
+  * @param  flags SPI_HOST_F_xxx
+  * @param  model 器件模型, 提供 mmap 时控制器支持映射
+  * @retval 0=成功, 负数=错误码
+  */
+int spi_host_init(struct spi_host *host, const char *name, uint32_t caps, uint32_t flags,
+                  const struct spi_host_model *model, void *ctx)
+{
+    int ret;
+
+    if (!host || !model || !model->select || !model->write || !model->read)
+        return -EINVAL;
+
+    memset(host, 0, sizeof(*host));
+    host->model = model;
+    host->ctx = ctx;
+    host->ops.caps = caps | SPI_CAP_DUMMY;
+    host->ops.setup = spi_host_setup;
+    host->ops.set_cs = spi_host_set_cs;
+    host->ops.transfer_one = spi_host_transfer_one;
+    if (flags & SPI_HOST_F_POLL)
+        host->ops.poll_status = spi_host_poll_status;
+    if (model->mmap) {
+        host->ops.mmap_enable = spi_host_mmap_enable;
+        host->ops.mmap_disable = spi_host_mmap_disable;
+    }
+
+    ret = spi_controller_register(&host->ctrl, name, &host->ops);
+    if (ret)
+        return ret;
+
+    host->ctrl.priv = host;
+
+    return 0;
+}
+
+/**
+  * @brief  更换能力集, 下次探测时生效
+  */
+void spi_host_set_caps(struct spi_host *host, uint32_t caps)
+{
+    host->ops.caps = caps | SPI_CAP_DUMMY;
+}
+
+void spi_host_reset_stats(struct spi_host *host)
+{
+    memset(&host->stats, 0, sizeof(host->stats));
+}
+
+uint64_t spi_host_total_clocks(const struct spi_host *host)
+{
+    uint64_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i <= SPI_NBITS_QUAD; i++)
+        sum += host->stats.clocks[i];
+
+    return sum;
+}
+
+/* Private functions ---------------------------------------------------------*/
+static void spi_host_clock(struct spi_host *host, uint8_t nbits, uint64_t clocks)
+{
+    uint64_t ns;
+
+    host->stats.clocks[nbits] += clocks;
+
+    if (!host->hz)
+        return;
+
+    host->clk_acc += clocks;
+    ns = host->clk_acc * 1000000000ULL / host->hz;
+    host_advance_ns(ns - host->ns_acc);
+    host->ns_acc = ns;
+}
+
+static int spi_host_setup(struct spi_controller *ctrl, struct spi_device *dev)
+{
+    struct spi_host *host = (struct spi_host *)ctrl->priv;
+
+    host->hz = dev->max_speed_hz;
+    host->clk_acc = 0;
+    host->ns_acc = 0;
+
+    return 0;
+}
+
+static void spi_host_set_cs(struct spi_controller *ctrl, struct spi_device *dev, uint8_t enable)
+{
+    struct spi_host *host = (struct spi_host *)ctrl->priv;
+
+    if (enable)
+        host->stats.frames++;
+
+    host->model->select(host->ctx, enable);
+}
+
+/**
+  * @brief  单线时全双工, 接收时发送内容被器件忽略 (与Flash一致)
+  */
+static ssize_t spi_host_transfer_one(struct spi_controller *ctrl, struct spi_device *dev,
+                                     struct spi_transfer *t)
+{
+    struct spi_host *host = (struct spi_host *)ctrl->priv;
+    uint8_t nbits = t->rx_buf ? t->rx_nbits : t->tx_nbits;
+    uint32_t per_byte;
+    uint8_t *rx = (uint8_t *)t->rx_buf;
+    size_t i;
+
+    if (!nbits)
+        nbits = SPI_NBITS_SINGLE;
+    per_byte = 8U / nbits;
+    if (t->dtr)
+        per_byte /= 2U;
+
+    host->stats.transfers++;
+    host->stats.bytes += t->len;
+
+    if (t->dummy_cycles) {
+        if (host->model->dummy)
+            host->model->dummy(host->ctx, t->dummy_cycles);
+        spi_host_clock(host, nbits, t->dummy_cycles);
+    }
+
+    if (rx) {
+        for (i = 0; i < t->len; i++) {
+            spi_host_clock(host, nbits, per_byte);
+            host->model->read(host->ctx, &rx[i], 1, nbits);
+        }
+    } else {
+        if (t->tx_buf)
+            host->model->write(host->ctx, (const uint8_t *)t->tx_buf, t->len, nbits);
+        spi_host_clock(host, nbits, (uint64_t)t->len * per_byte);
+    }
+
+    return (ssize_t)t->len;
+}
+
+/**
+  * @brief  按间隔重复 "命令 + 1字节状态" 直到匹配或超时, 与 QUADSPI 自动轮询相同
+  */
+static int spi_host_poll_status(struct spi_controller *ctrl, struct spi_device *dev,
+                                const struct spi_poll_info *info, uint8_t *status)
+{
+    struct spi_host *host = (struct spi_host *)ctrl->priv;
+    uint8_t nbits = info->nbits ? info->nbits : SPI_NBITS_SINGLE;
+    uint64_t start = host_now_ns();
+    uint8_t sr;
+
+    for (;;) {
+        host->stats.frames++;
+        host->stats.polls++;
+        host->model->select(host->ctx, 1);
+        host->model->write(host->ctx, &info->opcode, 1, nbits);
+        spi_host_clock(host, nbits, 8U / nbits);
+        spi_host_clock(host, nbits, 8U / nbits);
+        host->model->read(host->ctx, &sr, 1, nbits);
+        host->model->select(host->ctx, 0);
+
+        *status = sr;
+        if ((sr & info->mask) == info->match)
+            return 0;
+
+        if (host_now_ns() - start >= (uint64_t)info->timeout_ms * 1000000ULL)
+            return -ETIMEDOUT;
+
+        host_advance_us(info->interval_us ? info->interval_us : 1U);
+    }
+}
+
+static int spi_host_mmap_enable(struct spi_controller *ctrl, struct spi_device *dev,
+                                const struct spi_mmap_info *info, const void **base, size_t *size)
+{
+    struct spi_host *host = (struct spi_host *)ctrl->priv;
+    int ret;
+
+    ret = host->model->mmap(host->ctx, info, base, size);
+    if (ret == 0)
+        host->stats.mmaps++;
+
+    return ret;
+}
+
+static void spi_host_mmap_disable(struct spi_controller *ctrl, struct spi_device *dev)
+{
+    struct spi_host *host = (struct spi_host *)ctrl->priv;
+
+    if (host->model->unmap)
+        host->model->unmap(host->ctx);
+}
@@ -0,0 +1,78 @@
+/**
+  ******************************************************************************
+  * @file        : spi_host.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 主机端SPI控制器, 把传输转交给器件模型并按时钟数推进虚拟时间
+  * @attention   : - 始终声明 SPI_CAP_DUMMY, dummy周期以 model->dummy 通知器件
+  *                - 每次传输按 len*8/nbits (DTR减半) + dummy_cycles 计入对应线宽的时钟数
+  *                - 接收按字节推进时间, 器件可在一次突发读中反映状态变化
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __SPI_HOST_H__
+#define __SPI_HOST_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include "spi.h"
+
+/* Exported define -----------------------------------------------------------*/
+#define SPI_HOST_F_POLL         (1U << 0)   /* 提供 poll_status (硬件状态轮询) */
+
+/* Exported typedef ----------------------------------------------------------*/
+/**
+ * @brief 挂在控制器上的器件模型
+ */
+struct spi_host_model {
+    void (*select)(void *ctx, int active);                              /* 片选有效/释放 */
+    void (*write)(void *ctx, const uint8_t *buf, size_t len, uint8_t nbits);
+    void (*read)(void *ctx, uint8_t *buf, size_t len, uint8_t nbits);
+    void (*dummy)(void *ctx, uint32_t cycles);                          /* 可选 */
+    int (*mmap)(void *ctx, const struct spi_mmap_info *info,
+                const void **base, size_t *size);                       /* 可选, 非NULL时提供映射 */
+    void (*unmap)(void *ctx);                                           /* 可选 */
+};
+
+struct spi_host_stats {
+    uint32_t frames;            /* 片选有效次数 */
+    uint32_t transfers;
+    uint64_t clocks[SPI_NBITS_QUAD + 1];    /* 按线宽 (1/2/4) 统计的时钟数 */
+    uint64_t bytes;
+    uint32_t polls;             /* 硬件轮询发出的状态读次数 */
+    uint32_t mmaps;             /* 进入映射模式次数 */
+};
+
+struct spi_host {
+    struct spi_controller ctrl;
+    struct spi_controller_ops ops;
+    const struct spi_host_model *model;
+    void *ctx;
+    uint32_t hz;                /* 当前器件时钟 */
+    uint64_t clk_acc;           /* 自上次 setup 起的时钟数, 换算时间时不累积舍入误差 */
+    uint64_t ns_acc;
+    struct spi_host_stats stats;
+};
+
+/* Exported macro ------------------------------------------------------------*/
+
+/* Exported variable prototypes ----------------------------------------------*/
+
+/* Exported function prototypes ----------------------------------------------*/
+int spi_host_init(struct spi_host *host, const char *name, uint32_t caps, uint32_t flags,
+                  const struct spi_host_model *model, void *ctx);
+void spi_host_set_caps(struct spi_host *host, uint32_t caps);
+void spi_host_reset_stats(struct spi_host *host);
+uint64_t spi_host_total_clocks(const struct spi_host *host);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __SPI_HOST_H__ */
@@ -0,0 +1,11 @@
+/**
+  * @file   bitops.h
+  * @brief  主机测试用: 位操作宏
+  */
+#ifndef __BITOPS_H__
+#define __BITOPS_H__
+
+#define BIT(n)          (1UL << (n))
+#define GENMASK(h, l)   (((~0UL) << (l)) & (~0UL >> (sizeof(long) * 8 - 1 - (h))))
+
+#endif /* __BITOPS_H__ */
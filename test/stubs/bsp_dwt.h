@@ -0,0 +1,12 @@
+/**
+  * @file   bsp_dwt.h
+  * @brief  主机测试用: 微秒延时, 推进虚拟时钟
+  */
+#ifndef __BSP_DWT_H__
+#define __BSP_DWT_H__
+
+#include <stdint.h>
+
+void bsp_dwt_delay_us(uint32_t us);
+
+#endif /* __BSP_DWT_H__ */
@@ -0,0 +1,16 @@
+/**
+  * @file   cmsis_compiler.h
+  * @brief  主机测试用: 中断屏蔽与中断上下文查询, 由 host.c 模拟
+  */
+#ifndef __CMSIS_COMPILER_H__
+#define __CMSIS_COMPILER_H__
+
+#include <stdint.h>
+
+uint32_t __get_IPSR(void);
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+
+#endif /* __CMSIS_COMPILER_H__ */
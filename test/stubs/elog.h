@@ -0,0 +1,23 @@
+/**
+  * @file   elog.h
+  * @brief  主机测试用: 日志输出到 stderr, 级别由 host_log_level 控制
+  */
+#ifndef __ELOG_H__
+#define __ELOG_H__
+
+#define ELOG_LVL_ASSERT         0
+#define ELOG_LVL_ERROR          1
+#define ELOG_LVL_WARN           2
+#define ELOG_LVL_INFO           3
+#define ELOG_LVL_DEBUG          4
+#define ELOG_LVL_VERBOSE        5
+
+void host_log(int level, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+#define log_e(...)              host_log(ELOG_LVL_ERROR, __VA_ARGS__)
+#define log_w(...)              host_log(ELOG_LVL_WARN, __VA_ARGS__)
+#define log_i(...)              host_log(ELOG_LVL_INFO, __VA_ARGS__)
+#define log_d(...)              host_log(ELOG_LVL_DEBUG, __VA_ARGS__)
+#define log_v(...)              host_log(ELOG_LVL_VERBOSE, __VA_ARGS__)
+
+#endif /* __ELOG_H__ */
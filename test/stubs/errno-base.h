@@ -0,0 +1,49 @@
+/**
+  * @file   errno-base.h
+  * @brief  主机测试用: 平台错误码
+  */
+#ifndef __ERRNO_BASE_H__
+#define __ERRNO_BASE_H__
+
+#define EPERM           1
+#define ENOENT          2
+#define EIO             5
+#define ENXIO           6
+#define E2BIG           7
+#define EAGAIN          11
+#define ENOMEM          12
+#define EACCES          13
+#define EFAULT          14
+#define EBUSY           16
+#define EEXIST          17
+#define ENODEV          19
+#define EINVAL          22
+#define ENOSPC          28
+#define EROFS           30
+#define ERANGE          34
+#define ENOSYS          38
+#define ENODATA         61
+#define EBADMSG         74
+#define EOVERFLOW       75
+#define EILSEQ          84
+#define EMSGSIZE        90
+#define ETIMEDOUT       110
+#define EUCLEAN         117
+#define ECANCELED       125
+#define ENOTSUPP        524
+
+#define ERR_BUSY        EBUSY
+#define ERR_EXIST       EEXIST
+#define ERR_INVAL       EINVAL
+#define ERR_IO          EIO
+#define ERR_NODEV       ENODEV
+#define ERR_NOENT       ENOENT
+#define ERR_NOMEM       ENOMEM
+#define ERR_NOSPC       ENOSPC
+#define ERR_NOSYS       ENOSYS
+#define ERR_NOTSUPP     ENOTSUPP
+#define ERR_ROFS        EROFS
+#define ERR_TIMEOUT     ETIMEDOUT
+#define ERR_UCLEAN      EUCLEAN
+
+#endif /* __ERRNO_BASE_H__ */
@@ -0,0 +1,15 @@
+/**
+  * @file   log.h
+  * @brief  主机测试用: Platform 驱动的日志宏
+  */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include "elog.h"
+
+#define LOG_E(...)              host_log(ELOG_LVL_ERROR, __VA_ARGS__)
+#define LOG_W(...)              host_log(ELOG_LVL_WARN, __VA_ARGS__)
+#define LOG_I(...)              host_log(ELOG_LVL_INFO, __VA_ARGS__)
+#define LOG_D(...)              host_log(ELOG_LVL_DEBUG, __VA_ARGS__)
+
+#endif /* __LOG_H__ */
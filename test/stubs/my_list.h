@@ -0,0 +1,61 @@
+/**
+  * @file   my_list.h
+  * @brief  主机测试用: 双向循环链表
+  */
+#ifndef __MY_LIST_H__
+#define __MY_LIST_H__
+
+#include <stddef.h>
+#include <sys/types.h>
+
+struct list_node {
+    struct list_node *next;
+    struct list_node *prev;
+};
+
+typedef struct list_node list_t;
+
+#define container_of(ptr, type, member) \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+
+#define LIST_HEAD(name)         struct list_node name = { &(name), &(name) }
+
+static inline void list_node_init(list_t *node)
+{
+    node->next = node;
+    node->prev = node;
+}
+
+static inline void list_add_tail(list_t *node, list_t *head)
+{
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static inline void list_del(list_t *node)
+{
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->next = node;
+    node->prev = node;
+}
+
+static inline int list_empty(const list_t *head)
+{
+    return head->next == head;
+}
+
+#define list_entry(ptr, type, member)           container_of(ptr, type, member)
+#define list_first_entry(ptr, type, member)     list_entry((ptr)->next, type, member)
+
+#define list_for_each(pos, head) \
+    for ((pos) = (head)->next; (pos) != (head); (pos) = (pos)->next)
+
+#define list_for_each_entry(pos, head, member) \
+    for ((pos) = list_entry((head)->next, __typeof__(*(pos)), member); \
+         &(pos)->member != (head); \
+         (pos) = list_entry((pos)->member.next, __typeof__(*(pos)), member))
+
+#endif /* __MY_LIST_H__ */
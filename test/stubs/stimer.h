@@ -0,0 +1,28 @@
+/**
+  * @file   stimer.h
+  * @brief  主机测试用: 软件定时器, 由 host.c 按虚拟时钟触发
+  */
+#ifndef __STIMER_H__
+#define __STIMER_H__
+
+#include <stdint.h>
+
+#define STIMER_ONE_SHOT         0
+#define STIMER_AUTO_RELOAD      1
+
+typedef struct stimer {
+    uint32_t period;            /* 周期 (ms) */
+    uint8_t mode;
+    uint8_t active;
+    void (*cb)(void *arg);
+    void *arg;
+    uint64_t expires_ns;        /* 下次到期的虚拟时刻 */
+    struct stimer *next;        /* 运行中定时器链表 */
+} stimer_t;
+
+int stimer_create(stimer_t *timer, uint32_t period, uint8_t mode, void (*cb)(void *arg), void *arg);
+int stimer_start(stimer_t *timer);
+int stimer_stop(stimer_t *timer);
+int stimer_get_status(stimer_t *timer);
+
+#endif /* __STIMER_H__ */
@@ -0,0 +1,15 @@
+/**
+  * @file   sys_def.h
+  * @brief  主机测试用: 系统公共定义
+  */
+#ifndef __SYS_DEF_H__
+#define __SYS_DEF_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+uint32_t HAL_GetTick(void);
+
+#endif /* __SYS_DEF_H__ */
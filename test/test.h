@@ -0,0 +1,87 @@
+/**
+  ******************************************************************************
+  * @file        : test.h
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 主机端单元测试断言
+  * @attention   : 断言失败打印位置并结束当前用例, 由 TEST_RUN 统计结果;
+  *                main() 以 test_summary() 作为退出码
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#ifdef __cplusplus
+ extern "C" {
+#endif /* __cplusplus */
+
+/* Includes ------------------------------------------------------------------*/
+#include <setjmp.h>
+#include <stdio.h>
+#include "host.h"
+
+/* Exported typedef ----------------------------------------------------------*/
+struct test_state {
+    jmp_buf env;
+    int run;
+    int failed;
+};
+
+/* Exported variable prototypes ----------------------------------------------*/
+/* 每个测试程序只有一个使用断言的源文件 */
+static struct test_state test_state;
+
+/* Exported macro ------------------------------------------------------------*/
+#define TEST_FAIL_AT(file, line, fmt, ...) do { \
+    fprintf(stderr, "%s:%d: " fmt "\n", file, line, __VA_ARGS__); \
+    longjmp(test_state.env, 1); \
+} while (0)
+
+#define TEST_ASSERT(cond) do { \
+    if (!(cond)) \
+        TEST_FAIL_AT(__FILE__, __LINE__, "assertion failed: %s", #cond); \
+} while (0)
+
+#define TEST_ASSERT_EQ(actual, expected) do { \
+    long long test_a_ = (long long)(actual); \
+    long long test_e_ = (long long)(expected); \
+    if (test_a_ != test_e_) \
+        TEST_FAIL_AT(__FILE__, __LINE__, "%s == %lld, expected %s == %lld", \
+                     #actual, test_a_, #expected, test_e_); \
+} while (0)
+
+#define TEST_RUN(fn)            test_run(#fn, fn)
+
+/* Exported function prototypes ----------------------------------------------*/
+/**
+  * @brief  执行一个用例, 每个用例从虚拟时刻0开始
+  */
+static inline void test_run(const char *name, void (*fn)(void))
+{
+    test_state.run++;
+    host_reset();
+
+    if (setjmp(test_state.env) == 0) {
+        fn();
+        printf("[ OK ] %s\n", name);
+    } else {
+        test_state.failed++;
+        printf("[FAIL] %s\n", name);
+    }
+}
+
+static inline int test_summary(void)
+{
+    printf("%d/%d passed\n", test_state.run - test_state.failed, test_state.run);
+    return test_state.failed ? 1 : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __TEST_H__ */
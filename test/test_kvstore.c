@@ -0,0 +1,321 @@
+/**
+  ******************************************************************************
+  * @file        : test_kvstore.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : KV存储测试 (64KB 文件后端 NOR)
+  * @attention   : 每次"重启"都关闭并重新打开文件, 只有落到文件里的内容才算数;
+  *                掉电用 mtd_sim 的写/擦除撕裂注入
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "kvstore.h"
+#include "mtd_file.h"
+#include "errno-base.h"
+#include "elog.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define KV_REGION               (64U * 1024U)
+#define NKEYS                   300
+#define VAL_MAX                 64
+
+/* Private variables ---------------------------------------------------------*/
+static struct mtd_file file;
+static struct kv_store kv;
+static char path[] = "/tmp/kvstore_XXXXXX";
+static uint8_t shadow[NKEYS][VAL_MAX];
+static int shadow_len[NKEYS];           /* -1=不存在 */
+static uint32_t seed;
+
+static const struct mtd_sim_config kv_cfg = {
+    .name = "kv", .type = MTD_NORFLASH, .size = KV_REGION,
+    .erasesize = 4096, .writesize = 256,
+    .timing = { .bus_kbps = 40000, .cmd_ns = 500, .prog_us = 700, .erase_us = 45000 },
+};
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245U + 12345U;
+    return seed >> 8;
+}
+
+static void key_name(char *key, int k)
+{
+    snprintf(key, KV_KEY_MAX, "cal.%d", k);
+}
+
+/**
+  * @brief  从文件重新打开设备 (丢弃读缓存) 并挂载
+  */
+static struct mtd_info *reboot(void)
+{
+    struct mtd_info *mtd;
+
+    if (file.fp)
+        TEST_ASSERT_EQ(mtd_file_close(&file), 0);
+    TEST_ASSERT_EQ(mtd_file_open(&file, &kv_cfg, path), 0);
+    mtd = mtd_file_to_mtd(&file);
+    mtd_cache_invalidate(mtd);
+
+    TEST_ASSERT_EQ(kv_mount(&kv, mtd), 0);
+    return mtd;
+}
+
+/**
+  * @brief  空文件上挂载, 影子表清空
+  */
+static void fresh(void)
+{
+    int k;
+
+    if (file.fp)
+        TEST_ASSERT_EQ(mtd_file_close(&file), 0);
+    unlink(path);
+    reboot();
+
+    for (k = 0; k < NKEYS; k++)
+        shadow_len[k] = -1;
+    seed = 1;
+}
+
+static int key_matches(int k)
+{
+    char key[KV_KEY_MAX];
+    uint8_t buf[KV_VAL_MAX];
+    size_t len = 0;
+    int ret;
+
+    key_name(key, k);
+    ret = kv_get(&kv, key, buf, sizeof(buf), &len);
+    if (shadow_len[k] < 0)
+        return ret == -ERR_NOENT;
+    return ret == 0 && len == (size_t)shadow_len[k] && memcmp(buf, shadow[k], len) == 0;
+}
+
+static void check_all(void)
+{
+    int k;
+    int count = 0;
+
+    for (k = 0; k < NKEYS; k++) {
+        TEST_ASSERT(key_matches(k));
+        if (shadow_len[k] >= 0)
+            count++;
+    }
+    TEST_ASSERT_EQ(kv_count(&kv), count);
+}
+
+/**
+  * @brief  随机设置/删除一个键, 影子表同步
+  */
+static void churn(int ops)
+{
+    char key[KV_KEY_MAX];
+    uint8_t val[VAL_MAX];
+    int i, k, len, j;
+
+    for (i = 0; i < ops; i++) {
+        k = (int)(rnd() % NKEYS);
+        key_name(key, k);
+
+        if (rnd() % 20 == 0) {
+            TEST_ASSERT_EQ(kv_delete(&kv, key), shadow_len[k] < 0 ? -ERR_NOENT : 0);
+            shadow_len[k] = -1;
+            continue;
+        }
+
+        len = (int)(rnd() % VAL_MAX);
+        for (j = 0; j < len; j++)
+            val[j] = (uint8_t)rnd();
+        TEST_ASSERT_EQ(kv_set(&kv, key, val, (size_t)len), 0);
+        memcpy(shadow[k], val, (size_t)len);
+        shadow_len[k] = len;
+    }
+}
+
+/* ------------------------------------------------------------------ 用例 */
+static void test_set_get_delete(void)
+{
+    uint8_t buf[16];
+    size_t len;
+
+    fresh();
+
+    TEST_ASSERT_EQ(kv_get(&kv, "a", buf, sizeof(buf), &len), -ERR_NOENT);
+    TEST_ASSERT_EQ(kv_set(&kv, "a", "one", 3), 0);
+    TEST_ASSERT_EQ(kv_set(&kv, "b", "", 0), 0);
+    TEST_ASSERT_EQ(kv_set(&kv, "a", "three", 5), 0);
+    TEST_ASSERT_EQ(kv_count(&kv), 2);
+
+    TEST_ASSERT_EQ(kv_get(&kv, "a", buf, sizeof(buf), &len), 0);
+    TEST_ASSERT_EQ(len, 5);
+    TEST_ASSERT(memcmp(buf, "three", 5) == 0);
+    TEST_ASSERT_EQ(kv_get(&kv, "b", buf, sizeof(buf), &len), 0);
+    TEST_ASSERT_EQ(len, 0);
+
+    TEST_ASSERT_EQ(kv_delete(&kv, "a"), 0);
+    TEST_ASSERT_EQ(kv_delete(&kv, "a"), -ERR_NOENT);
+    TEST_ASSERT_EQ(kv_count(&kv), 1);
+
+    reboot();
+    TEST_ASSERT_EQ(kv_get(&kv, "a", buf, sizeof(buf), &len), -ERR_NOENT);
+    TEST_ASSERT_EQ(kv_get(&kv, "b", buf, sizeof(buf), &len), 0);
+    TEST_ASSERT_EQ(kv_count(&kv), 1);
+}
+
+static void test_invalid_arguments(void)
+{
+    static char long_key[KV_KEY_MAX + 2];
+    static uint8_t big[KV_VAL_MAX + 1];
+
+    fresh();
+
+    memset(long_key, 'k', sizeof(long_key) - 1);
+    TEST_ASSERT_EQ(kv_set(&kv, "", "x", 1), -ERR_INVAL);
+    TEST_ASSERT_EQ(kv_set(&kv, long_key, "x", 1), -ERR_INVAL);
+    TEST_ASSERT_EQ(kv_set(&kv, "big", big, sizeof(big)), -ERR_INVAL);
+    TEST_ASSERT_EQ(kv_count(&kv), 0);
+}
+
+/**
+  * @brief  300个键反复改写 (多轮扇区回收), 每次重启后全部一致
+  */
+static void test_churn_survives_reboot(void)
+{
+    uint32_t erases = 0;
+    int round;
+
+    fresh();
+
+    for (round = 0; round < 10; round++) {
+        churn(2000);
+        check_all();
+        erases += file.sim.stats.erases;
+        reboot();
+        check_all();
+    }
+    TEST_ASSERT(erases > 4U * KV_REGION / 4096U);
+}
+
+/**
+  * @brief  重启并返回挂载的设备时间 (ns)
+  */
+static uint64_t timed_mount(void)
+{
+    struct mtd_info *mtd;
+
+    TEST_ASSERT_EQ(mtd_file_close(&file), 0);
+    TEST_ASSERT_EQ(mtd_file_open(&file, &kv_cfg, path), 0);
+    mtd = mtd_file_to_mtd(&file);
+    mtd_cache_invalidate(mtd);
+
+    TEST_ASSERT_EQ(kv_mount(&kv, mtd), 0);
+    printf("  mount: %u reads, %llu bytes, %.2f ms device\n", file.sim.stats.reads,
+           (unsigned long long)file.sim.stats.read_bytes,
+           (double)file.sim.stats.elapsed_ns / 1e6);
+
+    return file.sim.stats.elapsed_ns;
+}
+
+/**
+  * @brief  挂载只扫描区域内现存的记录, 耗时由区域大小决定, 不随改写历史增长
+  */
+static void test_mount_is_bounded(void)
+{
+    uint64_t early, late;
+
+    fresh();
+    churn(2000);
+    early = timed_mount();
+    check_all();
+
+    churn(20000);
+    late = timed_mount();
+    check_all();
+
+    TEST_ASSERT(late < early * 2U);
+    TEST_ASSERT(late < 20000000ULL);
+}
+
+/**
+  * @brief  写或擦除中途掉电: 被改写的键为旧值或新值, 其他键不变
+  */
+static void test_power_fail(void)
+{
+    char key[KV_KEY_MAX];
+    uint8_t val[VAL_MAX];
+    uint8_t old[VAL_MAX];
+    int i, j, k, len, old_len;
+    int torn = 0;
+
+    fresh();
+    churn(600);
+    reboot();
+
+    /* 撕裂的记录与扇区在挂载时告警, 这里是预期的 */
+    host_log_level = ELOG_LVL_ERROR;
+
+    for (i = 0; i < 400; i++) {
+        k = (int)(rnd() % NKEYS);
+        key_name(key, k);
+        len = (int)(rnd() % VAL_MAX);
+        for (j = 0; j < len; j++)
+            val[j] = (uint8_t)rnd();
+
+        if (rnd() % 4)
+            file.sim.fault.write_fail_after = (long)(rnd() % 4);
+        else
+            file.sim.fault.erase_fail_after = 0;
+
+        if (kv_set(&kv, key, val, (size_t)len) < 0)
+            torn++;
+        mtd_sim_power_cycle(&file.sim);
+        reboot();
+
+        old_len = shadow_len[k];
+        memcpy(old, shadow[k], VAL_MAX);
+        memcpy(shadow[k], val, (size_t)len);
+        shadow_len[k] = len;
+        if (!key_matches(k)) {
+            memcpy(shadow[k], old, VAL_MAX);
+            shadow_len[k] = old_len;
+        }
+        check_all();
+    }
+
+    host_log_level = ELOG_LVL_WARN;
+    printf("  %d of 400 updates interrupted\n", torn);
+    TEST_ASSERT(torn > 0);
+}
+
+int main(void)
+{
+    int fd;
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    TEST_RUN(test_set_get_delete);
+    TEST_RUN(test_invalid_arguments);
+    TEST_RUN(test_churn_survives_reboot);
+    TEST_RUN(test_mount_is_bounded);
+    TEST_RUN(test_power_fail);
+
+    if (file.fp)
+        mtd_file_close(&file);
+    unlink(path);
+    return test_summary();
+}
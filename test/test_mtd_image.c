@@ -0,0 +1,343 @@
+/**
+  ******************************************************************************
+  * @file        : test_mtd_image.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 镜像流式校验测试: CRC32/SHA-256 标准向量, NOR分段读流水, 同步读退化
+  * @attention   : NOR 走 spi_nor 的 mtd_read_start/mtd_read_wait, 同步路径用 mtd_ram;
+  *                CRC 与逐位实现对比 (覆盖 slice-by-8 的各种起始对齐)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nor_sim.h"
+#include "spi_nor.h"
+#include "mtd_ram.h"
+#include "mtd_image.h"
+#include "crc32.h"
+#include "sha256.h"
+#include "errno-base.h"
+#include "elog.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_HZ                  50000000U
+#define IMG_ADDR                0x1007U         /* 故意不对齐 */
+#define IMG_LEN                 (300U * 1024U + 13U)
+#define BUF_SIZE                (16U * 1024U)
+#define RAM_SIZE                (512U * 1024U)
+
+#define CAPS_QUAD               (SPI_CAP_TX_DUAL | SPI_CAP_RX_DUAL | \
+                                 SPI_CAP_TX_QUAD | SPI_CAP_RX_QUAD)
+
+#define HWCAPS_ALL              (SNOR_HWCAPS_READ | SNOR_HWCAPS_READ_FAST | \
+                                 SNOR_HWCAPS_READ_1_1_4 | SNOR_HWCAPS_READ_1_4_4 | \
+                                 SNOR_HWCAPS_PP | SNOR_HWCAPS_PP_1_1_4)
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;
+static struct nor_sim sim;
+static struct spi_nor nor;
+static struct spi_device dev = {
+    .name = "nor", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static struct mtd_ram ram;
+static uint8_t ram_mem[RAM_SIZE];
+
+static uint8_t image[IMG_LEN];
+static uint8_t dst[IMG_LEN];
+static uint8_t buf[BUF_SIZE];
+static uint32_t image_crc;
+static uint8_t image_sha[SHA256_DIGEST_SIZE];
+
+static const struct nor_sim_config sim_cfg = {
+    .id = { 0xEF, 0x40, 0x18 },
+    .size = 16U * 1024U * 1024U,
+};
+
+static const struct mtd_sim_config ram_cfg = {
+    .name = "ram", .type = MTD_NORFLASH, .size = RAM_SIZE,
+    .erasesize = 4096, .writesize = 1,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  逐位参考实现
+  */
+static uint32_t crc32_bitwise(uint32_t crc, const uint8_t *p, size_t len)
+{
+    int k;
+
+    crc = ~crc;
+    while (len--) {
+        crc ^= *p++;
+        for (k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320U & (0U - (crc & 1U)));
+    }
+
+    return ~crc;
+}
+
+static void sha256_hex(const uint8_t *digest, char *out)
+{
+    int i;
+
+    for (i = 0; i < SHA256_DIGEST_SIZE; i++)
+        sprintf(&out[2 * i], "%02x", digest[i]);
+}
+
+/**
+  * @brief  上电, 镜像放入阵列并探测
+  */
+static struct mtd_info *nor_open(void)
+{
+    nor_sim_free(&sim);
+    TEST_ASSERT_EQ(nor_sim_init(&sim, &sim_cfg), 0);
+    memcpy(&sim.mem[IMG_ADDR], image, IMG_LEN);
+
+    memset(&nor, 0, sizeof(nor));
+    nor.spi = &dev;
+    TEST_ASSERT_EQ(spi_nor_scan(&nor, HWCAPS_ALL), 0);
+    TEST_ASSERT_EQ(spi_nor_mtd_init(&nor, "nor"), 0);
+    mtd_cache_invalidate(&nor.mtd);
+
+    spi_host_reset_stats(&host);
+    nor_sim_reset_stats(&sim);
+
+    return &nor.mtd;
+}
+
+static struct mtd_info *ram_open(void)
+{
+    struct mtd_info *mtd;
+
+    /* 初始化时格式化为擦除态, 之后再放入镜像 */
+    TEST_ASSERT_EQ(mtd_ram_init(&ram, &ram_cfg, ram_mem, sizeof(ram_mem)), 0);
+    memcpy(&ram_mem[IMG_ADDR], image, IMG_LEN);
+    mtd = mtd_ram_to_mtd(&ram);
+    mtd_cache_invalidate(mtd);
+
+    return mtd;
+}
+
+/* ------------------------------------------------------------------ 用例 */
+static void test_crc32_vectors(void)
+{
+    uint32_t seed = 3;
+    uint32_t off, len, init, split;
+    int i;
+
+    TEST_ASSERT_EQ(crc32(0, "123456789", 9), 0xCBF43926U);
+    TEST_ASSERT_EQ(crc32(0, "", 0), 0);
+    TEST_ASSERT_EQ(crc32(0x12345678U, "", 0), 0x12345678U);
+
+    for (i = 0; i < 2000; i++) {
+        seed = seed * 1103515245U + 12345U;
+        off = (seed >> 8) % 1000U;
+        seed = seed * 1103515245U + 12345U;
+        len = (seed >> 8) % 5000U;
+        init = seed;
+        TEST_ASSERT_EQ(crc32(init, &image[off], len), crc32_bitwise(init, &image[off], len));
+
+        split = len ? (seed >> 4) % len : 0;
+        TEST_ASSERT_EQ(crc32(crc32(0, &image[off], split), &image[off + split], len - split),
+                       crc32(0, &image[off], len));
+    }
+}
+
+static void test_sha256_vectors(void)
+{
+    static const char *m448 = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    static uint8_t million_a[1000000];
+    struct sha256_ctx ctx;
+    uint8_t d[SHA256_DIGEST_SIZE];
+    char hex[2 * SHA256_DIGEST_SIZE + 1];
+    uint32_t seed = 5;
+    size_t i, n;
+
+    sha256_init(&ctx);
+    sha256_update(&ctx, "abc", 3);
+    sha256_final(&ctx, d);
+    sha256_hex(d, hex);
+    TEST_ASSERT(strcmp(hex, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad") == 0);
+
+    sha256_init(&ctx);
+    sha256_final(&ctx, d);
+    sha256_hex(d, hex);
+    TEST_ASSERT(strcmp(hex, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855") == 0);
+
+    /* 逐字节喂入 */
+    sha256_init(&ctx);
+    for (i = 0; i < strlen(m448); i++)
+        sha256_update(&ctx, &m448[i], 1);
+    sha256_final(&ctx, d);
+    sha256_hex(d, hex);
+    TEST_ASSERT(strcmp(hex, "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1") == 0);
+
+    /* 随机分段 */
+    memset(million_a, 'a', sizeof(million_a));
+    sha256_init(&ctx);
+    for (i = 0; i < sizeof(million_a); i += n) {
+        seed = seed * 1103515245U + 12345U;
+        n = 1U + (seed >> 8) % 300U;
+        if (n > sizeof(million_a) - i)
+            n = sizeof(million_a) - i;
+        sha256_update(&ctx, &million_a[i], n);
+    }
+    sha256_final(&ctx, d);
+    sha256_hex(d, hex);
+    TEST_ASSERT(strcmp(hex, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0") == 0);
+}
+
+/**
+  * @brief  NOR: 分段读与计算重叠, 只读一遍, 设备时间接近纯数据传输时间
+  */
+static void test_verify_nor_pipelined(void)
+{
+    struct mtd_info *mtd = nor_open();
+    struct mtd_image_result r;
+    uint32_t chunks = (IMG_LEN + BUF_SIZE / 2U - 1U) / (BUF_SIZE / 2U);
+    uint64_t wire_ns = (uint64_t)IMG_LEN * 2U * 1000000000ULL / SPI_HZ;
+    uint64_t t0 = host_now_ns();
+    uint64_t ns;
+
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_CRC32, &image_crc,
+                                    buf, sizeof(buf), &r), 0);
+    ns = host_now_ns() - t0;
+
+    printf("  %u KB in %u chunks: %.2f ms device, %.2f ms on the wire, %u KB/s\n",
+           IMG_LEN / 1024U, chunks, (double)ns / 1e6, (double)wire_ns / 1e6, r.kbps);
+
+    TEST_ASSERT(r.overlapped);
+    TEST_ASSERT_EQ(r.bytes, IMG_LEN);
+    TEST_ASSERT_EQ(r.crc, image_crc);
+    TEST_ASSERT_EQ(sim.stats.ops[nor.read_opcode], chunks);
+    TEST_ASSERT(host.stats.bytes < IMG_LEN + chunks * 16U);
+    TEST_ASSERT(ns < wire_ns + wire_ns / 20U);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+static void test_verify_sha256_and_mismatch(void)
+{
+    struct mtd_info *mtd = nor_open();
+    struct mtd_image_result r;
+    uint32_t bad_crc = image_crc ^ 1U;
+
+    /* 奇数缓冲: 两半各 500 字节 */
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_SHA256, image_sha,
+                                    buf, 1001, &r), 0);
+    TEST_ASSERT(memcmp(r.sha256, image_sha, sizeof(image_sha)) == 0);
+
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_CRC32, &bad_crc,
+                                    buf, sizeof(buf), &r), MTD_IMAGE_MISMATCH);
+    TEST_ASSERT_EQ(r.crc, image_crc);
+
+    /* 镜像中间一位损坏 */
+    sim.mem[IMG_ADDR + IMG_LEN / 2U] ^= 0x10;
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_SHA256, image_sha,
+                                    buf, sizeof(buf), &r), MTD_IMAGE_MISMATCH);
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_CRC32, &image_crc,
+                                    buf, sizeof(buf), &r), MTD_IMAGE_MISMATCH);
+    TEST_ASSERT_EQ(r.bytes, IMG_LEN);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+static void test_load_nor(void)
+{
+    struct mtd_info *mtd = nor_open();
+    struct mtd_image_result r;
+
+    memset(dst, 0, sizeof(dst));
+    TEST_ASSERT_EQ(mtd_image_load(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_SHA256, image_sha,
+                                  dst, 3000, &r), 0);
+    TEST_ASSERT(r.overlapped);
+    TEST_ASSERT(memcmp(dst, image, IMG_LEN) == 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  不支持分段读的设备逐块同步读, 结果相同
+  */
+static void test_sync_fallback(void)
+{
+    struct mtd_info *mtd = ram_open();
+    struct mtd_image_result r;
+
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_CRC32, &image_crc,
+                                    buf, sizeof(buf), &r), 0);
+    TEST_ASSERT(!r.overlapped);
+    TEST_ASSERT_EQ(r.crc, image_crc);
+
+    memset(dst, 0, sizeof(dst));
+    TEST_ASSERT_EQ(mtd_image_load(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_SHA256, image_sha,
+                                  dst, 3000, &r), 0);
+    TEST_ASSERT(memcmp(dst, image, IMG_LEN) == 0);
+
+    /* 读干扰翻转被发现 */
+    ram.sim.fault.read_flip_every = 7;
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_CRC32, &image_crc,
+                                    buf, sizeof(buf), &r), MTD_IMAGE_MISMATCH);
+}
+
+static void test_errors_and_bounds(void)
+{
+    struct mtd_info *mtd = ram_open();
+    struct mtd_image_result r;
+
+    /* 以下错误日志是预期的 */
+    host_log_level = ELOG_LVL_ASSERT;
+
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, 0, RAM_SIZE + 1U, MTD_IMAGE_CRC32, NULL,
+                                    buf, sizeof(buf), &r), -ERR_INVAL);
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, RAM_SIZE, 1, MTD_IMAGE_CRC32, NULL,
+                                    buf, sizeof(buf), &r), -ERR_INVAL);
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, 0, 16, MTD_IMAGE_CRC32, NULL, buf, 1, &r), -ERR_INVAL);
+    TEST_ASSERT_EQ(mtd_image_load(mtd, 0, 16, MTD_IMAGE_CRC32, NULL, dst, 0, &r), -ERR_INVAL);
+
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, 0, 0, MTD_IMAGE_CRC32, NULL, buf, sizeof(buf), &r), 0);
+    TEST_ASSERT_EQ(r.crc, 0);
+    TEST_ASSERT_EQ(r.bytes, 0);
+
+    /* 读失败: 返回错误码, 已计算的字节数停在失败处 */
+    ram.sim.fault.powered_off = 1;
+    TEST_ASSERT_EQ(mtd_image_verify(mtd, IMG_ADDR, IMG_LEN, MTD_IMAGE_CRC32, &image_crc,
+                                    buf, sizeof(buf), &r), -ERR_IO);
+    TEST_ASSERT_EQ(r.bytes, 0);
+
+    host_log_level = ELOG_LVL_WARN;
+}
+
+int main(void)
+{
+    struct sha256_ctx ctx;
+    uint32_t i;
+
+    for (i = 0; i < IMG_LEN; i++)
+        image[i] = (uint8_t)(i * 131U + (i >> 8) * 7U + (i >> 16));
+    image_crc = crc32_bitwise(0, image, IMG_LEN);
+    sha256_init(&ctx);
+    sha256_update(&ctx, image, IMG_LEN);
+    sha256_final(&ctx, image_sha);
+
+    if (spi_host_init(&host, "qspi", CAPS_QUAD, 0, &nor_sim_model, &sim) ||
+        spi_device_attach(&dev, "qspi")) {
+        fprintf(stderr, "spi host setup failed\n");
+        return 1;
+    }
+
+    TEST_RUN(test_crc32_vectors);
+    TEST_RUN(test_sha256_vectors);
+    TEST_RUN(test_verify_nor_pipelined);
+    TEST_RUN(test_verify_sha256_and_mismatch);
+    TEST_RUN(test_load_nor);
+    TEST_RUN(test_sync_fallback);
+    TEST_RUN(test_errors_and_bounds);
+
+    nor_sim_free(&sim);
+    return test_summary();
+}
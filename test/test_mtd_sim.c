@@ -0,0 +1,271 @@
+/**
+  ******************************************************************************
+  * @file        : test_mtd_sim.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 仿真MTD设备 (mtd_sim / mtd_ram / mtd_file) 测试
+  * @attention   : 读缓存按主设备指针区分, 复用同一设备结构时须先失效
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "mtd_ram.h"
+#include "mtd_file.h"
+#include "bsp_dwt.h"
+#include "errno-base.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define NOR_SIZE                (64U * 1024U)
+#define NAND_PAGE               2048U
+#define NAND_OOB                64U
+#define NAND_BLOCK              (64U * NAND_PAGE)
+#define NAND_SIZE               (8U * NAND_BLOCK)
+
+/* Private variables ---------------------------------------------------------*/
+static struct mtd_ram ram;
+static uint8_t mem[NAND_SIZE + NAND_SIZE / NAND_PAGE * NAND_OOB];
+
+static const struct mtd_sim_config nor_cfg = {
+    .name = "nor", .type = MTD_NORFLASH, .size = NOR_SIZE,
+    .erasesize = 4096, .writesize = 256,
+};
+
+static const struct mtd_sim_config nand_cfg = {
+    .name = "nand", .type = MTD_NANDFLASH, .size = NAND_SIZE,
+    .erasesize = NAND_BLOCK, .writesize = NAND_PAGE, .oobsize = NAND_OOB,
+};
+
+/* Private functions ---------------------------------------------------------*/
+static struct mtd_info *ram_open(const struct mtd_sim_config *cfg)
+{
+    TEST_ASSERT_EQ(mtd_ram_init(&ram, cfg, mem, sizeof(mem)), 0);
+    mtd_cache_invalidate(mtd_ram_to_mtd(&ram));
+    return mtd_ram_to_mtd(&ram);
+}
+
+static int erase(struct mtd_info *mtd, mtd_addr_t addr, mtd_addr_t len, mtd_addr_t *fail_addr)
+{
+    struct erase_info ei = { .addr = addr, .len = len };
+    int ret = mtd_erase(mtd, &ei);
+
+    if (fail_addr)
+        *fail_addr = ei.fail_addr;
+    return ret;
+}
+
+/* ------------------------------------------------------------------ 用例 */
+static void test_nor_program_is_bitwise_and(void)
+{
+    struct mtd_info *mtd = ram_open(&nor_cfg);
+    uint8_t b;
+    size_t n;
+
+    b = 0xF0;
+    TEST_ASSERT_EQ(mtd_write(mtd, 10, 1, &n, &b), 0);
+    b = 0x3C;
+    TEST_ASSERT_EQ(mtd_write(mtd, 10, 1, &n, &b), 0);
+    TEST_ASSERT_EQ(mtd_read(mtd, 10, 1, &n, &b), 0);
+    TEST_ASSERT_EQ(b, 0x30);
+    TEST_ASSERT_EQ(ram.sim.stats.overprogram, 1);
+
+    TEST_ASSERT_EQ(erase(mtd, 0, 4096, NULL), 0);
+    TEST_ASSERT_EQ(mtd_read(mtd, 10, 1, &n, &b), 0);
+    TEST_ASSERT_EQ(b, 0xFF);
+    TEST_ASSERT_EQ(ram.sim.erase_count[0], 1);
+}
+
+static void test_timing_model(void)
+{
+    struct mtd_sim_config cfg = nor_cfg;
+    struct mtd_info *mtd;
+    uint8_t buf[512];
+    size_t n;
+
+    cfg.timing.bus_kbps = 10000;
+    cfg.timing.cmd_ns = 1000;
+    cfg.timing.prog_us = 700;
+    cfg.timing.erase_us = 45000;
+    mtd = ram_open(&cfg);
+    memset(buf, 0x5A, sizeof(buf));
+
+    /* 跨2页: 命令 + 2 x tPP + 512B / 10MB/s */
+    TEST_ASSERT_EQ(mtd_write(mtd, 0, sizeof(buf), &n, buf), 0);
+    TEST_ASSERT_EQ(ram.sim.stats.elapsed_ns, 1000 + 1400000 + 51200);
+
+    mtd_sim_reset_stats(&ram.sim);
+    TEST_ASSERT_EQ(erase(mtd, 0, 8192, NULL), 0);
+    TEST_ASSERT_EQ(ram.sim.stats.elapsed_ns, 2 * (1000 + 45000000ULL));
+    TEST_ASSERT_EQ(ram.sim.stats.erases, 2);
+}
+
+static void test_timing_delay_hook(void)
+{
+    struct mtd_sim_config cfg = nor_cfg;
+    struct mtd_info *mtd;
+    uint64_t t0;
+
+    cfg.timing.erase_us = 30000;
+    cfg.timing.delay_us = bsp_dwt_delay_us;
+    mtd = ram_open(&cfg);
+
+    t0 = host_now_ns();
+    TEST_ASSERT_EQ(erase(mtd, 4096, 4096, NULL), 0);
+    TEST_ASSERT_EQ(host_now_ns() - t0, 30000000ULL);
+}
+
+static void test_write_fault_tears_and_powers_off(void)
+{
+    struct mtd_info *mtd = ram_open(&nor_cfg);
+    uint8_t buf[64];
+    uint8_t rd[64];
+    size_t n;
+
+    memset(buf, 0x00, sizeof(buf));
+    ram.sim.fault.write_fail_after = 1;
+
+    TEST_ASSERT_EQ(mtd_write(mtd, 0, sizeof(buf), &n, buf), 0);
+    TEST_ASSERT_EQ(mtd_write(mtd, 256, sizeof(buf), &n, buf), -ERR_IO);
+    TEST_ASSERT_EQ(ram.sim.stats.faults, 1);
+
+    /* 掉电期间全部失败 */
+    TEST_ASSERT_EQ(mtd_read(mtd, 256, sizeof(rd), &n, rd), -ERR_IO);
+    TEST_ASSERT_EQ(erase(mtd, 0, 4096, NULL), -ERR_IO);
+
+    /* 上电后可见被撕裂的一半 */
+    mtd_sim_power_cycle(&ram.sim);
+    TEST_ASSERT_EQ(mtd_read(mtd, 256, sizeof(rd), &n, rd), 0);
+    TEST_ASSERT_EQ(rd[0], 0x00);
+    TEST_ASSERT_EQ(rd[31], 0x00);
+    TEST_ASSERT_EQ(rd[32], 0xFF);
+    TEST_ASSERT_EQ(rd[63], 0xFF);
+}
+
+static void test_erase_limit_reports_fail_addr(void)
+{
+    struct mtd_sim_config cfg = nor_cfg;
+    struct mtd_info *mtd;
+    mtd_addr_t fail;
+
+    cfg.erase_limit = 2;
+    mtd = ram_open(&cfg);
+
+    TEST_ASSERT_EQ(erase(mtd, 8192, 4096, NULL), 0);
+    TEST_ASSERT_EQ(erase(mtd, 8192, 4096, NULL), 0);
+    TEST_ASSERT_EQ(erase(mtd, 4096, 8192, &fail), -ERR_IO);
+    TEST_ASSERT_EQ(fail, 8192);
+    TEST_ASSERT_EQ(ram.sim.erase_count[1], 1);
+}
+
+static void test_read_flip_every(void)
+{
+    struct mtd_info *mtd = ram_open(&nor_cfg);
+    uint8_t buf[512];
+    size_t n;
+    int i;
+    int flipped = 0;
+
+    ram.sim.fault.read_flip_every = 3;
+
+    /* 大于缓存行, 每次都直达设备 */
+    for (i = 0; i < 6; i++) {
+        TEST_ASSERT_EQ(mtd_read(mtd, 0, sizeof(buf), &n, buf), 0);
+        for (n = 0; n < sizeof(buf); n++) {
+            if (buf[n] != 0xFF)
+                flipped++;
+        }
+    }
+
+    TEST_ASSERT_EQ(ram.sim.stats.flips, 2);
+    TEST_ASSERT_EQ(flipped, 2);
+}
+
+static void test_nand_oob_and_bad_block(void)
+{
+    struct mtd_info *mtd = ram_open(&nand_cfg);
+    static uint8_t page[NAND_PAGE];
+    uint8_t oob[NAND_OOB];
+    struct mtd_oob_ops ops;
+    size_t n;
+
+    memset(page, 0xA5, sizeof(page));
+    memset(oob, 0x11, sizeof(oob));
+
+    memset(&ops, 0, sizeof(ops));
+    ops.mode = MTD_OPS_RAW;
+    ops.len = NAND_PAGE;
+    ops.datbuf = page;
+    ops.ooblen = NAND_OOB;
+    ops.oobbuf = oob;
+    TEST_ASSERT_EQ(mtd_write_oob(mtd, NAND_PAGE, &ops), 0);
+
+    memset(page, 0, sizeof(page));
+    memset(oob, 0, sizeof(oob));
+    memset(&ops, 0, sizeof(ops));
+    ops.mode = MTD_OPS_RAW;
+    ops.len = NAND_PAGE;
+    ops.datbuf = page;
+    ops.ooblen = NAND_OOB;
+    ops.oobbuf = oob;
+    TEST_ASSERT_EQ(mtd_read_oob(mtd, NAND_PAGE, &ops), 0);
+    TEST_ASSERT_EQ(ops.oobretlen, NAND_OOB);
+    TEST_ASSERT_EQ(page[NAND_PAGE - 1], 0xA5);
+    TEST_ASSERT_EQ(oob[0], 0x11);
+    TEST_ASSERT_EQ(oob[NAND_OOB - 1], 0x11);
+
+    /* 非整页写被拒绝 */
+    TEST_ASSERT(mtd_write(mtd, 0, 512, &n, page) < 0);
+
+    TEST_ASSERT_EQ(mtd_block_isbad(mtd, 2 * NAND_BLOCK), 0);
+    TEST_ASSERT_EQ(mtd_sim_set_bad(&ram.sim, 2, 1), 0);
+    TEST_ASSERT_EQ(mtd_block_isbad(mtd, 2 * NAND_BLOCK), 1);
+    TEST_ASSERT(erase(mtd, 2 * NAND_BLOCK, NAND_BLOCK, NULL) < 0);
+    TEST_ASSERT(mtd_write(mtd, 2 * NAND_BLOCK, NAND_PAGE, &n, page) < 0);
+}
+
+static void test_file_persists_across_reopen(void)
+{
+    char path[] = "/tmp/mtd_file_XXXXXX";
+    struct mtd_file file;
+    const char msg[] = "persist";
+    char rd[sizeof(msg)];
+    size_t n;
+    int fd;
+
+    fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+    unlink(path);
+
+    TEST_ASSERT_EQ(mtd_file_open(&file, &nor_cfg, path), 0);
+    mtd_cache_invalidate(mtd_file_to_mtd(&file));
+    TEST_ASSERT_EQ(mtd_write(mtd_file_to_mtd(&file), 4000, sizeof(msg), &n, (const uint8_t *)msg), 0);
+    TEST_ASSERT_EQ(mtd_file_close(&file), 0);
+
+    TEST_ASSERT_EQ(mtd_file_open(&file, &nor_cfg, path), 0);
+    mtd_cache_invalidate(mtd_file_to_mtd(&file));
+    TEST_ASSERT_EQ(mtd_read(mtd_file_to_mtd(&file), 4000, sizeof(rd), &n, (uint8_t *)rd), 0);
+    TEST_ASSERT_EQ(memcmp(rd, msg, sizeof(msg)), 0);
+    TEST_ASSERT_EQ(mtd_file_close(&file), 0);
+    unlink(path);
+}
+
+int main(void)
+{
+    TEST_RUN(test_nor_program_is_bitwise_and);
+    TEST_RUN(test_timing_model);
+    TEST_RUN(test_timing_delay_hook);
+    TEST_RUN(test_write_fault_tears_and_powers_off);
+    TEST_RUN(test_erase_limit_reports_fail_addr);
+    TEST_RUN(test_read_flip_every);
+    TEST_RUN(test_nand_oob_and_bad_block);
+    TEST_RUN(test_file_persists_across_reopen);
+
+    return test_summary();
+}
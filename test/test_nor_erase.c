@@ -0,0 +1,203 @@
+/**
+  ******************************************************************************
+  * @file        : test_nor_erase.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : spi_nor 擦除规划测试: 覆盖范围与擦除耗时
+  * @attention   : 器件按命令计擦除时间 (20h 45ms / 52h 120ms / D8h 150ms, 按1/100缩放
+  *                以减少状态轮询帧数, 比例不变), 期望耗时由动态规划求出的最优 4K/32K/64K 组合给出
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nor_sim.h"
+#include "spi_nor.h"
+#include "mtd.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_HZ                  50000000U
+#define UNIT                    4096U
+#define MAX_UNITS               (2U * 1024U * 1024U / UNIT)
+#define TIME_SCALE              100U        /* 器件时间缩放倍数, 打印时还原 */
+#define REAL_MS(ns)             ((double)(ns) * TIME_SCALE / 1e6)
+
+/* Private typedef -----------------------------------------------------------*/
+struct erase_range {
+    uint32_t addr;
+    uint32_t len;
+};
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;
+static struct nor_sim sim;
+static struct spi_nor nor;
+static struct spi_device dev = {
+    .name = "nor", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+
+static const struct nor_sim_config sim_cfg = {
+    .id = { 0xEF, 0x40, 0x18 },
+    .size = 16U * 1024U * 1024U,
+    .timing = { .tpp_us = 7, .tse_us = 450, .tbe32_us = 1200, .tbe64_us = 1500,
+                .tce_ms = 400, .tw_us = 100 },
+};
+
+/* 起点/终点分别落在 4K、32K、64K 边界上的各种组合 */
+static const struct erase_range ranges[] = {
+    { 0x000000, 0x001000 },
+    { 0x000000, 0x010000 },
+    { 0x001000, 0x00F000 },
+    { 0x007000, 0x00A000 },
+    { 0x00F000, 0x002000 },
+    { 0x008000, 0x018000 },
+    { 0x001000, 0x01E000 },
+    { 0x018000, 0x030000 },
+    { 0x007000, 0x100000 },
+    { 0x000000, 0x100000 },
+};
+
+/* Private functions ---------------------------------------------------------*/
+static struct mtd_info *nor_open(void)
+{
+    nor_sim_free(&sim);
+    TEST_ASSERT_EQ(nor_sim_init(&sim, &sim_cfg), 0);
+
+    memset(&nor, 0, sizeof(nor));
+    nor.spi = &dev;
+    TEST_ASSERT_EQ(spi_nor_scan(&nor, SNOR_HWCAPS_DEFAULT), 0);
+    TEST_ASSERT_EQ(spi_nor_mtd_init(&nor, "nor"), 0);
+    mtd_cache_invalidate(&nor.mtd);
+
+    return &nor.mtd;
+}
+
+/**
+  * @brief  [addr, addr+len) 只用对齐的 4K/32K/64K 块恰好覆盖时的最短擦除时间 (ns)
+  */
+static uint64_t optimal_erase_ns(uint32_t addr, uint32_t len)
+{
+    static const uint32_t units[] = { 1, 8, 16 };
+    const uint64_t cost[] = {
+        sim_cfg.timing.tse_us * 1000ULL,
+        sim_cfg.timing.tbe32_us * 1000ULL,
+        sim_cfg.timing.tbe64_us * 1000ULL,
+    };
+    static uint64_t best[MAX_UNITS + 1];
+    uint32_t start = addr / UNIT;
+    uint32_t n = len / UNIT;
+    uint32_t i, k;
+    uint64_t c;
+
+    best[n] = 0;
+    for (i = n; i-- > 0;) {
+        best[i] = UINT64_MAX;
+        for (k = 0; k < sizeof(units) / sizeof(units[0]); k++) {
+            if ((start + i) % units[k] || i + units[k] > n)
+                continue;
+            c = cost[k] + best[i + units[k]];
+            if (c < best[i])
+                best[i] = c;
+        }
+    }
+
+    return best[0];
+}
+
+/**
+  * @brief  擦除并检查: 范围内全为 0xFF, 前后 64KB 保持原样, 耗时等于最优组合
+  */
+static void check_erase(struct mtd_info *mtd, uint32_t addr, uint32_t len, int verbose)
+{
+    struct erase_info ei = { .addr = addr, .len = len };
+    uint32_t lo = addr >= 0x10000U ? addr - 0x10000U : 0U;
+    uint32_t hi = addr + len + 0x10000U;
+    uint32_t i;
+
+    memset(&sim.mem[lo], 0x00, hi - lo);
+    nor_sim_reset_stats(&sim);
+
+    TEST_ASSERT_EQ(mtd_erase(mtd, &ei), 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+
+    for (i = lo; i < hi; i++)
+        TEST_ASSERT_EQ(sim.mem[i], (i >= addr && i < addr + len) ? 0xFF : 0x00);
+
+    if (verbose)
+        printf("  %06X+%06X  4K x%-3u 32K x%-3u 64K x%-3u  %8.1f ms\n", addr, len,
+               sim.stats.ops[SPINOR_CMD_BE_4K], sim.stats.ops[SPINOR_CMD_BE_32K],
+               sim.stats.ops[SPINOR_CMD_BE_64K], REAL_MS(sim.stats.erase_ns));
+
+    TEST_ASSERT_EQ(sim.stats.erase_ns, optimal_erase_ns(addr, len));
+}
+
+/* ------------------------------------------------------------------ 用例 */
+static void test_mixed_alignment_ranges(void)
+{
+    struct mtd_info *mtd = nor_open();
+    uint32_t i;
+
+    for (i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++)
+        check_erase(mtd, ranges[i].addr, ranges[i].len, 1);
+}
+
+static void test_random_ranges(void)
+{
+    struct mtd_info *mtd = nor_open();
+    uint32_t seed = 0x12345678U;
+    uint32_t addr, len;
+    int i;
+
+    for (i = 0; i < 24; i++) {
+        seed = seed * 1103515245U + 12345U;
+        addr = ((seed >> 8) % (MAX_UNITS / 2U)) * UNIT;
+        seed = seed * 1103515245U + 12345U;
+        len = ((seed >> 8) % 48U + 1U) * UNIT;
+        check_erase(mtd, addr, len, 0);
+    }
+}
+
+/**
+  * @brief  1MB: 规划结果与逐个 4K 擦除的耗时比
+  */
+static void test_faster_than_4k_only(void)
+{
+    struct mtd_info *mtd = nor_open();
+    struct erase_info ei = { .addr = 0, .len = 0x100000 };
+    uint64_t planned;
+    uint32_t addr;
+
+    nor_sim_reset_stats(&sim);
+    TEST_ASSERT_EQ(mtd_erase(mtd, &ei), 0);
+    planned = sim.stats.erase_ns;
+
+    nor_sim_reset_stats(&sim);
+    for (addr = 0; addr < 0x100000U; addr += UNIT)
+        TEST_ASSERT_EQ(spi_nor_sector_erase(&nor, addr), 0);
+
+    printf("  1MB planned %.1f ms, 4K only %.1f ms\n",
+           REAL_MS(planned), REAL_MS(sim.stats.erase_ns));
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_BE_4K], 256);
+    TEST_ASSERT(planned * 4U < sim.stats.erase_ns);
+}
+
+int main(void)
+{
+    if (spi_host_init(&host, "qspi", 0, 0, &nor_sim_model, &sim) ||
+        spi_device_attach(&dev, "qspi")) {
+        fprintf(stderr, "spi host setup failed\n");
+        return 1;
+    }
+
+    TEST_RUN(test_mixed_alignment_ranges);
+    TEST_RUN(test_random_ranges);
+    TEST_RUN(test_faster_than_4k_only);
+
+    nor_sim_free(&sim);
+    return test_summary();
+}
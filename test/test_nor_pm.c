@@ -0,0 +1,324 @@
+/**
+  ******************************************************************************
+  * @file        : test_nor_pm.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : spi_nor 空闲自动掉电测试: 空闲超时发 B9h, 访问前透明唤醒
+  * @attention   : - 空闲定时器随虚拟时钟推进触发, B9h 由定时器回调排入控制器队列
+  *                - tDP/tRES1 由 nor_sim 检查, 未等够即发命令计为违规
+  *                - HAL_GetTick() 按毫秒截断, 时间类断言留 1ms 余量
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nor_sim.h"
+#include "spi_nor.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_HZ                  50000000U
+#define IDLE_MS                 50U
+#define ERASE_ADDR              0x1000U
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;
+static struct spi_device dev = {
+    .name = "nor", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static struct nor_sim sim;
+static struct spi_nor nor;
+static uint8_t buf[NOR_SIM_PAGE_SIZE];
+static int erase_status;
+static int erase_done;
+
+/* W25Q128: tDP = tRES1 = 3us, 与 winbond.c 一致 */
+static const struct nor_sim_config sim_cfg = {
+    .id = { 0xEF, 0x40, 0x18 },
+    .size = 16U * 1024U * 1024U,
+    .timing = { .tpp_us = 700, .tse_us = 45000, .tbe32_us = 120000, .tbe64_us = 150000,
+                .tce_ms = 40000, .tw_us = 10000, .tdp_us = 3, .tres1_us = 3 },
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void nor_power_on(void)
+{
+    uint32_t i;
+
+    nor_sim_free(&sim);
+    TEST_ASSERT_EQ(nor_sim_init(&sim, &sim_cfg), 0);
+    for (i = 0; i < 65536U; i++)
+        sim.mem[i] = (uint8_t)(i * 7U + (i >> 8));
+}
+
+static void nor_probe(void)
+{
+    memset(&nor, 0, sizeof(nor));
+    nor.spi = &dev;
+    TEST_ASSERT_EQ(spi_nor_scan(&nor, SNOR_HWCAPS_DEFAULT), 0);
+    nor_sim_reset_stats(&sim);
+}
+
+static void nor_open(void)
+{
+    nor_power_on();
+    nor_probe();
+}
+
+/**
+  * @brief  读一页并与阵列比较
+  */
+static void check_read(uint32_t addr)
+{
+    memset(buf, 0, sizeof(buf));
+    TEST_ASSERT_EQ(spi_nor_read_data(&nor, addr, sizeof(buf), buf), SPI_NOR_OK);
+    TEST_ASSERT(!memcmp(buf, &sim.mem[addr], sizeof(buf)));
+}
+
+static void erase_cb(struct spi_nor *n, int status, void *arg)
+{
+    (void)n;
+    (void)arg;
+    erase_status = status;
+    erase_done = 1;
+}
+
+/* ------------------------------------------------------------------ 用例 */
+/**
+  * @brief  最后一次访问后满 idle_ms 才掉电, 之前的访问重新计时
+  */
+static void test_idle_timeout(void)
+{
+    nor_open();
+    TEST_ASSERT_EQ(spi_nor_pm_enable(&nor, IDLE_MS), SPI_NOR_OK);
+
+    host_advance_ms(20);
+    check_read(0);
+
+    /* 定时器在 50ms 到期, 距上次访问不足 idle_ms, 顺延 */
+    host_advance_ms(IDLE_MS - 5U);
+    TEST_ASSERT(!sim.dpd);
+    TEST_ASSERT_EQ(nor.pm.state, SNOR_PM_STANDBY);
+
+    host_advance_ms(10);
+    TEST_ASSERT(sim.dpd);
+    TEST_ASSERT_EQ(nor.pm.state, SNOR_PM_POWER_DOWN);
+    TEST_ASSERT_EQ(sim.stats.power_downs, 1);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_POWER_DOWN], 1);
+
+    /* 掉电后定时器不再触发, 器件保持掉电 */
+    host_advance_ms(10U * IDLE_MS);
+    TEST_ASSERT(sim.dpd);
+    TEST_ASSERT_EQ(sim.stats.power_downs, 1);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  掉电后的读/写/擦除先发 ABh 并等待 tRES1, 调用方无感知; 统计与器件一致
+  */
+static void test_transparent_wake(void)
+{
+    struct spi_nor_pm_stats st;
+    uint32_t i;
+
+    nor_open();
+    TEST_ASSERT_EQ(spi_nor_pm_enable(&nor, IDLE_MS), SPI_NOR_OK);
+
+    host_advance_ms(IDLE_MS + 1U);
+    TEST_ASSERT(sim.dpd);
+    host_advance_ms(1000);
+
+    check_read(0x100);
+    TEST_ASSERT(!sim.dpd);
+    TEST_ASSERT_EQ(sim.stats.releases, 1);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_RELEASE_POWER_DOWN], 1);
+
+    spi_nor_pm_get_stats(&nor, &st);
+    printf("  asleep %u ms (device %.3f ms), awake %u ms\n",
+           st.time_ms[SNOR_PM_POWER_DOWN], sim.stats.dpd_ns / 1e6, st.time_ms[SNOR_PM_STANDBY]);
+    TEST_ASSERT_EQ(st.power_downs, 1);
+    TEST_ASSERT_EQ(st.wakeups, 1);
+    TEST_ASSERT(st.time_ms[SNOR_PM_POWER_DOWN] + 1U >= 1000U);
+    TEST_ASSERT(st.time_ms[SNOR_PM_POWER_DOWN] <= 1002U);
+    TEST_ASSERT(sim.stats.dpd_ns / 1000000ULL + 1U >= st.time_ms[SNOR_PM_POWER_DOWN]);
+    TEST_ASSERT(st.time_ms[SNOR_PM_STANDBY] + 1U >= IDLE_MS);
+
+    /* 写路径: WREN/PP/RDSR 都排在 ABh 之后 */
+    host_advance_ms(IDLE_MS + 1U);
+    TEST_ASSERT(sim.dpd);
+    for (i = 0; i < sizeof(buf); i++)
+        buf[i] = (uint8_t)~i;
+    TEST_ASSERT_EQ(spi_nor_erase(&nor, 0x20000U, 4096U, NULL), SPI_NOR_OK);
+    TEST_ASSERT_EQ(sim.stats.releases, 2);
+
+    host_advance_ms(IDLE_MS + 1U);
+    TEST_ASSERT(sim.dpd);
+    TEST_ASSERT_EQ(spi_nor_write(&nor, 0x20000U, sizeof(buf), buf), SPI_NOR_OK);
+    TEST_ASSERT_EQ(sim.stats.releases, 3);
+    for (i = 0; i < sizeof(buf); i++)
+        TEST_ASSERT_EQ(sim.mem[0x20000U + i], (uint8_t)~i);
+
+    spi_nor_pm_get_stats(&nor, &st);
+    TEST_ASSERT_EQ(st.power_downs, 3);
+    TEST_ASSERT_EQ(st.wakeups, 3);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  B9h 之后立即访问: 同一毫秒内先补足 tDP 再发 ABh
+  */
+static void test_wake_within_tdp(void)
+{
+    nor_open();
+
+    TEST_ASSERT_EQ(spi_nor_power_down(&nor), SPI_NOR_OK);
+    TEST_ASSERT(sim.dpd);
+    TEST_ASSERT(spi_nor_read_sr1(&nor) >= 0);
+    TEST_ASSERT(!sim.dpd);
+    TEST_ASSERT_EQ(sim.stats.releases, 1);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  异步擦除期间不掉电 (轮询仍可读SR1), 完成后重新计时
+  */
+static void test_busy_blocks_power_down(void)
+{
+    uint32_t steps = 0;
+
+    nor_open();
+    TEST_ASSERT_EQ(spi_nor_pm_enable(&nor, 10), SPI_NOR_OK);
+
+    erase_done = 0;
+    erase_status = -1;
+    memset(&sim.mem[ERASE_ADDR], 0, 4096U);
+    TEST_ASSERT_EQ(spi_nor_erase_async(&nor, ERASE_ADDR, erase_cb, NULL), SPI_NOR_OK);
+    TEST_ASSERT_EQ(spi_nor_power_down(&nor), SPI_NOR_ERR_BUSY);
+
+    while (!erase_done && steps++ < 100U) {
+        host_advance_ms(5);
+        TEST_ASSERT(erase_done || !sim.dpd);
+    }
+    TEST_ASSERT(erase_done);
+    TEST_ASSERT_EQ(erase_status, SPI_NOR_OK);
+    TEST_ASSERT(!spi_nor_is_busy(&nor));
+    TEST_ASSERT_EQ(sim.mem[ERASE_ADDR], 0xFF);
+    TEST_ASSERT_EQ(sim.mem[ERASE_ADDR + 4095U], 0xFF);
+
+    host_advance_ms(22);
+    TEST_ASSERT(sim.dpd);
+    TEST_ASSERT_EQ(sim.stats.power_downs, 1);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  嵌套映射: 最后一次 unpoint 之前不掉电; 掉电时 point 先唤醒
+  */
+static void test_point_nested(void)
+{
+    const uint8_t *p1;
+    const uint8_t *p2;
+    uint32_t len;
+
+    nor_open();
+    TEST_ASSERT_EQ(spi_nor_pm_enable(&nor, 10), SPI_NOR_OK);
+
+    host_advance_ms(12);
+    TEST_ASSERT(sim.dpd);
+
+    TEST_ASSERT_EQ(spi_nor_point(&nor, 0x100, 16, &len, (const void **)&p1), SPI_NOR_OK);
+    TEST_ASSERT(!sim.dpd);
+    TEST_ASSERT_EQ(spi_nor_point(&nor, 0x200, 16, &len, (const void **)&p2), SPI_NOR_OK);
+    TEST_ASSERT_EQ(nor.pm.pointed, 2);
+    TEST_ASSERT_EQ(nor.pm.active, 1);
+
+    TEST_ASSERT_EQ(spi_nor_unpoint(&nor), SPI_NOR_OK);
+    TEST_ASSERT_EQ(nor.pm.pointed, 1);
+    host_advance_ms(100);
+    TEST_ASSERT(!sim.dpd);
+    TEST_ASSERT(sim.mapped);
+    TEST_ASSERT(!memcmp(p2, &sim.mem[0x200], 16));
+
+    TEST_ASSERT_EQ(spi_nor_unpoint(&nor), SPI_NOR_OK);
+    TEST_ASSERT_EQ(nor.pm.active, 0);
+    TEST_ASSERT(!sim.mapped);
+    TEST_ASSERT_EQ(spi_nor_unpoint(&nor), SPI_NOR_OK);
+    TEST_ASSERT_EQ(nor.pm.active, 0);
+
+    host_advance_ms(12);
+    TEST_ASSERT(sim.dpd);
+    TEST_ASSERT_EQ(sim.stats.power_downs, 2);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  手动掉电/唤醒, 关闭空闲掉电时唤醒器件, 不支持DPD时拒绝开启
+  */
+static void test_manual_and_disable(void)
+{
+    nor_open();
+
+    TEST_ASSERT_EQ(spi_nor_power_down(&nor), SPI_NOR_OK);
+    TEST_ASSERT_EQ(spi_nor_power_down(&nor), SPI_NOR_OK);
+    TEST_ASSERT_EQ(sim.stats.power_downs, 1);
+    host_advance_ms(1);
+    TEST_ASSERT_EQ(spi_nor_release_power_down(&nor), SPI_NOR_OK);
+    TEST_ASSERT(!sim.dpd);
+    check_read(0);
+
+    TEST_ASSERT_EQ(spi_nor_pm_enable(&nor, 10), SPI_NOR_OK);
+    host_advance_ms(12);
+    TEST_ASSERT(sim.dpd);
+    TEST_ASSERT_EQ(spi_nor_pm_enable(&nor, 0), SPI_NOR_OK);
+    TEST_ASSERT(!sim.dpd);
+    host_advance_ms(500);
+    TEST_ASSERT(!sim.dpd);
+    TEST_ASSERT_EQ(sim.stats.power_downs, 2);
+    TEST_ASSERT_EQ(sim.stats.releases, 2);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+
+    nor.flags |= SNOR_F_NO_DPD;
+    TEST_ASSERT_EQ(spi_nor_pm_enable(&nor, 10), SPI_NOR_ERR_NOT_SUPPORTED);
+    TEST_ASSERT_EQ(spi_nor_pm_enable(&nor, 0), SPI_NOR_OK);
+}
+
+/**
+  * @brief  MCU复位而Flash仍在深度掉电: 探测先发 ABh, 能读到ID
+  */
+static void test_scan_while_asleep(void)
+{
+    nor_open();
+    TEST_ASSERT_EQ(spi_nor_power_down(&nor), SPI_NOR_OK);
+    host_advance_ms(1);
+
+    nor_probe();
+    TEST_ASSERT(!sim.dpd);
+    TEST_ASSERT(nor.info != NULL);
+    TEST_ASSERT_EQ(nor.pm.state, SNOR_PM_STANDBY);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+    check_read(0);
+}
+
+int main(void)
+{
+    if (spi_host_init(&host, "qspi", 0, 0, &nor_sim_model, &sim) ||
+        spi_device_attach(&dev, "qspi")) {
+        fprintf(stderr, "spi host setup failed\n");
+        return 1;
+    }
+
+    TEST_RUN(test_idle_timeout);
+    TEST_RUN(test_transparent_wake);
+    TEST_RUN(test_wake_within_tdp);
+    TEST_RUN(test_busy_blocks_power_down);
+    TEST_RUN(test_point_nested);
+    TEST_RUN(test_manual_and_disable);
+    TEST_RUN(test_scan_while_asleep);
+
+    nor_sim_free(&sim);
+    return test_summary();
+}
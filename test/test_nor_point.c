@@ -0,0 +1,239 @@
+/**
+  ******************************************************************************
+  * @file        : test_nor_point.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : mtd_point()/mtd_unpoint() 零拷贝读测试
+  * @attention   : nor_sim 的阵列映射自临时文件, 控制器映射窗口直接指向该映射
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nor_sim.h"
+#include "spi_nor.h"
+#include "mtd.h"
+#include "errno-base.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_HZ                  50000000U
+#define ASSET_ADDR              0x20000U
+#define ASSET_LEN               (16U * 1024U)
+
+#define CAPS_QUAD               (SPI_CAP_TX_DUAL | SPI_CAP_RX_DUAL | \
+                                 SPI_CAP_TX_QUAD | SPI_CAP_RX_QUAD)
+
+#define HWCAPS_ALL              (SNOR_HWCAPS_READ | SNOR_HWCAPS_READ_FAST | \
+                                 SNOR_HWCAPS_READ_1_1_4 | SNOR_HWCAPS_READ_1_4_4 | \
+                                 SNOR_HWCAPS_PP | SNOR_HWCAPS_PP_1_1_4)
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;            /* 带映射窗口 */
+static struct spi_host host_plain;      /* 只有间接传输 */
+static struct spi_host_model plain_model;
+static struct spi_device dev = {
+    .name = "nor", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static struct spi_device dev_plain = {
+    .name = "nor_plain", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static struct nor_sim sim;
+static struct spi_nor nor;
+static char path[] = "/tmp/nor_point_XXXXXX";
+static uint8_t asset[ASSET_LEN];
+
+static const struct nor_sim_config sim_cfg = {
+    .id = { 0xEF, 0x40, 0x18 },
+    .size = 16U * 1024U * 1024U,
+    .path = path,
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  上电 (保留文件内容) 并探测
+  */
+static struct mtd_info *nor_open(struct spi_device *spi)
+{
+    nor_sim_free(&sim);
+    TEST_ASSERT_EQ(nor_sim_init(&sim, &sim_cfg), 0);
+
+    memset(&nor, 0, sizeof(nor));
+    nor.spi = spi;
+    TEST_ASSERT_EQ(spi_nor_scan(&nor, HWCAPS_ALL), 0);
+    TEST_ASSERT_EQ(spi_nor_mtd_init(&nor, "nor"), 0);
+    mtd_cache_invalidate(&nor.mtd);
+
+    return &nor.mtd;
+}
+
+static struct mtd_info *nor_open_with_asset(void)
+{
+    struct mtd_info *mtd = nor_open(&dev);
+    struct erase_info ei = { .addr = ASSET_ADDR, .len = ASSET_LEN };
+    size_t n;
+
+    TEST_ASSERT_EQ(mtd_erase(mtd, &ei), 0);
+    TEST_ASSERT_EQ(mtd_write(mtd, ASSET_ADDR, ASSET_LEN, &n, asset), 0);
+    TEST_ASSERT_EQ(n, ASSET_LEN);
+
+    return mtd;
+}
+
+/* ------------------------------------------------------------------ 用例 */
+/**
+  * @brief  返回的指针就是文件映射中的地址, 且映射用的是驱动选定的读命令
+  */
+static void test_point_returns_mapped_file(void)
+{
+    struct mtd_info *mtd = nor_open_with_asset();
+    const void *virt;
+    size_t retlen;
+    uint8_t disk[64];
+    uint32_t frames;
+    int fd;
+
+    frames = host.stats.frames;
+    TEST_ASSERT_EQ(mtd_point(mtd, ASSET_ADDR, ASSET_LEN, &retlen, &virt), 0);
+    TEST_ASSERT_EQ(retlen, ASSET_LEN);
+    TEST_ASSERT(virt == sim.mem + ASSET_ADDR);
+    TEST_ASSERT(memcmp(virt, asset, ASSET_LEN) == 0);
+    TEST_ASSERT_EQ(host.stats.frames, frames);
+    TEST_ASSERT_EQ(sim.stats.mmaps, 1);
+    TEST_ASSERT(sim.mapped);
+    TEST_ASSERT_EQ(sim.map.opcode, nor.read_opcode);
+    TEST_ASSERT_EQ(sim.map.opcode, SPINOR_CMD_READ_1_4_4);
+    TEST_ASSERT_EQ(sim.map.data_nbits, SPI_NBITS_QUAD);
+
+    TEST_ASSERT_EQ(mtd_unpoint(mtd, ASSET_ADDR, ASSET_LEN), 0);
+    TEST_ASSERT(!sim.mapped);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+
+    fd = open(path, O_RDONLY);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT_EQ(pread(fd, disk, sizeof(disk), ASSET_ADDR + 100), sizeof(disk));
+    close(fd);
+    TEST_ASSERT(memcmp(disk, &asset[100], sizeof(disk)) == 0);
+}
+
+/**
+  * @brief  嵌套映射只进入一次映射模式, 最后一次释放后才退出
+  */
+static void test_point_nested(void)
+{
+    struct mtd_info *mtd = nor_open_with_asset();
+    const void *a, *b;
+    size_t n;
+
+    TEST_ASSERT_EQ(mtd_point(mtd, ASSET_ADDR, 256, &n, &a), 0);
+    TEST_ASSERT_EQ(mtd_point(mtd, ASSET_ADDR + 4096, 256, &n, &b), 0);
+    TEST_ASSERT((const uint8_t *)b - (const uint8_t *)a == 4096);
+    TEST_ASSERT_EQ(sim.stats.mmaps, 1);
+
+    TEST_ASSERT_EQ(mtd_unpoint(mtd, ASSET_ADDR + 4096, 256), 0);
+    TEST_ASSERT(sim.mapped);
+    TEST_ASSERT_EQ(mtd_unpoint(mtd, ASSET_ADDR, 256), 0);
+    TEST_ASSERT(!sim.mapped);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  映射期间的间接读: 控制器先退出映射模式, 传输结束后恢复窗口
+  */
+static void test_indirect_read_while_pointed(void)
+{
+    struct mtd_info *mtd = nor_open_with_asset();
+    static uint8_t buf[ASSET_LEN];
+    const void *virt;
+    size_t n;
+
+    TEST_ASSERT_EQ(mtd_point(mtd, ASSET_ADDR, ASSET_LEN, &n, &virt), 0);
+    TEST_ASSERT_EQ(mtd_read(mtd, ASSET_ADDR, ASSET_LEN, &n, buf), 0);
+    TEST_ASSERT(memcmp(buf, asset, ASSET_LEN) == 0);
+    TEST_ASSERT(sim.mapped);
+    TEST_ASSERT(sim.stats.mmaps >= 2);
+    TEST_ASSERT(memcmp(virt, asset, ASSET_LEN) == 0);
+    TEST_ASSERT_EQ(mtd_unpoint(mtd, ASSET_ADDR, ASSET_LEN), 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  释放后擦写, 再次映射看到新内容; 掉电重启后内容仍在文件中
+  */
+static void test_rewrite_after_unpoint_persists(void)
+{
+    struct mtd_info *mtd = nor_open_with_asset();
+    struct erase_info ei = { .addr = ASSET_ADDR, .len = 4096 };
+    static const char msg[] = "rewritten";
+    const void *virt;
+    size_t n;
+
+    TEST_ASSERT_EQ(mtd_point(mtd, ASSET_ADDR, 4096, &n, &virt), 0);
+    TEST_ASSERT_EQ(mtd_unpoint(mtd, ASSET_ADDR, 4096), 0);
+
+    TEST_ASSERT_EQ(mtd_erase(mtd, &ei), 0);
+    TEST_ASSERT_EQ(mtd_write(mtd, ASSET_ADDR, sizeof(msg), &n, (const uint8_t *)msg), 0);
+
+    mtd = nor_open(&dev);
+    TEST_ASSERT_EQ(mtd_point(mtd, ASSET_ADDR, 8192, &n, &virt), 0);
+    TEST_ASSERT(memcmp(virt, msg, sizeof(msg)) == 0);
+    TEST_ASSERT(memcmp((const uint8_t *)virt + 4096, &asset[4096], 4096) == 0);
+    TEST_ASSERT_EQ(mtd_unpoint(mtd, ASSET_ADDR, 8192), 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+static void test_point_without_window(void)
+{
+    struct mtd_info *mtd = nor_open(&dev_plain);
+    const void *virt;
+    size_t n;
+
+    TEST_ASSERT_EQ(mtd_point(mtd, ASSET_ADDR, 256, &n, &virt), -ERR_NOTSUPP);
+    TEST_ASSERT_EQ(n, 0);
+    TEST_ASSERT(virt == NULL);
+}
+
+int main(void)
+{
+    uint32_t i;
+    int fd;
+
+    for (i = 0; i < ASSET_LEN; i++)
+        asset[i] = (uint8_t)(i * 29U + (i >> 10));
+
+    fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        return 1;
+    }
+    close(fd);
+
+    plain_model = nor_sim_model;
+    plain_model.mmap = NULL;
+    plain_model.unmap = NULL;
+
+    if (spi_host_init(&host, "qspi", CAPS_QUAD, 0, &nor_sim_model, &sim) ||
+        spi_host_init(&host_plain, "qspi_plain", CAPS_QUAD, 0, &plain_model, &sim) ||
+        spi_device_attach(&dev, "qspi") || spi_device_attach(&dev_plain, "qspi_plain")) {
+        fprintf(stderr, "spi host setup failed\n");
+        unlink(path);
+        return 1;
+    }
+
+    TEST_RUN(test_point_returns_mapped_file);
+    TEST_RUN(test_point_nested);
+    TEST_RUN(test_indirect_read_while_pointed);
+    TEST_RUN(test_rewrite_after_unpoint_persists);
+    TEST_RUN(test_point_without_window);
+
+    nor_sim_free(&sim);
+    unlink(path);
+    return test_summary();
+}
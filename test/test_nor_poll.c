@@ -0,0 +1,226 @@
+/**
+  ******************************************************************************
+  * @file        : test_nor_poll.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : spi_nor_wait_ready() 测试: 保持片选连续读SR1 与 控制器硬件状态轮询
+  * @attention   : - 同一 nor_sim 挂在两个控制器上, 只有 "qspi_poll" 提供 poll_status
+  *                - 响应延迟 = 函数返回时刻 - WIP 清零时刻, 帧数取器件收到的 05h 帧
+  *                - 逐次RDSR的帧数按每帧 16 个时钟估算 (不含软件开销, 是下限)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nor_sim.h"
+#include "spi_nor.h"
+#include "elog.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_HZ                  50000000U
+#define SR_BURST                32U         /* 与 spi_nor.c 的 SPI_NOR_SR_BURST 一致 */
+#define POLL_INTERVAL_NS        1000U       /* 与 spi_nor.c 的 SPI_NOR_POLL_INTERVAL_US 一致 */
+#define WAIT_TIMEOUT_NS         1000000000ULL   /* 写状态寄存器的等待上限 SPI_NOR_TIMEOUT_MS */
+
+/* 05h + n 字节状态的一帧所需时间, 加一次 HAL_GetTick() */
+#define RDSR_FRAME_NS(n)        (((n) + 1ULL) * 8ULL * 1000000000ULL / SPI_HZ + HOST_TICK_COST_NS)
+
+/* Private typedef -----------------------------------------------------------*/
+struct wait_result {
+    uint64_t busy_ns;           /* 命令发出到 WIP 清零 */
+    uint64_t latency_ns;        /* WIP 清零到函数返回 */
+    uint32_t frames;            /* 05h 帧数 */
+};
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;            /* 软件读状态 */
+static struct spi_host host_poll;       /* 另有硬件状态轮询 */
+static struct spi_device dev = {
+    .name = "nor", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static struct spi_device dev_poll = {
+    .name = "nor_poll", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static struct nor_sim sim;
+static struct spi_nor nor;
+static uint8_t page[NOR_SIM_PAGE_SIZE];
+
+/* W25Q128 典型值; tW 远大于等待上限, 用于超时用例 */
+static const struct nor_sim_config sim_cfg = {
+    .id = { 0xEF, 0x40, 0x18 },
+    .size = 16U * 1024U * 1024U,
+    .timing = { .tpp_us = 700, .tse_us = 45000, .tbe32_us = 120000, .tbe64_us = 150000,
+                .tce_ms = 40000, .tw_us = 3000000 },
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void nor_open(struct spi_device *spi)
+{
+    nor_sim_free(&sim);
+    TEST_ASSERT_EQ(nor_sim_init(&sim, &sim_cfg), 0);
+
+    memset(&nor, 0, sizeof(nor));
+    nor.spi = spi;
+    TEST_ASSERT_EQ(spi_nor_scan(&nor, SNOR_HWCAPS_DEFAULT), 0);
+}
+
+/**
+  * @brief  操作返回后 WIP 必已清零, 统计等待过程
+  */
+static void wait_done(uint64_t t0, struct wait_result *r)
+{
+    uint64_t now = host_now_ns();
+
+    TEST_ASSERT(!nor_sim_busy(&sim));
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+    TEST_ASSERT(sim.busy_until > t0);
+
+    r->busy_ns = sim.busy_until - t0;
+    r->latency_ns = now - sim.busy_until;
+    r->frames = sim.stats.ops[SPINOR_CMD_RDSR];
+}
+
+static void do_program(uint32_t addr, struct wait_result *r)
+{
+    uint64_t t0;
+    uint32_t i;
+
+    for (i = 0; i < sizeof(page); i++)
+        page[i] = (uint8_t)(addr + i * 13U);
+
+    nor_sim_reset_stats(&sim);
+    t0 = host_now_ns();
+    TEST_ASSERT_EQ(spi_nor_page_program(&nor, addr, sizeof(page), page), SPI_NOR_OK);
+    wait_done(t0, r);
+    TEST_ASSERT(!memcmp(&sim.mem[addr], page, sizeof(page)));
+}
+
+static void do_erase(uint32_t addr, struct wait_result *r)
+{
+    uint64_t t0;
+
+    memset(&sim.mem[addr], 0x00, 4096U);
+    nor_sim_reset_stats(&sim);
+    t0 = host_now_ns();
+    TEST_ASSERT_EQ(spi_nor_sector_erase(&nor, addr), SPI_NOR_OK);
+    wait_done(t0, r);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_BE_4K], 1);
+    TEST_ASSERT_EQ(sim.mem[addr], 0xFF);
+    TEST_ASSERT_EQ(sim.mem[addr + 4095U], 0xFF);
+}
+
+static void print_result(const char *what, const struct wait_result *r)
+{
+    printf("  %-18s busy %8.1f us  latency %6.0f ns  05h frames %6u (per-RDSR >= %llu)\n",
+           what, r->busy_ns / 1e3, (double)r->latency_ns, r->frames,
+           (unsigned long long)(r->busy_ns / RDSR_FRAME_NS(1)));
+}
+
+/* ------------------------------------------------------------------ 用例 */
+/**
+  * @brief  突发从1字节起翻倍: 短操作的延迟不超过一次满突发, 帧数远少于逐次读
+  */
+static void test_burst_program(void)
+{
+    struct wait_result r;
+    uint32_t addr;
+
+    nor_open(&dev);
+
+    for (addr = 0; addr < 8U * NOR_SIM_PAGE_SIZE; addr += NOR_SIM_PAGE_SIZE) {
+        do_program(addr, &r);
+        TEST_ASSERT(r.latency_ns <= RDSR_FRAME_NS(SR_BURST));
+        TEST_ASSERT(r.frames * 8U < r.busy_ns / RDSR_FRAME_NS(1));
+    }
+    print_result("burst, tPP", &r);
+}
+
+/**
+  * @brief  长擦除: 稳定在满突发后每帧覆盖 SR_BURST 次查询, 帧数约为逐次读的 2/(SR_BURST+1)
+  */
+static void test_burst_erase(void)
+{
+    struct wait_result r;
+
+    nor_open(&dev);
+
+    do_erase(0x10000U, &r);
+    print_result("burst, tSE", &r);
+
+    TEST_ASSERT(r.latency_ns <= RDSR_FRAME_NS(SR_BURST));
+    TEST_ASSERT(r.frames * 10U < r.busy_ns / RDSR_FRAME_NS(1));
+    TEST_ASSERT_EQ(host.stats.polls, 0);
+}
+
+/**
+  * @brief  控制器按间隔比较SR1: 延迟不超过一个间隔加一帧, 状态读全部由硬件发出
+  */
+static void test_hw_poll(void)
+{
+    struct wait_result r;
+    uint32_t polls;
+
+    nor_open(&dev_poll);
+
+    polls = host_poll.stats.polls;
+    do_program(0, &r);
+    print_result("hw poll, tPP", &r);
+    TEST_ASSERT(r.latency_ns <= POLL_INTERVAL_NS + RDSR_FRAME_NS(1));
+    TEST_ASSERT_EQ(r.frames, host_poll.stats.polls - polls);
+
+    polls = host_poll.stats.polls;
+    do_erase(0x10000U, &r);
+    print_result("hw poll, tSE", &r);
+    TEST_ASSERT(r.latency_ns <= POLL_INTERVAL_NS + RDSR_FRAME_NS(1));
+    TEST_ASSERT_EQ(r.frames, host_poll.stats.polls - polls);
+    TEST_ASSERT(r.frames * 2U > r.busy_ns / (POLL_INTERVAL_NS + RDSR_FRAME_NS(1)));
+}
+
+/**
+  * @brief  WIP 不清零时两条路径都在等待上限处返回超时
+  * @note   起点取自 HAL_GetTick(), 实际等待可比上限少不到 1ms
+  */
+static void test_timeout(void)
+{
+    struct spi_device *devs[] = { &dev, &dev_poll };
+    uint64_t t0, elapsed;
+    uint32_t i;
+
+    host_log_level = ELOG_LVL_ASSERT;
+    for (i = 0; i < sizeof(devs) / sizeof(devs[0]); i++) {
+        nor_open(devs[i]);
+
+        t0 = host_now_ns();
+        TEST_ASSERT_EQ(spi_nor_write_sr1(&nor, 0), SPI_NOR_ERR_TIMEOUT);
+        elapsed = host_now_ns() - t0;
+        printf("  %-18s timeout after %.3f ms\n", devs[i]->name, elapsed / 1e6);
+
+        TEST_ASSERT(nor_sim_busy(&sim));
+        TEST_ASSERT(elapsed + 1000000ULL > WAIT_TIMEOUT_NS);
+        TEST_ASSERT(elapsed < WAIT_TIMEOUT_NS + 1000000ULL);
+    }
+    host_log_level = ELOG_LVL_WARN;
+}
+
+int main(void)
+{
+    if (spi_host_init(&host, "qspi", 0, 0, &nor_sim_model, &sim) ||
+        spi_host_init(&host_poll, "qspi_poll", 0, SPI_HOST_F_POLL, &nor_sim_model, &sim) ||
+        spi_device_attach(&dev, "qspi") || spi_device_attach(&dev_poll, "qspi_poll")) {
+        fprintf(stderr, "spi host setup failed\n");
+        return 1;
+    }
+
+    TEST_RUN(test_burst_program);
+    TEST_RUN(test_burst_erase);
+    TEST_RUN(test_hw_poll);
+    TEST_RUN(test_timeout);
+
+    nor_sim_free(&sim);
+    return test_summary();
+}
@@ -0,0 +1,311 @@
+/**
+  ******************************************************************************
+  * @file        : test_sfdp_smpt.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : SFDP 扇区映射表 (SMPT) 测试: 配置检测、擦除区域、擦除规划与分区擦除粒度
+  * @attention   : 1MB 混合扇区器件, BFPT 只给出 4K(20h)/64K(D8h) 两种擦除类型;
+  *                65h 读地址4的 bit2 选择映射:
+  *                  映射0: [0,128K) 4K|64K, [128K,1M) 64K
+  *                  映射1: [0,896K) 64K, [896K,992K) 4K|64K (64K 与边界不对齐), [992K,1M) 4K
+  *                nor_sim 按同样的区域检查每条擦除命令
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nor_sim.h"
+#include "spi_nor.h"
+#include "mtd.h"
+#include "elog.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_HZ                  50000000U
+#define FLASH_SIZE              (1024U * 1024U)
+#define KB(n)                   ((n) * 1024U)
+
+#define BFPT_PTP                0x40U
+#define SMPT_PTP                0x100U
+#define CFG_REG_ADDR            4U
+#define CFG_REG_TOP             0x04U       /* 选择映射1 */
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;
+static struct spi_device dev = {
+    .name = "nor", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static struct nor_sim sim;
+static struct spi_nor nor;
+static uint8_t sfdp[512];
+static uint8_t regs[8];
+
+static const struct nor_sim_region map0[] = {
+    { 0,         KB(128), NOR_SIM_ERASE_4K | NOR_SIM_ERASE_64K },
+    { KB(128),   KB(896), NOR_SIM_ERASE_64K },
+};
+
+static const struct nor_sim_region map1[] = {
+    { 0,         KB(896), NOR_SIM_ERASE_64K },
+    { KB(896),   KB(96),  NOR_SIM_ERASE_4K | NOR_SIM_ERASE_64K },
+    { KB(992),   KB(32),  NOR_SIM_ERASE_4K },
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void put32(uint32_t ofs, uint32_t v)
+{
+    sfdp[ofs + 0] = (uint8_t)v;
+    sfdp[ofs + 1] = (uint8_t)(v >> 8);
+    sfdp[ofs + 2] = (uint8_t)(v >> 16);
+    sfdp[ofs + 3] = (uint8_t)(v >> 24);
+}
+
+/**
+  * @brief  SMPT 区域描述: 大小以256字节为单位, 低4位为可用擦除类型
+  */
+static uint32_t smpt_region(uint32_t size, uint32_t types)
+{
+    return ((size / 256U - 1U) << 8) | types;
+}
+
+/**
+  * @brief  生成 SFDP: 头 + BFPT(16 DWORD) + SMPT
+  * @param  terminated 0=映射1缺少最后一个区域且没有结束标志 (表损坏)
+  */
+static void build_sfdp(int terminated)
+{
+    uint32_t k = 0;
+
+    memset(sfdp, 0xFF, sizeof(sfdp));
+
+    /* SFDP 头, 2个参数头 */
+    put32(0, 0x50444653U);
+    sfdp[4] = 6; sfdp[5] = 1; sfdp[6] = 1; sfdp[7] = 0xFF;
+    /* BFPT 参数头 */
+    sfdp[8] = 0x00; sfdp[9] = 6; sfdp[10] = 1; sfdp[11] = 16;
+    put32(12, BFPT_PTP | 0xFF000000U);
+    /* SMPT 参数头 */
+    sfdp[16] = 0x81; sfdp[17] = 0; sfdp[18] = 1; sfdp[19] = terminated ? 10 : 8;
+    put32(20, SMPT_PTP | 0xFF000000U);
+
+    /* BFPT: 仅3字节地址, 1MB, 4K=20h / 64K=D8h, 256字节页, 不支持暂停, 无QE */
+    memset(&sfdp[BFPT_PTP], 0, 16U * 4U);
+    put32(BFPT_PTP + 0, 0xFFF820E5U & ~(3U << 17));
+    put32(BFPT_PTP + 4, FLASH_SIZE * 8U - 1U);
+    put32(BFPT_PTP + 28, 0xD810200CU);
+    /* 典型擦除时间 4K 1ms / 64K 2ms, 最大为典型的8倍 (器件时间按1/100缩放) */
+    put32(BFPT_PTP + 36, (1U << 11) | (0U << 4) | 3U);
+    put32(BFPT_PTP + 40, 0x80U);
+    put32(BFPT_PTP + 44, 0x80000000U);
+
+    /* 检测命令: 65h, 3字节地址, 8个dummy, 取 bit2 */
+    put32(SMPT_PTP + 4U * k++, (CFG_REG_TOP << 24) | (1U << 22) | (8U << 16) |
+                               ((uint32_t)SPINOR_CMD_RD_EVCR << 8) | 1U);
+    put32(SMPT_PTP + 4U * k++, CFG_REG_ADDR);
+    /* 映射0 (类型位 bit0=4K, bit1=64K) */
+    put32(SMPT_PTP + 4U * k++, (1U << 16) | (0U << 8) | 2U);
+    put32(SMPT_PTP + 4U * k++, smpt_region(KB(128), 3));
+    put32(SMPT_PTP + 4U * k++, smpt_region(KB(896), 2));
+    /* 映射1, 最后一个描述符带结束标志 */
+    put32(SMPT_PTP + 4U * k++, (2U << 16) | (1U << 8) | 3U);
+    put32(SMPT_PTP + 4U * k++, smpt_region(KB(896), 2));
+    put32(SMPT_PTP + 4U * k++, smpt_region(KB(96), 3));
+    if (terminated)
+        put32(SMPT_PTP + 4U * k++, smpt_region(KB(32), 1));
+}
+
+static void nor_open(uint8_t cfg_reg, const struct nor_sim_region *map, size_t nregions)
+{
+    struct nor_sim_config cfg = {
+        .id = { 0x01, 0x60, 0x14 },
+        .size = FLASH_SIZE,
+        .sfdp = sfdp,
+        .sfdp_len = sizeof(sfdp),
+        .regs = regs,
+        .regs_len = sizeof(regs),
+        .regions = map,
+        .nregions = nregions,
+        .timing = { .tpp_us = 7, .tse_us = 450, .tbe64_us = 1500, .tce_ms = 400 },
+    };
+
+    regs[CFG_REG_ADDR] = cfg_reg;
+
+    nor_sim_free(&sim);
+    TEST_ASSERT_EQ(nor_sim_init(&sim, &cfg), 0);
+
+    memset(&nor, 0, sizeof(nor));
+    nor.spi = &dev;
+    TEST_ASSERT_EQ(spi_nor_scan(&nor, SNOR_HWCAPS_READ | SNOR_HWCAPS_PP), 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  擦除并检查命令数、范围内外的内容
+  * @param  n4k/n64k 期望的 20h/D8h 条数, 期望失败时为0
+  */
+static void check_erase(uint32_t addr, uint32_t len, int expect, uint32_t n4k, uint32_t n64k)
+{
+    uint32_t lo = addr >= KB(64) ? addr - KB(64) : 0U;
+    uint32_t hi = addr + len + KB(64) <= FLASH_SIZE ? addr + len + KB(64) : FLASH_SIZE;
+    uint32_t i;
+
+    memset(&sim.mem[lo], 0x00, hi - lo);
+    nor_sim_reset_stats(&sim);
+
+    TEST_ASSERT_EQ(spi_nor_erase(&nor, addr, len, NULL), expect);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_BE_4K], n4k);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_BE_64K], n64k);
+
+    for (i = lo; i < hi; i++)
+        TEST_ASSERT_EQ(sim.mem[i], (expect == 0 && i >= addr && i < addr + len) ? 0xFF : 0x00);
+}
+
+/* ------------------------------------------------------------------ 用例 */
+/**
+  * @brief  映射0: 底部128K可用4K, 其余只用64K; 规划不跨区域, 不对齐时不发命令
+  */
+static void test_bottom_map(void)
+{
+    build_sfdp(1);
+    nor_open(0x00, map0, 2);
+
+    TEST_ASSERT(nor.flags & SNOR_F_HAS_SMPT);
+    TEST_ASSERT_EQ(nor.params.n_regions, 2);
+    TEST_ASSERT_EQ(nor.params.regions[0].size, KB(128));
+    TEST_ASSERT_EQ(nor.params.regions[0].erase_mask, 0x3);
+    TEST_ASSERT_EQ(nor.params.regions[1].offset, KB(128));
+    TEST_ASSERT_EQ(nor.params.regions[1].erase_mask, 0x2);
+    TEST_ASSERT_EQ(nor.sector_size, KB(64));
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_RD_EVCR], 1);
+
+    check_erase(0, KB(192), 0, 0, 3);
+    check_erase(KB(4), KB(8), 0, 2, 0);
+    check_erase(KB(120), KB(72), 0, 2, 1);
+    check_erase(KB(132), KB(4), SPI_NOR_ERR_NOT_ALIGNED, 0, 0);
+    check_erase(KB(128), KB(68), SPI_NOR_ERR_NOT_ALIGNED, 0, 0);
+}
+
+/**
+  * @brief  mtd 导出区域, 分区按所在区域取擦除粒度
+  */
+static void test_mtd_regions(void)
+{
+    const struct mtd_partition parts[] = {
+        { "boot", 0,                  KB(32),  0 },
+        { "kv",   MTDPART_OFS_APPEND, KB(96),  0 },
+        { "data", MTDPART_OFS_APPEND, MTDPART_SIZ_FULL, 0 },
+    };
+    const struct mtd_partition bad = { "x", KB(4), KB(128), 0 };
+    struct mtd_info slots[3];
+    struct erase_info ei = { .addr = KB(4), .len = KB(4) };
+    struct mtd_info *mtd;
+    uint32_t i;
+
+    build_sfdp(1);
+    nor_open(0x00, map0, 2);
+    TEST_ASSERT_EQ(spi_nor_mtd_init(&nor, "nor"), 0);
+    mtd = &nor.mtd;
+    mtd_cache_invalidate(mtd);
+
+    TEST_ASSERT_EQ(mtd->erasesize, KB(64));
+    TEST_ASSERT_EQ(mtd->numeraseregions, 2);
+    TEST_ASSERT_EQ(mtd->eraseregions[0].erasesize, KB(4));
+    TEST_ASSERT_EQ(mtd->eraseregions[0].numblocks, 32);
+    TEST_ASSERT_EQ(mtd->eraseregions[1].offset, KB(128));
+    TEST_ASSERT_EQ(mtd->eraseregions[1].erasesize, KB(64));
+    TEST_ASSERT_EQ(mtd->eraseregions[1].numblocks, 14);
+
+    TEST_ASSERT_EQ(mtd_get_erasesize(mtd, 0, KB(128)), KB(4));
+    TEST_ASSERT_EQ(mtd_get_erasesize(mtd, KB(128), KB(64)), KB(64));
+    TEST_ASSERT_EQ(mtd_get_erasesize(mtd, KB(124), KB(8)), KB(64));
+
+    TEST_ASSERT_EQ(mtd_add_partitions(mtd, parts, slots, 3), 0);
+    TEST_ASSERT_EQ(slots[0].erasesize, KB(4));
+    TEST_ASSERT_EQ(slots[1].erasesize, KB(4));
+    TEST_ASSERT_EQ(slots[2].erasesize, KB(64));
+    TEST_ASSERT_EQ(slots[2].size, KB(896));
+
+    memset(&sim.mem[0], 0x00, KB(12));
+    nor_sim_reset_stats(&sim);
+    TEST_ASSERT_EQ(mtd_erase(&slots[0], &ei), 0);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_BE_4K], 1);
+    for (i = 0; i < KB(12); i++)
+        TEST_ASSERT_EQ(sim.mem[i], (i >= KB(4) && i < KB(8)) ? 0xFF : 0x00);
+
+    for (i = 3; i-- > 0;)
+        TEST_ASSERT_EQ(mtd_del_partition(&slots[i]), 0);
+
+    /* 跨入64K区域且起点不按64K对齐: 只读 */
+    host_log_level = ELOG_LVL_ERROR;
+    TEST_ASSERT_EQ(mtd_add_partitions(mtd, &bad, slots, 1), 0);
+    host_log_level = ELOG_LVL_WARN;
+    TEST_ASSERT_EQ(slots[0].erasesize, KB(64));
+    TEST_ASSERT(!(slots[0].flags & MTD_WRITEABLE));
+    TEST_ASSERT_EQ(mtd_del_partition(&slots[0]), 0);
+
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  映射1: 与参数扇区重叠的64K类型被丢弃, 顶部只用4K
+  */
+static void test_top_map(void)
+{
+    build_sfdp(1);
+    nor_open(CFG_REG_TOP, map1, 3);
+
+    TEST_ASSERT_EQ(nor.params.n_regions, 3);
+    TEST_ASSERT_EQ(nor.params.regions[0].erase_mask, 0x2);
+    TEST_ASSERT_EQ(nor.params.regions[1].offset, KB(896));
+    TEST_ASSERT_EQ(nor.params.regions[1].erase_mask, 0x1);
+    TEST_ASSERT_EQ(nor.params.regions[2].offset, KB(992));
+    TEST_ASSERT_EQ(nor.params.regions[2].erase_mask, 0x1);
+    TEST_ASSERT_EQ(nor.sector_size, KB(64));
+
+    check_erase(KB(832), KB(64), 0, 0, 1);
+    check_erase(KB(896), KB(64), 0, 16, 0);
+    check_erase(KB(900), KB(12), 0, 3, 0);
+    check_erase(KB(988), KB(36), 0, 9, 0);
+    check_erase(KB(892), KB(12), SPI_NOR_ERR_NOT_ALIGNED, 0, 0);
+}
+
+/**
+  * @brief  SMPT 损坏时退回均匀扇区, 探测本身不失败
+  */
+static void test_malformed_smpt(void)
+{
+    build_sfdp(0);
+    nor_open(CFG_REG_TOP, NULL, 0);
+
+    TEST_ASSERT(nor.flags & SNOR_F_HAS_SFDP);
+    TEST_ASSERT_EQ(nor.params.n_regions, 0);
+    TEST_ASSERT_EQ(nor.capacity, FLASH_SIZE);
+
+    TEST_ASSERT_EQ(spi_nor_mtd_init(&nor, "nor"), 0);
+    TEST_ASSERT_EQ(nor.mtd.numeraseregions, 0);
+
+    check_erase(KB(4), KB(8), 0, 2, 0);
+    check_erase(KB(64), KB(128), 0, 0, 2);
+}
+
+int main(void)
+{
+    if (spi_host_init(&host, "qspi", 0, 0, &nor_sim_model, &sim) ||
+        spi_device_attach(&dev, "qspi")) {
+        fprintf(stderr, "spi host setup failed\n");
+        return 1;
+    }
+
+    TEST_RUN(test_bottom_map);
+    TEST_RUN(test_mtd_regions);
+    TEST_RUN(test_top_map);
+    TEST_RUN(test_malformed_smpt);
+
+    nor_sim_free(&sim);
+    return test_summary();
+}
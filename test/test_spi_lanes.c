@@ -0,0 +1,184 @@
+/**
+  ******************************************************************************
+  * @file        : test_spi_lanes.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : 单线/双线/四线读命令选择与时钟数测试
+  * @attention   : 同一器件换控制器能力集重新探测, 比较读 64KB 的数据阶段与总时钟数
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nor_sim.h"
+#include "spi_nor.h"
+#include "mtd.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define READ_LEN                (64U * 1024U)
+#define SPI_HZ                  50000000U
+
+#define CAPS_DUAL               (SPI_CAP_TX_DUAL | SPI_CAP_RX_DUAL)
+#define CAPS_QUAD               (CAPS_DUAL | SPI_CAP_TX_QUAD | SPI_CAP_RX_QUAD)
+
+#define HWCAPS_ALL              (SNOR_HWCAPS_READ | SNOR_HWCAPS_READ_FAST | \
+                                 SNOR_HWCAPS_READ_1_1_2 | SNOR_HWCAPS_READ_1_2_2 | \
+                                 SNOR_HWCAPS_READ_1_1_4 | SNOR_HWCAPS_READ_1_4_4 | \
+                                 SNOR_HWCAPS_PP | SNOR_HWCAPS_PP_1_1_4)
+
+/* Private typedef -----------------------------------------------------------*/
+struct lane_result {
+    uint8_t opcode;
+    uint8_t nbits;              /* 数据阶段线宽 */
+    uint64_t data_clocks;
+    uint64_t total_clocks;
+    uint64_t ns;
+};
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;
+static struct nor_sim sim;
+static struct spi_nor nor;
+static struct spi_device dev = {
+    .name = "nor", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static uint8_t ref[READ_LEN];
+static uint8_t buf[READ_LEN];
+
+static const struct nor_sim_config sim_cfg = {
+    .id = { 0xEF, 0x40, 0x18 },
+    .size = 16U * 1024U * 1024U,
+    .uid = { 1, 2, 3, 4, 5, 6, 7, 8 },
+};
+
+/* Private functions ---------------------------------------------------------*/
+/**
+  * @brief  以给定能力集探测, 读 64KB 并统计
+  */
+static void read_with_caps(uint32_t caps, struct lane_result *res)
+{
+    struct mtd_info *mtd = &nor.mtd;
+    uint64_t t0;
+    size_t n;
+
+    nor_sim_free(&sim);
+    TEST_ASSERT_EQ(nor_sim_init(&sim, &sim_cfg), 0);
+    memcpy(&sim.mem[0x10000], ref, sizeof(ref));
+
+    spi_host_set_caps(&host, caps);
+    memset(&nor, 0, sizeof(nor));
+    nor.spi = &dev;
+    TEST_ASSERT_EQ(spi_nor_scan(&nor, HWCAPS_ALL), 0);
+    TEST_ASSERT_EQ(spi_nor_mtd_init(&nor, "nor"), 0);
+    mtd_cache_invalidate(mtd);
+
+    spi_host_reset_stats(&host);
+    nor_sim_reset_stats(&sim);
+    t0 = host_now_ns();
+    TEST_ASSERT_EQ(mtd_read(mtd, 0x10000, READ_LEN, &n, buf), 0);
+    TEST_ASSERT_EQ(n, READ_LEN);
+    TEST_ASSERT(memcmp(buf, ref, READ_LEN) == 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+
+    res->opcode = nor.read_opcode;
+    res->nbits = spi_nor_get_protocol_data_nbits(nor.read_proto);
+    res->data_clocks = host.stats.clocks[res->nbits];
+    res->total_clocks = spi_host_total_clocks(&host);
+    res->ns = host_now_ns() - t0;
+
+    printf("  %-6s %02Xh  clocks %8llu  %6.2f MB/s\n",
+           caps & SPI_CAP_RX_QUAD ? "quad" : caps & SPI_CAP_RX_DUAL ? "dual" : "single",
+           res->opcode, (unsigned long long)res->total_clocks,
+           (double)READ_LEN * 1000.0 / (double)res->ns);
+}
+
+/* ------------------------------------------------------------------ 用例 */
+static void test_read_opcode_per_caps(void)
+{
+    struct lane_result single, dual, quad;
+
+    read_with_caps(0, &single);
+    read_with_caps(CAPS_DUAL, &dual);
+    read_with_caps(CAPS_QUAD, &quad);
+
+    TEST_ASSERT_EQ(single.opcode, SPINOR_CMD_READ_FAST);
+    TEST_ASSERT_EQ(single.nbits, SPI_NBITS_SINGLE);
+    TEST_ASSERT_EQ(dual.opcode, SPINOR_CMD_READ_1_2_2);
+    TEST_ASSERT_EQ(dual.nbits, SPI_NBITS_DUAL);
+    TEST_ASSERT_EQ(quad.opcode, SPINOR_CMD_READ_1_4_4);
+    TEST_ASSERT_EQ(quad.nbits, SPI_NBITS_QUAD);
+}
+
+/**
+  * @brief  数据阶段时钟数 = len*8/nbits, 命令/地址/dummy 开销只占零头
+  * @note   1-2-2/1-4-4 的地址与dummy也走多线, 计在同一线宽上
+  */
+static void test_quad_speedup(void)
+{
+    struct lane_result single, dual, quad;
+
+    read_with_caps(0, &single);
+    read_with_caps(CAPS_DUAL, &dual);
+    read_with_caps(CAPS_QUAD, &quad);
+
+    TEST_ASSERT(dual.data_clocks >= (uint64_t)READ_LEN * 8U / 2U);
+    TEST_ASSERT(dual.data_clocks < (uint64_t)READ_LEN * 8U / 2U + 64U);
+    TEST_ASSERT(quad.data_clocks >= (uint64_t)READ_LEN * 8U / 4U);
+    TEST_ASSERT(quad.data_clocks < (uint64_t)READ_LEN * 8U / 4U + 64U);
+
+    TEST_ASSERT(quad.total_clocks * 4U < single.total_clocks + single.total_clocks / 50U);
+    TEST_ASSERT(dual.total_clocks * 2U < single.total_clocks + single.total_clocks / 50U);
+    TEST_ASSERT(quad.ns * 3U < single.ns);
+}
+
+static void test_single_lane_controller_stays_single(void)
+{
+    struct lane_result res;
+    uint32_t i;
+
+    read_with_caps(0, &res);
+
+    TEST_ASSERT_EQ(host.stats.clocks[SPI_NBITS_DUAL], 0);
+    TEST_ASSERT_EQ(host.stats.clocks[SPI_NBITS_QUAD], 0);
+    TEST_ASSERT_EQ(sim.sr[1] & SPINOR_SR2_QUAD_EN_BIT1, 0);
+    TEST_ASSERT(sim.stats.ops[SPINOR_CMD_READ_FAST] > 0);
+    for (i = 0; i < 256; i++)
+        TEST_ASSERT(!sim.stats.ops[i] || i == SPINOR_CMD_READ_FAST);
+}
+
+static void test_quad_controller_sets_qe(void)
+{
+    struct lane_result res;
+
+    read_with_caps(CAPS_QUAD, &res);
+
+    TEST_ASSERT(sim.sr[1] & SPINOR_SR2_QUAD_EN_BIT1);
+    TEST_ASSERT_EQ(sim.nv_sr[1] & SPINOR_SR2_QUAD_EN_BIT1, 0);
+}
+
+int main(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < READ_LEN; i++)
+        ref[i] = (uint8_t)(i * 131U + (i >> 8));
+
+    if (spi_host_init(&host, "qspi", 0, 0, &nor_sim_model, &sim) ||
+        spi_device_attach(&dev, "qspi")) {
+        fprintf(stderr, "spi host setup failed\n");
+        return 1;
+    }
+
+    TEST_RUN(test_read_opcode_per_caps);
+    TEST_RUN(test_quad_speedup);
+    TEST_RUN(test_single_lane_controller_stays_single);
+    TEST_RUN(test_quad_controller_sets_qe);
+
+    nor_sim_free(&sim);
+    return test_summary();
+}
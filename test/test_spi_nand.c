@@ -0,0 +1,395 @@
+/**
+  ******************************************************************************
+  * @file        : test_spi_nand.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : spi_nand 驱动测试: 读写/OOB/ECC事件/坏块/流水读吞吐
+  * @attention   : 每个用例对三种器件各跑一遍: W25N01GV (BUF=0 连续读),
+  *                MT29F1G01 (30h/3Fh 流水读), MT29F2G01 (流水读 + 双plane)
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nand_sim.h"
+#include "spi_nand.h"
+#include "mtd.h"
+#include "errno-base.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_HZ                  50000000U
+#define PAGE                    2048U
+#define PPB                     64U
+#define DATA_BLOCKS             8U              /* 写入参考数据的块数 */
+#define DATA_PAGES              (DATA_BLOCKS * PPB)
+#define DATA_SIZE               (DATA_PAGES * PAGE)
+#define SEQ_PAGES               32U
+
+#define CAPS_QUAD               (SPI_CAP_TX_DUAL | SPI_CAP_RX_DUAL | \
+                                 SPI_CAP_TX_QUAD | SPI_CAP_RX_QUAD)
+
+#define HWCAPS_ALL              (SPINAND_HWCAPS_READ_X2 | SPINAND_HWCAPS_READ_X4 | \
+                                 SPINAND_HWCAPS_PROG_X4)
+
+/* Private typedef -----------------------------------------------------------*/
+struct chip {
+    const char *name;
+    struct nand_sim_config cfg;
+    uint8_t corr_flips;         /* 可纠正且达到 bitflip_threshold 的翻转数 */
+};
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;
+static struct nand_sim sim;
+static struct spi_nand nand;
+static struct spi_device dev = {
+    .name = "nand", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+
+static uint8_t ref_data[DATA_SIZE];
+static uint8_t ref_oob[DATA_PAGES * 64U];
+static uint8_t buf[40U * PAGE];
+static uint8_t oob[40U * 128U];
+
+/* 时间取典型值 */
+static const struct chip chips[] = {
+    { "W25N01GV", {
+        .id = { 0xEF, 0xAA, 0x21 }, .flags = NAND_SIM_F_CONT_READ,
+        .page_size = PAGE, .oob_size = 64, .pages_per_block = PPB, .nblocks = 1024,
+        .ecc_strength = 1, .prot = 0x7C, .cfg = SPINAND_CFG_ECC_EN | SPINAND_CFG_BUF,
+        .timing = { .tr_us = 25, .tprog_us = 250, .tbers_us = 2000, .trst_us = 5 } }, 1 },
+    { "MT29F1G01ABAFD", {
+        .id = { 0x2C, 0x14, 0x00 }, .flags = NAND_SIM_F_CACHE_RANDOM | NAND_SIM_F_ECC_3BIT,
+        .page_size = PAGE, .oob_size = 128, .pages_per_block = PPB, .nblocks = 1024,
+        .ecc_strength = 8, .prot = 0x38, .cfg = SPINAND_CFG_ECC_EN,
+        .timing = { .tr_us = 46, .trcbsy_us = 3, .tprog_us = 220, .tbers_us = 2000,
+                    .trst_us = 5 } }, 5 },
+    { "MT29F2G01ABAGD", {
+        .id = { 0x2C, 0x24, 0x00 },
+        .flags = NAND_SIM_F_CACHE_RANDOM | NAND_SIM_F_ECC_3BIT | NAND_SIM_F_TWO_PLANES,
+        .page_size = PAGE, .oob_size = 128, .pages_per_block = PPB, .nblocks = 2048,
+        .ecc_strength = 8, .prot = 0x38, .cfg = SPINAND_CFG_ECC_EN,
+        .timing = { .tr_us = 46, .trcbsy_us = 3, .tprog_us = 220, .tbers_us = 2000,
+                    .trst_us = 5 } }, 5 },
+};
+
+static const struct chip *chip;
+static uint32_t seed;
+
+/* Private functions ---------------------------------------------------------*/
+static uint32_t rnd(void)
+{
+    seed = seed * 1103515245U + 12345U;
+    return seed >> 8;
+}
+
+/**
+  * @brief  上电并探测
+  */
+static struct mtd_info *nand_open(void)
+{
+    nand_sim_free(&sim);
+    TEST_ASSERT_EQ(nand_sim_init(&sim, &chip->cfg), 0);
+
+    memset(&nand, 0, sizeof(nand));
+    nand.spi = &dev;
+    TEST_ASSERT_EQ(spi_nand_scan(&nand, HWCAPS_ALL), 0);
+    TEST_ASSERT_EQ(spi_nand_mtd_init(&nand, NULL), 0);
+
+    return spi_nand_to_mtd(&nand);
+}
+
+/**
+  * @brief  上电, 前 DATA_BLOCKS 块经驱动写入参考数据和 AUTO OOB
+  */
+static struct mtd_info *nand_open_and_write(void)
+{
+    struct mtd_info *mtd = nand_open();
+    uint32_t avail = mtd->oobavail;
+    uint32_t pg;
+
+    for (pg = 0; pg < DATA_PAGES; pg += 16U) {
+        struct mtd_oob_ops ops = {
+            .mode = MTD_OPS_AUTO_OOB,
+            .len = 16U * PAGE, .datbuf = &ref_data[pg * PAGE],
+            .ooblen = 16U * avail, .oobbuf = &ref_oob[pg * avail],
+        };
+        TEST_ASSERT_EQ(mtd_write_oob(mtd, (mtd_addr_t)pg * PAGE, &ops), 0);
+        TEST_ASSERT_EQ(ops.retlen, 16U * PAGE);
+    }
+    TEST_ASSERT_EQ(sim.stats.programs, DATA_PAGES);
+
+    return mtd;
+}
+
+/**
+  * @brief  上电, 参考数据直接放入阵列 (布局同 nand_open_and_write, 省去编程轮询)
+  */
+static struct mtd_info *nand_open_with_data(void)
+{
+    struct mtd_info *mtd = nand_open();
+    uint32_t avail = mtd->oobavail;
+    uint8_t *p;
+    uint32_t pg;
+
+    for (pg = 0; pg < DATA_PAGES; pg++) {
+        p = &sim.mem[(size_t)pg * sim.page_bytes];
+        memset(p, 0xFF, sim.page_bytes);
+        memcpy(p, &ref_data[pg * PAGE], PAGE);
+        memcpy(&p[PAGE + nand.info->oob_free_offs], &ref_oob[pg * avail], avail);
+        sim.nop[pg] = 1;
+    }
+
+    return mtd;
+}
+
+/**
+  * @brief  读 SEQ_PAGES 页并返回设备时间 (ns)
+  */
+static uint64_t timed_seq_read(struct mtd_info *mtd, uint32_t page)
+{
+    uint64_t t0 = host_now_ns();
+    size_t n;
+
+    TEST_ASSERT_EQ(mtd_read(mtd, (mtd_addr_t)page * PAGE, SEQ_PAGES * PAGE, &n, buf), 0);
+    TEST_ASSERT(memcmp(buf, &ref_data[page * PAGE], SEQ_PAGES * PAGE) == 0);
+
+    return host_now_ns() - t0;
+}
+
+/* ------------------------------------------------------------------ 用例 */
+/**
+  * @brief  探测后解除保护, 打开ECC, Winbond 置 BUF=1, 选四线命令
+  */
+static void test_scan(void)
+{
+    struct mtd_info *mtd = nand_open();
+
+    TEST_ASSERT(strcmp(mtd->name, chip->name) == 0);
+    TEST_ASSERT_EQ(mtd->size, (mtd_addr_t)chip->cfg.nblocks * PPB * PAGE);
+    TEST_ASSERT_EQ(mtd->erasesize, PPB * PAGE);
+    TEST_ASSERT_EQ(mtd->writesize, PAGE);
+    TEST_ASSERT_EQ(mtd->oobsize, chip->cfg.oob_size);
+    TEST_ASSERT_EQ(nand.read_opcode, SPINAND_CMD_READ_FROM_CACHE_X4);
+    TEST_ASSERT_EQ(nand.program_opcode, SPINAND_CMD_PROG_LOAD_X4);
+
+    TEST_ASSERT_EQ(sim.prot, 0);
+    TEST_ASSERT(sim.cfg_reg & SPINAND_CFG_ECC_EN);
+    TEST_ASSERT_EQ(!!(sim.cfg_reg & SPINAND_CFG_BUF),
+                   !!(chip->cfg.flags & NAND_SIM_F_CONT_READ));
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  经驱动写入后, 随机偏移/长度的读, 部分带 AUTO OOB 或只读 OOB
+  */
+static void test_random_reads(void)
+{
+    struct mtd_info *mtd = nand_open_and_write();
+    uint32_t avail = mtd->oobavail;
+    uint32_t from, maxo;
+    int i, ret;
+
+    seed = 7;
+    for (i = 0; i < 300; i++) {
+        struct mtd_oob_ops ops = { .mode = MTD_OPS_AUTO_OOB, .datbuf = buf };
+
+        from = rnd() % (DATA_SIZE - 1U);
+        if (rnd() % 4 == 0)
+            from -= from % PAGE;
+        ops.len = (rnd() % 3) ? rnd() % (6U * PAGE) : rnd() % (40U * PAGE);
+        if (from + ops.len > DATA_SIZE)
+            ops.len = DATA_SIZE - from;
+
+        if (rnd() % 3 == 0) {
+            ops.ooboffs = rnd() % avail;
+            ops.ooblen = 1U + rnd() % (3U * avail);
+            ops.oobbuf = oob;
+            maxo = (DATA_PAGES - from / PAGE) * avail - ops.ooboffs;
+            if (ops.ooblen > maxo)
+                ops.ooblen = maxo;
+            if (rnd() % 4 == 0) {
+                ops.len = 0;
+                ops.datbuf = NULL;
+            }
+        }
+
+        ret = mtd_read_oob(mtd, from, &ops);
+        TEST_ASSERT_EQ(ret, 0);
+        TEST_ASSERT_EQ(ops.retlen, ops.len);
+        TEST_ASSERT(memcmp(buf, &ref_data[from], ops.len) == 0);
+        TEST_ASSERT_EQ(ops.oobretlen, ops.ooblen);
+        TEST_ASSERT(memcmp(oob, &ref_oob[(from / PAGE) * avail + ops.ooboffs], ops.ooblen) == 0);
+    }
+
+    printf("  %s: page %u, cache %u, cont %u\n", chip->name, nand.stats.page_reads,
+           nand.stats.cache_reads, nand.stats.cont_reads);
+    if (chip->cfg.flags & NAND_SIM_F_CACHE_RANDOM)
+        TEST_ASSERT(nand.stats.cache_reads > 0);
+    if (chip->cfg.flags & NAND_SIM_F_CONT_READ)
+        TEST_ASSERT(nand.stats.cont_reads > 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  可纠正翻转达到阈值时返回 -ERR_UCLEAN, 无法纠正时 -ERR_IO, 其余页数据正确
+  */
+static void test_ecc_events(void)
+{
+    struct mtd_info *mtd = nand_open_with_data();
+    struct mtd_req_stats st;
+    struct mtd_oob_ops ops = { .len = 4U * PAGE, .datbuf = buf, .stats = &st };
+    uint32_t corrected = mtd->ecc_stats.corrected;
+    uint32_t failed = mtd->ecc_stats.failed;
+
+    sim.flips[10] = chip->corr_flips;
+    memset(&st, 0, sizeof(st));
+    TEST_ASSERT_EQ(mtd_read_oob(mtd, 9U * PAGE, &ops), -ERR_UCLEAN);
+    TEST_ASSERT(memcmp(buf, &ref_data[9U * PAGE], 4U * PAGE) == 0);
+    TEST_ASSERT(st.corrected_bitflips >= chip->corr_flips);
+    TEST_ASSERT(mtd->ecc_stats.corrected > corrected);
+    TEST_ASSERT_EQ(st.uncorrectable_errors, 0);
+    if (chip->cfg.flags & NAND_SIM_F_CONT_READ)
+        TEST_ASSERT_EQ(nand.stats.cont_fallback, 1);
+
+    sim.flips[12] = chip->cfg.ecc_strength + 1U;
+    memset(&st, 0, sizeof(st));
+    ops.retlen = 0;
+    TEST_ASSERT_EQ(mtd_read_oob(mtd, 9U * PAGE, &ops), -ERR_IO);
+    TEST_ASSERT_EQ(st.uncorrectable_errors, 1);
+    TEST_ASSERT_EQ(mtd->ecc_stats.failed, failed + 1U);
+    TEST_ASSERT(memcmp(buf, &ref_data[9U * PAGE], 3U * PAGE) == 0);
+    TEST_ASSERT(memcmp(&buf[3U * PAGE], &ref_data[12U * PAGE], PAGE) != 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  RAW读关闭ECC: 看到原始翻转和整个OOB, 读完恢复ECC与BUF
+  */
+static void test_raw_read(void)
+{
+    struct mtd_info *mtd = nand_open_with_data();
+    uint32_t avail = mtd->oobavail;
+    struct mtd_oob_ops raw = {
+        .mode = MTD_OPS_RAW, .len = PAGE, .datbuf = buf,
+        .ooblen = chip->cfg.oob_size, .oobbuf = oob,
+    };
+    size_t n;
+    int ret;
+
+    TEST_ASSERT_EQ(mtd_read_oob(mtd, 3U * PAGE, &raw), 0);
+    TEST_ASSERT(memcmp(buf, &ref_data[3U * PAGE], PAGE) == 0);
+    TEST_ASSERT(memcmp(&oob[nand.info->oob_free_offs], &ref_oob[3U * avail], avail) == 0);
+    TEST_ASSERT_EQ(oob[0], 0xFF);
+    TEST_ASSERT(sim.cfg_reg & SPINAND_CFG_ECC_EN);
+
+    sim.flips[3] = 1;
+    raw.retlen = 0;
+    raw.oobretlen = 0;
+    TEST_ASSERT_EQ(mtd_read_oob(mtd, 3U * PAGE, &raw), 0);
+    TEST_ASSERT(memcmp(buf, &ref_data[3U * PAGE], PAGE) != 0);
+    ret = mtd_read(mtd, 3U * PAGE, PAGE, &n, buf);
+    TEST_ASSERT(ret == 0 || ret == -ERR_UCLEAN);
+    TEST_ASSERT(memcmp(buf, &ref_data[3U * PAGE], PAGE) == 0);
+
+    TEST_ASSERT(sim.cfg_reg & SPINAND_CFG_ECC_EN);
+    TEST_ASSERT_EQ(!!(sim.cfg_reg & SPINAND_CFG_BUF),
+                   !!(chip->cfg.flags & NAND_SIM_F_CONT_READ));
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  坏块标记, 整块擦除, 非页对齐写被拒绝
+  */
+static void test_bad_block_and_erase(void)
+{
+    struct mtd_info *mtd = nand_open_with_data();
+    struct erase_info ei = { .addr = 6U * PPB * PAGE, .len = 2U * PPB * PAGE };
+    size_t n;
+    uint32_t i;
+
+    TEST_ASSERT_EQ(mtd_block_isbad(mtd, 5U * PPB * PAGE), 0);
+    TEST_ASSERT_EQ(mtd_block_markbad(mtd, 5U * PPB * PAGE), 0);
+    TEST_ASSERT_EQ(mtd_block_isbad(mtd, 5U * PPB * PAGE), 1);
+    TEST_ASSERT_EQ(mtd_block_isbad(mtd, 4U * PPB * PAGE), 0);
+
+    TEST_ASSERT_EQ(mtd_erase(mtd, &ei), 0);
+    TEST_ASSERT_EQ(sim.stats.erases, 2);
+    TEST_ASSERT_EQ(mtd_read(mtd, 6U * PPB * PAGE + 100U, 3U * PAGE, &n, buf), 0);
+    for (i = 0; i < 3U * PAGE; i++)
+        TEST_ASSERT_EQ(buf[i], 0xFF);
+    TEST_ASSERT_EQ(mtd_read(mtd, 5U * PPB * PAGE, PAGE, &n, buf), 0);
+    TEST_ASSERT(memcmp(buf, &ref_data[5U * PPB * PAGE], PAGE) == 0);
+
+    TEST_ASSERT_EQ(mtd_write(mtd, 6U * PPB * PAGE + 1U, PAGE, &n, buf), -ERR_INVAL);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  顺序读: 流水/连续读把阵列载入与总线传输重叠, 每页省下 tR 与传输时间中较小者的大部分
+  */
+static void test_pipelined_read_overlap(void)
+{
+    struct mtd_info *mtd = nand_open_with_data();
+    const struct spi_nand_info *orig = nand.info;
+    struct spi_nand_info plain = *orig;
+    uint64_t xfer_ns = (uint64_t)(PAGE + chip->cfg.oob_size) * 2U * 1000000000ULL / SPI_HZ;
+    uint64_t tr_ns = (uint64_t)chip->cfg.timing.tr_us * 1000U;
+    uint64_t hidden = tr_ns < xfer_ns ? tr_ns : xfer_ns;
+    uint64_t fast, slow;
+
+    /* 跨块边界, 双plane器件中途换plane */
+    fast = timed_seq_read(mtd, PPB - SEQ_PAGES / 2U);
+
+    plain.flags &= ~(uint32_t)(SPINAND_F_CACHE_RANDOM | SPINAND_F_CONT_READ);
+    nand.info = &plain;
+    slow = timed_seq_read(mtd, PPB - SEQ_PAGES / 2U);
+    nand.info = orig;
+
+    printf("  %s x4: %u pages %.1f us/page pipelined, %.1f us/page page-by-page (%.2fx)\n",
+           chip->name, SEQ_PAGES, (double)fast / SEQ_PAGES / 1e3,
+           (double)slow / SEQ_PAGES / 1e3, (double)slow / (double)fast);
+
+    TEST_ASSERT(fast + SEQ_PAGES * hidden * 8U / 10U < slow);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+static void run_chip(const struct chip *c)
+{
+    chip = c;
+    printf("-- %s\n", c->name);
+
+    TEST_RUN(test_scan);
+    TEST_RUN(test_random_reads);
+    TEST_RUN(test_ecc_events);
+    TEST_RUN(test_raw_read);
+    TEST_RUN(test_bad_block_and_erase);
+    TEST_RUN(test_pipelined_read_overlap);
+}
+
+int main(void)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(ref_data); i++)
+        ref_data[i] = (uint8_t)(i * 13U + (i >> 11) * 7U);
+    for (i = 0; i < sizeof(ref_oob); i++)
+        ref_oob[i] = (uint8_t)(i * 5U + 3U);
+
+    if (spi_host_init(&host, "qspi", CAPS_QUAD, 0, &nand_sim_model, &sim) ||
+        spi_device_attach(&dev, "qspi")) {
+        fprintf(stderr, "spi host setup failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < sizeof(chips) / sizeof(chips[0]); i++)
+        run_chip(&chips[i]);
+
+    nand_sim_free(&sim);
+    return test_summary();
+}
@@ -0,0 +1,301 @@
+/**
+  ******************************************************************************
+  * @file        : test_winbond.c
+  * @author      : ZJY
+  * @version     : V1.0
+  * @date        : 2026-10-16
+  * @brief       : Winbond 厂商修正测试: 四线I/O、易失状态寄存器写、安全寄存器、唯一ID
+  * @attention   : 器件不提供SFDP, 参数全部来自 winbond.c 的型号表与修正;
+  *                W25Q128JV 上电时 BP/CMP/WPS 均置位且 LB1=1, W25Q256JV-IM 出厂 QE=1
+  ******************************************************************************
+  * @history     :
+  *         V1.0 : 1. 初始版本
+  ******************************************************************************
+  */
+/* Includes ------------------------------------------------------------------*/
+#include "test.h"
+#include "spi_host.h"
+#include "nor_sim.h"
+#include "spi_nor.h"
+#include "mtd.h"
+#include "errno-base.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define SPI_HZ                  50000000U
+
+#define CAPS_QUAD               (SPI_CAP_TX_DUAL | SPI_CAP_RX_DUAL | \
+                                 SPI_CAP_TX_QUAD | SPI_CAP_RX_QUAD)
+
+#define HWCAPS_ALL              (SNOR_HWCAPS_READ | SNOR_HWCAPS_READ_FAST | \
+                                 SNOR_HWCAPS_READ_1_1_4 | SNOR_HWCAPS_READ_1_4_4 | \
+                                 SNOR_HWCAPS_PP | SNOR_HWCAPS_PP_1_1_4)
+
+#define SR1_PROT                0x7CU       /* BP0~BP2/TB/SEC */
+#define SR2_CMP                 0x40U
+#define SR3_WPS                 0x04U
+
+/* Private variables ---------------------------------------------------------*/
+static struct spi_host host;
+static struct spi_device dev = {
+    .name = "nor", .max_speed_hz = SPI_HZ, .bits_per_word = 8, .mode = SPI_MODE_HW_CS,
+};
+static struct nor_sim sim;
+static struct spi_nor nor;
+static uint8_t wbuf[NOR_SIM_OTP_REGIONS * NOR_SIM_OTP_LEN];
+static uint8_t rbuf[NOR_SIM_OTP_REGIONS * NOR_SIM_OTP_LEN];
+
+static const struct nor_sim_config w25q128jv = {
+    .id = { 0xEF, 0x40, 0x18 },
+    .size = 16U * 1024U * 1024U,
+    .sr = { 0x3C, SR2_CMP | SPINOR_SR2_LB1, SR3_WPS },
+    .uid = { 0xD2, 0x63, 0x38, 0x1C, 0x4B, 0x2D, 0x11, 0x27 },
+    .timing = { .tpp_us = 700, .tse_us = 45000, .tw_us = 10000 },
+};
+
+static const struct nor_sim_config w25q256jv_im = {
+    .id = { 0xEF, 0x70, 0x19 },
+    .size = 32U * 1024U * 1024U,
+    .sr = { 0x00, SPINOR_SR2_QUAD_EN_BIT1, 0x00 },
+    .uid = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 },
+    .timing = { .tpp_us = 700, .tse_us = 45000, .tw_us = 10000 },
+};
+
+/* Private functions ---------------------------------------------------------*/
+static void nor_open(const struct nor_sim_config *cfg)
+{
+    nor_sim_free(&sim);
+    TEST_ASSERT_EQ(nor_sim_init(&sim, cfg), 0);
+
+    memset(&nor, 0, sizeof(nor));
+    nor.spi = &dev;
+    TEST_ASSERT_EQ(spi_nor_scan(&nor, HWCAPS_ALL), 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+static uint32_t sr_writes(void)
+{
+    return sim.stats.ops[SPINOR_CMD_WRSR] + sim.stats.ops[SPINOR_CMD_WRSR2] +
+           sim.stats.ops[SPINOR_CMD_WRSR3];
+}
+
+/**
+  * @brief  经 mtd 写读一段数据, 确认所选的四线协议可用
+  */
+static void check_data_path(uint32_t addr)
+{
+    struct erase_info ei = { .addr = addr, .len = 4096 };
+    size_t n;
+    uint32_t i;
+
+    TEST_ASSERT_EQ(spi_nor_mtd_init(&nor, "nor"), 0);
+    mtd_cache_invalidate(&nor.mtd);
+
+    for (i = 0; i < sizeof(wbuf); i++)
+        wbuf[i] = (uint8_t)(i * 7U + addr);
+
+    spi_host_reset_stats(&host);
+    TEST_ASSERT_EQ(mtd_erase(&nor.mtd, &ei), 0);
+    TEST_ASSERT_EQ(mtd_write(&nor.mtd, addr + 100U, sizeof(wbuf), &n, wbuf), 0);
+    memset(rbuf, 0, sizeof(rbuf));
+    TEST_ASSERT_EQ(mtd_read(&nor.mtd, addr + 100U, sizeof(rbuf), &n, rbuf), 0);
+    TEST_ASSERT(!memcmp(rbuf, wbuf, sizeof(wbuf)));
+    TEST_ASSERT(!memcmp(&sim.mem[addr + 100U], wbuf, sizeof(wbuf)));
+    TEST_ASSERT(host.stats.clocks[SPI_NBITS_QUAD] > 0);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/* ------------------------------------------------------------------ 用例 */
+/**
+  * @brief  探测: 选中 EBh/32h, QE 与解除保护都只用易失写, 非易失位不磨损
+  */
+static void test_scan_w25q128jv(void)
+{
+    nor_open(&w25q128jv);
+
+    TEST_ASSERT(nor.info != NULL);
+    TEST_ASSERT(!strcmp(nor.info->name, "w25q128jv"));
+    TEST_ASSERT_EQ(nor.capacity, 16U * 1024U * 1024U);
+    TEST_ASSERT_EQ(nor.addr_nbytes, 3);
+    TEST_ASSERT_EQ(nor.read_opcode, SPINOR_CMD_READ_1_4_4);
+    TEST_ASSERT_EQ(nor.read_dummy, 6);
+    TEST_ASSERT_EQ(nor.program_opcode, SPINOR_CMD_PP_1_1_4);
+
+    /* 易失: QE=1, BP/TB/SEC/CMP 清零; 98h 解除单块锁 */
+    TEST_ASSERT(sim.sr[1] & SPINOR_SR2_QUAD_EN_BIT1);
+    TEST_ASSERT_EQ(sim.sr[0] & SR1_PROT, 0);
+    TEST_ASSERT_EQ(sim.sr[1] & SR2_CMP, 0);
+    TEST_ASSERT(sim.sr[1] & SPINOR_SR2_LB1);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_GBULK], 1);
+    TEST_ASSERT(sim.stats.v_sr_writes >= 2);
+    TEST_ASSERT_EQ(sim.stats.v_sr_writes, sim.stats.ops[SPINOR_CMD_EWSR]);
+
+    /* 非易失值保持上电时的内容 */
+    TEST_ASSERT_EQ(sim.stats.nv_sr_writes, 0);
+    TEST_ASSERT_EQ(sim.nv_sr[0], w25q128jv.sr[0]);
+    TEST_ASSERT_EQ(sim.nv_sr[1], w25q128jv.sr[1]);
+
+    check_data_path(0x20000U);
+}
+
+/**
+  * @brief  50h 写不占用 tW 也不改非易失值; 软件复位后恢复非易失值, 驱动重新打开QE
+  */
+static void test_volatile_sr(void)
+{
+    uint64_t busy;
+
+    nor_open(&w25q128jv);
+
+    nor_sim_reset_stats(&sim);
+    TEST_ASSERT_EQ(spi_nor_write_volatile_sr1(&nor, 0x0C), SPI_NOR_OK);
+    TEST_ASSERT_EQ(spi_nor_read_sr1(&nor), 0x0C);
+    TEST_ASSERT_EQ(sim.stats.v_sr_writes, 1);
+    TEST_ASSERT_EQ(sim.stats.nv_sr_writes, 0);
+    TEST_ASSERT_EQ(sim.stats.busy_ns, 0);
+    TEST_ASSERT_EQ(sim.nv_sr[0], w25q128jv.sr[0]);
+
+    /* 非易失写 SR1+SR2: 按 tW 等待 */
+    TEST_ASSERT_EQ(spi_nor_write_sr1_sr2(&nor, 0x00, SPINOR_SR2_QUAD_EN_BIT1, false), SPI_NOR_OK);
+    busy = sim.stats.busy_ns;
+    TEST_ASSERT_EQ(sim.stats.nv_sr_writes, 1);
+    TEST_ASSERT_EQ(busy, w25q128jv.timing.tw_us * 1000ULL);
+    TEST_ASSERT_EQ(sim.nv_sr[0], 0x00);
+    TEST_ASSERT_EQ(sim.nv_sr[1], SPINOR_SR2_QUAD_EN_BIT1 | SPINOR_SR2_LB1);
+    TEST_ASSERT(!nor_sim_busy(&sim));
+
+    /* 易失改动在复位后丢失 */
+    TEST_ASSERT_EQ(spi_nor_write_volatile_sr1(&nor, 0x1C), SPI_NOR_OK);
+    TEST_ASSERT_EQ(spi_nor_write_volatile_sr2(&nor, SPINOR_SR2_LB1), SPI_NOR_OK);
+    TEST_ASSERT_EQ(spi_nor_software_reset(&nor), SPI_NOR_OK);
+    TEST_ASSERT_EQ(sim.sr[0], 0x00);
+    TEST_ASSERT(sim.sr[1] & SPINOR_SR2_QUAD_EN_BIT1);
+    TEST_ASSERT_EQ(sim.stats.nv_sr_writes, 1);
+
+    /* 出厂非易失 QE=0 时复位清除易失QE, 驱动须重新置位才能继续四线读 */
+    nor_open(&w25q128jv);
+    TEST_ASSERT_EQ(spi_nor_software_reset(&nor), SPI_NOR_OK);
+    TEST_ASSERT(sim.sr[1] & SPINOR_SR2_QUAD_EN_BIT1);
+    TEST_ASSERT_EQ(sim.stats.nv_sr_writes, 0);
+    check_data_path(0x30000U);
+}
+
+/**
+  * @brief  安全寄存器: 跨区域读写、区域擦除、锁定位检查在发命令之前
+  */
+static void test_security_registers(void)
+{
+    uint32_t i;
+
+    nor_open(&w25q128jv);
+
+    for (i = 0; i < sizeof(wbuf); i++)
+        wbuf[i] = (uint8_t)(i * 13U + 5U);
+
+    /* 区域0 已由 LB1 锁定 */
+    TEST_ASSERT_EQ(spi_nor_program_security_register(&nor, 10, 20, wbuf), -EACCES);
+    TEST_ASSERT_EQ(spi_nor_erase_security_register(&nor, 0), -EACCES);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_PSECR] + sim.stats.ops[SPINOR_CMD_ESECR], 0);
+
+    /* 偏移 456 起 100 字节: 区域1 的 200~255 与区域2 的 0~43 */
+    TEST_ASSERT_EQ(spi_nor_program_security_register(&nor, 256 + 200, 100, wbuf), SPI_NOR_OK);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_PSECR], 2);
+    TEST_ASSERT(!memcmp(&sim.otp[1][200], wbuf, 56));
+    TEST_ASSERT(!memcmp(&sim.otp[2][0], &wbuf[56], 44));
+    TEST_ASSERT_EQ(sim.otp[1][199], 0xFF);
+    TEST_ASSERT_EQ(sim.otp[2][44], 0xFF);
+
+    memset(rbuf, 0, sizeof(rbuf));
+    TEST_ASSERT_EQ(spi_nor_read_security_register(&nor, 256 + 200, 100, rbuf), SPI_NOR_OK);
+    TEST_ASSERT(!memcmp(rbuf, wbuf, 100));
+
+    /* 整个空间一次读出 */
+    TEST_ASSERT_EQ(spi_nor_read_security_register(&nor, 0, 768, rbuf), SPI_NOR_OK);
+    TEST_ASSERT(!memcmp(rbuf, sim.otp, 768));
+    TEST_ASSERT_EQ(spi_nor_read_security_register(&nor, 700, 100, rbuf), SPI_NOR_ERR_INVALID_ADDR);
+
+    /* 擦除区域2, 区域1不受影响 */
+    TEST_ASSERT_EQ(spi_nor_erase_security_register(&nor, 2), SPI_NOR_OK);
+    for (i = 0; i < NOR_SIM_OTP_LEN; i++)
+        TEST_ASSERT_EQ(sim.otp[2][i], 0xFF);
+    TEST_ASSERT(!memcmp(&sim.otp[1][200], wbuf, 56));
+    TEST_ASSERT_EQ(spi_nor_erase_security_register(&nor, 3), SPI_NOR_ERR_INVALID_ADDR);
+
+    /* 置位 LB2 (一次性) 后区域1只读 */
+    TEST_ASSERT_EQ(spi_nor_write_sr2(&nor, (uint8_t)spi_nor_read_sr2(&nor) | SPINOR_SR2_LB2),
+                   SPI_NOR_OK);
+    TEST_ASSERT(sim.nv_sr[1] & SPINOR_SR2_LB2);
+    TEST_ASSERT_EQ(spi_nor_program_security_register(&nor, 256, 4, wbuf), -EACCES);
+    TEST_ASSERT_EQ(spi_nor_erase_security_register(&nor, 1), -EACCES);
+    TEST_ASSERT_EQ(spi_nor_program_security_register(&nor, 512, 4, wbuf), SPI_NOR_OK);
+
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  4Bh: 64位ID, 3字节模式下4个dummy字节
+  */
+static void test_unique_id(void)
+{
+    uint8_t uid[SPI_NOR_UID_MAX];
+
+    nor_open(&w25q128jv);
+
+    memset(uid, 0, sizeof(uid));
+    TEST_ASSERT_EQ(spi_nor_read_unique_id(&nor, uid), 8);
+    TEST_ASSERT(!memcmp(uid, w25q128jv.uid, 8));
+    TEST_ASSERT_EQ(nor.unique_id, 0x1C3863D2U ^ 0x27112D4BU);
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+}
+
+/**
+  * @brief  W25Q256JV-IM: 出厂 QE=1 不写状态寄存器; B7h 后唯一ID多一个dummy字节,
+  *         安全寄存器使用4字节地址
+  */
+static void test_w25q256jv_im(void)
+{
+    uint8_t uid[SPI_NOR_UID_MAX];
+
+    nor_open(&w25q256jv_im);
+
+    TEST_ASSERT(!strcmp(nor.info->name, "w25q256jvm"));
+    TEST_ASSERT_EQ(nor.capacity, 32U * 1024U * 1024U);
+    TEST_ASSERT_EQ(nor.read_opcode, SPINOR_CMD_READ_1_4_4);
+    TEST_ASSERT_EQ(sr_writes(), 0);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_EWSR], 0);
+    TEST_ASSERT_EQ(sim.stats.ops[SPINOR_CMD_GBULK], 0);
+
+    TEST_ASSERT_EQ(nor.addr_nbytes, 4);
+    TEST_ASSERT(sim.addr4);
+    TEST_ASSERT_EQ(nor.unique_id, 0x04030201U ^ 0x08070605U);
+    memset(uid, 0, sizeof(uid));
+    TEST_ASSERT_EQ(spi_nor_read_unique_id(&nor, uid), 8);
+    TEST_ASSERT(!memcmp(uid, w25q256jv_im.uid, 8));
+
+    memcpy(wbuf, "w25q256jv-im otp", 16);
+    TEST_ASSERT_EQ(spi_nor_program_security_register(&nor, 256, 16, wbuf), SPI_NOR_OK);
+    TEST_ASSERT_EQ(spi_nor_read_security_register(&nor, 256, 16, rbuf), SPI_NOR_OK);
+    TEST_ASSERT(!memcmp(rbuf, wbuf, 16));
+    TEST_ASSERT(!memcmp(sim.otp[1], wbuf, 16));
+    TEST_ASSERT_EQ(sim.stats.violations, 0);
+
+    check_data_path(0x1FF0000U);
+}
+
+int main(void)
+{
+    if (spi_host_init(&host, "qspi", CAPS_QUAD, 0, &nor_sim_model, &sim) ||
+        spi_device_attach(&dev, "qspi")) {
+        fprintf(stderr, "spi host setup failed\n");
+        return 1;
+    }
+
+    TEST_RUN(test_scan_w25q128jv);
+    TEST_RUN(test_volatile_sr);
+    TEST_RUN(test_security_registers);
+    TEST_RUN(test_unique_id);
+    TEST_RUN(test_w25q256jv_im);
+
+    nor_sim_free(&sim);
+    return test_summary();
+}
@@ -1,31 +1,261 @@
 /**
   ******************************************************************************
-  * @file        : xxxx.c
+  * @file        : winbond.c
   * @author      : ZJY
   * @version     : V1.0
-  * @date        : 20xx-xx-xx
-  * @brief       : 
-  * @attention   : None
+  * @date        : 2026-10-16
+  * @brief       : Winbond SPI NOR Flash (W25Q系列) 厂商修正
+  * @attention   : - QE位于SR2 bit1, 优先使用 50h 易失写, 避免每次上电磨损非易失位
+  *                - 探测时以易失写清除 BP/TB/SEC/CMP, WPS=1时用 98h 解除单块锁
+  *                - 3组256字节安全寄存器 (0x1000/0x2000/0x3000), 锁定位为SR2 LB1~LB3
+  *                - 4Bh 读64位唯一ID
   ******************************************************************************
   * @history     :
-  *         V1.0 : 1.xxx
+  *         V1.0 : 1. 初始版本
   ******************************************************************************
   */
 /* Includes ------------------------------------------------------------------*/
+#include "spi_nor.h"
+#include "errno-base.h"
+#include <string.h>
+
+#define  LOG_TAG             "winbond"
+#define  LOG_LVL             ELOG_LVL_INFO
+#include "elog.h"
 
 /* Private typedef -----------------------------------------------------------*/
 
 /* Private define ------------------------------------------------------------*/
+#define WINBOND_MFR_ID              0xef
+
+/* BP0~BP3/TB/SEC: 不同容量的位分配不同, 均落在 bit2~bit6 */
+#define WINBOND_SR1_PROT_MASK       GENMASK(6, 2)
+#define WINBOND_SR2_CMP             BIT(6)      /* Complement protect */
+#define WINBOND_SR3_WPS             BIT(2)      /* 1=单块锁保护, 0=BP位保护 */
+
+#define WINBOND_OTP_BASE            0x1000
+#define WINBOND_OTP_OFFSET          0x1000
+#define WINBOND_OTP_LEN             256
+#define WINBOND_OTP_REGIONS         3
+
+#define WINBOND_UID_LEN             8
+#define WINBOND_UID_DUMMY           32          /* 3字节地址模式下4个dummy字节 */
+
+#define WINBOND_TDP_US              3           /* B9h 后进入深度掉电 */
+#define WINBOND_TRES1_US            3           /* ABh 后恢复待机 */
+
+#define WINBOND_FLAGS               (SNOR_INFO_DUAL_READ | SNOR_INFO_QUAD_READ | \
+                                     SNOR_INFO_QUAD_PP | SNOR_INFO_SR_VOLATILE | \
+                                     SNOR_INFO_SUSPEND)
 
 /* Private macro -------------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
 
-/* Exported variables  -------------------------------------------------------*/
-
 /* Private function prototypes -----------------------------------------------*/
+static void winbond_default_init(struct spi_nor *nor);
+static void winbond_post_sfdp(struct spi_nor *nor);
+static int winbond_late_init(struct spi_nor *nor);
+static int winbond_quad_enable(struct spi_nor *nor);
+static int winbond_suspend_status(struct spi_nor *nor);
+static int winbond_otp_is_locked(struct spi_nor *nor, uint32_t region);
+
+static const struct spi_nor_otp_ops winbond_otp_ops = {
+    .read = spi_nor_otp_read_secr,
+    .write = spi_nor_otp_write_secr,
+    .erase = spi_nor_otp_erase_secr,
+    .is_locked = winbond_otp_is_locked,
+};
+
+static const struct spi_nor_fixups winbond_fixups = {
+    .default_init = winbond_default_init,
+    .post_sfdp = winbond_post_sfdp,
+    .late_init = winbond_late_init,
+};
+
+/* -IM/-JM (ID 70xxh) 出厂QE=1, 其余与 -IQ 相同 */
+static const struct flash_info winbond_parts[] = {
+    { "w25q80dv",  0x4014, 1UL << 20, WINBOND_FLAGS, NULL },
+    { "w25q16jv",  0x4015, 1UL << 21, WINBOND_FLAGS, NULL },
+    { "w25q32jv",  0x4016, 1UL << 22, WINBOND_FLAGS, NULL },
+    { "w25q64jv",  0x4017, 1UL << 23, WINBOND_FLAGS, NULL },
+    { "w25q128jv", 0x4018, 1UL << 24, WINBOND_FLAGS, NULL },
+    { "w25q256jv", 0x4019, 1UL << 25, WINBOND_FLAGS, NULL },
+    { "w25q512jv", 0x4020, 1UL << 26, WINBOND_FLAGS, NULL },
+    { "w25q16jvm", 0x7015, 1UL << 21, WINBOND_FLAGS, NULL },
+    { "w25q32jvm", 0x7016, 1UL << 22, WINBOND_FLAGS, NULL },
+    { "w25q64jvm", 0x7017, 1UL << 23, WINBOND_FLAGS, NULL },
+    { "w25q128jvm", 0x7018, 1UL << 24, WINBOND_FLAGS, NULL },
+    { "w25q256jvm", 0x7019, 1UL << 25, WINBOND_FLAGS, NULL },
+};
+
+/* Exported variables  -------------------------------------------------------*/
+const struct spi_nor_manufacturer spi_nor_winbond = {
+    .name = "winbond",
+    .id = WINBOND_MFR_ID,
+    .parts = winbond_parts,
+    .nparts = sizeof(winbond_parts) / sizeof(winbond_parts[0]),
+    .fixups = &winbond_fixups,
+};
 
 /* Exported functions --------------------------------------------------------*/
 
 /* Private functions ---------------------------------------------------------*/
+/**
+ * @brief  无SFDP时补充双线/四线I/O读与安全寄存器、唯一ID、掉电时间参数
+ * @note   BBh: 4个模式位周期 (2线下1字节M7~M0), 无等待;
+ *         EBh: 2个模式位周期 + 4个等待周期. 模式位由dummy发出, 不进入连续读模式
+ */
+static void winbond_default_init(struct spi_nor *nor)
+{
+    struct spi_nor_flash_parameter *params = &nor->params;
+
+    params->hwcaps |= SNOR_HWCAPS_READ_1_2_2 | SNOR_HWCAPS_READ_1_4_4;
+    params->reads[SNOR_CMD_READ_1_2_2].num_mode_clocks = 4;
+    params->reads[SNOR_CMD_READ_1_2_2].num_wait_states = 0;
+    params->reads[SNOR_CMD_READ_1_2_2].opcode = SPINOR_CMD_READ_1_2_2;
+    params->reads[SNOR_CMD_READ_1_2_2].proto = SNOR_PROTO_1_2_2;
+    params->reads[SNOR_CMD_READ_1_4_4].num_mode_clocks = 2;
+    params->reads[SNOR_CMD_READ_1_4_4].num_wait_states = 4;
+    params->reads[SNOR_CMD_READ_1_4_4].opcode = SPINOR_CMD_READ_1_4_4;
+    params->reads[SNOR_CMD_READ_1_4_4].proto = SNOR_PROTO_1_4_4;
+
+    params->otp.base = WINBOND_OTP_BASE;
+    params->otp.offset = WINBOND_OTP_OFFSET;
+    params->otp.len = WINBOND_OTP_LEN;
+    params->otp.n_regions = WINBOND_OTP_REGIONS;
+    params->otp.ops = &winbond_otp_ops;
+
+    params->unique_id_len = WINBOND_UID_LEN;
+    params->unique_id_dummy = WINBOND_UID_DUMMY;
+    
+    params->power_down_us = WINBOND_TDP_US;
+    params->release_power_down_us = WINBOND_TRES1_US;
+
+    params->suspend_status = winbond_suspend_status;
+}
+
+/**
+ * @brief  SFDP (JESD216 BFPT) 的QE描述会指向通用的 31h 非易失写, 改用本厂商实现
+ */
+static void winbond_post_sfdp(struct spi_nor *nor)
+{
+    nor->params.quad_enable = winbond_quad_enable;
+}
+
+/**
+ * @brief  解除写保护, 修正4字节地址模式下的唯一ID dummy
+ */
+static int winbond_late_init(struct spi_nor *nor)
+{
+#if SPI_NOR_UNLOCK_AT_SCAN
+    bool vol = (nor->flags & SNOR_F_SR_VOLATILE) != 0U;
+    int sr1;
+    int sr2;
+    int sr3;
+    int ret;
+
+    sr1 = spi_nor_read_sr1(nor);
+    if (sr1 < 0)
+        return sr1;
+
+    sr2 = spi_nor_read_sr2(nor);
+    if (sr2 < 0)
+        return sr2;
+
+    /* SR1与SR2一起写, 单字节 01h 在部分型号上会清除SR2 */
+    if ((sr1 & WINBOND_SR1_PROT_MASK) || (sr2 & WINBOND_SR2_CMP)) {
+        ret = spi_nor_write_sr1_sr2(nor, (uint8_t)sr1 & ~WINBOND_SR1_PROT_MASK,
+                                    (uint8_t)sr2 & ~WINBOND_SR2_CMP, vol);
+        if (ret < 0)
+            return ret;
+
+        /* SRP=1且/WP为低时写入被忽略, 不视为探测失败 */
+        ret = spi_nor_read_sr1(nor);
+        if (ret >= 0 && (ret & WINBOND_SR1_PROT_MASK))
+            log_w("winbond: block protect locked, SR1=%02X.", ret);
+    }
+
+    sr3 = spi_nor_read_sr3(nor);
+    if (sr3 < 0)
+        return sr3;
+
+    if (sr3 & WINBOND_SR3_WPS) {
+        struct spi_nor_op op;
+
+        (void)memset(&op, 0, sizeof(op));
+        op.proto = SNOR_PROTO_1_1_1;
+        op.opcode = SPINOR_CMD_WREN;
+        ret = spi_nor_exec_op(nor, &op);
+        if (ret < 0)
+            return ret;
+
+        op.opcode = SPINOR_CMD_GBULK;
+        ret = spi_nor_exec_op(nor, &op);
+        if (ret < 0)
+            return ret;
+    }
+#endif
+
+    /* 4字节地址模式下 4Bh 后需5个dummy字节 */
+    if ((nor->flags & SNOR_F_4B_MODE) && nor->params.unique_id_len)
+        nor->params.unique_id_dummy = WINBOND_UID_DUMMY + 8U;
+
+    return SPI_NOR_OK;
+}
+
+/**
+ * @brief  置位SR2 QE, 支持时使用易失写, 写后回读确认
+ */
+static int winbond_quad_enable(struct spi_nor *nor)
+{
+    int ret;
+
+    ret = spi_nor_read_sr2(nor);
+    if (ret < 0)
+        return ret;
+
+    if (ret & SPINOR_SR2_QUAD_EN_BIT1)
+        return SPI_NOR_OK;
+
+    if (nor->flags & SNOR_F_SR_VOLATILE)
+        ret = spi_nor_write_volatile_sr2(nor, (uint8_t)ret | SPINOR_SR2_QUAD_EN_BIT1);
+    else
+        ret = spi_nor_write_sr2(nor, (uint8_t)ret | SPINOR_SR2_QUAD_EN_BIT1);
+    if (ret < 0)
+        return ret;
+
+    ret = spi_nor_read_sr2(nor);
+    if (ret < 0)
+        return ret;
+
+    return (ret & SPINOR_SR2_QUAD_EN_BIT1) ? SPI_NOR_OK : SPI_NOR_ERR_WRITE;
+}
+
+/**
+ * @brief  SR2 SUS 位指示擦写已暂停
+ */
+static int winbond_suspend_status(struct spi_nor *nor)
+{
+    int ret;
+
+    ret = spi_nor_read_sr2(nor);
+    if (ret < 0)
+        return ret;
+
+    return (ret & SPINOR_SR2_SUS) ? 1 : 0;
+}
+
+/**
+ * @brief  LB1~LB3 为一次性锁定位, 置位后对应区域只读
+ */
+static int winbond_otp_is_locked(struct spi_nor *nor, uint32_t region)
+{
+    int ret;
+
+    ret = spi_nor_read_sr2(nor);
+    if (ret < 0)
+        return ret;
 
+    return (ret & (SPINOR_SR2_LB1 << region)) ? 1 : 0;
+}